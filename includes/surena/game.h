@@ -13,7 +13,7 @@
 extern "C" {
 #endif
 
-static const uint64_t SURENA_GAME_API_VERSION = 35;
+static const uint64_t SURENA_GAME_API_VERSION = 36;
 
 typedef uint32_t error_code;
 
@@ -57,6 +57,16 @@ typedef struct seed128_s {
 // anywhere a rng seed is use, SEED_NONE represents not using the rng
 static const seed128 SEED128_NONE = (seed128){.bytes = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
 
+// counter based rng (philox4x32-10): draw K of stream N is a pure function of (seed, N, K), there is no state carried between draws
+// hand every thread / playout its own stream of the same seed and the results are reproducible regardless of scheduling
+// use the game_e_rng_* functions to create and draw from it
+typedef struct game_rng_s {
+    uint32_t key[2]; // derived from the seed
+    uint64_t stream;
+    uint64_t ctr; // next draw of game_e_rng_next
+    uint32_t block[4]; // block of the current ctr, only valid if ctr is not a multiple of 4
+} game_rng;
+
 // moves represent state transitions on the game board (and its internal state)
 // actions represent sets of moves, i.e. sets of concrete moves (action instances / informed moves)
 // every action can be encoded as a move
@@ -145,8 +155,41 @@ typedef struct game_feature_flags_s {
 
     bool move_ordering : 1;
 
+    // FEATURE: !random_moves && !hidden_information && !simultaneous_moves
+    bool unmake_move : 1;
+
+    // the game can generate its concrete moves lazily one by one, otherwise the wrapper iterates the full list
+    bool lazy_moves : 1;
+
+    // FEATURE: !big_moves
+    // the game can list its concrete moves as plain move codes, otherwise the wrapper gathers them from get_concrete_moves
+    bool move_codes : 1;
+
+    // the game has its own batch entrypoint for making many moves at once, otherwise the wrapper falls back to a loop
+    bool make_moves : 1;
+
+    // FEATURE: !big_moves
+    // the game offers the _into variants of its queries, which write to caller owned buffers and never modify the game
+    bool query_into : 1;
+
+    // the game can be placed in one block from a caller supplied arena, otherwise create_in and clone_in fall back to the heap
+    bool create_in : 1;
+
+    // FEATURE: !big_moves && !random_moves && !hidden_information && !simultaneous_moves
+    // many instances of the game can be stepped in lockstep from one struct-of-arrays game_batch, see batch_create
+    bool batch : 1;
+
+    // the game can report how many bytes it owns, see memory_usage
+    bool memory_usage : 1;
+
+    // the game keeps a short journal of its changes and can export just those since an earlier state, see export_state_delta
+    bool export_state_delta : 1;
+
     bool id : 1;
 
+    // the game can give the same id to all states that are equal up to a symmetry of the board, see canonical_id
+    bool canonical_id : 1;
+
     bool eval : 1;
 
     // FEATURE: hidden_information || simultaneous_moves
@@ -166,6 +209,27 @@ typedef struct game_feature_flags_s {
 
 } game_feature_flags;
 
+// caller owned cursor for lazily iterating the concrete moves of a player, see get_moves_begin
+// all fields are opaque to the caller, they are set up by get_moves_begin and only meaningful to the game (or wrapper) that did so
+typedef struct move_iterator_s {
+    player_id player;
+    uint8_t stage; // e.g. captures before quiet moves
+    uint32_t idx; // e.g. the next cell to look at
+    uint32_t sub; // e.g. the next move of the current piece
+    // only used by the wrapper fallback, points into the game owned move list
+    uint32_t count;
+    const move_data* moves;
+} move_iterator;
+
+// bump allocator over a caller owned buffer, games created in it occupy one contiguous block (see create_in)
+// all allocations are aligned for any type, there is no freeing of single allocations, only resetting the whole arena
+// an unaligned buffer loses up to _Alignof(max_align_t) - 1 bytes at its start, size buffers with game_e_arena_buffer_size
+typedef struct game_arena_s {
+    uint8_t* buf;
+    size_t size;
+    size_t used;
+} game_arena;
+
 typedef struct sync_data_s {
     uint8_t player_c;
     uint8_t* players;
@@ -218,6 +282,22 @@ typedef struct timectlstage_s timectlstage; //TODO better name?
 typedef struct game_s game; // forward declare the game for the game methods
 typedef struct game_methods_s game_methods;
 
+// N instances of one game (incl. its options) in game owned struct-of-arrays storage, stepped together by the batch methods (see batch_create)
+// moves of all instances share one dense index space [0, move_space), legal moves are reported as bit masks over it
+// masks are instance major, every instance has game_e_batch_mask_words(batch) u64 words with bit (idx % 64) of word (idx / 64) for index idx
+typedef struct game_batch_s {
+    const game_methods* methods;
+    uint32_t count;
+    uint32_t move_space;
+    const move_code* move_codes; // move_codes[idx] is the move code of move index idx, owned by the batch
+    void* data; // owned by the game method
+} game_batch;
+
+// no move for this instance in batch_make_moves, e.g. because it is already over
+static const uint32_t GAME_BATCH_MOVE_NONE = UINT32_MAX;
+
+typedef struct game_cache_s game_cache; // opaque, owned by the wrapper
+
 ///////
 // game method functions, usage comments are by the typedefs where the arguments are
 
@@ -260,11 +340,33 @@ typedef error_code destroy_gf_t(game* self);
 // undefined behaviour if self == clone_target
 typedef error_code clone_gf_t(game* self, game* clone_target);
 
+// FEATURE: create_in
+// returns the size of the single block the game occupies when created from init_info, or when cloned from self if init_info is NULL
+// for a size from init_info self only needs its methods set, just like for create
+typedef error_code size_hint_gf_t(game* self, game_init* init_info, size_t* ret_size);
+
+// FEATURE: create_in
+// same as create (or clone), but the game data and all its buffers are placed in one block of size_hint taken from the arena
+// fails with ERR_OUT_OF_MEMORY without taking anything from the arena if it has not enough space left
+// the arena must outlive the game, destroy still has to be called but gives nothing back to the arena, reset the arena for that
+// nothing is heap allocated for the game after this, state that grows with the moves made is bounded to what fits the block
+// (e.g. chess in an arena can only unmake the last 32 moves recorded, see unmake_move)
+typedef error_code create_in_gf_t(game* self, game_init* init_info, game_arena* arena);
+
+// FEATURE: create_in
+typedef error_code clone_in_gf_t(game* self, game* clone_target, game_arena* arena);
+
 // deep clone the game state of other into self
 // other is restricted to already created games using the same options, otherwise undefined behaviour
 // undefined behaviour if self == other
 typedef error_code copy_from_gf_t(game* self, game* other);
 
+// FEATURE: memory_usage
+// returns the number of bytes currently owned by the game, this does not include the game struct itself
+// ret_state counts the game data, options and any history kept for unmaking moves, ret_buffers counts the buffers backing the returned read only pointers
+// containers are counted by their current capacity, i.e. this is what is held right now, not what the state strictly needs
+typedef error_code memory_usage_gf_t(game* self, size_t* ret_state, size_t* ret_buffers);
+
 // DEPRECATED
 // FEATURE: compare
 // returns true iff self and other are in a behaviourally identical state (concerning the game methods)
@@ -287,6 +389,14 @@ typedef error_code player_count_gf_t(game* self, uint8_t* ret_count);
 // the returned ptr is valid until the next call on this game, undefined behaviour if used after; it is still owned by the game
 typedef error_code export_state_gf_t(game* self, size_t* ret_size, const char** ret_str);
 
+// FEATURE: export_state_delta
+// writes a game specific delta string that turns the state exported at since_sync_ctr into the current one, and returns a read only pointer to it
+// the games document their delta format, typically the changed cells with their current content plus the small non board part of the state
+// only a bounded number of recent changes is kept, and none across import_state, unmake_move and other changes that are not moves
+// if the delta is not available ret_str is set to NULL (with size 0) and ERR_OK is returned, the receiver then needs the full export_state
+// the returned ptr is valid until the next call on this game, undefined behaviour if used after; it is still owned by the game
+typedef error_code export_state_delta_gf_t(game* self, uint64_t since_sync_ctr, size_t* ret_size, const char** ret_str);
+
 // load the game state from the given string, beware this may be called on running games
 // if str is NULL then the initial position is loaded
 // errors while parsing are handled (NOTE: avoid crashes)
@@ -314,6 +424,46 @@ typedef error_code players_to_move_gf_t(game* self, uint8_t* ret_count, const pl
 // the returned ptr is valid until the next call on this game, undefined behaviour if used after; it is still owned by the game
 typedef error_code get_concrete_moves_gf_t(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves);
 
+// FEATURE: lazy_moves
+// starts a lazy iteration over the same moves get_concrete_moves would list for player, though possibly in a different order
+// the game state must be the same on every get_moves_next as it was here, moves made in between have to be unmade again
+// only available if this ptm is to move
+typedef error_code get_moves_begin_gf_t(game* self, player_id player, move_iterator* it);
+
+// FEATURE: lazy_moves
+// writes the next move of the iteration and advances it, or sets ret_done if there are no more moves (ret_move is not written then)
+// callers may stop at any point, there is nothing to clean up
+// the game only writes the move, for big moves its data is still owned by the game and valid until the next call on this game
+typedef error_code get_moves_next_gf_t(game* self, move_iterator* it, bool* ret_done, move_data* ret_move);
+
+// FEATURE: move_codes
+// same as get_concrete_moves, but writes the plain move codes without the move_data wrapping, for a dense list of moves
+// the returned ptr is valid until the next call on this game, undefined behaviour if used after; it is still owned by the game
+typedef error_code get_concrete_moves_codes_gf_t(game* self, player_id player, uint32_t* ret_count, const move_code** ret_moves);
+
+// FEATURE: query_into
+// the _into variants below write to caller owned buffers instead of the game owned ones and are strictly read only on the game (incl. data1 and data2)
+// i.e. any number of threads can use them concurrently on the same game, as long as no other (modifying) method is called on it meanwhile
+// cap is the capacity of the caller buffer (size for strings, count otherwise), if it can be too small for what the game may write
+// then nothing is written to the buffer, the capacity required is returned in ret_size / ret_count and this fails with ERR_OUT_OF_MEMORY
+// the required capacity is constant per game (i.e. only depends on its options), so it only needs to be queried once
+// everything else behaves exactly like the respective method without _into
+
+// FEATURE: query_into
+typedef error_code players_to_move_into_gf_t(game* self, uint8_t cap, uint8_t* ret_count, player_id* players);
+
+// FEATURE: query_into
+typedef error_code get_concrete_moves_into_gf_t(game* self, player_id player, uint32_t cap, uint32_t* ret_count, move_data* moves);
+
+// FEATURE: query_into
+typedef error_code export_state_into_gf_t(game* self, size_t cap, size_t* ret_size, char* str);
+
+// FEATURE: query_into
+typedef error_code get_move_str_into_gf_t(game* self, player_id player, move_data_sync move, size_t cap, size_t* ret_size, char* str);
+
+// FEATURE: query_into && print
+typedef error_code print_into_gf_t(game* self, size_t cap, size_t* ret_size, char* str);
+
 // FEATURE: random_moves
 // writes the probabilities [0,1] of each avilable move in get_concrete_moves(player=PLAYER_ENV) and returns a read only pointer to them (SUM=1)
 // order is the same as get_concrete_moves
@@ -368,6 +518,28 @@ typedef error_code move_to_action_gf_t(game* self, player_id player, move_data_s
 // the game only reads the move, the caller still has to clean it up
 typedef error_code make_move_gf_t(game* self, player_id player, move_data_sync move);
 
+// FEATURE: make_moves
+// make count moves in sequence, moves[i] is made by players[i], as if by calling make_move for each
+// if trusted is set all moves are known to be legal (e.g. replaying a stored record) and the game may skip all checks
+// otherwise every move is checked for legality (incl. the player being to move) right before it would be made, and the batch stops at the first illegal one
+// returns the number of moves that were made, on error this is the index of the failing move
+// the game does NOT touch the sync_ctr, the wrapper advances it by the number of moves made
+// the game only reads the moves, the caller still has to clean them up
+typedef error_code make_moves_gf_t(game* self, uint32_t count, const player_id* players, const move_data_sync* moves, bool trusted, uint32_t* ret_made);
+
+// FEATURE: unmake_move
+// take back the move that was last made on the game state by player, restoring the exact state from before it was made
+// moves can only be unmade in reverse order of being made (LIFO), undefined behaviour otherwise (MAY CRASH)
+// importing a state discards all moves that could have been unmade so far
+// clones and copy_from targets start without any moves to unmake, only the instance that made the moves can unmake them
+// games that need a history to take back a move (e.g. chess, havannah, twixt_pp) only record the moves made while unmake_history is set
+// a move made without it drops the recorded history, so only the moves since the last game_e_unmake_enable can be unmade
+// games in an arena (see create_in) keep a bounded history in their block, moves before that fail to unmake with ERR_INVALID_INPUT
+// games that can take back every move from the state alone (e.g. tictactoe) ignore the flag, set it anyway to stay portable
+// after a move is unmade the sync_ctr in the game must be decremented!
+// the game only reads the move, the caller still has to clean it up
+typedef error_code unmake_move_gf_t(game* self, player_id player, move_data_sync move);
+
 // writes the result (winning) players and returns a read only pointer to them
 // writes no ids if the game is not over yet or there are no result players
 // returns the number of ids written
@@ -399,6 +571,12 @@ typedef error_code get_legacy_results_sgf_t(game_methods* methods, const char* o
 //TODO usefulness breaks down quickly for hidden info games? want perspective too?
 typedef error_code id_gf_t(game* self, uint64_t* ret_id);
 
+// FEATURE: canonical_id
+// state id that is the same for all states which are equal up to a symmetry of the board (rotations, mirrors, ..)
+// it is the smallest id among the symmetric images of the state, ret_transform is the index of the symmetry that maps this state to that image
+// transform 0 is the identity, the games document which symmetry every other index is, so moves can be mapped to and from the image
+typedef error_code canonical_id_gf_t(game* self, uint64_t* ret_id, uint8_t* ret_transform);
+
 // FEATURE: eval
 // evaluates the state comparatively against others
 // higher evaluations correspond to a (game method) perceived better position for the player
@@ -454,6 +632,39 @@ typedef error_code get_move_str_gf_t(game* self, player_id player, move_data_syn
 // the returned ptr is valid until the next call on this game, undefined behaviour if used after; it is still owned by the game
 typedef error_code print_gf_t(game* self, size_t* ret_size, const char** ret_str);
 
+// FEATURE: batch
+// creates a batch of count instances which all start out as a copy of the state of self, and share its options
+// every instance has at most one player to move, the batch methods do not keep or compare sync ctrs, use the single game methods for that
+typedef error_code batch_create_gf_t(game* self, uint32_t count, game_batch* ret_batch);
+
+// FEATURE: batch
+typedef error_code batch_destroy_gf_t(game_batch* batch);
+
+// FEATURE: batch
+// sets the state of instance idx to the one of source, which must use the same options as the batch
+typedef error_code batch_load_gf_t(game_batch* batch, uint32_t idx, game* source);
+
+// FEATURE: batch
+// sets the state of target to the one of instance idx, target must be an already created game using the same options as the batch
+typedef error_code batch_store_gf_t(game_batch* batch, uint32_t idx, game* target);
+
+// FEATURE: batch
+// writes the player to move of every instance to players (count entries), PLAYER_NONE for instances that are over
+typedef error_code batch_players_to_move_gf_t(game_batch* batch, player_id* players);
+
+// FEATURE: batch
+// writes the legal move mask of the player to move of every instance to masks (count * game_e_batch_mask_words entries), all zero for instances that are over
+typedef error_code batch_get_move_masks_gf_t(game_batch* batch, uint64_t* masks);
+
+// FEATURE: batch
+// makes move index move_idxs[i] for the player to move of instance i, GAME_BATCH_MOVE_NONE leaves the instance as is
+// moves are trusted, i.e. every one has to be set in the move mask of its instance, and instances that are over have to get GAME_BATCH_MOVE_NONE
+typedef error_code batch_make_moves_gf_t(game_batch* batch, const uint32_t* move_idxs);
+
+// FEATURE: batch
+// writes the winner of every instance to results (count entries), PLAYER_NONE for draws and instances that are not over yet
+typedef error_code batch_get_results_gf_t(game_batch* batch, player_id* results);
+
 // FEATURE: time
 // informs the game that the game.time timestamp has moved
 // the game may modify timectlstages, moves available, players to move and even end the game; so any caches of those are now potentially invalid
@@ -466,6 +677,7 @@ typedef struct game_methods_s {
 
     // the game methods functions work ONLY on the data supplied to it in the game
     // i.e. they are threadsafe across multiple games, but not within one game instance
+    // the only exception are the _into query variants (FEATURE: query_into), which can be shared by many readers of one game instance
     // use of lookup tables and similar constant read only game external structures is ok
 
     // except where explicitly permitted, methods should never cause a crash or undefined behaviour
@@ -495,15 +707,28 @@ typedef struct game_methods_s {
     create_gf_t* create;
     destroy_gf_t* destroy;
     clone_gf_t* clone;
+    size_hint_gf_t* size_hint;
+    create_in_gf_t* create_in;
+    clone_in_gf_t* clone_in;
     copy_from_gf_t* copy_from;
+    memory_usage_gf_t* memory_usage;
     compare_gf_t* compare;
     export_options_gf_t* export_options;
     player_count_gf_t* player_count;
     export_state_gf_t* export_state;
+    export_state_delta_gf_t* export_state_delta;
     import_state_gf_t* import_state;
     serialize_gf_t* serialize;
     players_to_move_gf_t* players_to_move;
     get_concrete_moves_gf_t* get_concrete_moves;
+    get_concrete_moves_codes_gf_t* get_concrete_moves_codes;
+    get_moves_begin_gf_t* get_moves_begin;
+    get_moves_next_gf_t* get_moves_next;
+    players_to_move_into_gf_t* players_to_move_into;
+    get_concrete_moves_into_gf_t* get_concrete_moves_into;
+    export_state_into_gf_t* export_state_into;
+    get_move_str_into_gf_t* get_move_str_into;
+    print_into_gf_t* print_into;
     get_concrete_move_probabilities_gf_t* get_concrete_move_probabilities;
     get_random_move_gf_t* get_random_move;
     get_concrete_moves_ordered_gf_t* get_concrete_moves_ordered;
@@ -511,10 +736,13 @@ typedef struct game_methods_s {
     is_legal_move_gf_t* is_legal_move;
     move_to_action_gf_t* move_to_action;
     make_move_gf_t* make_move;
+    make_moves_gf_t* make_moves;
+    unmake_move_gf_t* unmake_move;
     get_results_gf_t* get_results;
     export_legacy_gf_t* export_legacy;
     get_legacy_results_sgf_t* s_get_legacy_results;
     id_gf_t* id;
+    canonical_id_gf_t* canonical_id;
     eval_gf_t* eval;
     discretize_gf_t* discretize;
     playout_gf_t* playout;
@@ -524,6 +752,14 @@ typedef struct game_methods_s {
     get_move_data_gf_t* get_move_data;
     get_move_str_gf_t* get_move_str;
     print_gf_t* print;
+    batch_create_gf_t* batch_create;
+    batch_destroy_gf_t* batch_destroy;
+    batch_load_gf_t* batch_load;
+    batch_store_gf_t* batch_store;
+    batch_players_to_move_gf_t* batch_players_to_move;
+    batch_get_move_masks_gf_t* batch_get_move_masks;
+    batch_make_moves_gf_t* batch_make_moves;
+    batch_get_results_gf_t* batch_get_results;
 
 } game_methods;
 
@@ -533,6 +769,15 @@ struct game_s {
     void* data2; // owned by the game method
     uint64_t sync_ctr;
 
+    // opt-in query cache of the wrapper, see game_e_cache_enable, NULL if disabled
+    // game_create and game_clone always start out without a cache
+    game_cache* cache;
+
+    // FEATURE: unmake_move
+    // opt-in move history for unmake_move, see game_e_unmake_enable, games only read this in make_move
+    // game_create and game_clone always start out without it
+    bool unmake_history;
+
     // FEATURE: time
     // representation of the "current time" at function invocation, use to determine relative durations
     // the only allowed changes are monotonic increases (incl. no change)
@@ -578,15 +823,28 @@ get_last_error_gf_t game_get_last_error;
 create_gf_t game_create;
 destroy_gf_t game_destroy;
 clone_gf_t game_clone;
+size_hint_gf_t game_size_hint; // fails with ERR_FEATURE_UNSUPPORTED without the create_in feature, those games are only ever placed on the heap (e.g. havannah, twixt_pp)
+create_in_gf_t game_create_in; // always available, without the create_in feature this is a plain create on the heap
+clone_in_gf_t game_clone_in; // always available, without the create_in feature this is a plain clone on the heap
 copy_from_gf_t game_copy_from;
+memory_usage_gf_t game_memory_usage; // the query cache of the wrapper, if enabled, is counted into ret_buffers
 compare_gf_t game_compare;
 export_options_gf_t game_export_options;
 player_count_gf_t game_player_count;
 export_state_gf_t game_export_state;
+export_state_delta_gf_t game_export_state_delta;
 import_state_gf_t game_import_state;
 serialize_gf_t game_serialize;
 players_to_move_gf_t game_players_to_move;
 get_concrete_moves_gf_t game_get_concrete_moves;
+get_moves_begin_gf_t game_get_moves_begin; // always available, without the lazy_moves feature this iterates the full move list, which is then only valid until the next call on this game
+get_moves_next_gf_t game_get_moves_next;
+players_to_move_into_gf_t game_players_to_move_into;
+get_concrete_moves_into_gf_t game_get_concrete_moves_into;
+export_state_into_gf_t game_export_state_into;
+get_move_str_into_gf_t game_get_move_str_into;
+print_into_gf_t game_print_into;
+get_concrete_moves_codes_gf_t game_get_concrete_moves_codes; // available for all !big_moves games, without the move_codes feature the returned ptr is owned by the wrapper and valid until the next call to this or game_e_thread_cleanup on the same thread
 get_concrete_move_probabilities_gf_t game_get_concrete_move_probabilities;
 get_random_move_gf_t game_get_random_move;
 get_concrete_moves_ordered_gf_t game_get_concrete_moves_ordered;
@@ -594,10 +852,13 @@ get_actions_gf_t game_get_actions;
 is_legal_move_gf_t game_is_legal_move;
 move_to_action_gf_t game_move_to_action;
 make_move_gf_t game_make_move;
+make_moves_gf_t game_make_moves; // always available, falls back to a loop over make_move if the game does not have the make_moves feature
+unmake_move_gf_t game_unmake_move;
 get_results_gf_t game_get_results;
 export_legacy_gf_t game_export_legacy;
 get_legacy_results_sgf_t game_s_get_legacy_results;
 id_gf_t game_id;
+canonical_id_gf_t game_canonical_id;
 eval_gf_t game_eval;
 discretize_gf_t game_discretize;
 playout_gf_t game_playout;
@@ -607,6 +868,14 @@ import_sync_data_gf_t game_import_sync_data;
 get_move_data_gf_t game_get_move_data;
 get_move_str_gf_t game_get_move_str;
 print_gf_t game_print;
+batch_create_gf_t game_batch_create;
+batch_destroy_gf_t game_batch_destroy;
+batch_load_gf_t game_batch_load;
+batch_store_gf_t game_batch_store;
+batch_players_to_move_gf_t game_batch_players_to_move;
+batch_get_move_masks_gf_t game_batch_get_move_masks;
+batch_make_moves_gf_t game_batch_make_moves;
+batch_get_results_gf_t game_batch_get_results;
 // extra utility for game funcs
 move_data game_e_create_move_small(move_code move);
 move_data game_e_create_move_big(size_t len, uint8_t* buf);
@@ -620,9 +889,72 @@ bool game_e_move_sync_copy(move_data_sync* target_move, const move_data_sync* so
 void game_e_move_destroy(move_data move);
 void game_e_move_sync_destroy(move_data_sync move);
 bool game_e_move_is_big(move_data move);
+// process wide storage mode for big move payloads, off by default where every big move owns a malloced payload
+// when enabled, created big moves and first copies of heap ones get an immutable refcounted payload in a slab, never write to their data
+// copying such a move (game_e_move_copy, the move serializer, move_history_insert) shares the payload, destroying it drops a reference
+// moves keep their storage when this is toggled, shared and heap moves can be mixed freely and are destroyed the same way
+void game_e_move_big_shared_enable(bool enable);
 move_data_sync game_e_get_random_move_sync(game* self, seed128 seed); // from a position where PLAYER_ENV is ptm this uses the get_concrete_move_probabilities to copy a random move sync
 bool game_e_player_to_move(game* self, player_id player); // returns true if this player is in ptm
-uint32_t game_e_seed_rand_intn(seed128 seed, uint32_t n); // generates [0,n)
+
+// all target players of one move that get the same action from game_e_move_to_action_groups
+typedef struct action_group_s {
+    uint8_t player_count;
+    const player_id* players;
+    size_t size;
+    const uint8_t* buf; // the action, serialized with sl_move_data_sync
+} action_group;
+
+// FEATURE: hidden_information || simultaneous_moves
+// fans the move out to game_move_to_action for every target player on their own, players with identical actions are grouped
+// every distinct action is copied and serialized only once, so sending out a move costs one encoding per group instead of per player
+// the groups keep the order in which their first player appears in target_players
+// the returned groups and buffers are owned by the calling thread and valid until its next call of this or game_e_thread_cleanup
+error_code game_e_move_to_action_groups(game* self, player_id player, move_data_sync move, uint8_t target_count, const player_id* target_players, uint8_t* ret_count, const action_group** ret_groups);
+// plays random moves until the game is over, works for every game regardless of the playout feature
+// PLAYER_ENV draws follow get_concrete_move_probabilities, every player of a simultaneous turn draws its own move
+// calls the game methods directly, skipping the wrapper legality checks, use game_playout for the game specific (faster) version
+// returns ERR_INVALID_STATE if a player to move has no moves, or the env has a different number of moves and move probabilities
+error_code game_e_playout_generic(game* self, seed128 seed);
+uint32_t game_e_seed_rand_intn(seed128 seed, uint32_t n); // generates [0,n) without bias, from stream 0 of the seed
+
+game_rng game_e_rng_create(seed128 seed, uint64_t stream); // stream N of the seed, positioned at draw 0
+uint32_t game_e_rng_at(const game_rng* rng, uint64_t draw); // draw K of the stream, does not advance it
+void game_e_rng_fill(const game_rng* rng, uint64_t first_draw, uint32_t count, uint32_t* buf); // draws [first_draw, first_draw + count) of the stream, does not advance it
+uint32_t game_e_rng_next(game_rng* rng); // next draw of the stream
+uint32_t game_e_rng_intn(game_rng* rng, uint32_t n); // generates [0,n) without bias, may consume more than one draw
+
+uint32_t game_e_batch_mask_words(game_batch* batch); // u64 words of one instance in the move masks
+
+void game_e_arena_init(game_arena* arena, void* buf, size_t size);
+void* game_e_arena_alloc(game_arena* arena, size_t size); // returns NULL if the arena is exhausted
+size_t game_e_arena_size(size_t size); // space an allocation of size takes up in an arena, sum these up for a size_hint
+size_t game_e_arena_buffer_size(size_t size); // buffer size that fits allocations summing up to size (e.g. size_hints), includes the padding to align an unaligned buffer
+void game_e_arena_reset(game_arena* arena); // releases all allocations at once, all games in it have to be destroyed before
+
+// releases the scratch buffers the wrappers keep per thread (the gather buffer of game_get_concrete_moves_codes, the action buffer of game_e_move_to_action_groups and the alias tables of random moves sampled without the query cache), they are not freed when a thread exits
+// call this on every worker thread before it exits, ptrs into these buffers returned on this thread become invalid, the buffers are allocated again on their next use
+void game_e_thread_cleanup();
+
+// the wrapper query cache remembers players_to_move and the concrete moves of the last queried player until the state changes
+// with it, is_legal_move is answered from a hash set of the cached move codes, for games whose listed moves are all their legal moves
+// i.e. only for !big_moves && !simultaneous_moves && !hidden_information && !random_moves games, and never for PLAYER_ENV
+// it also keeps a copy of the last export_state and print strings, repeated calls on an unchanged state return the copy without calling the game
+// and the alias table of the move probabilities, so repeated game_e_get_random_move_sync on an unchanged state sample in O(1) instead of O(moves)
+// the last few alias tables are kept keyed on their distribution, states with the same move probabilities (e.g. dice rolls) do not build them again
+// cached results are keyed on the sync_ctr and dropped on every state changing wrapper call (make/unmake, import, copy_from, ..)
+// the setters in the internal methods of the games (e.g. set_cell) bypass the wrapper, so they call game_e_cache_invalidate themselves
+// the games use plain setters for their own moves, only the entry points handed out in internal_methods pay for the invalidation
+// returned ptrs from the cache are valid until the next state change or disabling of the cache
+error_code game_e_cache_enable(game* self);
+void game_e_cache_disable(game* self);
+void game_e_cache_invalidate(game* self);
+
+// FEATURE: unmake_move
+// opt-in recording of the made moves, so they can be unmade, it is off by default so made moves (e.g. in playouts) do not pay for a history
+// disabling keeps the recorded moves until the next made move, which drops them
+void game_e_unmake_enable(game* self);
+void game_e_unmake_disable(game* self);
 
 // game internal rerrorf: if your error string is self->data2 use this as a shorthand
 error_code grerror(game* self, error_code ec, const char* str, const char* str_end);
@@ -68,10 +68,48 @@
 #error "surena gdd internal feature flag bool already defined: SURENA_GDD_FFB_MOVE_ORDERING"
 #endif
 
+#ifdef SURENA_GDD_FFB_LAZY_MOVES
+#error "surena gdd internal feature flag bool already defined: SURENA_GDD_FFB_LAZY_MOVES"
+#endif
+
+#ifdef SURENA_GDD_FFB_MOVE_CODES
+#error "surena gdd internal feature flag bool already defined: SURENA_GDD_FFB_MOVE_CODES"
+#endif
+
+#ifdef SURENA_GDD_FFB_MAKE_MOVES
+#error "surena gdd internal feature flag bool already defined: SURENA_GDD_FFB_MAKE_MOVES"
+#endif
+
+#ifdef SURENA_GDD_FFB_QUERY_INTO
+#error "surena gdd internal feature flag bool already defined: SURENA_GDD_FFB_QUERY_INTO"
+#endif
+
+#ifdef SURENA_GDD_FFB_CREATE_IN
+#error "surena gdd internal feature flag bool already defined: SURENA_GDD_FFB_CREATE_IN"
+#endif
+
+#ifdef SURENA_GDD_FFB_BATCH
+#error "surena gdd internal feature flag bool already defined: SURENA_GDD_FFB_BATCH"
+#endif
+
+#ifdef SURENA_GDD_FFB_MEMORY_USAGE
+#error "surena gdd internal feature flag bool already defined: SURENA_GDD_FFB_MEMORY_USAGE"
+#endif
+#ifdef SURENA_GDD_FFB_EXPORT_STATE_DELTA
+#error "surena gdd internal feature flag bool already defined: SURENA_GDD_FFB_EXPORT_STATE_DELTA"
+#endif
+
+#ifdef SURENA_GDD_FFB_UNMAKE_MOVE
+#error "surena gdd internal feature flag bool already defined: SURENA_GDD_FFB_UNMAKE_MOVE"
+#endif
+
 #ifdef SURENA_GDD_FFB_ID
 #error "surena gdd internal feature flag bool already defined: SURENA_GDD_FFB_ID"
 #endif
 
+#ifdef SURENA_GDD_FFB_CANONICAL_ID
+#error "surena gdd internal feature flag bool already defined: SURENA_GDD_FFB_CANONICAL_ID"
+#endif
 #ifdef SURENA_GDD_FFB_EVAL
 #error "surena gdd internal feature flag bool already defined: SURENA_GDD_FFB_EVAL"
 #endif
@@ -162,12 +200,72 @@
 #define SURENA_GDD_FFB_MOVE_ORDERING true
 #endif
 
+#ifndef SURENA_GDD_FF_LAZY_MOVES
+#define SURENA_GDD_FFB_LAZY_MOVES false
+#else
+#define SURENA_GDD_FFB_LAZY_MOVES true
+#endif
+
+#ifndef SURENA_GDD_FF_MOVE_CODES
+#define SURENA_GDD_FFB_MOVE_CODES false
+#else
+#define SURENA_GDD_FFB_MOVE_CODES true
+#endif
+
+#ifndef SURENA_GDD_FF_MAKE_MOVES
+#define SURENA_GDD_FFB_MAKE_MOVES false
+#else
+#define SURENA_GDD_FFB_MAKE_MOVES true
+#endif
+
+#ifndef SURENA_GDD_FF_QUERY_INTO
+#define SURENA_GDD_FFB_QUERY_INTO false
+#else
+#define SURENA_GDD_FFB_QUERY_INTO true
+#endif
+
+#ifndef SURENA_GDD_FF_CREATE_IN
+#define SURENA_GDD_FFB_CREATE_IN false
+#else
+#define SURENA_GDD_FFB_CREATE_IN true
+#endif
+
+#ifndef SURENA_GDD_FF_BATCH
+#define SURENA_GDD_FFB_BATCH false
+#else
+#define SURENA_GDD_FFB_BATCH true
+#endif
+
+#ifndef SURENA_GDD_FF_MEMORY_USAGE
+#define SURENA_GDD_FFB_MEMORY_USAGE false
+#else
+#define SURENA_GDD_FFB_MEMORY_USAGE true
+#endif
+
+#ifndef SURENA_GDD_FF_EXPORT_STATE_DELTA
+#define SURENA_GDD_FFB_EXPORT_STATE_DELTA false
+#else
+#define SURENA_GDD_FFB_EXPORT_STATE_DELTA true
+#endif
+
+#ifndef SURENA_GDD_FF_UNMAKE_MOVE
+#define SURENA_GDD_FFB_UNMAKE_MOVE false
+#else
+#define SURENA_GDD_FFB_UNMAKE_MOVE true
+#endif
+
 #ifndef SURENA_GDD_FF_ID
 #define SURENA_GDD_FFB_ID false
 #else
 #define SURENA_GDD_FFB_ID true
 #endif
 
+#ifndef SURENA_GDD_FF_CANONICAL_ID
+#define SURENA_GDD_FFB_CANONICAL_ID false
+#else
+#define SURENA_GDD_FFB_CANONICAL_ID true
+#endif
+
 #ifndef SURENA_GDD_FF_EVAL
 #define SURENA_GDD_FFB_EVAL false
 #else
@@ -210,7 +308,15 @@ static get_last_error_gf_t get_last_error_gf;
 static create_gf_t create_gf;
 static destroy_gf_t destroy_gf;
 static clone_gf_t clone_gf;
+#if SURENA_GDD_FFB_CREATE_IN
+static size_hint_gf_t size_hint_gf;
+static create_in_gf_t create_in_gf;
+static clone_in_gf_t clone_in_gf;
+#endif
 static copy_from_gf_t copy_from_gf;
+#if SURENA_GDD_FFB_MEMORY_USAGE
+static memory_usage_gf_t memory_usage_gf;
+#endif
 #if SURENA_GDD_FFB_COMPARE
 static compare_gf_t compare_gf;
 #endif
@@ -219,12 +325,31 @@ static export_options_gf_t export_options_gf;
 #endif
 static player_count_gf_t player_count_gf;
 static export_state_gf_t export_state_gf;
+#if SURENA_GDD_FFB_EXPORT_STATE_DELTA
+static export_state_delta_gf_t export_state_delta_gf;
+#endif
 static import_state_gf_t import_state_gf;
 #if SURENA_GDD_FFB_SERIALIZABLE
 static serialize_gf_t serialize_gf;
 #endif
 static players_to_move_gf_t players_to_move_gf;
 static get_concrete_moves_gf_t get_concrete_moves_gf;
+#if SURENA_GDD_FFB_MOVE_CODES && !SURENA_GDD_FFB_BIG_MOVES
+static get_concrete_moves_codes_gf_t get_concrete_moves_codes_gf;
+#endif
+#if SURENA_GDD_FFB_LAZY_MOVES
+static get_moves_begin_gf_t get_moves_begin_gf;
+static get_moves_next_gf_t get_moves_next_gf;
+#endif
+#if SURENA_GDD_FFB_QUERY_INTO && !SURENA_GDD_FFB_BIG_MOVES
+static players_to_move_into_gf_t players_to_move_into_gf;
+static get_concrete_moves_into_gf_t get_concrete_moves_into_gf;
+static export_state_into_gf_t export_state_into_gf;
+static get_move_str_into_gf_t get_move_str_into_gf;
+#endif
+#if SURENA_GDD_FFB_QUERY_INTO && !SURENA_GDD_FFB_BIG_MOVES && SURENA_GDD_FFB_PRINT
+static print_into_gf_t print_into_gf;
+#endif
 #if SURENA_GDD_FFB_RANDOM_MOVES
 static get_concrete_move_probabilities_gf_t get_concrete_move_probabilities_gf;
 #endif
@@ -242,6 +367,12 @@ static is_legal_move_gf_t is_legal_move_gf;
 static move_to_action_gf_t move_to_action_gf;
 #endif
 static make_move_gf_t make_move_gf;
+#if SURENA_GDD_FFB_MAKE_MOVES
+static make_moves_gf_t make_moves_gf;
+#endif
+#if SURENA_GDD_FFB_UNMAKE_MOVE
+static unmake_move_gf_t unmake_move_gf;
+#endif
 static get_results_gf_t get_results_gf;
 #if SURENA_GDD_FFB_LEGACY
 static export_legacy_gf_t export_legacy_gf;
@@ -252,6 +383,9 @@ static get_legacy_results_sgf_t get_legacy_results_sgf;
 #if SURENA_GDD_FFB_ID
 static id_gf_t id_gf;
 #endif
+#if SURENA_GDD_FFB_CANONICAL_ID
+static canonical_id_gf_t canonical_id_gf;
+#endif
 #if SURENA_GDD_FFB_EVAL
 static eval_gf_t eval_gf;
 #endif
@@ -275,6 +409,16 @@ static get_move_str_gf_t get_move_str_gf;
 #if SURENA_GDD_FFB_PRINT
 static print_gf_t print_gf;
 #endif
+#if SURENA_GDD_FFB_BATCH && !SURENA_GDD_FFB_BIG_MOVES && !SURENA_GDD_FFB_RANDOM_MOVES && !SURENA_GDD_FFB_HIDDEN_INFORMATION && !SURENA_GDD_FFB_SIMULTANEOUS_MOVES
+static batch_create_gf_t batch_create_gf;
+static batch_destroy_gf_t batch_destroy_gf;
+static batch_load_gf_t batch_load_gf;
+static batch_store_gf_t batch_store_gf;
+static batch_players_to_move_gf_t batch_players_to_move_gf;
+static batch_get_move_masks_gf_t batch_get_move_masks_gf;
+static batch_make_moves_gf_t batch_make_moves_gf;
+static batch_get_results_gf_t batch_get_results_gf;
+#endif
 
 // clang-format off
 const game_methods SURENA_GDD_BENAME
@@ -294,7 +438,17 @@ const game_methods SURENA_GDD_BENAME
         .simultaneous_moves = SURENA_GDD_FFB_SIMULTANEOUS_MOVES,
         .sync_ctr = SURENA_GDD_FFB_SYNC_CTR,
         .move_ordering = SURENA_GDD_FFB_MOVE_ORDERING,
+        .unmake_move = SURENA_GDD_FFB_UNMAKE_MOVE,
+        .lazy_moves = SURENA_GDD_FFB_LAZY_MOVES,
+        .move_codes = SURENA_GDD_FFB_MOVE_CODES,
+        .make_moves = SURENA_GDD_FFB_MAKE_MOVES,
+        .query_into = SURENA_GDD_FFB_QUERY_INTO,
+        .create_in = SURENA_GDD_FFB_CREATE_IN,
+        .batch = SURENA_GDD_FFB_BATCH,
+        .memory_usage = SURENA_GDD_FFB_MEMORY_USAGE,
+        .export_state_delta = SURENA_GDD_FFB_EXPORT_STATE_DELTA,
         .id = SURENA_GDD_FFB_ID,
+        .canonical_id = SURENA_GDD_FFB_CANONICAL_ID,
         .eval = SURENA_GDD_FFB_EVAL,
         .action_list = SURENA_GDD_FFB_ACTION_LIST,
         .discretize = SURENA_GDD_FFB_DISCRETIZE,
@@ -311,7 +465,21 @@ const game_methods SURENA_GDD_BENAME
     .create = create_gf,
     .destroy = destroy_gf,
     .clone = clone_gf,
+#if SURENA_GDD_FFB_CREATE_IN
+    .size_hint = size_hint_gf,
+    .create_in = create_in_gf,
+    .clone_in = clone_in_gf,
+#else
+    .size_hint = NULL,
+    .create_in = NULL,
+    .clone_in = NULL,
+#endif
     .copy_from = copy_from_gf,
+#if SURENA_GDD_FFB_MEMORY_USAGE
+    .memory_usage = memory_usage_gf,
+#else
+    .memory_usage = NULL,
+#endif
 #if SURENA_GDD_FFB_COMPARE
     .compare = compare_gf,
 #else
@@ -324,6 +492,11 @@ const game_methods SURENA_GDD_BENAME
 #endif
     .player_count = player_count_gf,
     .export_state = export_state_gf,
+#if SURENA_GDD_FFB_EXPORT_STATE_DELTA
+    .export_state_delta = export_state_delta_gf,
+#else
+    .export_state_delta = NULL,
+#endif
     .import_state = import_state_gf,
 #if SURENA_GDD_FFB_SERIALIZABLE
     .serialize = serialize_gf,
@@ -332,6 +505,34 @@ const game_methods SURENA_GDD_BENAME
 #endif
     .players_to_move = players_to_move_gf,
     .get_concrete_moves = get_concrete_moves_gf,
+#if SURENA_GDD_FFB_MOVE_CODES && !SURENA_GDD_FFB_BIG_MOVES
+    .get_concrete_moves_codes = get_concrete_moves_codes_gf,
+#else
+    .get_concrete_moves_codes = NULL,
+#endif
+#if SURENA_GDD_FFB_LAZY_MOVES
+    .get_moves_begin = get_moves_begin_gf,
+    .get_moves_next = get_moves_next_gf,
+#else
+    .get_moves_begin = NULL,
+    .get_moves_next = NULL,
+#endif
+#if SURENA_GDD_FFB_QUERY_INTO && !SURENA_GDD_FFB_BIG_MOVES
+    .players_to_move_into = players_to_move_into_gf,
+    .get_concrete_moves_into = get_concrete_moves_into_gf,
+    .export_state_into = export_state_into_gf,
+    .get_move_str_into = get_move_str_into_gf,
+#else
+    .players_to_move_into = NULL,
+    .get_concrete_moves_into = NULL,
+    .export_state_into = NULL,
+    .get_move_str_into = NULL,
+#endif
+#if SURENA_GDD_FFB_QUERY_INTO && !SURENA_GDD_FFB_BIG_MOVES && SURENA_GDD_FFB_PRINT
+    .print_into = print_into_gf,
+#else
+    .print_into = NULL,
+#endif
 #if SURENA_GDD_FFB_RANDOM_MOVES
     .get_concrete_move_probabilities = get_concrete_move_probabilities_gf,
 #else
@@ -359,6 +560,16 @@ const game_methods SURENA_GDD_BENAME
     .move_to_action = NULL,
 #endif
     .make_move = make_move_gf,
+#if SURENA_GDD_FFB_MAKE_MOVES
+    .make_moves = make_moves_gf,
+#else
+    .make_moves = NULL,
+#endif
+#if SURENA_GDD_FFB_UNMAKE_MOVE
+    .unmake_move = unmake_move_gf,
+#else
+    .unmake_move = NULL,
+#endif
     .get_results = get_results_gf,
 #if SURENA_GDD_FFB_LEGACY
     .export_legacy = export_legacy_gf,
@@ -375,6 +586,11 @@ const game_methods SURENA_GDD_BENAME
 #else
     .id = NULL,
 #endif
+#if SURENA_GDD_FFB_CANONICAL_ID
+    .canonical_id = canonical_id_gf,
+#else
+    .canonical_id = NULL,
+#endif
 #if SURENA_GDD_FFB_EVAL
     .eval = eval_gf,
 #else
@@ -412,6 +628,25 @@ const game_methods SURENA_GDD_BENAME
 #else
     .print = NULL,
 #endif
+#if SURENA_GDD_FFB_BATCH && !SURENA_GDD_FFB_BIG_MOVES && !SURENA_GDD_FFB_RANDOM_MOVES && !SURENA_GDD_FFB_HIDDEN_INFORMATION && !SURENA_GDD_FFB_SIMULTANEOUS_MOVES
+    .batch_create = batch_create_gf,
+    .batch_destroy = batch_destroy_gf,
+    .batch_load = batch_load_gf,
+    .batch_store = batch_store_gf,
+    .batch_players_to_move = batch_players_to_move_gf,
+    .batch_get_move_masks = batch_get_move_masks_gf,
+    .batch_make_moves = batch_make_moves_gf,
+    .batch_get_results = batch_get_results_gf,
+#else
+    .batch_create = NULL,
+    .batch_destroy = NULL,
+    .batch_load = NULL,
+    .batch_store = NULL,
+    .batch_players_to_move = NULL,
+    .batch_get_move_masks = NULL,
+    .batch_make_moves = NULL,
+    .batch_get_results = NULL,
+#endif
 };
     // clang-format on
 
@@ -455,9 +690,38 @@ const game_methods SURENA_GDD_BENAME
 #undef SURENA_GDD_FF_MOVE_ORDERING
 #undef SURENA_GDD_FFB_MOVE_ORDERING
 
+#undef SURENA_GDD_FF_LAZY_MOVES
+#undef SURENA_GDD_FFB_LAZY_MOVES
+
+#undef SURENA_GDD_FF_MOVE_CODES
+#undef SURENA_GDD_FFB_MOVE_CODES
+
+#undef SURENA_GDD_FF_MAKE_MOVES
+#undef SURENA_GDD_FFB_MAKE_MOVES
+
+#undef SURENA_GDD_FF_QUERY_INTO
+#undef SURENA_GDD_FFB_QUERY_INTO
+
+#undef SURENA_GDD_FF_CREATE_IN
+#undef SURENA_GDD_FFB_CREATE_IN
+
+#undef SURENA_GDD_FF_BATCH
+#undef SURENA_GDD_FFB_BATCH
+#undef SURENA_GDD_FF_MEMORY_USAGE
+#undef SURENA_GDD_FFB_MEMORY_USAGE
+
+#undef SURENA_GDD_FF_EXPORT_STATE_DELTA
+#undef SURENA_GDD_FFB_EXPORT_STATE_DELTA
+
+#undef SURENA_GDD_FF_UNMAKE_MOVE
+#undef SURENA_GDD_FFB_UNMAKE_MOVE
+
 #undef SURENA_GDD_FF_ID
 #undef SURENA_GDD_FFB_ID
 
+#undef SURENA_GDD_FF_CANONICAL_ID
+#undef SURENA_GDD_FFB_CANONICAL_ID
+
 #undef SURENA_GDD_FF_EVAL
 #undef SURENA_GDD_FFB_EVAL
 
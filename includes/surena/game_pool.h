@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "surena/game.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static const uint64_t SURENA_GAME_POOL_API_VERSION = 2;
+
+// recycles destroyed instances of one game (methods + options), so clone/destroy churn (e.g. one clone per simulation) turns into copy_from
+// every thread keeps its own free list of warm instances, acquire and release never contend with other threads
+typedef struct game_pool_s game_pool;
+
+// creates a pool for games with the methods and options of source, the options of source are recorded here
+// at most max_retained instances are kept warm per thread, and at most max_bytes summed over all threads
+// the bytes of an instance are sizeof(game) plus its game_memory_usage when released, games without that feature only count towards max_retained
+// releasing beyond either limit really destroys the instance, use SIZE_MAX to only limit the count
+// returns NULL if out of memory
+game_pool* game_pool_create(game* source, uint32_t max_retained, size_t max_bytes);
+
+// destroys all warm instances and the pool
+// all acquired instances have to be released (or destroyed) before
+void game_pool_destroy(game_pool* pool);
+
+// returns the bytes of all warm instances currently kept by the pool, summed over all threads
+size_t game_pool_retained_bytes(game_pool* pool);
+
+// fills target with a copy of source, via copy_from into a warm instance of this thread if there is one, otherwise via clone
+// source has to use the same methods as the pool was created with, a source with other options is always cloned
+// before reusing a warm instance this queries the options of source, so it must not run concurrently with other calls on source
+error_code game_pool_acquire(game_pool* pool, game* source, game* target);
+
+// hands the instance back to the free list of this thread, target is reset afterwards just like after game_destroy
+// instances with other options than the pool, or ones that would exceed its limits, are destroyed instead
+// the instance does not have to be released on the same thread it was acquired on
+error_code game_pool_release(game_pool* pool, game* target);
+
+#ifdef __cplusplus
+}
+#endif
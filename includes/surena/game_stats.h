@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "surena/game.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static const uint64_t SURENA_GAME_STATS_API_VERSION = 1;
+
+// per method call counters and latency histograms, collected by the game_* wrappers (and the batch wrappers) for every game_methods
+// only compiled in with SURENA_GAME_STATS defined (cmake option SURENA_GAME_STATS), otherwise the wrappers call the methods directly and nothing is collected
+// every thread counts into its own tables without locks or atomic read-modify-writes, snapshot and reset sum them up over all threads
+// time is measured around the method call only, wrapper checks and cache hits in the wrapper are not included
+
+typedef enum GAME_STATS_METHOD_E {
+    GAME_STATS_METHOD_CREATE = 0,
+    GAME_STATS_METHOD_DESTROY,
+    GAME_STATS_METHOD_CLONE,
+    GAME_STATS_METHOD_SIZE_HINT,
+    GAME_STATS_METHOD_CREATE_IN,
+    GAME_STATS_METHOD_CLONE_IN,
+    GAME_STATS_METHOD_COPY_FROM,
+    GAME_STATS_METHOD_MEMORY_USAGE,
+    GAME_STATS_METHOD_COMPARE,
+    GAME_STATS_METHOD_EXPORT_OPTIONS,
+    GAME_STATS_METHOD_PLAYER_COUNT,
+    GAME_STATS_METHOD_EXPORT_STATE,
+    GAME_STATS_METHOD_EXPORT_STATE_DELTA,
+    GAME_STATS_METHOD_IMPORT_STATE,
+    GAME_STATS_METHOD_SERIALIZE,
+    GAME_STATS_METHOD_PLAYERS_TO_MOVE,
+    GAME_STATS_METHOD_GET_CONCRETE_MOVES,
+    GAME_STATS_METHOD_GET_CONCRETE_MOVES_CODES,
+    GAME_STATS_METHOD_GET_MOVES_BEGIN,
+    GAME_STATS_METHOD_GET_MOVES_NEXT,
+    GAME_STATS_METHOD_PLAYERS_TO_MOVE_INTO,
+    GAME_STATS_METHOD_GET_CONCRETE_MOVES_INTO,
+    GAME_STATS_METHOD_EXPORT_STATE_INTO,
+    GAME_STATS_METHOD_GET_MOVE_STR_INTO,
+    GAME_STATS_METHOD_PRINT_INTO,
+    GAME_STATS_METHOD_GET_CONCRETE_MOVE_PROBABILITIES,
+    GAME_STATS_METHOD_GET_RANDOM_MOVE,
+    GAME_STATS_METHOD_GET_CONCRETE_MOVES_ORDERED,
+    GAME_STATS_METHOD_GET_ACTIONS,
+    GAME_STATS_METHOD_IS_LEGAL_MOVE,
+    GAME_STATS_METHOD_MOVE_TO_ACTION,
+    GAME_STATS_METHOD_MAKE_MOVE,
+    GAME_STATS_METHOD_MAKE_MOVES,
+    GAME_STATS_METHOD_UNMAKE_MOVE,
+    GAME_STATS_METHOD_GET_RESULTS,
+    GAME_STATS_METHOD_EXPORT_LEGACY,
+    GAME_STATS_METHOD_ID,
+    GAME_STATS_METHOD_CANONICAL_ID,
+    GAME_STATS_METHOD_EVAL,
+    GAME_STATS_METHOD_DISCRETIZE,
+    GAME_STATS_METHOD_PLAYOUT,
+    GAME_STATS_METHOD_REDACT_KEEP_STATE,
+    GAME_STATS_METHOD_EXPORT_SYNC_DATA,
+    GAME_STATS_METHOD_IMPORT_SYNC_DATA,
+    GAME_STATS_METHOD_GET_MOVE_DATA,
+    GAME_STATS_METHOD_GET_MOVE_STR,
+    GAME_STATS_METHOD_PRINT,
+    GAME_STATS_METHOD_BATCH_CREATE,
+    GAME_STATS_METHOD_BATCH_DESTROY,
+    GAME_STATS_METHOD_BATCH_LOAD,
+    GAME_STATS_METHOD_BATCH_STORE,
+    GAME_STATS_METHOD_BATCH_PLAYERS_TO_MOVE,
+    GAME_STATS_METHOD_BATCH_GET_MOVE_MASKS,
+    GAME_STATS_METHOD_BATCH_MAKE_MOVES,
+    GAME_STATS_METHOD_BATCH_GET_RESULTS,
+    GAME_STATS_METHOD_COUNT,
+} GAME_STATS_METHOD;
+
+extern const char* const game_stats_method_names[GAME_STATS_METHOD_COUNT]; // same as the game_methods member names
+
+// bucket i counts calls that took [2^i, 2^(i+1)) ns, bucket 0 also counts 0ns, the last bucket counts everything above too
+#define GAME_STATS_BUCKETS 32
+
+typedef struct game_stats_entry_s {
+    const game_methods* methods;
+    GAME_STATS_METHOD method;
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t buckets[GAME_STATS_BUCKETS];
+} game_stats_entry;
+
+// returns true if the wrappers were compiled with SURENA_GAME_STATS
+bool game_stats_enabled();
+
+// sums up the stats of all threads since the last reset, one entry per game_methods and method that was called at least once
+// entries of the same game_methods are next to each other, in method order
+// the returned entries are owned by the calling thread and valid until its next call of this
+// returns ERR_FEATURE_UNSUPPORTED if the stats are not compiled in
+error_code game_stats_snapshot(uint32_t* ret_count, const game_stats_entry** ret_entries);
+
+// starts all counters over from zero, calls running on other threads while resetting may be counted either before or after
+void game_stats_reset();
+
+// used by the wrappers: counts one call of the method that took ns
+void game_stats_record(const game_methods* methods, GAME_STATS_METHOD method, uint64_t ns);
+
+#ifdef __cplusplus
+}
+#endif
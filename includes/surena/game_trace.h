@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rosalia/serialization.h"
+
+#include "surena/game.h"
+#include "surena/game_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static const uint64_t SURENA_GAME_TRACE_API_VERSION = 1;
+
+// binary trace of the game method calls made by the wrappers, for reproducing and benchmarking a real workload offline
+// only compiled in with SURENA_GAME_TRACE defined (cmake option SURENA_GAME_TRACE), otherwise the wrappers record nothing and start fails
+// every method call the wrappers make is appended once it returned, with the inputs needed to make it again and its result code
+// calls answered from the wrapper query cache never reach the game and are not in the trace, just like they would not be in a replay
+// not recorded are size_hint, memory_usage, the move iterator methods, the _into queries and the batch methods
+//
+// file format, all integers in host byte order:
+// header: "SRNTRACE" u32 version
+// record: u32 size of the rest of the record, u8 method (GAME_STATS_METHOD), u64 instance (address of the game), u64 sync_ctr, u8 unmake_history, u32 result
+// followed by the inputs of the method:
+// - player: u8
+// - move: sl_move_data_sync
+// - seed: seed128
+// - str: u32 len (UINT32_MAX for NULL) + bytes
+// - instance: u64 address of the other game (clone target, copy_from / compare source)
+// - players: u8 count + count * u8
+// create and create_in: str composite id of the game (name.variant.impl), sl_game_init_info
+// make_moves: u32 count, u8 trusted, count * (player, move)
+// export_state_delta: u64 since_sync_ctr
+// import_sync_data: u32 len + bytes
+// each method writes the inputs of its game_methods member in order, e.g. move_to_action is player, move, players
+
+#define SURENA_GAME_TRACE_VERSION 2
+
+// starts appending all method calls of all threads to a new trace file at path, replaces an existing file
+// returns ERR_FEATURE_UNSUPPORTED if tracing is not compiled in, ERR_INVALID_INPUT if a trace is already running (or failed and was not stopped yet) or the file can not be created
+error_code game_trace_start(const char* path);
+
+// stops the running trace and closes its file, calls that are being recorded concurrently are either fully written or not at all
+// if a record could not be written (out of memory or a failed write) the trace already ended there, its file holds all calls up to the failed one
+// returns the error that ended the trace early (ERR_OUT_OF_MEMORY, or ERR_NOK for a failed write or close), ERR_OK if every call made it into the file
+error_code game_trace_stop();
+
+// returns true if the wrappers were compiled with SURENA_GAME_TRACE
+bool game_trace_enabled();
+
+typedef struct game_trace_replay_stats_s {
+    uint64_t calls; // calls replayed
+    uint64_t skipped; // calls on instances of other games, or on instances not created in the trace
+    uint64_t mismatches; // replayed calls that returned a different result than recorded
+    uint64_t ns; // time spent in the replayed calls, without reading and decoding the trace
+} game_trace_replay_stats;
+
+// reads the whole trace at path and makes all its calls again, as fast as possible, on instances of methods
+// only instances created (or cloned from ones created) as methods in the trace are replayed, lifecycle calls go through the wrappers, all other calls directly to methods with the recorded sync_ctr
+// create_in and clone_in are replayed as create and clone, there is no arena to replay them in
+// works regardless of SURENA_GAME_TRACE, all instances left in the trace are destroyed at the end
+// returns ERR_INVALID_INPUT if the file can not be read or is not a trace of this version
+error_code game_trace_replay(const char* path, const game_methods* methods, game_trace_replay_stats* ret_stats);
+
+// used by the wrappers: the inputs of one method call, which members are read depends on the method
+typedef struct game_trace_args_s {
+    player_id player;
+    const move_data_sync* move;
+    seed128 seed;
+    const char* str;
+    const game* other;
+    uint8_t player_count;
+    const player_id* players;
+    uint64_t since_sync_ctr;
+    const blob* b;
+    const game_init* init_info;
+    uint32_t move_count;
+    const player_id* move_players;
+    const move_data_sync* moves;
+    bool trusted;
+} game_trace_args;
+
+// used by the wrappers: appends the call of method on self, that returned ec, to the running trace, if any
+void game_trace_record(game* self, GAME_STATS_METHOD method, error_code ec, game_trace_args args);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "surena/game.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static const uint64_t SURENA_GAME_VIEW_CACHE_API_VERSION = 1;
+
+// keeps one redacted view (clone + redact_keep_state) of an authoritative game per distinct pov set, e.g. for serving spectators and clients
+// moves are applied to the views as the move_to_action their povs get, so views follow the game without being cloned and redacted again
+// every view has the wrapper query cache enabled, so repeated export_state / print calls for the same pov set only render once per move
+// all calls on one view cache (and its source game) have to come from one thread at a time
+typedef struct game_view_cache_s game_view_cache;
+
+// creates an empty view cache for games with the methods of source, source is only read here
+// returns NULL if out of memory
+game_view_cache* game_view_cache_create(game* source);
+
+// destroys all views and the cache, views returned by get are invalid afterwards
+void game_view_cache_destroy(game_view_cache* cache);
+
+// returns the view of source for the set of pov players, order and duplicates in povs do not matter
+// the empty pov set is the public view, as seen by spectators, PLAYER_ENV in povs keeps the hidden information of the env too
+// move_to_action has no actions for nobody, so in hidden information and simultaneous move games the public view is instead rebuilt by copy_from and redact, once per move on its next get
+// known limitation: that rebuild copies the whole source, where the other views only make one action per move
+// the view is created on first use, and rebuilt from source if it could not follow the moves made since
+// source has to be the game all moves were made on through game_view_cache_make_move since the cache was created or invalidated
+// the returned game is owned by the cache, only read from it, it stays valid until the cache is destroyed
+error_code game_view_cache_get(game_view_cache* cache, game* source, uint8_t pov_count, const player_id* povs, game** ret_view);
+
+// makes the move on source and advances every view by the action its pov set gets for it
+// nothing is changed if the move is not legal on source
+// views that fail to make their action are rebuilt on their next get, the move on source is still made
+// if making the move on source fails, all views are rebuilt on their next get
+error_code game_view_cache_make_move(game_view_cache* cache, game* source, player_id player, move_data_sync move);
+
+// marks all views to be rebuilt on their next get, use after changing source by anything else than game_view_cache_make_move (import, unmake, ..)
+void game_view_cache_invalidate(game_view_cache* cache);
+
+#ifdef __cplusplus
+}
+#endif
@@ -49,6 +49,8 @@ typedef struct chess_internal_methods_s {
 
 } chess_internal_methods;
 
+// export_state_delta writes the changed squares comma separated as their name followed by their FEN piece, or - if empty (e.g. "e2-,e4P")
+// then the fields after the board that also end the state string (e.g. " b KQkq e3 0 1")
 extern const game_methods chess_standard_gbe;
 
 #ifdef __cplusplus
@@ -62,6 +62,11 @@ typedef struct havannah_internal_methods_s {
 
 } havannah_internal_methods;
 
+// the canonical_id transform t moves the cell (x, y) of the state to its place in the canonical image
+// using the cube coordinates (a, b, c) = (x - m, m - y, y - x) around the center m = size - 1, which map back by x = a + m and y = m - b
+// t >= 6 mirrors by swapping b and c first, then it is rotated (t % 6) times by 60 degrees with (a, b, c) -> (-c, -a, -b)
+// export_state_delta writes the changed cells comma separated as their move string followed by their O/X/. content (e.g. "c5O,d4X")
+// then the current and result player that also end the state string (e.g. " X -")
 extern const game_methods havannah_standard_gbe;
 
 #ifdef __cplusplus
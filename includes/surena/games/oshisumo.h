@@ -1,30 +1,39 @@
 #pragma once
 
-#ifdef __cplusplus
-extern "C" {
-#endif
-
 #include <stdint.h>
 
 #include "surena/game.h"
 
-const uint8_t OSHISUMO_NONE = UINT8_MAX;
-const uint8_t OSHISUMO_ANY = UINT8_MAX - 1;
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static const uint8_t OSHISUMO_NONE = UINT8_MAX;
+static const uint8_t OSHISUMO_ANY = UINT8_MAX - 1;
 
 typedef struct oshisumo_options_s {
     uint8_t size; // [2, 120] //TODO find proper max
-    uint8_t tokens; // [size, 253]
+    uint8_t tokens; // [1, 253]
 } oshisumo_options;
 
 typedef struct oshisumo_internal_methods_s {
 
     error_code (*get_tokens)(game* self, player_id p, uint8_t* t);
     error_code (*set_tokens)(game* self, player_id p, uint8_t t);
+    // the wrestler stands on cells [-size/2, size/2], player 1 pushes towards positive cells
     error_code (*get_cell)(game* self, int8_t* c);
     error_code (*set_cell)(game* self, int8_t c);
     error_code (*get_sm_tokens)(game* self, player_id p, uint8_t* t);
     //TODO need set_sm_tokens ?
 
+    // returns the mixed equilibrium of the stage game at (tokens_p1, tokens_p2, push_cell)
+    // value is the expected result for player 1 in [-1, 1], strategies are indexed by bid and have length tokens+1
+    // all stage games for the options of this game are solved by backward induction on first use and then shared read only
+    // tables only exist for options with up to 64 tokens whose strategy pool of (2*(size/2)+1) * (tokens+1)^2 * (tokens+2) floats fits in 2^23, returns ERR_FEATURE_UNSUPPORTED for bigger options, eval then falls back to a coarse estimate
+    // returns ERR_OUT_OF_MEMORY if the table could not be built
+    // the returned ptrs stay valid for the lifetime of the process
+    error_code (*get_equilibrium)(game* self, uint8_t tokens_p1, uint8_t tokens_p2, int8_t push_cell, float* ret_value, const float** ret_strategy_p1, const float** ret_strategy_p2);
+
 } oshisumo_internal_methods;
 
 extern const game_methods oshisumo_gbe;
@@ -18,6 +18,11 @@ typedef struct quasar_internal_methods_s {
     error_code (*can_payout)(game* self, bool* r);
     error_code (*can_small)(game* self, bool* r);
 
+    // exact expected value of the current state under optimal play, precomputed for all states
+    error_code (*get_exact_ev)(game* self, float* ev);
+    // expected value optimal decision (big/payout/small), only available if the player is to move
+    error_code (*get_optimal_move)(game* self, move_code* m);
+
 } quasar_internal_methods;
 
 extern const game_methods quasar_standard_gbe;
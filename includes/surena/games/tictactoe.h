@@ -20,6 +20,8 @@ typedef struct tictactoe_internal_methods_s {
 
 } tictactoe_internal_methods;
 
+// the canonical_id transform t moves the cell (x, y) of the state to its place in the canonical image
+// t & 4 mirrors x -> 2 - x first, then it is rotated counter clockwise (t & 3) times by (x, y) -> (2 - y, x)
 extern const game_methods tictactoe_standard_gbe;
 
 #ifdef __cplusplus
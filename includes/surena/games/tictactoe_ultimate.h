@@ -29,6 +29,8 @@ typedef struct tictactoe_ultimate_internal_methods_s {
 
 } tictactoe_ultimate_internal_methods;
 
+// the canonical_id transform t moves the cell (x, y) of the 9 by 9 board to its place in the canonical image, local boards move along
+// t & 4 mirrors x -> 8 - x first, then it is rotated counter clockwise (t & 3) times by (x, y) -> (8 - y, x)
 extern const game_methods tictactoe_ultimate_gbe;
 
 #ifdef __cplusplus
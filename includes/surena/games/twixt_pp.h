@@ -88,6 +88,8 @@ typedef struct twixt_pp_internal_methods_s {
 
 } twixt_pp_internal_methods;
 
+// export_state_delta writes the changed nodes comma separated as their move string, their O/X/. player and their connections as a hex digit (e.g. "c5O0,d7X4")
+// then the current and result player that also end the state string (e.g. " X -")
 extern const game_methods twixt_pp_gbe;
 
 #ifdef __cplusplus
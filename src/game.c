@@ -1,22 +1,46 @@
 #include <assert.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#include "rosalia/noise.h"
 #include "rosalia/serialization.h"
 
 #include "surena/game.h"
 
+#include "surena/game_stats.h"
+#include "surena/game_trace.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 #define PTRMAX ((void*)UINTPTR_MAX)
 
+// wraps the call of a game method in the wrappers, counting it per method if the stats are compiled in
+#ifdef SURENA_GAME_STATS
+#define GAME_STATS_CALL(methods, method, call) __extension__({ \
+    const game_methods* game_stats_methods = (methods); \
+    uint64_t game_stats_start = timestamp_get_ns64(); \
+    error_code game_stats_ec = (call); \
+    game_stats_record(game_stats_methods, GAME_STATS_METHOD_##method, timestamp_get_ns64() - game_stats_start); \
+    game_stats_ec; \
+})
+#else
+#define GAME_STATS_CALL(methods, method, call) (call)
+#endif
+
+// appends the call of a game method that just returned ec to the running trace, the args are the designated inputs of game_trace_args
+#ifdef SURENA_GAME_TRACE
+#define GAME_TRACE(self, method, ec, ...) game_trace_record((self), GAME_STATS_METHOD_##method, (ec), (game_trace_args){__VA_ARGS__})
+#else
+#define GAME_TRACE(self, method, ec, ...) ((void)0)
+#endif
+
 const char* general_error_strings[] = {
     [ERR_OK] = "OK",
     [ERR_NOK] = "NOK",
@@ -87,9 +111,177 @@ error_code rerrorfv(char** pbuf, error_code ec, const char* fmt, va_list args)
     return ec;
 }
 
+// shared big move payloads live in slabs, every payload is immutable and refcounted, so copies of a move share its data ptr
+// a slab is reused once all payloads in it are destroyed, slabs are never given back, shared payloads keep their peak memory
+#define MOVE_SLAB_SIZE ((size_t)1 << 16) // slabs are aligned to their size, so the slab of a payload is found by masking its ptr
+#define MOVE_SLAB_MAX_PAYLOAD (MOVE_SLAB_SIZE / 8) // larger payloads stay on the heap, they would leave most of a slab unused
+#define MOVE_SLAB_REGISTRY_SIZE 4096 // at most half of this many slabs are created, after that new payloads stay on the heap
+
+typedef struct move_slab_s {
+    atomic_uint_least32_t live; // payloads in this slab, +1 while a thread allocates from it
+    uint32_t used; // bump offset, only written by the thread allocating from it
+    struct move_slab_s* next_free;
+} move_slab;
+
+typedef struct move_payload_head_s {
+    _Alignas(8) atomic_uint_least32_t refs;
+} move_payload_head; // directly in front of the payload data
+
+#define MOVE_SLAB_HEAD_SIZE ((sizeof(move_slab) + 7) & ~(size_t)7)
+
+static atomic_bool move_payload_shared = false;
+static atomic_flag move_slab_lock = ATOMIC_FLAG_INIT; // guards the free list and inserts into the registry
+static move_slab* move_slab_free = NULL;
+static atomic_uint_least32_t move_slab_count = 0;
+static _Atomic(move_slab*) move_slab_registry[MOVE_SLAB_REGISTRY_SIZE]; // open addressed by slab address, entries are never removed, so lookups need no lock
+static _Thread_local move_slab* move_slab_current = NULL; // the slab of a thread that exits stays held until the process ends
+
+static uint32_t move_slab_registry_idx(uintptr_t base)
+{
+    return (uint32_t)(((uint64_t)(base / MOVE_SLAB_SIZE) * 0x9E3779B97F4A7C15ull) >> 32) % MOVE_SLAB_REGISTRY_SIZE;
+}
+
+// returns the slab the payload is in, or NULL if it is a heap payload
+static move_slab* move_slab_of(move_data move)
+{
+    if (move.data == NULL || move.cl.len == 0 || atomic_load_explicit(&move_slab_count, memory_order_acquire) == 0) {
+        return NULL;
+    }
+    uintptr_t base = (uintptr_t)move.data & ~(uintptr_t)(MOVE_SLAB_SIZE - 1);
+    for (uint32_t idx = move_slab_registry_idx(base);; idx = (idx + 1) % MOVE_SLAB_REGISTRY_SIZE) {
+        move_slab* slab = atomic_load_explicit(&move_slab_registry[idx], memory_order_acquire);
+        if (slab == NULL || (uintptr_t)slab == base) {
+            return slab;
+        }
+    }
+}
+
+// returns a reset slab that the calling thread holds, or NULL if no more slabs can be created
+static move_slab* move_slab_acquire()
+{
+    while (atomic_flag_test_and_set_explicit(&move_slab_lock, memory_order_acquire)) {}
+    move_slab* slab = move_slab_free;
+    if (slab != NULL) {
+        move_slab_free = slab->next_free;
+    } else if (atomic_load_explicit(&move_slab_count, memory_order_relaxed) < MOVE_SLAB_REGISTRY_SIZE / 2) {
+        slab = (move_slab*)aligned_alloc(MOVE_SLAB_SIZE, MOVE_SLAB_SIZE);
+        if (slab != NULL) {
+            uint32_t idx = move_slab_registry_idx((uintptr_t)slab);
+            while (atomic_load_explicit(&move_slab_registry[idx], memory_order_relaxed) != NULL) {
+                idx = (idx + 1) % MOVE_SLAB_REGISTRY_SIZE;
+            }
+            atomic_store_explicit(&move_slab_registry[idx], slab, memory_order_release);
+            atomic_fetch_add_explicit(&move_slab_count, 1, memory_order_release);
+        }
+    }
+    atomic_flag_clear_explicit(&move_slab_lock, memory_order_release);
+    if (slab != NULL) {
+        atomic_store_explicit(&slab->live, 1, memory_order_relaxed);
+        slab->used = MOVE_SLAB_HEAD_SIZE;
+        slab->next_free = NULL;
+    }
+    return slab;
+}
+
+static void move_slab_release(move_slab* slab)
+{
+    if (atomic_fetch_sub_explicit(&slab->live, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+    while (atomic_flag_test_and_set_explicit(&move_slab_lock, memory_order_acquire)) {}
+    slab->next_free = move_slab_free;
+    move_slab_free = slab;
+    atomic_flag_clear_explicit(&move_slab_lock, memory_order_release);
+}
+
+// returns a copy of buf in a shared payload with one reference, or NULL if it has to go on the heap instead
+static uint8_t* move_payload_create_shared(size_t len, const uint8_t* buf)
+{
+    size_t need = sizeof(move_payload_head) + ((len + 7) & ~(size_t)7);
+    if (need > MOVE_SLAB_MAX_PAYLOAD) {
+        return NULL;
+    }
+    move_slab* slab = move_slab_current;
+    if (slab == NULL || slab->used + need > MOVE_SLAB_SIZE) {
+        move_slab* fresh = move_slab_acquire();
+        if (fresh == NULL) {
+            return NULL;
+        }
+        if (slab != NULL) {
+            move_slab_release(slab);
+        }
+        move_slab_current = fresh;
+        slab = fresh;
+    }
+    move_payload_head* head = (move_payload_head*)((uint8_t*)slab + slab->used);
+    slab->used += need;
+    atomic_fetch_add_explicit(&slab->live, 1, memory_order_relaxed);
+    atomic_init(&head->refs, 1);
+    uint8_t* data = (uint8_t*)(head + 1);
+    memcpy(data, buf, len);
+    return data;
+}
+
+// payload for a new big move, len 0 moves have no payload
+static uint8_t* move_payload_create(size_t len, const uint8_t* buf)
+{
+    if (len == 0) {
+        return PTRMAX;
+    }
+    uint8_t* data = NULL;
+    if (atomic_load_explicit(&move_payload_shared, memory_order_relaxed) == true) {
+        data = move_payload_create_shared(len, buf);
+    }
+    if (data == NULL) {
+        data = (uint8_t*)malloc(len);
+        memcpy(data, buf, len);
+    }
+    return data;
+}
+
+static void move_payload_ref(move_data move)
+{
+    atomic_fetch_add_explicit(&((move_payload_head*)move.data - 1)->refs, 1, memory_order_relaxed);
+}
+
+static void move_payload_unref(move_slab* slab, move_data move)
+{
+    if (atomic_fetch_sub_explicit(&((move_payload_head*)move.data - 1)->refs, 1, memory_order_acq_rel) == 1) {
+        move_slab_release(slab);
+    }
+}
+
+void game_e_move_big_shared_enable(bool enable)
+{
+    atomic_store_explicit(&move_payload_shared, enable, memory_order_relaxed);
+}
+
 //TODO this might be a candidate for a rosalia utility in serialization.h
 size_t ls_move_data_serializer(GSIT itype, void* obj_in, void* obj_out, void* buf, void* buf_end)
 {
+    // shared payloads are immutable, a copy only takes another reference and destroying drops one
+    if (itype == GSIT_COPY || itype == GSIT_DESTROY) {
+        move_data* move_p = (move_data*)obj_in;
+        move_slab* slab = move_slab_of(*move_p);
+        if (slab != NULL) {
+            if (itype == GSIT_COPY) {
+                move_payload_ref(*move_p);
+                *(move_data*)obj_out = *move_p;
+            } else {
+                move_payload_unref(slab, *move_p);
+            }
+            return 0;
+        }
+        if (itype == GSIT_COPY && game_e_move_is_big(*move_p) == true && move_p->cl.len > 0 && atomic_load_explicit(&move_payload_shared, memory_order_relaxed) == true) {
+            // move heap payloads over on their first copy, so all further copies share
+            uint8_t* data = move_payload_create_shared(move_p->cl.len, move_p->data);
+            if (data != NULL) {
+                *(move_data*)obj_out = (move_data){.cl.len = move_p->cl.len, .data = data};
+                return 0;
+            }
+        }
+    }
+
     // flatten the unions, this encodes more data than required, but keeps complexity down
 
     typedef enum __attribute__((__packed__)) FLAT_MOVE_TYPE_E {
@@ -304,6 +496,352 @@ const char* game_get_last_error(game* self)
     return self->methods->get_last_error(self);
 }
 
+// a cached copy of an exported string, e.g. the state or print string
+typedef struct cache_str_s {
+    bool valid;
+    size_t size; // excluding null character
+    size_t cap;
+    char* str;
+} cache_str;
+
+// walker/vose alias table for one chance distribution, sampling is one bounded draw for the column and one coin flip against its threshold
+typedef struct alias_table_s {
+    uint32_t count;
+    uint32_t cap;
+    double* scaled; // build space, the probabilities scaled to mean 1
+    uint32_t* thresholds; // keep column i if the coin is below this, otherwise take the alias
+    uint32_t* aliases;
+    uint32_t* work; // build space, the small columns from the front, the large ones from the back
+} alias_table;
+
+// (re)builds the table for the distribution, reusing its buffer, returns false if out of memory
+static bool alias_table_build(alias_table* table, uint32_t count, const float* probs)
+{
+    if (count > table->cap) {
+        // one allocation for all arrays, the doubles go first for their alignment
+        void* buf = realloc(table->scaled, count * (sizeof(double) + 3 * sizeof(uint32_t)));
+        if (buf == NULL) {
+            return false;
+        }
+        table->scaled = (double*)buf;
+        table->cap = count;
+    }
+    table->thresholds = (uint32_t*)(table->scaled + table->cap);
+    table->aliases = table->thresholds + table->cap;
+    table->work = table->aliases + table->cap;
+    table->count = count;
+    // vose: scale to mean 1, then pair each small column with a large one that fills it up
+    double sum = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        sum += probs[i];
+    }
+    double* scaled = table->scaled;
+    uint32_t* work = table->work;
+    uint32_t small_c = 0;
+    uint32_t large_c = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        scaled[i] = (sum > 0 ? probs[i] * count / sum : 1);
+        if (scaled[i] < 1) {
+            work[small_c++] = i;
+        } else {
+            work[count - 1 - large_c++] = i;
+        }
+    }
+    while (small_c > 0 && large_c > 0) {
+        uint32_t s = work[--small_c];
+        uint32_t l = work[count - large_c];
+        table->thresholds[s] = (uint32_t)(scaled[s] * 4294967296.0);
+        table->aliases[s] = l;
+        scaled[l] -= 1 - scaled[s];
+        if (scaled[l] < 1) {
+            large_c--;
+            work[small_c++] = l;
+        }
+    }
+    // whatever is left is 1 up to rounding, always keep those columns
+    while (large_c > 0) {
+        uint32_t l = work[count - large_c--];
+        table->thresholds[l] = UINT32_MAX;
+        table->aliases[l] = l;
+    }
+    while (small_c > 0) {
+        uint32_t s = work[--small_c];
+        table->thresholds[s] = UINT32_MAX;
+        table->aliases[s] = s;
+    }
+    return true;
+}
+
+static void alias_table_destroy(alias_table* table)
+{
+    free(table->scaled);
+    *table = (alias_table){.count = 0, .cap = 0, .scaled = NULL, .thresholds = NULL, .aliases = NULL, .work = NULL};
+}
+
+#define ALIAS_LRU_SIZE 4
+
+typedef struct alias_lru_entry_s {
+    uint64_t last_use; // 0 if unused
+    uint32_t probs_cap;
+    float* probs; // copy of the distribution the table was built from, this is the key
+    alias_table table;
+} alias_lru_entry;
+
+// the last few alias tables, keyed on their distribution, so states sharing one (e.g. every roll of the same dice) share the table as well
+typedef struct alias_lru_s {
+    uint64_t clock;
+    alias_lru_entry entries[ALIAS_LRU_SIZE];
+} alias_lru;
+
+// returns the idx of the entry holding the table for this distribution, building it over the least recently used one if there is none, -1 if out of memory
+static int alias_lru_get(alias_lru* lru, uint32_t count, const float* probs)
+{
+    lru->clock++;
+    int victim = 0;
+    for (int i = 0; i < ALIAS_LRU_SIZE; i++) {
+        alias_lru_entry* entry = &lru->entries[i];
+        if (entry->last_use > 0 && entry->table.count == count && memcmp(entry->probs, probs, count * sizeof(float)) == 0) {
+            entry->last_use = lru->clock;
+            return i;
+        }
+        if (entry->last_use < lru->entries[victim].last_use) {
+            victim = i;
+        }
+    }
+    alias_lru_entry* entry = &lru->entries[victim];
+    entry->last_use = 0;
+    if (count > entry->probs_cap) {
+        float* buf = (float*)realloc(entry->probs, count * sizeof(float));
+        if (buf == NULL) {
+            return -1;
+        }
+        entry->probs = buf;
+        entry->probs_cap = count;
+    }
+    if (alias_table_build(&entry->table, count, probs) == false) {
+        return -1;
+    }
+    memcpy(entry->probs, probs, count * sizeof(float));
+    entry->last_use = lru->clock;
+    return victim;
+}
+
+static size_t alias_lru_size(const alias_lru* lru)
+{
+    size_t size = 0;
+    for (int i = 0; i < ALIAS_LRU_SIZE; i++) {
+        size += lru->entries[i].probs_cap * sizeof(float) + lru->entries[i].table.cap * (sizeof(double) + 3 * sizeof(uint32_t));
+    }
+    return size;
+}
+
+static void alias_lru_destroy(alias_lru* lru)
+{
+    for (int i = 0; i < ALIAS_LRU_SIZE; i++) {
+        free(lru->entries[i].probs);
+        alias_table_destroy(&lru->entries[i].table);
+    }
+    *lru = (alias_lru){.clock = 0};
+}
+
+// alias tables for games without the query cache and for game_e_playout_generic, released by game_e_thread_cleanup
+static _Thread_local alias_lru alias_lru_thread;
+
+struct game_cache_s {
+    uint64_t sync_ctr; // all cached results below are for the state at this sync_ctr
+    bool ptm_valid;
+    uint8_t ptm_count;
+    player_id ptm[UINT8_MAX];
+    bool moves_valid;
+    error_code moves_ec; // cached failure of get_concrete_moves, e.g. ERR_UNENUMERABLE
+    player_id moves_player;
+    uint32_t moves_count;
+    uint32_t moves_cap;
+    move_data* moves;
+    // open addressed (linear probing) set of the cached move codes, slots hold the idx + 1 into moves, 0 is empty
+    uint32_t set_cap; // power of 2
+    uint32_t* set;
+    cache_str state;
+    cache_str print;
+    int alias_cur; // idx of the alias table of the concrete move probabilities of this state, -1 if not looked up yet
+    alias_lru alias; // keyed on the distribution, it stays valid across state changes
+};
+
+static uint32_t cache_set_slot(move_code code, uint32_t cap)
+{
+    return (uint32_t)((code * 0x9E3779B97F4A7C15ULL) >> 32) & (cap - 1);
+}
+
+// returns the cache if enabled, with all its results dropped if the sync_ctr moved on
+static game_cache* cache_get(game* self)
+{
+    game_cache* cache = self->cache;
+    if (cache != NULL && cache->sync_ctr != self->sync_ctr) {
+        cache->sync_ctr = self->sync_ctr;
+        cache->ptm_valid = false;
+        cache->moves_valid = false;
+        cache->state.valid = false;
+        cache->print.valid = false;
+        cache->alias_cur = -1;
+    }
+    return cache;
+}
+
+// fills the cached move list (and set) for player, if not already present, returns the result of get_concrete_moves
+static error_code cache_fill_moves(game* self, game_cache* cache, player_id player)
+{
+    if (cache->moves_valid == true && cache->moves_player == player) {
+        return cache->moves_ec;
+    }
+    uint32_t count;
+    const move_data* moves;
+    error_code ec = GAME_STATS_CALL(self->methods, GET_CONCRETE_MOVES, self->methods->get_concrete_moves(self, player, &count, &moves));
+    GAME_TRACE(self, GET_CONCRETE_MOVES, ec, .player = player);
+    cache->moves_valid = true;
+    cache->moves_ec = ec;
+    cache->moves_player = player;
+    cache->moves_count = 0;
+    if (ec != ERR_OK) {
+        return ec;
+    }
+    if (count > cache->moves_cap) {
+        uint32_t set_cap = 8;
+        while (set_cap < count * 2) {
+            set_cap *= 2;
+        }
+        move_data* new_moves = (move_data*)realloc(cache->moves, count * sizeof(move_data));
+        if (new_moves != NULL) {
+            cache->moves = new_moves;
+        }
+        uint32_t* new_set = (uint32_t*)realloc(cache->set, set_cap * sizeof(uint32_t));
+        if (new_set != NULL) {
+            cache->set = new_set;
+        }
+        if (new_moves == NULL || new_set == NULL) {
+            cache->moves_valid = false;
+            return ERR_OUT_OF_MEMORY;
+        }
+        cache->moves_cap = count;
+        cache->set_cap = set_cap;
+    }
+    memcpy(cache->moves, moves, count * sizeof(move_data));
+    cache->moves_count = count;
+    memset(cache->set, 0, cache->set_cap * sizeof(uint32_t));
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t slot = cache_set_slot(moves[i].cl.code, cache->set_cap);
+        while (cache->set[slot] != 0) {
+            slot = (slot + 1) & (cache->set_cap - 1);
+        }
+        cache->set[slot] = i + 1;
+    }
+    return ERR_OK;
+}
+
+// copies str into the cached string, on failure the cached string just stays invalid
+static void cache_str_store(cache_str* cs, size_t size, const char* str)
+{
+    cs->valid = false;
+    if (size + 1 > cs->cap) {
+        char* new_str = (char*)realloc(cs->str, size + 1);
+        if (new_str == NULL) {
+            return;
+        }
+        cs->str = new_str;
+        cs->cap = size + 1;
+    }
+    memcpy(cs->str, str, size);
+    cs->str[size] = '\0';
+    cs->size = size;
+    cs->valid = true;
+}
+
+// returns true if the concrete moves of player are the complete set of legal moves, only then can the cached list answer is_legal_move
+// actions and placeholder moves of hidden information games are legal without being listed, just like seeded or unlisted PLAYER_ENV moves
+static bool cache_lists_all_legal_moves(game* self, player_id player)
+{
+    game_feature_flags ff = game_ff(self);
+    return ff.big_moves == false && ff.simultaneous_moves == false && ff.hidden_information == false && ff.random_moves == false && player != PLAYER_ENV;
+}
+
+static bool cache_set_contains(game_cache* cache, move_code code)
+{
+    uint32_t slot = cache_set_slot(code, cache->set_cap);
+    while (cache->set[slot] != 0) {
+        if (cache->moves[cache->set[slot] - 1].cl.code == code) {
+            return true;
+        }
+        slot = (slot + 1) & (cache->set_cap - 1);
+    }
+    return false;
+}
+
+error_code game_e_cache_enable(game* self)
+{
+    assert(self);
+    if (self->cache != NULL) {
+        return ERR_OK;
+    }
+    self->cache = (game_cache*)malloc(sizeof(game_cache));
+    if (self->cache == NULL) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    *self->cache = (game_cache){
+        .sync_ctr = self->sync_ctr,
+        .ptm_valid = false,
+        .moves_valid = false,
+        .moves_cap = 0,
+        .moves = NULL,
+        .set_cap = 0,
+        .set = NULL,
+        .state = (cache_str){.valid = false, .size = 0, .cap = 0, .str = NULL},
+        .print = (cache_str){.valid = false, .size = 0, .cap = 0, .str = NULL},
+        .alias_cur = -1,
+        .alias = (alias_lru){.clock = 0},
+    };
+    return ERR_OK;
+}
+
+void game_e_cache_disable(game* self)
+{
+    assert(self);
+    if (self->cache == NULL) {
+        return;
+    }
+    free(self->cache->moves);
+    free(self->cache->set);
+    free(self->cache->state.str);
+    free(self->cache->print.str);
+    alias_lru_destroy(&self->cache->alias);
+    free(self->cache);
+    self->cache = NULL;
+}
+
+void game_e_cache_invalidate(game* self)
+{
+    assert(self);
+    if (self->cache == NULL) {
+        return;
+    }
+    self->cache->ptm_valid = false;
+    self->cache->moves_valid = false;
+    self->cache->state.valid = false;
+    self->cache->print.valid = false;
+    self->cache->alias_cur = -1;
+}
+
+void game_e_unmake_enable(game* self)
+{
+    assert(self);
+    assert(game_ff(self).unmake_move);
+    self->unmake_history = true;
+}
+
+void game_e_unmake_disable(game* self)
+{
+    assert(self);
+    self->unmake_history = false;
+}
+
 error_code game_create(game* self, game_init* init_info)
 {
     assert(self);
@@ -312,7 +850,45 @@ error_code game_create(game* self, game_init* init_info)
     assert(!(init_info->source_type == GAME_INIT_SOURCE_TYPE_SERIALIZED && game_ff(self).serializable == false));
     self->data1 = NULL;
     self->data2 = NULL;
-    error_code ec = self->methods->create(self, init_info);
+    self->cache = NULL;
+    self->unmake_history = false;
+    error_code ec = GAME_STATS_CALL(self->methods, CREATE, self->methods->create(self, init_info));
+    GAME_TRACE(self, CREATE, ec, .init_info = init_info);
+    if (init_info->source_type == GAME_INIT_SOURCE_TYPE_DEFAULT) {
+        self->sync_ctr = SYNC_CTR_DEFAULT;
+    } else if (init_info->source_type == GAME_INIT_SOURCE_TYPE_STANDARD) {
+        self->sync_ctr = init_info->source.standard.sync_ctr;
+    }
+    return ec;
+}
+
+error_code game_size_hint(game* self, game_init* init_info, size_t* ret_size)
+{
+    assert(self);
+    assert(self->methods);
+    assert(ret_size);
+    if (game_ff(self).create_in == false) {
+        return ERR_FEATURE_UNSUPPORTED;
+    }
+    return GAME_STATS_CALL(self->methods, SIZE_HINT, self->methods->size_hint(self, init_info, ret_size));
+}
+
+error_code game_create_in(game* self, game_init* init_info, game_arena* arena)
+{
+    assert(self);
+    assert(self->methods);
+    assert(init_info);
+    assert(arena);
+    if (game_ff(self).create_in == false) {
+        return game_create(self, init_info);
+    }
+    assert(!(init_info->source_type == GAME_INIT_SOURCE_TYPE_SERIALIZED && game_ff(self).serializable == false));
+    self->data1 = NULL;
+    self->data2 = NULL;
+    self->cache = NULL;
+    self->unmake_history = false;
+    error_code ec = GAME_STATS_CALL(self->methods, CREATE_IN, self->methods->create_in(self, init_info, arena));
+    GAME_TRACE(self, CREATE_IN, ec, .init_info = init_info);
     if (init_info->source_type == GAME_INIT_SOURCE_TYPE_DEFAULT) {
         self->sync_ctr = SYNC_CTR_DEFAULT;
     } else if (init_info->source_type == GAME_INIT_SOURCE_TYPE_STANDARD) {
@@ -325,12 +901,16 @@ error_code game_destroy(game* self)
 {
     assert(self);
     assert(self->methods);
-    error_code ec = self->methods->destroy(self);
+    error_code ec = GAME_STATS_CALL(self->methods, DESTROY, self->methods->destroy(self));
+    GAME_TRACE(self, DESTROY, ec);
+    game_e_cache_disable(self);
     *self = (game){
         .methods = NULL,
         .data1 = NULL,
         .data2 = NULL,
         .sync_ctr = SYNC_CTR_DEFAULT,
+        .cache = NULL,
+        .unmake_history = false,
     };
     return ec;
 }
@@ -341,7 +921,28 @@ error_code game_clone(game* self, game* clone_target)
     assert(self->methods);
     assert(clone_target);
     clone_target->methods = self->methods;
-    error_code ec = self->methods->clone(self, clone_target);
+    clone_target->cache = NULL;
+    clone_target->unmake_history = false;
+    error_code ec = GAME_STATS_CALL(self->methods, CLONE, self->methods->clone(self, clone_target));
+    GAME_TRACE(self, CLONE, ec, .other = clone_target);
+    clone_target->sync_ctr = self->sync_ctr;
+    return ec;
+}
+
+error_code game_clone_in(game* self, game* clone_target, game_arena* arena)
+{
+    assert(self);
+    assert(self->methods);
+    assert(clone_target);
+    assert(arena);
+    if (game_ff(self).create_in == false) {
+        return game_clone(self, clone_target);
+    }
+    clone_target->methods = self->methods;
+    clone_target->cache = NULL;
+    clone_target->unmake_history = false;
+    error_code ec = GAME_STATS_CALL(self->methods, CLONE_IN, self->methods->clone_in(self, clone_target, arena));
+    GAME_TRACE(self, CLONE_IN, ec, .other = clone_target);
     clone_target->sync_ctr = self->sync_ctr;
     return ec;
 }
@@ -352,18 +953,38 @@ error_code game_copy_from(game* self, game* other)
     assert(self->methods);
     assert(other);
     //TODO want to assert that game_methods are equal?
-    error_code ec = self->methods->copy_from(self, other);
+    game_e_cache_invalidate(self);
+    error_code ec = GAME_STATS_CALL(self->methods, COPY_FROM, self->methods->copy_from(self, other));
+    GAME_TRACE(self, COPY_FROM, ec, .other = other);
     self->sync_ctr = other->sync_ctr;
     return ec;
 }
 
+error_code game_memory_usage(game* self, size_t* ret_state, size_t* ret_buffers)
+{
+    assert(self);
+    assert(self->methods);
+    assert(game_ff(self).memory_usage);
+    assert(ret_state);
+    assert(ret_buffers);
+    error_code ec = GAME_STATS_CALL(self->methods, MEMORY_USAGE, self->methods->memory_usage(self, ret_state, ret_buffers));
+    if (ec == ERR_OK && self->cache != NULL) {
+        *ret_buffers += sizeof(game_cache) + self->cache->moves_cap * sizeof(move_data) + self->cache->set_cap * sizeof(uint32_t);
+        *ret_buffers += self->cache->state.cap + self->cache->print.cap;
+        *ret_buffers += alias_lru_size(&self->cache->alias);
+    }
+    return ec;
+}
+
 error_code game_compare(game* self, game* other, bool* ret_equal)
 {
     assert(self);
     assert(self->methods);
     assert(other);
     assert(ret_equal);
-    return self->methods->compare(self, other, ret_equal);
+    error_code ec = GAME_STATS_CALL(self->methods, COMPARE, self->methods->compare(self, other, ret_equal));
+    GAME_TRACE(self, COMPARE, ec, .other = other);
+    return ec;
 }
 
 error_code game_export_options(game* self, size_t* ret_size, const char** ret_str)
@@ -373,7 +994,9 @@ error_code game_export_options(game* self, size_t* ret_size, const char** ret_st
     assert(game_ff(self).options);
     assert(ret_size);
     assert(ret_str);
-    return self->methods->export_options(self, ret_size, ret_str);
+    error_code ec = GAME_STATS_CALL(self->methods, EXPORT_OPTIONS, self->methods->export_options(self, ret_size, ret_str));
+    GAME_TRACE(self, EXPORT_OPTIONS, ec);
+    return ec;
 }
 
 error_code game_player_count(game* self, uint8_t* ret_count)
@@ -381,7 +1004,9 @@ error_code game_player_count(game* self, uint8_t* ret_count)
     assert(self);
     assert(self->methods);
     assert(ret_count);
-    return self->methods->player_count(self, ret_count);
+    error_code ec = GAME_STATS_CALL(self->methods, PLAYER_COUNT, self->methods->player_count(self, ret_count));
+    GAME_TRACE(self, PLAYER_COUNT, ec);
+    return ec;
 }
 
 error_code game_export_state(game* self, size_t* ret_size, const char** ret_str)
@@ -390,7 +1015,48 @@ error_code game_export_state(game* self, size_t* ret_size, const char** ret_str)
     assert(self->methods);
     assert(ret_size);
     assert(ret_str);
-    return self->methods->export_state(self, ret_size, ret_str);
+    game_cache* cache = cache_get(self);
+    if (cache == NULL) {
+        error_code ec = GAME_STATS_CALL(self->methods, EXPORT_STATE, self->methods->export_state(self, ret_size, ret_str));
+        GAME_TRACE(self, EXPORT_STATE, ec);
+        return ec;
+    }
+    if (cache->state.valid == false) {
+        size_t size;
+        const char* str;
+        error_code ec = GAME_STATS_CALL(self->methods, EXPORT_STATE, self->methods->export_state(self, &size, &str));
+        GAME_TRACE(self, EXPORT_STATE, ec);
+        if (ec != ERR_OK) {
+            return ec;
+        }
+        cache_str_store(&cache->state, size, str);
+        if (cache->state.valid == false) {
+            *ret_size = size;
+            *ret_str = str;
+            return ERR_OK;
+        }
+    }
+    *ret_size = cache->state.size;
+    *ret_str = cache->state.str;
+    return ERR_OK;
+}
+
+error_code game_export_state_delta(game* self, uint64_t since_sync_ctr, size_t* ret_size, const char** ret_str)
+{
+    assert(self);
+    assert(self->methods);
+    assert(game_ff(self).export_state_delta);
+    assert(ret_size);
+    assert(ret_str);
+    if (since_sync_ctr > self->sync_ctr) {
+        // the receiver is ahead of this game, no journal can reach there
+        *ret_size = 0;
+        *ret_str = NULL;
+        return ERR_OK;
+    }
+    error_code ec = GAME_STATS_CALL(self->methods, EXPORT_STATE_DELTA, self->methods->export_state_delta(self, since_sync_ctr, ret_size, ret_str));
+    GAME_TRACE(self, EXPORT_STATE_DELTA, ec, .since_sync_ctr = since_sync_ctr);
+    return ec;
 }
 
 error_code game_import_state(game* self, const char* str)
@@ -398,7 +1064,10 @@ error_code game_import_state(game* self, const char* str)
     assert(self);
     assert(self->methods);
     assert(str);
-    return self->methods->import_state(self, str);
+    game_e_cache_invalidate(self);
+    error_code ec = GAME_STATS_CALL(self->methods, IMPORT_STATE, self->methods->import_state(self, str));
+    GAME_TRACE(self, IMPORT_STATE, ec, .str = str);
+    return ec;
 }
 
 error_code game_serialize(game* self, const blob** ret_blob)
@@ -407,7 +1076,9 @@ error_code game_serialize(game* self, const blob** ret_blob)
     assert(self->methods);
     assert(game_ff(self).serializable);
     assert(ret_blob);
-    return self->methods->serialize(self, ret_blob);
+    error_code ec = GAME_STATS_CALL(self->methods, SERIALIZE, self->methods->serialize(self, ret_blob));
+    GAME_TRACE(self, SERIALIZE, ec);
+    return ec;
 }
 
 error_code game_players_to_move(game* self, uint8_t* ret_count, const player_id** ret_players)
@@ -416,7 +1087,29 @@ error_code game_players_to_move(game* self, uint8_t* ret_count, const player_id*
     assert(self->methods);
     assert(ret_count);
     assert(ret_players);
-    return self->methods->players_to_move(self, ret_count, ret_players);
+    game_cache* cache = cache_get(self);
+    if (cache == NULL) {
+        error_code ec = GAME_STATS_CALL(self->methods, PLAYERS_TO_MOVE, self->methods->players_to_move(self, ret_count, ret_players));
+        GAME_TRACE(self, PLAYERS_TO_MOVE, ec);
+        return ec;
+    }
+    if (cache->ptm_valid == false) {
+        uint8_t count;
+        const player_id* players;
+        error_code ec = GAME_STATS_CALL(self->methods, PLAYERS_TO_MOVE, self->methods->players_to_move(self, &count, &players));
+        GAME_TRACE(self, PLAYERS_TO_MOVE, ec);
+        if (ec != ERR_OK) {
+            return ec;
+        }
+        cache->ptm_count = count;
+        if (count > 0) {
+            memcpy(cache->ptm, players, count * sizeof(player_id));
+        }
+        cache->ptm_valid = true;
+    }
+    *ret_count = cache->ptm_count;
+    *ret_players = cache->ptm;
+    return ERR_OK;
 }
 
 error_code game_get_concrete_moves(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves)
@@ -428,58 +1121,234 @@ error_code game_get_concrete_moves(game* self, player_id player, uint32_t* ret_c
     if (game_e_player_to_move(self, player) == false) {
         return ERR_INVALID_INPUT;
     }
-    return self->methods->get_concrete_moves(self, player, ret_count, ret_moves);
+    game_cache* cache = cache_get(self);
+    if (cache == NULL || game_ff(self).big_moves == true) {
+        // big moves point into game owned buffers, so they can not outlive the call
+        error_code ec = GAME_STATS_CALL(self->methods, GET_CONCRETE_MOVES, self->methods->get_concrete_moves(self, player, ret_count, ret_moves));
+        GAME_TRACE(self, GET_CONCRETE_MOVES, ec, .player = player);
+        return ec;
+    }
+    error_code ec = cache_fill_moves(self, cache, player);
+    if (ec != ERR_OK) {
+        return ec;
+    }
+    *ret_count = cache->moves_count;
+    *ret_moves = cache->moves;
+    return ERR_OK;
 }
 
-error_code game_get_concrete_move_probabilities(game* self, uint32_t* ret_count, const float** ret_move_probabilities)
+error_code game_get_moves_begin(game* self, player_id player, move_iterator* it)
 {
     assert(self);
     assert(self->methods);
-    assert(game_ff(self).random_moves);
-    assert(ret_count);
-    assert(ret_move_probabilities);
-    if (game_e_player_to_move(self, PLAYER_ENV) == false) {
+    assert(it);
+    if (game_e_player_to_move(self, player) == false) {
         return ERR_INVALID_INPUT;
     }
-    return self->methods->get_concrete_move_probabilities(self, ret_count, ret_move_probabilities);
+    if (game_ff(self).lazy_moves == true) {
+        return GAME_STATS_CALL(self->methods, GET_MOVES_BEGIN, self->methods->get_moves_begin(self, player, it));
+    }
+    it->player = player;
+    it->stage = 0;
+    it->idx = 0;
+    it->sub = 0;
+    error_code ec = GAME_STATS_CALL(self->methods, GET_CONCRETE_MOVES, self->methods->get_concrete_moves(self, player, &it->count, &it->moves));
+    GAME_TRACE(self, GET_CONCRETE_MOVES, ec, .player = player);
+    return ec;
 }
 
-error_code game_get_random_move(game* self, seed128 seed, move_data_sync** ret_move)
+error_code game_get_moves_next(game* self, move_iterator* it, bool* ret_done, move_data* ret_move)
 {
     assert(self);
     assert(self->methods);
-    assert(game_ff(self).random_moves);
+    assert(it);
+    assert(ret_done);
     assert(ret_move);
-    if (game_e_player_to_move(self, PLAYER_ENV) == false) {
-        return ERR_INVALID_INPUT;
+    if (game_ff(self).lazy_moves == true) {
+        return GAME_STATS_CALL(self->methods, GET_MOVES_NEXT, self->methods->get_moves_next(self, it, ret_done, ret_move));
     }
-    return self->methods->get_random_move(self, seed, ret_move);
+    if (it->idx >= it->count) {
+        *ret_done = true;
+        return ERR_OK;
+    }
+    *ret_done = false;
+    *ret_move = it->moves[it->idx++];
+    return ERR_OK;
 }
 
-error_code game_get_concrete_moves_ordered(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves)
+// the _into wrappers must stay read only on the game, so they neither use the cache nor game_e_player_to_move
+
+error_code game_players_to_move_into(game* self, uint8_t cap, uint8_t* ret_count, player_id* players)
 {
     assert(self);
     assert(self->methods);
-    assert(game_ff(self).move_ordering);
+    assert(game_ff(self).query_into);
     assert(ret_count);
-    assert(ret_moves);
-    if (game_e_player_to_move(self, player) == false) {
-        return ERR_INVALID_INPUT;
-    }
-    return self->methods->get_concrete_moves_ordered(self, player, ret_count, ret_moves);
+    assert(players);
+    return GAME_STATS_CALL(self->methods, PLAYERS_TO_MOVE_INTO, self->methods->players_to_move_into(self, cap, ret_count, players));
 }
 
-error_code game_get_actions(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves)
+error_code game_get_concrete_moves_into(game* self, player_id player, uint32_t cap, uint32_t* ret_count, move_data* moves)
 {
     assert(self);
     assert(self->methods);
-    assert(game_ff(self).action_list && (game_ff(self).hidden_information || game_ff(self).simultaneous_moves));
+    assert(game_ff(self).query_into);
     assert(ret_count);
-    assert(ret_moves);
-    if (game_e_player_to_move(self, player) == false) {
+    assert(moves);
+    assert(player != PLAYER_NONE);
+    uint8_t ptm_count;
+    player_id ptm[UINT8_MAX];
+    error_code ec = GAME_STATS_CALL(self->methods, PLAYERS_TO_MOVE_INTO, self->methods->players_to_move_into(self, UINT8_MAX, &ptm_count, ptm));
+    if (ec != ERR_OK) {
+        return ec;
+    }
+    bool is_ptm = false;
+    for (uint8_t i = 0; i < ptm_count; i++) {
+        if (ptm[i] == player) {
+            is_ptm = true;
+            break;
+        }
+    }
+    if (is_ptm == false) {
         return ERR_INVALID_INPUT;
     }
-    return self->methods->get_actions(self, player, ret_count, ret_moves);
+    return GAME_STATS_CALL(self->methods, GET_CONCRETE_MOVES_INTO, self->methods->get_concrete_moves_into(self, player, cap, ret_count, moves));
+}
+
+error_code game_export_state_into(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    assert(self);
+    assert(self->methods);
+    assert(game_ff(self).query_into);
+    assert(ret_size);
+    assert(str);
+    return GAME_STATS_CALL(self->methods, EXPORT_STATE_INTO, self->methods->export_state_into(self, cap, ret_size, str));
+}
+
+error_code game_get_move_str_into(game* self, player_id player, move_data_sync move, size_t cap, size_t* ret_size, char* str)
+{
+    assert(self);
+    assert(self->methods);
+    assert(game_ff(self).query_into);
+    assert(ret_size);
+    assert(str);
+    assert(player != PLAYER_NONE);
+    if (self->sync_ctr != move.sync_ctr && game_ff(self).simultaneous_moves == false) {
+        return ERR_SYNC_COUNTER_MISMATCH;
+    }
+    return GAME_STATS_CALL(self->methods, GET_MOVE_STR_INTO, self->methods->get_move_str_into(self, player, move, cap, ret_size, str));
+}
+
+error_code game_print_into(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    assert(self);
+    assert(self->methods);
+    assert(game_ff(self).query_into);
+    assert(game_ff(self).print);
+    assert(ret_size);
+    assert(str);
+    return GAME_STATS_CALL(self->methods, PRINT_INTO, self->methods->print_into(self, cap, ret_size, str));
+}
+
+// gather buffer for games without the move_codes feature, released by game_e_thread_cleanup
+static _Thread_local move_code* concrete_moves_codes_buf = NULL;
+static _Thread_local uint32_t concrete_moves_codes_cap = 0;
+
+error_code game_get_concrete_moves_codes(game* self, player_id player, uint32_t* ret_count, const move_code** ret_moves)
+{
+    assert(self);
+    assert(self->methods);
+    assert(game_ff(self).big_moves == false);
+    assert(ret_count);
+    assert(ret_moves);
+    if (game_e_player_to_move(self, player) == false) {
+        return ERR_INVALID_INPUT;
+    }
+    if (game_ff(self).move_codes == true) {
+        error_code ec = GAME_STATS_CALL(self->methods, GET_CONCRETE_MOVES_CODES, self->methods->get_concrete_moves_codes(self, player, ret_count, ret_moves));
+        GAME_TRACE(self, GET_CONCRETE_MOVES_CODES, ec, .player = player);
+        return ec;
+    }
+    uint32_t count;
+    const move_data* moves;
+    error_code ec = GAME_STATS_CALL(self->methods, GET_CONCRETE_MOVES, self->methods->get_concrete_moves(self, player, &count, &moves));
+    GAME_TRACE(self, GET_CONCRETE_MOVES, ec, .player = player);
+    if (ec != ERR_OK) {
+        return ec;
+    }
+    if (count > concrete_moves_codes_cap) {
+        move_code* new_buf = (move_code*)realloc(concrete_moves_codes_buf, count * sizeof(move_code));
+        if (new_buf == NULL) {
+            return ERR_OUT_OF_MEMORY;
+        }
+        concrete_moves_codes_buf = new_buf;
+        concrete_moves_codes_cap = count;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        concrete_moves_codes_buf[i] = moves[i].cl.code;
+    }
+    *ret_count = count;
+    *ret_moves = concrete_moves_codes_buf;
+    return ERR_OK;
+}
+
+error_code game_get_concrete_move_probabilities(game* self, uint32_t* ret_count, const float** ret_move_probabilities)
+{
+    assert(self);
+    assert(self->methods);
+    assert(game_ff(self).random_moves);
+    assert(ret_count);
+    assert(ret_move_probabilities);
+    if (game_e_player_to_move(self, PLAYER_ENV) == false) {
+        return ERR_INVALID_INPUT;
+    }
+    error_code ec = GAME_STATS_CALL(self->methods, GET_CONCRETE_MOVE_PROBABILITIES, self->methods->get_concrete_move_probabilities(self, ret_count, ret_move_probabilities));
+    GAME_TRACE(self, GET_CONCRETE_MOVE_PROBABILITIES, ec);
+    return ec;
+}
+
+error_code game_get_random_move(game* self, seed128 seed, move_data_sync** ret_move)
+{
+    assert(self);
+    assert(self->methods);
+    assert(game_ff(self).random_moves);
+    assert(ret_move);
+    if (game_e_player_to_move(self, PLAYER_ENV) == false) {
+        return ERR_INVALID_INPUT;
+    }
+    error_code ec = GAME_STATS_CALL(self->methods, GET_RANDOM_MOVE, self->methods->get_random_move(self, seed, ret_move));
+    GAME_TRACE(self, GET_RANDOM_MOVE, ec, .seed = seed);
+    return ec;
+}
+
+error_code game_get_concrete_moves_ordered(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves)
+{
+    assert(self);
+    assert(self->methods);
+    assert(game_ff(self).move_ordering);
+    assert(ret_count);
+    assert(ret_moves);
+    if (game_e_player_to_move(self, player) == false) {
+        return ERR_INVALID_INPUT;
+    }
+    error_code ec = GAME_STATS_CALL(self->methods, GET_CONCRETE_MOVES_ORDERED, self->methods->get_concrete_moves_ordered(self, player, ret_count, ret_moves));
+    GAME_TRACE(self, GET_CONCRETE_MOVES_ORDERED, ec, .player = player);
+    return ec;
+}
+
+error_code game_get_actions(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves)
+{
+    assert(self);
+    assert(self->methods);
+    assert(game_ff(self).action_list && (game_ff(self).hidden_information || game_ff(self).simultaneous_moves));
+    assert(ret_count);
+    assert(ret_moves);
+    if (game_e_player_to_move(self, player) == false) {
+        return ERR_INVALID_INPUT;
+    }
+    error_code ec = GAME_STATS_CALL(self->methods, GET_ACTIONS, self->methods->get_actions(self, player, ret_count, ret_moves));
+    GAME_TRACE(self, GET_ACTIONS, ec, .player = player);
+    return ec;
 }
 
 error_code game_is_legal_move(game* self, player_id player, move_data_sync move)
@@ -495,7 +1364,16 @@ error_code game_is_legal_move(game* self, player_id player, move_data_sync move)
     if (game_ff(self).big_moves == false && game_e_move_is_big(move.md) == true) {
         return ERR_INVALID_INPUT;
     }
-    return self->methods->is_legal_move(self, player, move);
+    game_cache* cache = cache_get(self);
+    if (cache != NULL && cache_lists_all_legal_moves(self, player) == true) {
+        // legal moves are exactly the listed ones here, so one generation answers all further checks on this state
+        if (cache_fill_moves(self, cache, player) == ERR_OK) {
+            return cache_set_contains(cache, move.md.cl.code) == true ? ERR_OK : ERR_INVALID_INPUT;
+        }
+    }
+    error_code ec = GAME_STATS_CALL(self->methods, IS_LEGAL_MOVE, self->methods->is_legal_move(self, player, move));
+    GAME_TRACE(self, IS_LEGAL_MOVE, ec, .player = player, .move = &move);
+    return ec;
 }
 
 error_code game_move_to_action(game* self, player_id player, move_data_sync move, uint8_t target_count, const player_id* target_players, move_data_sync** ret_action)
@@ -510,7 +1388,9 @@ error_code game_move_to_action(game* self, player_id player, move_data_sync move
     if (self->sync_ctr != move.sync_ctr && game_ff(self).sync_ctr == false) {
         return ERR_SYNC_COUNTER_MISMATCH;
     }
-    return self->methods->move_to_action(self, player, move, target_count, target_players, ret_action);
+    error_code ec = GAME_STATS_CALL(self->methods, MOVE_TO_ACTION, self->methods->move_to_action(self, player, move, target_count, target_players, ret_action));
+    GAME_TRACE(self, MOVE_TO_ACTION, ec, .player = player, .move = &move, .player_count = target_count, .players = target_players);
+    return ec;
 }
 
 error_code game_make_move(game* self, player_id player, move_data_sync move)
@@ -522,20 +1402,102 @@ error_code game_make_move(game* self, player_id player, move_data_sync move)
     if (ec != ERR_OK) {
         return ec;
     }
-    ec = self->methods->make_move(self, player, move);
+    game_e_cache_invalidate(self);
+    ec = GAME_STATS_CALL(self->methods, MAKE_MOVE, self->methods->make_move(self, player, move));
+    GAME_TRACE(self, MAKE_MOVE, ec, .player = player, .move = &move);
     if (ec == ERR_OK) {
         self->sync_ctr++;
     }
     return ec;
 }
 
+error_code game_make_moves(game* self, uint32_t count, const player_id* players, const move_data_sync* moves, bool trusted, uint32_t* ret_made)
+{
+    assert(self);
+    assert(self->methods);
+    assert(ret_made);
+    assert(count == 0 || (players && moves));
+    *ret_made = 0;
+    error_code ec = ERR_OK;
+    if (trusted == false) {
+        // sync ctrs and move kinds do not depend on the state, so check them for the whole batch before making any move
+        for (uint32_t i = 0; i < count; i++) {
+            if (self->sync_ctr + i != moves[i].sync_ctr && game_ff(self).sync_ctr == false) {
+                ec = ERR_SYNC_COUNTER_MISMATCH;
+            } else if ((game_ff(self).big_moves == false && game_e_move_is_big(moves[i].md) == true) || players[i] == PLAYER_NONE) {
+                ec = ERR_INVALID_INPUT;
+            }
+            if (ec != ERR_OK) {
+                // only make the valid prefix, then report the failure at this idx
+                count = i;
+                break;
+            }
+        }
+    }
+    game_e_cache_invalidate(self);
+    if (game_ff(self).make_moves == true) {
+        error_code bec = GAME_STATS_CALL(self->methods, MAKE_MOVES, self->methods->make_moves(self, count, players, moves, trusted, ret_made));
+        GAME_TRACE(self, MAKE_MOVES, bec, .move_count = count, .move_players = players, .moves = moves, .trusted = trusted);
+        self->sync_ctr += *ret_made;
+        if (bec != ERR_OK) {
+            return bec;
+        }
+        return ec;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        error_code mec;
+        if (trusted == true) {
+            mec = GAME_STATS_CALL(self->methods, MAKE_MOVE, self->methods->make_move(self, players[i], moves[i]));
+            GAME_TRACE(self, MAKE_MOVE, mec, .player = players[i], .move = &moves[i]);
+            if (mec == ERR_OK) {
+                self->sync_ctr++;
+            }
+        } else {
+            mec = game_make_move(self, players[i], moves[i]);
+        }
+        if (mec != ERR_OK) {
+            return mec;
+        }
+        *ret_made = i + 1;
+    }
+    return ec;
+}
+
+error_code game_unmake_move(game* self, player_id player, move_data_sync move)
+{
+    assert(self);
+    assert(self->methods);
+    assert(game_ff(self).unmake_move);
+    assert(player != PLAYER_NONE);
+    if (self->sync_ctr == 0) {
+        return ERR_INVALID_INPUT;
+    }
+    // the move carries the sync_ctr it was made at, which is one behind the current one
+    if (self->sync_ctr - 1 != move.sync_ctr && game_ff(self).sync_ctr == false) {
+        return ERR_SYNC_COUNTER_MISMATCH;
+    }
+    if (game_ff(self).big_moves == false && game_e_move_is_big(move.md) == true) {
+        return ERR_INVALID_INPUT;
+    }
+    // the sync_ctr goes back to a value that cached results may already be keyed on
+    game_e_cache_invalidate(self);
+    error_code ec = GAME_STATS_CALL(self->methods, UNMAKE_MOVE, self->methods->unmake_move(self, player, move));
+    GAME_TRACE(self, UNMAKE_MOVE, ec, .player = player, .move = &move);
+    if (ec == ERR_OK) {
+        self->sync_ctr--;
+    }
+    return ec;
+}
+
 error_code game_get_results(game* self, uint8_t* ret_count, const player_id** ret_players)
 {
     assert(self);
     assert(self->methods);
     assert(ret_count);
     assert(ret_players);
-    return self->methods->get_results(self, ret_count, ret_players);
+    error_code ec = GAME_STATS_CALL(self->methods, GET_RESULTS, self->methods->get_results(self, ret_count, ret_players));
+    GAME_TRACE(self, GET_RESULTS, ec);
+    return ec;
 }
 
 error_code game_export_legacy(game* self, player_id player, size_t* ret_size, const char** ret_str)
@@ -546,7 +1508,9 @@ error_code game_export_legacy(game* self, player_id player, size_t* ret_size, co
     assert(ret_size);
     assert(ret_str);
     assert(player != PLAYER_NONE);
-    return self->methods->export_legacy(self, player, ret_size, ret_str);
+    error_code ec = GAME_STATS_CALL(self->methods, EXPORT_LEGACY, self->methods->export_legacy(self, player, ret_size, ret_str));
+    GAME_TRACE(self, EXPORT_LEGACY, ec, .player = player);
+    return ec;
 }
 
 error_code game_s_get_legacy_results(game_methods* methods, const char* opts_str, const char* env_legacy, uint16_t player_legacy_count, const char* const* player_legacies, uint16_t* ret_count, const uint16_t** ret_legacy_idxs)
@@ -567,7 +1531,21 @@ error_code game_id(game* self, uint64_t* ret_id)
     assert(self->methods);
     assert(game_ff(self).id);
     assert(ret_id);
-    return self->methods->id(self, ret_id);
+    error_code ec = GAME_STATS_CALL(self->methods, ID, self->methods->id(self, ret_id));
+    GAME_TRACE(self, ID, ec);
+    return ec;
+}
+
+error_code game_canonical_id(game* self, uint64_t* ret_id, uint8_t* ret_transform)
+{
+    assert(self);
+    assert(self->methods);
+    assert(game_ff(self).canonical_id);
+    assert(ret_id);
+    assert(ret_transform);
+    error_code ec = GAME_STATS_CALL(self->methods, CANONICAL_ID, self->methods->canonical_id(self, ret_id, ret_transform));
+    GAME_TRACE(self, CANONICAL_ID, ec);
+    return ec;
 }
 
 error_code game_eval(game* self, player_id player, float* ret_eval)
@@ -577,7 +1555,9 @@ error_code game_eval(game* self, player_id player, float* ret_eval)
     assert(game_ff(self).eval);
     assert(ret_eval);
     assert(player != PLAYER_NONE && player != PLAYER_ENV);
-    return self->methods->eval(self, player, ret_eval);
+    error_code ec = GAME_STATS_CALL(self->methods, EVAL, self->methods->eval(self, player, ret_eval));
+    GAME_TRACE(self, EVAL, ec, .player = player);
+    return ec;
 }
 
 error_code game_discretize(game* self, seed128 seed)
@@ -586,7 +1566,10 @@ error_code game_discretize(game* self, seed128 seed)
     assert(self->methods);
     assert((game_ff(self).random_moves || game_ff(self).hidden_information || game_ff(self).simultaneous_moves) && game_ff(self).discretize);
     assert(memcmp(&seed, &SEED128_NONE, sizeof(seed128)) != 0);
-    return self->methods->discretize(self, seed);
+    game_e_cache_invalidate(self);
+    error_code ec = GAME_STATS_CALL(self->methods, DISCRETIZE, self->methods->discretize(self, seed));
+    GAME_TRACE(self, DISCRETIZE, ec, .seed = seed);
+    return ec;
 }
 
 error_code game_playout(game* self, seed128 seed)
@@ -595,7 +1578,10 @@ error_code game_playout(game* self, seed128 seed)
     assert(self->methods);
     assert(game_ff(self).playout);
     assert(memcmp(&seed, &SEED128_NONE, sizeof(seed128)) != 0);
-    return self->methods->playout(self, seed);
+    game_e_cache_invalidate(self);
+    error_code ec = GAME_STATS_CALL(self->methods, PLAYOUT, self->methods->playout(self, seed));
+    GAME_TRACE(self, PLAYOUT, ec, .seed = seed);
+    return ec;
 }
 
 error_code game_redact_keep_state(game* self, uint8_t count, const player_id* players)
@@ -604,7 +1590,10 @@ error_code game_redact_keep_state(game* self, uint8_t count, const player_id* pl
     assert(self->methods);
     assert(game_ff(self).random_moves || game_ff(self).hidden_information || game_ff(self).simultaneous_moves);
     assert(players);
-    return self->methods->redact_keep_state(self, count, players);
+    game_e_cache_invalidate(self);
+    error_code ec = GAME_STATS_CALL(self->methods, REDACT_KEEP_STATE, self->methods->redact_keep_state(self, count, players));
+    GAME_TRACE(self, REDACT_KEEP_STATE, ec, .player_count = count, .players = players);
+    return ec;
 }
 
 error_code game_export_sync_data(game* self, uint32_t* ret_count, const sync_data** ret_sync_data)
@@ -614,7 +1603,9 @@ error_code game_export_sync_data(game* self, uint32_t* ret_count, const sync_dat
     assert((game_ff(self).hidden_information || game_ff(self).simultaneous_moves) && game_ff(self).sync_data);
     assert(ret_count);
     assert(ret_sync_data);
-    return self->methods->export_sync_data(self, ret_count, ret_sync_data);
+    error_code ec = GAME_STATS_CALL(self->methods, EXPORT_SYNC_DATA, self->methods->export_sync_data(self, ret_count, ret_sync_data));
+    GAME_TRACE(self, EXPORT_SYNC_DATA, ec);
+    return ec;
 }
 
 error_code game_import_sync_data(game* self, blob b)
@@ -623,7 +1614,10 @@ error_code game_import_sync_data(game* self, blob b)
     assert(self->methods);
     assert((game_ff(self).hidden_information || game_ff(self).simultaneous_moves) && game_ff(self).sync_data);
     assert(!blob_is_null(&b));
-    return self->methods->import_sync_data(self, b);
+    game_e_cache_invalidate(self);
+    error_code ec = GAME_STATS_CALL(self->methods, IMPORT_SYNC_DATA, self->methods->import_sync_data(self, b));
+    GAME_TRACE(self, IMPORT_SYNC_DATA, ec, .b = &b);
+    return ec;
 }
 
 error_code game_get_move_data(game* self, player_id player, const char* str, move_data_sync** ret_move)
@@ -633,7 +1627,8 @@ error_code game_get_move_data(game* self, player_id player, const char* str, mov
     assert(str);
     assert(ret_move);
     assert(player != PLAYER_NONE);
-    error_code ec = self->methods->get_move_data(self, player, str, ret_move);
+    error_code ec = GAME_STATS_CALL(self->methods, GET_MOVE_DATA, self->methods->get_move_data(self, player, str, ret_move));
+    GAME_TRACE(self, GET_MOVE_DATA, ec, .player = player, .str = str);
     if (ec == ERR_OK) {
         (*ret_move)->sync_ctr = self->sync_ctr;
     }
@@ -650,7 +1645,9 @@ error_code game_get_move_str(game* self, player_id player, move_data_sync move,
     if (self->sync_ctr != move.sync_ctr && game_ff(self).simultaneous_moves == false) {
         return ERR_SYNC_COUNTER_MISMATCH;
     }
-    return self->methods->get_move_str(self, player, move, ret_size, ret_str);
+    error_code ec = GAME_STATS_CALL(self->methods, GET_MOVE_STR, self->methods->get_move_str(self, player, move, ret_size, ret_str));
+    GAME_TRACE(self, GET_MOVE_STR, ec, .player = player, .move = &move);
+    return ec;
 }
 
 error_code game_print(game* self, size_t* ret_size, const char** ret_str)
@@ -660,7 +1657,112 @@ error_code game_print(game* self, size_t* ret_size, const char** ret_str)
     assert(game_ff(self).print);
     assert(ret_size);
     assert(ret_str);
-    return self->methods->print(self, ret_size, ret_str);
+    game_cache* cache = cache_get(self);
+    if (cache == NULL) {
+        error_code ec = GAME_STATS_CALL(self->methods, PRINT, self->methods->print(self, ret_size, ret_str));
+        GAME_TRACE(self, PRINT, ec);
+        return ec;
+    }
+    if (cache->print.valid == false) {
+        size_t size;
+        const char* str;
+        error_code ec = GAME_STATS_CALL(self->methods, PRINT, self->methods->print(self, &size, &str));
+        GAME_TRACE(self, PRINT, ec);
+        if (ec != ERR_OK) {
+            return ec;
+        }
+        cache_str_store(&cache->print, size, str);
+        if (cache->print.valid == false) {
+            *ret_size = size;
+            *ret_str = str;
+            return ERR_OK;
+        }
+    }
+    *ret_size = cache->print.size;
+    *ret_str = cache->print.str;
+    return ERR_OK;
+}
+
+error_code game_batch_create(game* self, uint32_t count, game_batch* ret_batch)
+{
+    assert(self);
+    assert(self->methods);
+    assert(game_ff(self).batch);
+    assert(ret_batch);
+    assert(count > 0);
+    ret_batch->methods = self->methods;
+    return GAME_STATS_CALL(self->methods, BATCH_CREATE, self->methods->batch_create(self, count, ret_batch));
+}
+
+error_code game_batch_destroy(game_batch* batch)
+{
+    assert(batch);
+    assert(batch->methods);
+    assert(batch->methods->features.batch);
+    return GAME_STATS_CALL(batch->methods, BATCH_DESTROY, batch->methods->batch_destroy(batch));
+}
+
+error_code game_batch_load(game_batch* batch, uint32_t idx, game* source)
+{
+    assert(batch);
+    assert(batch->methods);
+    assert(batch->methods->features.batch);
+    assert(source);
+    assert(source->methods == batch->methods);
+    if (idx >= batch->count) {
+        return ERR_INVALID_INPUT;
+    }
+    return GAME_STATS_CALL(batch->methods, BATCH_LOAD, batch->methods->batch_load(batch, idx, source));
+}
+
+error_code game_batch_store(game_batch* batch, uint32_t idx, game* target)
+{
+    assert(batch);
+    assert(batch->methods);
+    assert(batch->methods->features.batch);
+    assert(target);
+    assert(target->methods == batch->methods);
+    if (idx >= batch->count) {
+        return ERR_INVALID_INPUT;
+    }
+    game_e_cache_invalidate(target);
+    return GAME_STATS_CALL(batch->methods, BATCH_STORE, batch->methods->batch_store(batch, idx, target));
+}
+
+error_code game_batch_players_to_move(game_batch* batch, player_id* players)
+{
+    assert(batch);
+    assert(batch->methods);
+    assert(batch->methods->features.batch);
+    assert(players);
+    return GAME_STATS_CALL(batch->methods, BATCH_PLAYERS_TO_MOVE, batch->methods->batch_players_to_move(batch, players));
+}
+
+error_code game_batch_get_move_masks(game_batch* batch, uint64_t* masks)
+{
+    assert(batch);
+    assert(batch->methods);
+    assert(batch->methods->features.batch);
+    assert(masks);
+    return GAME_STATS_CALL(batch->methods, BATCH_GET_MOVE_MASKS, batch->methods->batch_get_move_masks(batch, masks));
+}
+
+error_code game_batch_make_moves(game_batch* batch, const uint32_t* move_idxs)
+{
+    assert(batch);
+    assert(batch->methods);
+    assert(batch->methods->features.batch);
+    assert(move_idxs);
+    return GAME_STATS_CALL(batch->methods, BATCH_MAKE_MOVES, batch->methods->batch_make_moves(batch, move_idxs));
+}
+
+error_code game_batch_get_results(game_batch* batch, player_id* results)
+{
+    assert(batch);
+    assert(batch->methods);
+    assert(batch->methods->features.batch);
+    assert(results);
+    return GAME_STATS_CALL(batch->methods, BATCH_GET_RESULTS, batch->methods->batch_get_results(batch, results));
 }
 
 move_data game_e_create_move_small(move_code move)
@@ -670,14 +1772,7 @@ move_data game_e_create_move_small(move_code move)
 
 move_data game_e_create_move_big(size_t len, uint8_t* buf)
 {
-    uint8_t* new_data = NULL;
-    if (len > 0) {
-        new_data = (uint8_t*)malloc(len);
-        memcpy(new_data, buf, len);
-    } else {
-        new_data = PTRMAX;
-    }
-    return (move_data){.cl.len = len, .data = new_data};
+    return (move_data){.cl.len = len, .data = move_payload_create(len, buf)};
 }
 
 move_data_sync game_e_create_move_sync_small(game* self, move_code move)
@@ -691,14 +1786,7 @@ move_data_sync game_e_create_move_sync_big(game* self, size_t len, uint8_t* buf)
 {
     assert(self);
     assert(self->methods);
-    uint8_t* new_data = NULL;
-    if (len > 0) {
-        new_data = (uint8_t*)malloc(len);
-        memcpy(new_data, buf, len);
-    } else {
-        new_data = PTRMAX;
-    }
-    return (move_data_sync){.md = {.cl.len = len, .data = new_data}, .sync_ctr = self->sync_ctr};
+    return (move_data_sync){.md = {.cl.len = len, .data = move_payload_create(len, buf)}, .sync_ctr = self->sync_ctr};
 }
 
 move_data_sync game_e_move_make_sync(game* self, move_data move)
@@ -710,9 +1798,12 @@ move_data_sync game_e_move_make_sync(game* self, move_data move)
 
 bool game_e_move_compare(move_data left, move_data right)
 {
-    assert(game_e_move_is_big(left) && game_e_move_is_big(right));
+    if (game_e_move_is_big(left) != game_e_move_is_big(right)) {
+        return false;
+    }
     if (game_e_move_is_big(left) == true) {
-        return left.cl.len == right.cl.len && memcmp(left.data, right.data, left.cl.len) == 0;
+        // copies of a shared payload have the same ptr, so equal moves are mostly found without reading the payloads
+        return left.cl.len == right.cl.len && (left.data == right.data || memcmp(left.data, right.data, left.cl.len) == 0);
     } else {
         return left.cl.code == right.cl.code;
     }
@@ -754,15 +1845,16 @@ bool game_e_move_is_big(move_data move)
     return move.data != NULL;
 }
 
-move_data_sync game_e_get_random_move_sync(game* self, seed128 seed)
+// choose 1 random move idx via the alias table of this distribution, column and coin are independent draws from the rng
+// table is NULL if it could not be built, then the same coin spins a roulette wheel
+static uint32_t sample_move_idx(game_rng* rng, const alias_table* table, uint32_t moves_c, const float* moves_prob)
 {
-    // get percentage change of random moves
-    uint32_t moves_c;
-    const float* moves_prob;
-    game_get_concrete_move_probabilities(self, &moves_c, &moves_prob);
-    assert(moves_c > 0);
-    // choose 1 random move via roulette wheel
-    float selected_move = get_1d_zto(game_e_seed_rand_intn(seed, UINT32_MAX), 0);
+    uint32_t column = game_e_rng_intn(rng, moves_c);
+    uint32_t coin = game_e_rng_next(rng);
+    if (table != NULL) {
+        return (coin < table->thresholds[column] ? column : table->aliases[column]);
+    }
+    float selected_move = (float)(coin / 4294967296.0);
     float move_prob_sum = 0;
     uint32_t move_idx = 0;
     for (; move_idx < moves_c; move_idx++) {
@@ -774,6 +1866,30 @@ move_data_sync game_e_get_random_move_sync(game* self, seed128 seed)
     if (move_idx == moves_c) {
         move_idx = moves_c - 1; // maybe can possibly get here with some floating point inaccuracies accumulating over time
     }
+    return move_idx;
+}
+
+move_data_sync game_e_get_random_move_sync(game* self, seed128 seed)
+{
+    // get percentage change of random moves
+    uint32_t moves_c;
+    const float* moves_prob;
+    game_get_concrete_move_probabilities(self, &moves_c, &moves_prob);
+    assert(moves_c > 0);
+    // with the cache the table is looked up once per state, otherwise once per draw, both pick the same move for a seed
+    game_cache* cache = cache_get(self);
+    const alias_table* table;
+    if (cache != NULL) {
+        if (cache->alias_cur < 0) {
+            cache->alias_cur = alias_lru_get(&cache->alias, moves_c, moves_prob);
+        }
+        table = (cache->alias_cur >= 0 ? &cache->alias.entries[cache->alias_cur].table : NULL);
+    } else {
+        int entry = alias_lru_get(&alias_lru_thread, moves_c, moves_prob);
+        table = (entry >= 0 ? &alias_lru_thread.entries[entry].table : NULL);
+    }
+    game_rng rng = game_e_rng_create(seed, 0);
+    uint32_t move_idx = sample_move_idx(&rng, table, moves_c, moves_prob);
     // get random moves available
     const move_data* moves;
     game_get_concrete_moves(self, PLAYER_ENV, &moves_c, &moves);
@@ -784,6 +1900,82 @@ move_data_sync game_e_get_random_move_sync(game* self, seed128 seed)
     return ret_move;
 }
 
+// impl of game_e_playout_generic, chance nodes with the same distribution share their alias table from the thread lru
+static error_code playout_generic(game* self, game_rng* rng)
+{
+    const game_methods* methods = self->methods;
+    bool big_moves = game_ff(self).big_moves;
+    error_code ec;
+    player_id ptm_buf[UINT8_MAX];
+    while (true) {
+        uint8_t ptm_c;
+        const player_id* ptm;
+        ec = methods->players_to_move(self, &ptm_c, &ptm);
+        if (ec != ERR_OK) {
+            return ec;
+        }
+        if (ptm_c == 0) {
+            return ERR_OK;
+        }
+        // simultaneous players each draw their own move for this turn, making one may invalidate the game owned ptm buffer
+        memcpy(ptm_buf, ptm, ptm_c * sizeof(player_id));
+        for (uint8_t pidx = 0; pidx < ptm_c; pidx++) {
+            player_id player = ptm_buf[pidx];
+            uint32_t moves_c;
+            const move_data* moves;
+            ec = methods->get_concrete_moves(self, player, &moves_c, &moves);
+            if (ec != ERR_OK) {
+                return ec;
+            }
+            if (moves_c == 0) {
+                return ERR_INVALID_STATE;
+            }
+            uint32_t move_idx;
+            if (player == PLAYER_ENV && game_ff(self).random_moves == true) {
+                uint32_t probs_c;
+                const float* probs;
+                ec = methods->get_concrete_move_probabilities(self, &probs_c, &probs);
+                if (ec != ERR_OK) {
+                    return ec;
+                }
+                if (probs_c != moves_c) {
+                    // every listed move needs its probability, a game that disagrees with itself can not be sampled
+                    return ERR_INVALID_STATE;
+                }
+                int entry = alias_lru_get(&alias_lru_thread, probs_c, probs);
+                move_idx = sample_move_idx(rng, (entry >= 0 ? &alias_lru_thread.entries[entry].table : NULL), probs_c, probs);
+            } else {
+                move_idx = game_e_rng_intn(rng, moves_c);
+            }
+            move_data_sync move = game_e_move_make_sync(self, moves[move_idx]);
+            if (big_moves == true && game_e_move_is_big(move.md) == true) {
+                // big move data lives in the game owned list, which make_move may overwrite
+                move_data_sync owned;
+                game_e_move_sync_copy(&owned, &move);
+                ec = methods->make_move(self, player, owned);
+                game_e_move_sync_destroy(owned);
+            } else {
+                ec = methods->make_move(self, player, move);
+            }
+            if (ec != ERR_OK) {
+                return ec;
+            }
+            self->sync_ctr++;
+        }
+    }
+}
+
+error_code game_e_playout_generic(game* self, seed128 seed)
+{
+    assert(self);
+    assert(self->methods);
+    assert(memcmp(&seed, &SEED128_NONE, sizeof(seed128)) != 0);
+    // goes straight to the game methods, moves drawn from the concrete move list are legal by construction
+    game_e_cache_invalidate(self);
+    game_rng rng = game_e_rng_create(seed, 0);
+    return playout_generic(self, &rng);
+}
+
 bool game_e_player_to_move(game* self, player_id player)
 {
     uint8_t ptm_c;
@@ -797,18 +1989,267 @@ bool game_e_player_to_move(game* self, player_id player)
     return false;
 }
 
+// fan out buffers of game_e_move_to_action_groups, the serialized actions in action_groups_buf are released by game_e_thread_cleanup
+static _Thread_local action_group action_groups[UINT8_MAX];
+static _Thread_local player_id action_groups_players[UINT8_MAX];
+static _Thread_local move_data_sync action_groups_actions[UINT8_MAX]; // copies of the distinct actions, to compare the next ones against
+static _Thread_local uint8_t* action_groups_buf = NULL;
+static _Thread_local size_t action_groups_buf_cap = 0;
+
+error_code game_e_move_to_action_groups(game* self, player_id player, move_data_sync move, uint8_t target_count, const player_id* target_players, uint8_t* ret_count, const action_group** ret_groups)
+{
+    assert(self);
+    assert(self->methods);
+    assert(game_ff(self).hidden_information || game_ff(self).simultaneous_moves);
+    assert(target_players);
+    assert(target_count > 0);
+    assert(ret_count);
+    assert(ret_groups);
+    error_code ec = ERR_OK;
+    uint8_t group_count = 0;
+    uint8_t player_group[UINT8_MAX];
+    size_t buf_size = 0;
+    for (uint8_t i = 0; i < target_count; i++) {
+        move_data_sync* action;
+        ec = game_move_to_action(self, player, move, 1, &target_players[i], &action);
+        if (ec != ERR_OK) {
+            break;
+        }
+        uint8_t group = 0;
+        while (group < group_count && game_e_move_sync_compare(*action, action_groups_actions[group]) == false) {
+            group++;
+        }
+        if (group == group_count) {
+            // the action ptr is only valid until the next call on the game, so keep a copy of every new one
+            if (game_e_move_sync_copy(&action_groups_actions[group], action) == false) {
+                ec = ERR_OUT_OF_MEMORY;
+                break;
+            }
+            group_count++;
+            action_groups[group].player_count = 0;
+            action_groups[group].size = layout_serializer(GSIT_SIZE, sl_move_data_sync, &action_groups_actions[group], NULL, NULL, NULL);
+            buf_size += action_groups[group].size;
+        }
+        action_groups[group].player_count++;
+        player_group[i] = group;
+    }
+    if (ec == ERR_OK && buf_size > action_groups_buf_cap) {
+        uint8_t* new_buf = (uint8_t*)realloc(action_groups_buf, buf_size);
+        if (new_buf == NULL) {
+            ec = ERR_OUT_OF_MEMORY;
+        } else {
+            action_groups_buf = new_buf;
+            action_groups_buf_cap = buf_size;
+        }
+    }
+    if (ec == ERR_OK) {
+        // groups own consecutive runs of the players and the buffer, in group order
+        size_t buf_offset = 0;
+        uint8_t players_offset = 0;
+        for (uint8_t group = 0; group < group_count; group++) {
+            action_groups[group].buf = action_groups_buf + buf_offset;
+            layout_serializer(GSIT_SERIALIZE, sl_move_data_sync, &action_groups_actions[group], NULL, action_groups_buf + buf_offset, action_groups_buf + buf_offset + action_groups[group].size);
+            buf_offset += action_groups[group].size;
+            action_groups[group].players = action_groups_players + players_offset;
+            players_offset += action_groups[group].player_count;
+            action_groups[group].player_count = 0;
+        }
+        for (uint8_t i = 0; i < target_count; i++) {
+            action_group* group = &action_groups[player_group[i]];
+            action_groups_players[group->players - action_groups_players + group->player_count++] = target_players[i];
+        }
+        *ret_count = group_count;
+        *ret_groups = action_groups;
+    }
+    for (uint8_t group = 0; group < group_count; group++) {
+        game_e_move_sync_destroy(action_groups_actions[group]);
+    }
+    return ec;
+}
+
 uint32_t game_e_seed_rand_intn(seed128 seed, uint32_t n)
 {
-    // fold the seed into a managable u32 for uintn
-    //TODO replace by proper, safer, random
-    uint32_t p = 0;
-    uint32_t s = 0;
-    for (int i = 0; i < 4; i++) {
-        uint32_t round_32 = ((uint32_t*)seed.bytes)[i];
-        s ^= round_32;
-        p = squirrelnoise5(round_32, s);
+    game_rng rng = game_e_rng_create(seed, 0);
+    return game_e_rng_intn(&rng, n);
+}
+
+// philox4x32-10 (salmon et al. 2011), one block maps a 128 bit counter and 64 bit key to 4 u32 draws
+static const uint32_t PHILOX_M0 = 0xD2511F53;
+static const uint32_t PHILOX_M1 = 0xCD9E8D57;
+static const uint32_t PHILOX_W0 = 0x9E3779B9;
+static const uint32_t PHILOX_W1 = 0xBB67AE85;
+
+static void philox_block(const uint32_t key[2], const uint32_t ctr[4], uint32_t out[4])
+{
+    uint32_t k0 = key[0];
+    uint32_t k1 = key[1];
+    uint32_t c0 = ctr[0];
+    uint32_t c1 = ctr[1];
+    uint32_t c2 = ctr[2];
+    uint32_t c3 = ctr[3];
+    for (int round = 0; round < 10; round++) {
+        uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+        uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+        c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        c1 = (uint32_t)p1;
+        c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c3 = (uint32_t)p0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+// block b of the stream, the counter is (block index, stream index)
+static void rng_block(const game_rng* rng, uint64_t block, uint32_t out[4])
+{
+    uint32_t ctr[4] = {(uint32_t)block, (uint32_t)(block >> 32), (uint32_t)rng->stream, (uint32_t)(rng->stream >> 32)};
+    philox_block(rng->key, ctr, out);
+}
+
+game_rng game_e_rng_create(seed128 seed, uint64_t stream)
+{
+    // the philox key is only 64 bit, so compress the full seed into it by running it through one block as the counter
+    static const uint32_t seed_key[2] = {0x243F6A88, 0x85A308D3};
+    uint32_t seed_ctr[4];
+    memcpy(seed_ctr, seed.bytes, sizeof(seed_ctr));
+    uint32_t derived[4];
+    philox_block(seed_key, seed_ctr, derived);
+    return (game_rng){
+        .key = {derived[0], derived[1]},
+        .stream = stream,
+        .ctr = 0,
+        .block = {0, 0, 0, 0},
+    };
+}
+
+uint32_t game_e_rng_at(const game_rng* rng, uint64_t draw)
+{
+    assert(rng);
+    uint32_t out[4];
+    rng_block(rng, draw / 4, out);
+    return out[draw % 4];
+}
+
+void game_e_rng_fill(const game_rng* rng, uint64_t first_draw, uint32_t count, uint32_t* buf)
+{
+    assert(rng);
+    assert(buf || count == 0);
+    uint32_t out[4];
+    uint32_t i = 0;
+    // unaligned head
+    if (first_draw % 4 != 0 && count > 0) {
+        rng_block(rng, first_draw / 4, out);
+        for (uint32_t w = first_draw % 4; w < 4 && i < count; w++) {
+            buf[i++] = out[w];
+        }
+    }
+    // whole blocks are independent of each other, so this loop vectorises across blocks
+    uint64_t block = (first_draw + i) / 4;
+    uint32_t whole_blocks = (count - i) / 4;
+    for (uint32_t b = 0; b < whole_blocks; b++) {
+        rng_block(rng, block + b, buf + i + b * 4);
+    }
+    i += whole_blocks * 4;
+    // tail
+    if (i < count) {
+        rng_block(rng, block + whole_blocks, out);
+        for (uint32_t w = 0; i < count; w++) {
+            buf[i++] = out[w];
+        }
+    }
+}
+
+uint32_t game_e_rng_next(game_rng* rng)
+{
+    assert(rng);
+    if (rng->ctr % 4 == 0) {
+        rng_block(rng, rng->ctr / 4, rng->block);
+    }
+    return rng->block[rng->ctr++ % 4];
+}
+
+uint32_t game_e_rng_intn(game_rng* rng, uint32_t n)
+{
+    assert(rng);
+    if (n == 0) {
+        return 0;
+    }
+    // lemire's multiply shift, rejecting the low values that would make some results one more likely than others, i.e. (2^32 - n) % n
+    uint64_t m = (uint64_t)game_e_rng_next(rng) * n;
+    uint32_t l = (uint32_t)m;
+    if (l < n) {
+        uint32_t t = -n % n;
+        while (l < t) {
+            m = (uint64_t)game_e_rng_next(rng) * n;
+            l = (uint32_t)m;
+        }
+    }
+    return m >> 32;
+}
+
+uint32_t game_e_batch_mask_words(game_batch* batch)
+{
+    assert(batch);
+    return (batch->move_space + 63) / 64;
+}
+
+void game_e_arena_init(game_arena* arena, void* buf, size_t size)
+{
+    assert(arena);
+    // skip to the first aligned address, every allocation is rounded up to the alignment so all later ones stay aligned
+    const size_t align = _Alignof(max_align_t);
+    size_t pad = (align - ((uintptr_t)buf & (align - 1))) & (align - 1);
+    *arena = (game_arena){
+        .buf = (uint8_t*)buf,
+        .size = size,
+        .used = pad < size ? pad : size,
+    };
+}
+
+void* game_e_arena_alloc(game_arena* arena, size_t size)
+{
+    assert(arena);
+    if (arena->used + size > arena->size) {
+        return NULL;
     }
-    return noise_get_uintn(p, s, n);
+    void* ret = arena->buf + arena->used;
+    arena->used += game_e_arena_size(size);
+    if (arena->used > arena->size) {
+        arena->used = arena->size;
+    }
+    return ret;
+}
+
+size_t game_e_arena_size(size_t size)
+{
+    const size_t align = _Alignof(max_align_t);
+    return (size + align - 1) & ~(align - 1);
+}
+
+size_t game_e_arena_buffer_size(size_t size)
+{
+    return size + _Alignof(max_align_t) - 1;
+}
+
+void game_e_arena_reset(game_arena* arena)
+{
+    assert(arena);
+    game_e_arena_init(arena, arena->buf, arena->size);
+}
+
+void game_e_thread_cleanup()
+{
+    free(concrete_moves_codes_buf);
+    concrete_moves_codes_buf = NULL;
+    concrete_moves_codes_cap = 0;
+    free(action_groups_buf);
+    action_groups_buf = NULL;
+    action_groups_buf_cap = 0;
+    alias_lru_destroy(&alias_lru_thread);
 }
 
 error_code grerror(game* self, error_code ec, const char* str, const char* str_end)
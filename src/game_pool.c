@@ -0,0 +1,207 @@
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "surena/game.h"
+
+#include "surena/game_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// threads are spread over this many free lists, only more threads than this ever share a list
+#define GAME_POOL_SLOT_COUNT 64
+
+typedef struct game_pool_entry_s {
+    game g;
+    size_t bytes; // memory usage of the instance when it was retained, given back to retained_bytes when it leaves the pool
+} game_pool_entry;
+
+typedef struct game_pool_slot_s {
+    _Alignas(64) atomic_flag lock; // only contended if threads share a slot, slots are kept on separate cache lines
+    uint32_t count;
+    game_pool_entry* entries; // max_retained warm instances, allocated on first release into this slot
+} game_pool_slot;
+
+struct game_pool_s {
+    const game_methods* methods;
+    char* options; // options of every retained instance, NULL if the game has no options feature
+    uint32_t max_retained;
+    size_t max_bytes;
+    atomic_size_t retained_bytes; // summed over all slots
+    game_pool_slot slots[GAME_POOL_SLOT_COUNT];
+};
+
+static atomic_uint_fast32_t game_pool_thread_ctr = 0;
+static _Thread_local uint32_t game_pool_thread_slot = UINT32_MAX;
+
+static game_pool_slot* slot_lock(game_pool* pool)
+{
+    if (game_pool_thread_slot == UINT32_MAX) {
+        game_pool_thread_slot = (uint32_t)(atomic_fetch_add(&game_pool_thread_ctr, 1) % GAME_POOL_SLOT_COUNT);
+    }
+    game_pool_slot* slot = &pool->slots[game_pool_thread_slot];
+    while (atomic_flag_test_and_set_explicit(&slot->lock, memory_order_acquire)) {}
+    return slot;
+}
+
+static void slot_unlock(game_pool_slot* slot)
+{
+    atomic_flag_clear_explicit(&slot->lock, memory_order_release);
+}
+
+// true if the game has the options the pool was created with, games without the options feature all match
+static bool options_match(game_pool* pool, game* self)
+{
+    if (pool->options == NULL) {
+        return true;
+    }
+    size_t size;
+    const char* str;
+    if (game_export_options(self, &size, &str) != ERR_OK) {
+        return false;
+    }
+    return strcmp(str, pool->options) == 0;
+}
+
+// bytes the instance occupies while retained, without the memory_usage feature only max_retained limits the pool
+static size_t instance_bytes(game* self)
+{
+    if (game_ff(self).memory_usage == false) {
+        return 0;
+    }
+    size_t state_size;
+    size_t buffers_size;
+    if (game_memory_usage(self, &state_size, &buffers_size) != ERR_OK) {
+        return SIZE_MAX;
+    }
+    return sizeof(game) + state_size + buffers_size;
+}
+
+game_pool* game_pool_create(game* source, uint32_t max_retained, size_t max_bytes)
+{
+    assert(source);
+    assert(source->methods);
+    game_pool* pool = (game_pool*)aligned_alloc(_Alignof(game_pool), sizeof(game_pool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->methods = source->methods;
+    pool->options = NULL;
+    if (game_ff(source).options == true) {
+        size_t size;
+        const char* str;
+        if (game_export_options(source, &size, &str) != ERR_OK || (pool->options = strdup(str)) == NULL) {
+            free(pool);
+            return NULL;
+        }
+    }
+    pool->max_retained = max_retained;
+    pool->max_bytes = max_bytes;
+    atomic_init(&pool->retained_bytes, 0);
+    for (uint32_t i = 0; i < GAME_POOL_SLOT_COUNT; i++) {
+        atomic_flag_clear(&pool->slots[i].lock);
+        pool->slots[i].count = 0;
+        pool->slots[i].entries = NULL;
+    }
+    return pool;
+}
+
+void game_pool_destroy(game_pool* pool)
+{
+    if (pool == NULL) {
+        return;
+    }
+    for (uint32_t i = 0; i < GAME_POOL_SLOT_COUNT; i++) {
+        game_pool_slot* slot = &pool->slots[i];
+        for (uint32_t j = 0; j < slot->count; j++) {
+            game_destroy(&slot->entries[j].g);
+        }
+        free(slot->entries);
+    }
+    free(pool->options);
+    free(pool);
+}
+
+size_t game_pool_retained_bytes(game_pool* pool)
+{
+    assert(pool);
+    return atomic_load(&pool->retained_bytes);
+}
+
+error_code game_pool_acquire(game_pool* pool, game* source, game* target)
+{
+    assert(pool);
+    assert(source);
+    assert(target);
+    assert(source->methods == pool->methods);
+    game_pool_slot* slot = slot_lock(pool);
+    if (slot->count == 0) {
+        slot_unlock(slot);
+        return game_clone(source, target);
+    }
+    if (options_match(pool, source) == false) {
+        // copy_from is only defined between games with the same options, the warm instances stay for matching sources
+        slot_unlock(slot);
+        return game_clone(source, target);
+    }
+    game_pool_entry* entry = &slot->entries[--slot->count];
+    *target = entry->g;
+    atomic_fetch_sub(&pool->retained_bytes, entry->bytes);
+    slot_unlock(slot);
+    target->unmake_history = false; // like a clone, the reused instance starts without recording moves
+    error_code ec = game_copy_from(target, source);
+    if (ec != ERR_OK) {
+        game_destroy(target);
+    }
+    return ec;
+}
+
+error_code game_pool_release(game_pool* pool, game* target)
+{
+    assert(pool);
+    assert(target);
+    assert(target->methods == pool->methods);
+    // measured outside of the slot lock, the instance is still only owned by the caller
+    size_t bytes = instance_bytes(target);
+    if (bytes > pool->max_bytes || options_match(pool, target) == false) {
+        return game_destroy(target);
+    }
+    game_pool_slot* slot = slot_lock(pool);
+    if (slot->entries == NULL && pool->max_retained > 0) {
+        slot->entries = (game_pool_entry*)malloc(pool->max_retained * sizeof(game_pool_entry));
+    }
+    if (slot->entries == NULL || slot->count >= pool->max_retained) {
+        slot_unlock(slot);
+        return game_destroy(target);
+    }
+    // other slots retain concurrently, so the bytes are reserved first and given back if that went over the cap
+    if (atomic_fetch_add(&pool->retained_bytes, bytes) > pool->max_bytes - bytes) {
+        atomic_fetch_sub(&pool->retained_bytes, bytes);
+        slot_unlock(slot);
+        return game_destroy(target);
+    }
+    slot->entries[slot->count++] = (game_pool_entry){
+        .g = *target,
+        .bytes = bytes,
+    };
+    slot_unlock(slot);
+    *target = (game){
+        .methods = NULL,
+        .data1 = NULL,
+        .data2 = NULL,
+        .sync_ctr = SYNC_CTR_DEFAULT,
+        .cache = NULL,
+        .unmake_history = false,
+    };
+    return ERR_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,259 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "surena/game.h"
+
+#include "surena/game_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const char* const game_stats_method_names[GAME_STATS_METHOD_COUNT] = {
+    [GAME_STATS_METHOD_CREATE] = "create",
+    [GAME_STATS_METHOD_DESTROY] = "destroy",
+    [GAME_STATS_METHOD_CLONE] = "clone",
+    [GAME_STATS_METHOD_SIZE_HINT] = "size_hint",
+    [GAME_STATS_METHOD_CREATE_IN] = "create_in",
+    [GAME_STATS_METHOD_CLONE_IN] = "clone_in",
+    [GAME_STATS_METHOD_COPY_FROM] = "copy_from",
+    [GAME_STATS_METHOD_MEMORY_USAGE] = "memory_usage",
+    [GAME_STATS_METHOD_COMPARE] = "compare",
+    [GAME_STATS_METHOD_EXPORT_OPTIONS] = "export_options",
+    [GAME_STATS_METHOD_PLAYER_COUNT] = "player_count",
+    [GAME_STATS_METHOD_EXPORT_STATE] = "export_state",
+    [GAME_STATS_METHOD_EXPORT_STATE_DELTA] = "export_state_delta",
+    [GAME_STATS_METHOD_IMPORT_STATE] = "import_state",
+    [GAME_STATS_METHOD_SERIALIZE] = "serialize",
+    [GAME_STATS_METHOD_PLAYERS_TO_MOVE] = "players_to_move",
+    [GAME_STATS_METHOD_GET_CONCRETE_MOVES] = "get_concrete_moves",
+    [GAME_STATS_METHOD_GET_CONCRETE_MOVES_CODES] = "get_concrete_moves_codes",
+    [GAME_STATS_METHOD_GET_MOVES_BEGIN] = "get_moves_begin",
+    [GAME_STATS_METHOD_GET_MOVES_NEXT] = "get_moves_next",
+    [GAME_STATS_METHOD_PLAYERS_TO_MOVE_INTO] = "players_to_move_into",
+    [GAME_STATS_METHOD_GET_CONCRETE_MOVES_INTO] = "get_concrete_moves_into",
+    [GAME_STATS_METHOD_EXPORT_STATE_INTO] = "export_state_into",
+    [GAME_STATS_METHOD_GET_MOVE_STR_INTO] = "get_move_str_into",
+    [GAME_STATS_METHOD_PRINT_INTO] = "print_into",
+    [GAME_STATS_METHOD_GET_CONCRETE_MOVE_PROBABILITIES] = "get_concrete_move_probabilities",
+    [GAME_STATS_METHOD_GET_RANDOM_MOVE] = "get_random_move",
+    [GAME_STATS_METHOD_GET_CONCRETE_MOVES_ORDERED] = "get_concrete_moves_ordered",
+    [GAME_STATS_METHOD_GET_ACTIONS] = "get_actions",
+    [GAME_STATS_METHOD_IS_LEGAL_MOVE] = "is_legal_move",
+    [GAME_STATS_METHOD_MOVE_TO_ACTION] = "move_to_action",
+    [GAME_STATS_METHOD_MAKE_MOVE] = "make_move",
+    [GAME_STATS_METHOD_MAKE_MOVES] = "make_moves",
+    [GAME_STATS_METHOD_UNMAKE_MOVE] = "unmake_move",
+    [GAME_STATS_METHOD_GET_RESULTS] = "get_results",
+    [GAME_STATS_METHOD_EXPORT_LEGACY] = "export_legacy",
+    [GAME_STATS_METHOD_ID] = "id",
+    [GAME_STATS_METHOD_CANONICAL_ID] = "canonical_id",
+    [GAME_STATS_METHOD_EVAL] = "eval",
+    [GAME_STATS_METHOD_DISCRETIZE] = "discretize",
+    [GAME_STATS_METHOD_PLAYOUT] = "playout",
+    [GAME_STATS_METHOD_REDACT_KEEP_STATE] = "redact_keep_state",
+    [GAME_STATS_METHOD_EXPORT_SYNC_DATA] = "export_sync_data",
+    [GAME_STATS_METHOD_IMPORT_SYNC_DATA] = "import_sync_data",
+    [GAME_STATS_METHOD_GET_MOVE_DATA] = "get_move_data",
+    [GAME_STATS_METHOD_GET_MOVE_STR] = "get_move_str",
+    [GAME_STATS_METHOD_PRINT] = "print",
+    [GAME_STATS_METHOD_BATCH_CREATE] = "batch_create",
+    [GAME_STATS_METHOD_BATCH_DESTROY] = "batch_destroy",
+    [GAME_STATS_METHOD_BATCH_LOAD] = "batch_load",
+    [GAME_STATS_METHOD_BATCH_STORE] = "batch_store",
+    [GAME_STATS_METHOD_BATCH_PLAYERS_TO_MOVE] = "batch_players_to_move",
+    [GAME_STATS_METHOD_BATCH_GET_MOVE_MASKS] = "batch_get_move_masks",
+    [GAME_STATS_METHOD_BATCH_MAKE_MOVES] = "batch_make_moves",
+    [GAME_STATS_METHOD_BATCH_GET_RESULTS] = "batch_get_results",
+};
+
+#ifdef SURENA_GAME_STATS
+
+typedef struct game_stats_counters_s {
+    atomic_uint_least64_t calls;
+    atomic_uint_least64_t total_ns;
+    atomic_uint_least64_t buckets[GAME_STATS_BUCKETS];
+} game_stats_counters;
+
+// the counters of one thread for one game_methods, only ever written by that thread
+typedef struct game_stats_table_s {
+    const game_methods* methods;
+    struct game_stats_table_s* thread_next; // tables of the same thread
+    struct game_stats_table_s* all_next; // tables of all threads, immutable once published
+    game_stats_counters counters[GAME_STATS_METHOD_COUNT];
+    game_stats_entry base[GAME_STATS_METHOD_COUNT]; // counter values at the last reset, guarded by game_stats_lock
+} game_stats_table;
+
+static _Atomic(game_stats_table*) game_stats_tables = NULL;
+static atomic_flag game_stats_lock = ATOMIC_FLAG_INIT; // serializes snapshot and reset against each other, never taken by recording
+static _Thread_local game_stats_table* game_stats_thread_tables = NULL; // tables of exited threads stay in the list, their calls keep counting
+static _Thread_local game_stats_entry* game_stats_snapshot_buf = NULL;
+static _Thread_local uint32_t game_stats_snapshot_cap = 0;
+
+// single writer, so a plain load and store is enough, readers on other threads still never see a torn value
+static void game_stats_add(atomic_uint_least64_t* counter, uint64_t value)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+static game_stats_table* game_stats_thread_table(const game_methods* methods)
+{
+    game_stats_table* table = game_stats_thread_tables;
+    game_stats_table* prev = NULL;
+    while (table != NULL && table->methods != methods) {
+        prev = table;
+        table = table->thread_next;
+    }
+    if (table != NULL) {
+        if (prev != NULL) {
+            // keep the most recently used methods first, usually a thread only works on one game
+            prev->thread_next = table->thread_next;
+            table->thread_next = game_stats_thread_tables;
+            game_stats_thread_tables = table;
+        }
+        return table;
+    }
+    table = (game_stats_table*)calloc(1, sizeof(game_stats_table));
+    if (table == NULL) {
+        return NULL;
+    }
+    table->methods = methods;
+    table->thread_next = game_stats_thread_tables;
+    game_stats_thread_tables = table;
+    table->all_next = atomic_load_explicit(&game_stats_tables, memory_order_relaxed);
+    while (atomic_compare_exchange_weak_explicit(&game_stats_tables, &table->all_next, table, memory_order_release, memory_order_relaxed) == false) {}
+    return table;
+}
+
+static void game_stats_read(game_stats_table* table, GAME_STATS_METHOD method, game_stats_entry* ret_entry)
+{
+    game_stats_counters* counters = &table->counters[method];
+    ret_entry->methods = table->methods;
+    ret_entry->method = method;
+    ret_entry->calls = atomic_load_explicit(&counters->calls, memory_order_relaxed);
+    ret_entry->total_ns = atomic_load_explicit(&counters->total_ns, memory_order_relaxed);
+    for (uint32_t i = 0; i < GAME_STATS_BUCKETS; i++) {
+        ret_entry->buckets[i] = atomic_load_explicit(&counters->buckets[i], memory_order_relaxed);
+    }
+}
+
+bool game_stats_enabled()
+{
+    return true;
+}
+
+error_code game_stats_snapshot(uint32_t* ret_count, const game_stats_entry** ret_entries)
+{
+    while (atomic_flag_test_and_set_explicit(&game_stats_lock, memory_order_acquire)) {}
+    uint32_t count = 0;
+    for (game_stats_table* table = atomic_load_explicit(&game_stats_tables, memory_order_acquire); table != NULL; table = table->all_next) {
+        for (GAME_STATS_METHOD m = 0; m < GAME_STATS_METHOD_COUNT; m++) {
+            game_stats_entry cur;
+            game_stats_read(table, m, &cur);
+            cur.calls -= table->base[m].calls;
+            if (cur.calls == 0) {
+                continue;
+            }
+            cur.total_ns -= table->base[m].total_ns;
+            for (uint32_t i = 0; i < GAME_STATS_BUCKETS; i++) {
+                cur.buckets[i] -= table->base[m].buckets[i];
+            }
+            // merge the threads, entries are kept sorted by methods (in order of first appearance) and method
+            uint32_t pos = 0;
+            while (pos < count && game_stats_snapshot_buf[pos].methods != cur.methods) {
+                pos++;
+            }
+            while (pos < count && game_stats_snapshot_buf[pos].methods == cur.methods && game_stats_snapshot_buf[pos].method < m) {
+                pos++;
+            }
+            if (pos < count && game_stats_snapshot_buf[pos].methods == cur.methods && game_stats_snapshot_buf[pos].method == m) {
+                game_stats_entry* entry = &game_stats_snapshot_buf[pos];
+                entry->calls += cur.calls;
+                entry->total_ns += cur.total_ns;
+                for (uint32_t i = 0; i < GAME_STATS_BUCKETS; i++) {
+                    entry->buckets[i] += cur.buckets[i];
+                }
+                continue;
+            }
+            if (count == game_stats_snapshot_cap) {
+                uint32_t new_cap = game_stats_snapshot_cap == 0 ? GAME_STATS_METHOD_COUNT : game_stats_snapshot_cap * 2;
+                game_stats_entry* new_buf = (game_stats_entry*)realloc(game_stats_snapshot_buf, new_cap * sizeof(game_stats_entry));
+                if (new_buf == NULL) {
+                    atomic_flag_clear_explicit(&game_stats_lock, memory_order_release);
+                    return ERR_OUT_OF_MEMORY;
+                }
+                game_stats_snapshot_buf = new_buf;
+                game_stats_snapshot_cap = new_cap;
+            }
+            memmove(&game_stats_snapshot_buf[pos + 1], &game_stats_snapshot_buf[pos], (count - pos) * sizeof(game_stats_entry));
+            game_stats_snapshot_buf[pos] = cur;
+            count++;
+        }
+    }
+    atomic_flag_clear_explicit(&game_stats_lock, memory_order_release);
+    *ret_count = count;
+    *ret_entries = game_stats_snapshot_buf;
+    return ERR_OK;
+}
+
+void game_stats_reset()
+{
+    // the counters only have a single writer each, so instead of clearing them the current values become the new zero
+    while (atomic_flag_test_and_set_explicit(&game_stats_lock, memory_order_acquire)) {}
+    for (game_stats_table* table = atomic_load_explicit(&game_stats_tables, memory_order_acquire); table != NULL; table = table->all_next) {
+        for (GAME_STATS_METHOD m = 0; m < GAME_STATS_METHOD_COUNT; m++) {
+            game_stats_read(table, m, &table->base[m]);
+        }
+    }
+    atomic_flag_clear_explicit(&game_stats_lock, memory_order_release);
+}
+
+void game_stats_record(const game_methods* methods, GAME_STATS_METHOD method, uint64_t ns)
+{
+    game_stats_table* table = game_stats_thread_table(methods);
+    if (table == NULL) {
+        return; // out of memory, the call just goes uncounted
+    }
+    game_stats_counters* counters = &table->counters[method];
+    uint32_t bucket = (ns == 0 ? 0 : 63 - __builtin_clzll(ns));
+    if (bucket >= GAME_STATS_BUCKETS) {
+        bucket = GAME_STATS_BUCKETS - 1;
+    }
+    game_stats_add(&counters->calls, 1);
+    game_stats_add(&counters->total_ns, ns);
+    game_stats_add(&counters->buckets[bucket], 1);
+}
+
+#else
+
+bool game_stats_enabled()
+{
+    return false;
+}
+
+error_code game_stats_snapshot(uint32_t* ret_count, const game_stats_entry** ret_entries)
+{
+    *ret_count = 0;
+    *ret_entries = NULL;
+    return ERR_FEATURE_UNSUPPORTED;
+}
+
+void game_stats_reset()
+{
+    // pass
+}
+
+void game_stats_record(const game_methods* methods, GAME_STATS_METHOD method, uint64_t ns)
+{
+    // pass
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,828 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rosalia/serialization.h"
+#include "rosalia/timestamp.h"
+
+#include "surena/game.h"
+#include "surena/game_stats.h"
+
+#include "surena/game_trace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static const char game_trace_magic[8] = {'S', 'R', 'N', 'T', 'R', 'A', 'C', 'E'};
+
+// inputs recorded per method, in the order they are written
+typedef enum __attribute__((__packed__)) TRACE_ARG_E {
+    TRACE_ARG_TRACED = 1 << 0, // the method is recorded at all
+    TRACE_ARG_INIT = 1 << 1,
+    TRACE_ARG_OTHER = 1 << 2,
+    TRACE_ARG_PLAYER = 1 << 3,
+    TRACE_ARG_MOVE = 1 << 4,
+    TRACE_ARG_STR = 1 << 5,
+    TRACE_ARG_PLAYERS = 1 << 6,
+    TRACE_ARG_SEED = 1 << 7,
+    TRACE_ARG_SINCE = 1 << 8,
+    TRACE_ARG_BLOB = 1 << 9,
+    TRACE_ARG_MOVES = 1 << 10,
+} TRACE_ARG;
+
+static const uint16_t trace_method_args[GAME_STATS_METHOD_COUNT] = {
+    [GAME_STATS_METHOD_CREATE] = TRACE_ARG_TRACED | TRACE_ARG_INIT,
+    [GAME_STATS_METHOD_DESTROY] = TRACE_ARG_TRACED,
+    [GAME_STATS_METHOD_CLONE] = TRACE_ARG_TRACED | TRACE_ARG_OTHER,
+    [GAME_STATS_METHOD_CREATE_IN] = TRACE_ARG_TRACED | TRACE_ARG_INIT,
+    [GAME_STATS_METHOD_CLONE_IN] = TRACE_ARG_TRACED | TRACE_ARG_OTHER,
+    [GAME_STATS_METHOD_COPY_FROM] = TRACE_ARG_TRACED | TRACE_ARG_OTHER,
+    [GAME_STATS_METHOD_COMPARE] = TRACE_ARG_TRACED | TRACE_ARG_OTHER,
+    [GAME_STATS_METHOD_EXPORT_OPTIONS] = TRACE_ARG_TRACED,
+    [GAME_STATS_METHOD_PLAYER_COUNT] = TRACE_ARG_TRACED,
+    [GAME_STATS_METHOD_EXPORT_STATE] = TRACE_ARG_TRACED,
+    [GAME_STATS_METHOD_EXPORT_STATE_DELTA] = TRACE_ARG_TRACED | TRACE_ARG_SINCE,
+    [GAME_STATS_METHOD_IMPORT_STATE] = TRACE_ARG_TRACED | TRACE_ARG_STR,
+    [GAME_STATS_METHOD_SERIALIZE] = TRACE_ARG_TRACED,
+    [GAME_STATS_METHOD_PLAYERS_TO_MOVE] = TRACE_ARG_TRACED,
+    [GAME_STATS_METHOD_GET_CONCRETE_MOVES] = TRACE_ARG_TRACED | TRACE_ARG_PLAYER,
+    [GAME_STATS_METHOD_GET_CONCRETE_MOVES_CODES] = TRACE_ARG_TRACED | TRACE_ARG_PLAYER,
+    [GAME_STATS_METHOD_GET_CONCRETE_MOVE_PROBABILITIES] = TRACE_ARG_TRACED,
+    [GAME_STATS_METHOD_GET_RANDOM_MOVE] = TRACE_ARG_TRACED | TRACE_ARG_SEED,
+    [GAME_STATS_METHOD_GET_CONCRETE_MOVES_ORDERED] = TRACE_ARG_TRACED | TRACE_ARG_PLAYER,
+    [GAME_STATS_METHOD_GET_ACTIONS] = TRACE_ARG_TRACED | TRACE_ARG_PLAYER,
+    [GAME_STATS_METHOD_IS_LEGAL_MOVE] = TRACE_ARG_TRACED | TRACE_ARG_PLAYER | TRACE_ARG_MOVE,
+    [GAME_STATS_METHOD_MOVE_TO_ACTION] = TRACE_ARG_TRACED | TRACE_ARG_PLAYER | TRACE_ARG_MOVE | TRACE_ARG_PLAYERS,
+    [GAME_STATS_METHOD_MAKE_MOVE] = TRACE_ARG_TRACED | TRACE_ARG_PLAYER | TRACE_ARG_MOVE,
+    [GAME_STATS_METHOD_MAKE_MOVES] = TRACE_ARG_TRACED | TRACE_ARG_MOVES,
+    [GAME_STATS_METHOD_UNMAKE_MOVE] = TRACE_ARG_TRACED | TRACE_ARG_PLAYER | TRACE_ARG_MOVE,
+    [GAME_STATS_METHOD_GET_RESULTS] = TRACE_ARG_TRACED,
+    [GAME_STATS_METHOD_EXPORT_LEGACY] = TRACE_ARG_TRACED | TRACE_ARG_PLAYER,
+    [GAME_STATS_METHOD_ID] = TRACE_ARG_TRACED,
+    [GAME_STATS_METHOD_CANONICAL_ID] = TRACE_ARG_TRACED,
+    [GAME_STATS_METHOD_EVAL] = TRACE_ARG_TRACED | TRACE_ARG_PLAYER,
+    [GAME_STATS_METHOD_DISCRETIZE] = TRACE_ARG_TRACED | TRACE_ARG_SEED,
+    [GAME_STATS_METHOD_PLAYOUT] = TRACE_ARG_TRACED | TRACE_ARG_SEED,
+    [GAME_STATS_METHOD_REDACT_KEEP_STATE] = TRACE_ARG_TRACED | TRACE_ARG_PLAYERS,
+    [GAME_STATS_METHOD_EXPORT_SYNC_DATA] = TRACE_ARG_TRACED,
+    [GAME_STATS_METHOD_IMPORT_SYNC_DATA] = TRACE_ARG_TRACED | TRACE_ARG_BLOB,
+    [GAME_STATS_METHOD_GET_MOVE_DATA] = TRACE_ARG_TRACED | TRACE_ARG_PLAYER | TRACE_ARG_STR,
+    [GAME_STATS_METHOD_GET_MOVE_STR] = TRACE_ARG_TRACED | TRACE_ARG_PLAYER | TRACE_ARG_MOVE,
+    [GAME_STATS_METHOD_PRINT] = TRACE_ARG_TRACED,
+};
+
+#ifdef SURENA_GAME_TRACE
+
+typedef struct trace_writer_s {
+    uint8_t* buf;
+    size_t len;
+    size_t cap;
+    bool oom;
+} trace_writer;
+
+static atomic_bool game_trace_active = false;
+static pthread_mutex_t game_trace_lock = PTHREAD_MUTEX_INITIALIZER; // guards the file and the error, every record is written as a whole while holding it
+static FILE* game_trace_file = NULL;
+static error_code game_trace_error = ERR_OK; // why the running trace was cut short, kept until stop reports it
+static _Thread_local trace_writer game_trace_writer = {.buf = NULL, .len = 0, .cap = 0, .oom = false};
+
+// returns space for size more bytes at the end of the record, or NULL if out of memory
+static uint8_t* trace_put(trace_writer* w, size_t size)
+{
+    if (w->len + size > w->cap) {
+        size_t new_cap = (w->cap == 0 ? 256 : w->cap * 2);
+        while (new_cap < w->len + size) {
+            new_cap *= 2;
+        }
+        uint8_t* new_buf = (uint8_t*)realloc(w->buf, new_cap);
+        if (new_buf == NULL) {
+            w->oom = true;
+            return NULL;
+        }
+        w->buf = new_buf;
+        w->cap = new_cap;
+    }
+    uint8_t* p = w->buf + w->len;
+    w->len += size;
+    return p;
+}
+
+static void trace_put_bytes(trace_writer* w, const void* data, size_t size)
+{
+    uint8_t* p = trace_put(w, size);
+    if (p != NULL) {
+        memcpy(p, data, size);
+    }
+}
+
+static void trace_put_u8(trace_writer* w, uint8_t v)
+{
+    trace_put_bytes(w, &v, sizeof(v));
+}
+
+static void trace_put_u32(trace_writer* w, uint32_t v)
+{
+    trace_put_bytes(w, &v, sizeof(v));
+}
+
+static void trace_put_u64(trace_writer* w, uint64_t v)
+{
+    trace_put_bytes(w, &v, sizeof(v));
+}
+
+static void trace_put_str(trace_writer* w, const char* str)
+{
+    if (str == NULL) {
+        trace_put_u32(w, UINT32_MAX);
+        return;
+    }
+    uint32_t len = (uint32_t)strlen(str);
+    trace_put_u32(w, len);
+    trace_put_bytes(w, str, len);
+}
+
+static void trace_put_layout(trace_writer* w, const serialization_layout* layout, const void* obj)
+{
+    size_t size = layout_serializer(GSIT_SIZE, layout, (void*)obj, NULL, NULL, NULL); // void* cast is fine because size and serialize only read from obj_in
+    uint8_t* p = trace_put(w, size);
+    if (p != NULL) {
+        layout_serializer(GSIT_SERIALIZE, layout, (void*)obj, NULL, p, p + size);
+    }
+}
+
+bool game_trace_enabled()
+{
+    return true;
+}
+
+error_code game_trace_start(const char* path)
+{
+    pthread_mutex_lock(&game_trace_lock);
+    error_code ec = ERR_OK;
+    if (game_trace_file != NULL || game_trace_error != ERR_OK) {
+        ec = ERR_INVALID_INPUT;
+    } else {
+        game_trace_file = fopen(path, "wb");
+        uint32_t version = SURENA_GAME_TRACE_VERSION;
+        if (game_trace_file == NULL) {
+            ec = ERR_INVALID_INPUT;
+        } else if (fwrite(game_trace_magic, sizeof(game_trace_magic), 1, game_trace_file) != 1 || fwrite(&version, sizeof(version), 1, game_trace_file) != 1) {
+            fclose(game_trace_file);
+            game_trace_file = NULL;
+            ec = ERR_INVALID_INPUT;
+        } else {
+            atomic_store_explicit(&game_trace_active, true, memory_order_relaxed);
+        }
+    }
+    pthread_mutex_unlock(&game_trace_lock);
+    return ec;
+}
+
+// ends the running trace early because a record could not be written, must hold the lock
+static void trace_fail(error_code ec)
+{
+    atomic_store_explicit(&game_trace_active, false, memory_order_relaxed);
+    if (game_trace_file != NULL) {
+        fclose(game_trace_file);
+        game_trace_file = NULL;
+        game_trace_error = ec;
+    }
+}
+
+error_code game_trace_stop()
+{
+    pthread_mutex_lock(&game_trace_lock);
+    atomic_store_explicit(&game_trace_active, false, memory_order_relaxed);
+    error_code ec = game_trace_error;
+    if (game_trace_file != NULL) {
+        // the last records may only be written out by the close
+        if (fclose(game_trace_file) != 0) {
+            ec = ERR_NOK;
+        }
+        game_trace_file = NULL;
+    }
+    game_trace_error = ERR_OK;
+    pthread_mutex_unlock(&game_trace_lock);
+    return ec;
+}
+
+void game_trace_record(game* self, GAME_STATS_METHOD method, error_code ec, game_trace_args args)
+{
+    if (atomic_load_explicit(&game_trace_active, memory_order_relaxed) == false || (trace_method_args[method] & TRACE_ARG_TRACED) == 0) {
+        return;
+    }
+    // the record is encoded on this thread first, so the lock is only held for one fwrite
+    trace_writer* w = &game_trace_writer;
+    w->len = 0;
+    w->oom = false;
+    trace_put_u32(w, 0); // size, filled in below
+    trace_put_u8(w, (uint8_t)method);
+    trace_put_u64(w, (uint64_t)(uintptr_t)self);
+    trace_put_u64(w, self->sync_ctr);
+    trace_put_u8(w, (uint8_t)self->unmake_history);
+    trace_put_u32(w, (uint32_t)ec);
+    uint16_t kinds = trace_method_args[method];
+    if (kinds & TRACE_ARG_INIT) {
+        char id[256];
+        snprintf(id, sizeof(id), "%s.%s.%s", self->methods->game_name, self->methods->variant_name, self->methods->impl_name);
+        trace_put_str(w, id);
+        trace_put_layout(w, sl_game_init_info, args.init_info);
+    }
+    if (kinds & TRACE_ARG_OTHER) {
+        trace_put_u64(w, (uint64_t)(uintptr_t)args.other);
+    }
+    if (kinds & TRACE_ARG_PLAYER) {
+        trace_put_u8(w, args.player);
+    }
+    if (kinds & TRACE_ARG_MOVE) {
+        trace_put_layout(w, sl_move_data_sync, args.move);
+    }
+    if (kinds & TRACE_ARG_STR) {
+        trace_put_str(w, args.str);
+    }
+    if (kinds & TRACE_ARG_PLAYERS) {
+        trace_put_u8(w, args.player_count);
+        trace_put_bytes(w, args.players, args.player_count * sizeof(player_id));
+    }
+    if (kinds & TRACE_ARG_SEED) {
+        trace_put_bytes(w, &args.seed, sizeof(seed128));
+    }
+    if (kinds & TRACE_ARG_SINCE) {
+        trace_put_u64(w, args.since_sync_ctr);
+    }
+    if (kinds & TRACE_ARG_BLOB) {
+        trace_put_u32(w, (uint32_t)args.b->len);
+        trace_put_bytes(w, args.b->data, args.b->len);
+    }
+    if (kinds & TRACE_ARG_MOVES) {
+        trace_put_u32(w, args.move_count);
+        trace_put_u8(w, args.trusted);
+        for (uint32_t i = 0; i < args.move_count; i++) {
+            trace_put_u8(w, args.move_players[i]);
+            trace_put_layout(w, sl_move_data_sync, &args.moves[i]);
+        }
+    }
+    uint32_t size = (uint32_t)(w->len - sizeof(uint32_t));
+    memcpy(w->buf, &size, sizeof(size));
+    pthread_mutex_lock(&game_trace_lock);
+    // a trace missing a call would desync its replay, so any record that can not be written ends the trace
+    if (w->oom == true) {
+        trace_fail(ERR_OUT_OF_MEMORY);
+    } else if (game_trace_file != NULL && fwrite(w->buf, w->len, 1, game_trace_file) != 1) {
+        trace_fail(ERR_NOK);
+    }
+    pthread_mutex_unlock(&game_trace_lock);
+}
+
+#else
+
+bool game_trace_enabled()
+{
+    return false;
+}
+
+error_code game_trace_start(const char* path)
+{
+    return ERR_FEATURE_UNSUPPORTED;
+}
+
+error_code game_trace_stop()
+{
+    return ERR_OK;
+}
+
+void game_trace_record(game* self, GAME_STATS_METHOD method, error_code ec, game_trace_args args)
+{
+    // pass
+}
+
+#endif
+
+typedef struct trace_reader_s {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok; // false once anything was read past the end
+} trace_reader;
+
+static const uint8_t* trace_get(trace_reader* r, size_t size)
+{
+    if (r->ok == false || (size_t)(r->end - r->p) < size) {
+        r->ok = false;
+        return NULL;
+    }
+    const uint8_t* p = r->p;
+    r->p += size;
+    return p;
+}
+
+static uint8_t trace_get_u8(trace_reader* r)
+{
+    const uint8_t* p = trace_get(r, sizeof(uint8_t));
+    return p == NULL ? 0 : *p;
+}
+
+static uint32_t trace_get_u32(trace_reader* r)
+{
+    uint32_t v = 0;
+    const uint8_t* p = trace_get(r, sizeof(v));
+    if (p != NULL) {
+        memcpy(&v, p, sizeof(v));
+    }
+    return v;
+}
+
+static uint64_t trace_get_u64(trace_reader* r)
+{
+    uint64_t v = 0;
+    const uint8_t* p = trace_get(r, sizeof(v));
+    if (p != NULL) {
+        memcpy(&v, p, sizeof(v));
+    }
+    return v;
+}
+
+// returns a copy of the string (NULL for a recorded NULL), the copy has to be freed
+static char* trace_get_str(trace_reader* r)
+{
+    uint32_t len = trace_get_u32(r);
+    if (len == UINT32_MAX) {
+        return NULL;
+    }
+    const uint8_t* p = trace_get(r, len);
+    char* str = (char*)malloc(len + 1);
+    if (p == NULL || str == NULL) {
+        r->ok = false;
+        free(str);
+        return NULL;
+    }
+    memcpy(str, p, len);
+    str[len] = '\0';
+    return str;
+}
+
+// returns false if the layout could not be read, obj_out is valid and has to be destroyed otherwise
+static bool trace_get_layout(trace_reader* r, const serialization_layout* layout, void* obj_out)
+{
+    if (r->ok == false) {
+        return false;
+    }
+    size_t size = layout_serializer(GSIT_DESERIALIZE, layout, NULL, obj_out, (void*)r->p, (void*)r->end);
+    if (size == LS_ERR) {
+        r->ok = false;
+        return false;
+    }
+    r->p += size;
+    return true;
+}
+
+// replayed instances by their recorded address, open addressed with linear probing
+typedef struct trace_instances_s {
+    uint32_t count;
+    uint32_t cap;
+    uint64_t* ids; // 0 is an empty slot, no game lives at address 0
+    game** games;
+} trace_instances;
+
+static uint32_t trace_instances_idx(trace_instances* ti, uint64_t id)
+{
+    uint32_t idx = (uint32_t)((id * 0x9E3779B97F4A7C15ull) >> 32) & (ti->cap - 1);
+    while (ti->ids[idx] != 0 && ti->ids[idx] != id) {
+        idx = (idx + 1) & (ti->cap - 1);
+    }
+    return idx;
+}
+
+static game* trace_instances_get(trace_instances* ti, uint64_t id)
+{
+    if (ti->cap == 0) {
+        return NULL;
+    }
+    uint32_t idx = trace_instances_idx(ti, id);
+    return ti->ids[idx] == id ? ti->games[idx] : NULL;
+}
+
+static bool trace_instances_put(trace_instances* ti, uint64_t id, game* g)
+{
+    if ((ti->count + 1) * 2 > ti->cap) {
+        trace_instances grown = {
+            .count = 0,
+            .cap = (ti->cap == 0 ? 64 : ti->cap * 2),
+        };
+        grown.ids = (uint64_t*)calloc(grown.cap, sizeof(uint64_t));
+        grown.games = (game**)malloc(grown.cap * sizeof(game*));
+        if (grown.ids == NULL || grown.games == NULL) {
+            free(grown.ids);
+            free(grown.games);
+            return false;
+        }
+        for (uint32_t i = 0; i < ti->cap; i++) {
+            if (ti->ids[i] != 0) {
+                uint32_t idx = trace_instances_idx(&grown, ti->ids[i]);
+                grown.ids[idx] = ti->ids[i];
+                grown.games[idx] = ti->games[i];
+                grown.count++;
+            }
+        }
+        free(ti->ids);
+        free(ti->games);
+        *ti = grown;
+    }
+    uint32_t idx = trace_instances_idx(ti, id);
+    if (ti->ids[idx] == 0) {
+        ti->count++;
+    }
+    ti->ids[idx] = id;
+    ti->games[idx] = g;
+    return true;
+}
+
+// removes the instance without destroying it
+static void trace_instances_remove(trace_instances* ti, uint64_t id)
+{
+    if (ti->cap == 0) {
+        return;
+    }
+    uint32_t idx = trace_instances_idx(ti, id);
+    if (ti->ids[idx] != id) {
+        return;
+    }
+    ti->ids[idx] = 0;
+    ti->count--;
+    // shift the following entries of the probe run back, so lookups never stop early at the hole
+    uint32_t hole = idx;
+    for (uint32_t i = (idx + 1) & (ti->cap - 1); ti->ids[i] != 0; i = (i + 1) & (ti->cap - 1)) {
+        uint32_t home = (uint32_t)((ti->ids[i] * 0x9E3779B97F4A7C15ull) >> 32) & (ti->cap - 1);
+        if (((i - home) & (ti->cap - 1)) >= ((i - hole) & (ti->cap - 1))) {
+            ti->ids[hole] = ti->ids[i];
+            ti->games[hole] = ti->games[i];
+            ti->ids[i] = 0;
+            hole = i;
+        }
+    }
+}
+
+static void trace_instance_destroy(trace_instances* ti, uint64_t id)
+{
+    game* g = trace_instances_get(ti, id);
+    if (g != NULL) {
+        game_destroy(g);
+        free(g);
+        trace_instances_remove(ti, id);
+    }
+}
+
+// makes the call of one record, self is the replayed instance of the record, or NULL for create
+// returns the result of the call, or ERR_RETRY if the record can not be replayed (other instance unknown, method missing)
+static error_code trace_replay_call(trace_reader* r, const game_methods* methods, trace_instances* ti, GAME_STATS_METHOD method, uint64_t id, game* self)
+{
+    error_code ec = ERR_RETRY;
+    const game_methods* gm = methods;
+    uint16_t kinds = trace_method_args[method];
+
+    char* id_str = NULL;
+    game_init init_info;
+    bool has_init = false;
+    uint64_t other_id = 0;
+    player_id player = PLAYER_NONE;
+    move_data_sync move;
+    bool has_move = false;
+    char* str = NULL;
+    uint8_t player_count = 0;
+    player_id players[UINT8_MAX];
+    seed128 seed = SEED128_NONE;
+    uint64_t since_sync_ctr = 0;
+    blob b = {.len = 0, .data = NULL};
+    uint32_t move_count = 0;
+    bool trusted = false;
+    player_id* move_players = NULL;
+    move_data_sync* moves = NULL;
+
+    if (kinds & TRACE_ARG_INIT) {
+        id_str = trace_get_str(r);
+        has_init = trace_get_layout(r, sl_game_init_info, &init_info);
+    }
+    if (kinds & TRACE_ARG_OTHER) {
+        other_id = trace_get_u64(r);
+    }
+    if (kinds & TRACE_ARG_PLAYER) {
+        player = trace_get_u8(r);
+    }
+    if (kinds & TRACE_ARG_MOVE) {
+        has_move = trace_get_layout(r, sl_move_data_sync, &move);
+    }
+    if (kinds & TRACE_ARG_STR) {
+        str = trace_get_str(r);
+    }
+    if (kinds & TRACE_ARG_PLAYERS) {
+        player_count = trace_get_u8(r);
+        const uint8_t* p = trace_get(r, player_count);
+        if (p != NULL) {
+            memcpy(players, p, player_count);
+        }
+    }
+    if (kinds & TRACE_ARG_SEED) {
+        const uint8_t* p = trace_get(r, sizeof(seed128));
+        if (p != NULL) {
+            memcpy(&seed, p, sizeof(seed128));
+        }
+    }
+    if (kinds & TRACE_ARG_SINCE) {
+        since_sync_ctr = trace_get_u64(r);
+    }
+    if (kinds & TRACE_ARG_BLOB) {
+        b.len = trace_get_u32(r);
+        b.data = (void*)trace_get(r, b.len);
+    }
+    if (kinds & TRACE_ARG_MOVES) {
+        move_count = trace_get_u32(r);
+        trusted = trace_get_u8(r);
+        if (r->ok == true && move_count <= (size_t)(r->end - r->p)) { // every move takes at least one byte
+            move_players = (player_id*)malloc(move_count * sizeof(player_id) + 1);
+            moves = (move_data_sync*)malloc(move_count * sizeof(move_data_sync) + 1);
+        }
+        if (move_players == NULL || moves == NULL) {
+            r->ok = false;
+            move_count = 0;
+        }
+        for (uint32_t i = 0; i < move_count; i++) {
+            move_players[i] = trace_get_u8(r);
+            if (trace_get_layout(r, sl_move_data_sync, &moves[i]) == false) {
+                move_count = i;
+                break;
+            }
+        }
+    }
+
+    game* other = (kinds & TRACE_ARG_OTHER) ? trace_instances_get(ti, other_id) : NULL;
+    if (r->ok == false) {
+        // pass
+    } else if (method == GAME_STATS_METHOD_CREATE || method == GAME_STATS_METHOD_CREATE_IN) {
+        char own_id[256];
+        snprintf(own_id, sizeof(own_id), "%s.%s.%s", gm->game_name, gm->variant_name, gm->impl_name);
+        // a create on the address of a live instance means its destroy was not traced
+        trace_instance_destroy(ti, id);
+        game* g = (game*)malloc(sizeof(game));
+        if (id_str != NULL && strcmp(id_str, own_id) == 0 && g != NULL) {
+            g->methods = gm;
+            ec = game_create(g, &init_info);
+            if (ec == ERR_OK && trace_instances_put(ti, id, g) == true) {
+                g = NULL;
+            } else if (ec == ERR_OK) {
+                game_destroy(g);
+            }
+        }
+        free(g);
+    } else if (self == NULL) {
+        // pass, instance of another game or created before the trace started
+    } else if (method == GAME_STATS_METHOD_DESTROY) {
+        game_destroy(self);
+        free(self);
+        trace_instances_remove(ti, id);
+        ec = ERR_OK;
+    } else if (method == GAME_STATS_METHOD_CLONE || method == GAME_STATS_METHOD_CLONE_IN) {
+        trace_instance_destroy(ti, other_id);
+        game* g = (game*)malloc(sizeof(game));
+        if (g != NULL) {
+            ec = game_clone(self, g);
+            if (ec == ERR_OK && trace_instances_put(ti, other_id, g) == true) {
+                g = NULL;
+            } else if (ec == ERR_OK) {
+                game_destroy(g);
+            }
+        }
+        free(g);
+    } else if (method == GAME_STATS_METHOD_COPY_FROM) {
+        if (other != NULL) {
+            ec = game_copy_from(self, other);
+        }
+    } else {
+        // everything else goes straight to the game, like the wrappers made it, without their checks and caches
+        uint8_t ret_u8;
+        uint32_t ret_u32;
+        size_t ret_size;
+        const char* ret_str;
+        const blob* ret_blob;
+        const player_id* ret_players;
+        const move_data* ret_moves;
+        const move_code* ret_codes;
+        const float* ret_probs;
+        const sync_data* ret_sync_data;
+        move_data_sync* ret_move;
+        uint64_t ret_u64;
+        float ret_eval;
+        bool ret_equal;
+        switch (method) {
+#define TRACE_REPLAY(member, ...)          \
+    if (gm->member != NULL) {              \
+        ec = gm->member(self, __VA_ARGS__); \
+    }                                      \
+    break
+            case GAME_STATS_METHOD_COMPARE: {
+                if (other != NULL) {
+                    TRACE_REPLAY(compare, other, &ret_equal);
+                }
+            } break;
+            case GAME_STATS_METHOD_EXPORT_OPTIONS: {
+                TRACE_REPLAY(export_options, &ret_size, &ret_str);
+            }
+            case GAME_STATS_METHOD_PLAYER_COUNT: {
+                TRACE_REPLAY(player_count, &ret_u8);
+            }
+            case GAME_STATS_METHOD_EXPORT_STATE: {
+                TRACE_REPLAY(export_state, &ret_size, &ret_str);
+            }
+            case GAME_STATS_METHOD_EXPORT_STATE_DELTA: {
+                TRACE_REPLAY(export_state_delta, since_sync_ctr, &ret_size, &ret_str);
+            }
+            case GAME_STATS_METHOD_IMPORT_STATE: {
+                TRACE_REPLAY(import_state, str);
+            }
+            case GAME_STATS_METHOD_SERIALIZE: {
+                TRACE_REPLAY(serialize, &ret_blob);
+            }
+            case GAME_STATS_METHOD_PLAYERS_TO_MOVE: {
+                TRACE_REPLAY(players_to_move, &ret_u8, &ret_players);
+            }
+            case GAME_STATS_METHOD_GET_CONCRETE_MOVES: {
+                TRACE_REPLAY(get_concrete_moves, player, &ret_u32, &ret_moves);
+            }
+            case GAME_STATS_METHOD_GET_CONCRETE_MOVES_CODES: {
+                TRACE_REPLAY(get_concrete_moves_codes, player, &ret_u32, &ret_codes);
+            }
+            case GAME_STATS_METHOD_GET_CONCRETE_MOVE_PROBABILITIES: {
+                TRACE_REPLAY(get_concrete_move_probabilities, &ret_u32, &ret_probs);
+            }
+            case GAME_STATS_METHOD_GET_RANDOM_MOVE: {
+                TRACE_REPLAY(get_random_move, seed, &ret_move);
+            }
+            case GAME_STATS_METHOD_GET_CONCRETE_MOVES_ORDERED: {
+                TRACE_REPLAY(get_concrete_moves_ordered, player, &ret_u32, &ret_moves);
+            }
+            case GAME_STATS_METHOD_GET_ACTIONS: {
+                TRACE_REPLAY(get_actions, player, &ret_u32, &ret_moves);
+            }
+            case GAME_STATS_METHOD_IS_LEGAL_MOVE: {
+                TRACE_REPLAY(is_legal_move, player, move);
+            }
+            case GAME_STATS_METHOD_MOVE_TO_ACTION: {
+                TRACE_REPLAY(move_to_action, player, move, player_count, players, &ret_move);
+            }
+            case GAME_STATS_METHOD_MAKE_MOVE: {
+                TRACE_REPLAY(make_move, player, move);
+            }
+            case GAME_STATS_METHOD_MAKE_MOVES: {
+                TRACE_REPLAY(make_moves, move_count, move_players, moves, trusted, &ret_u32);
+            }
+            case GAME_STATS_METHOD_UNMAKE_MOVE: {
+                TRACE_REPLAY(unmake_move, player, move);
+            }
+            case GAME_STATS_METHOD_GET_RESULTS: {
+                TRACE_REPLAY(get_results, &ret_u8, &ret_players);
+            }
+            case GAME_STATS_METHOD_EXPORT_LEGACY: {
+                TRACE_REPLAY(export_legacy, player, &ret_size, &ret_str);
+            }
+            case GAME_STATS_METHOD_ID: {
+                TRACE_REPLAY(id, &ret_u64);
+            }
+            case GAME_STATS_METHOD_CANONICAL_ID: {
+                TRACE_REPLAY(canonical_id, &ret_u64, &ret_u8);
+            }
+            case GAME_STATS_METHOD_EVAL: {
+                TRACE_REPLAY(eval, player, &ret_eval);
+            }
+            case GAME_STATS_METHOD_DISCRETIZE: {
+                TRACE_REPLAY(discretize, seed);
+            }
+            case GAME_STATS_METHOD_PLAYOUT: {
+                TRACE_REPLAY(playout, seed);
+            }
+            case GAME_STATS_METHOD_REDACT_KEEP_STATE: {
+                TRACE_REPLAY(redact_keep_state, player_count, players);
+            }
+            case GAME_STATS_METHOD_EXPORT_SYNC_DATA: {
+                TRACE_REPLAY(export_sync_data, &ret_u32, &ret_sync_data);
+            }
+            case GAME_STATS_METHOD_IMPORT_SYNC_DATA: {
+                TRACE_REPLAY(import_sync_data, b);
+            }
+            case GAME_STATS_METHOD_GET_MOVE_DATA: {
+                TRACE_REPLAY(get_move_data, player, str, &ret_move);
+            }
+            case GAME_STATS_METHOD_GET_MOVE_STR: {
+                TRACE_REPLAY(get_move_str, player, move, &ret_size, &ret_str);
+            }
+            case GAME_STATS_METHOD_PRINT: {
+                TRACE_REPLAY(print, &ret_size, &ret_str);
+            }
+#undef TRACE_REPLAY
+            default: {
+                // pass
+            } break;
+        }
+    }
+
+    free(id_str);
+    if (has_init == true) {
+        layout_serializer(GSIT_DESTROY, sl_game_init_info, &init_info, NULL, NULL, NULL);
+    }
+    if (has_move == true) {
+        game_e_move_sync_destroy(move);
+    }
+    free(str);
+    for (uint32_t i = 0; i < move_count; i++) {
+        game_e_move_sync_destroy(moves[i]);
+    }
+    free(move_players);
+    free(moves);
+    return ec;
+}
+
+error_code game_trace_replay(const char* path, const game_methods* methods, game_trace_replay_stats* ret_stats)
+{
+    *ret_stats = (game_trace_replay_stats){
+        .calls = 0,
+        .skipped = 0,
+        .mismatches = 0,
+        .ns = 0,
+    };
+    // read the whole trace up front, so the replay is not held up by the file
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        return ERR_INVALID_INPUT;
+    }
+    uint8_t* data = NULL;
+    size_t size = 0;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        long end = ftell(f);
+        if (end > 0 && fseek(f, 0, SEEK_SET) == 0) {
+            data = (uint8_t*)malloc(end);
+            size = (data != NULL && fread(data, end, 1, f) == 1 ? (size_t)end : 0);
+        }
+    }
+    fclose(f);
+    trace_reader file = {.p = data, .end = data + size, .ok = true};
+    const uint8_t* magic = trace_get(&file, sizeof(game_trace_magic));
+    if (magic == NULL || memcmp(magic, game_trace_magic, sizeof(game_trace_magic)) != 0 || trace_get_u32(&file) != SURENA_GAME_TRACE_VERSION) {
+        free(data);
+        return ERR_INVALID_INPUT;
+    }
+
+    trace_instances ti = {.count = 0, .cap = 0, .ids = NULL, .games = NULL};
+    error_code ec = ERR_OK;
+    while (file.p < file.end) {
+        uint32_t record_size = trace_get_u32(&file);
+        const uint8_t* record = trace_get(&file, record_size);
+        if (record == NULL) {
+            ec = ERR_INVALID_INPUT; // truncated, e.g. the process died while tracing, everything before is still replayed
+            break;
+        }
+        trace_reader r = {.p = record, .end = record + record_size, .ok = true};
+        uint8_t method = trace_get_u8(&r);
+        uint64_t id = trace_get_u64(&r);
+        uint64_t sync_ctr = trace_get_u64(&r);
+        bool unmake_history = (trace_get_u8(&r) != 0);
+        error_code recorded_ec = (error_code)trace_get_u32(&r);
+        if (r.ok == false || method >= GAME_STATS_METHOD_COUNT || (trace_method_args[method] & TRACE_ARG_TRACED) == 0) {
+            ec = ERR_INVALID_INPUT;
+            break;
+        }
+        game* self = trace_instances_get(&ti, id);
+        if (self != NULL) {
+            self->sync_ctr = sync_ctr;
+            self->unmake_history = unmake_history;
+        }
+        uint64_t start = timestamp_get_ns64();
+        error_code replayed_ec = trace_replay_call(&r, methods, &ti, (GAME_STATS_METHOD)method, id, self);
+        ret_stats->ns += timestamp_get_ns64() - start;
+        if (replayed_ec == ERR_RETRY) {
+            ret_stats->skipped++;
+            continue;
+        }
+        ret_stats->calls++;
+        if (replayed_ec != recorded_ec) {
+            ret_stats->mismatches++;
+        }
+    }
+
+    for (uint32_t i = 0; i < ti.cap; i++) {
+        if (ti.ids[i] != 0) {
+            game_destroy(ti.games[i]);
+            free(ti.games[i]);
+        }
+    }
+    free(ti.ids);
+    free(ti.games);
+    free(data);
+    return ec;
+}
+
+#ifdef __cplusplus
+}
+#endif
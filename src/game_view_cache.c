@@ -0,0 +1,222 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "surena/game.h"
+
+#include "surena/game_view_cache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct game_view_s {
+    uint8_t pov_count;
+    player_id povs[UINT8_MAX]; // sorted, without duplicates
+    bool stale; // missed a move (or the source changed otherwise), rebuilt from the source on the next get
+    game g;
+} game_view;
+
+struct game_view_cache_s {
+    const game_methods* methods;
+    uint32_t count;
+    uint32_t cap;
+    game_view** views; // views are allocated on their own, so the games handed out keep their address when this grows
+};
+
+// writes the sorted pov set without duplicates into ret_povs and returns its size
+static uint8_t pov_set(uint8_t pov_count, const player_id* povs, player_id* ret_povs)
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < pov_count; i++) {
+        uint8_t pos = count;
+        while (pos > 0 && ret_povs[pos - 1] > povs[i]) {
+            pos--;
+        }
+        if (pos > 0 && ret_povs[pos - 1] == povs[i]) {
+            continue;
+        }
+        memmove(&ret_povs[pos + 1], &ret_povs[pos], count - pos);
+        ret_povs[pos] = povs[i];
+        count++;
+    }
+    return count;
+}
+
+static bool view_has_pov(game_view* view, player_id p)
+{
+    for (uint8_t i = 0; i < view->pov_count; i++) {
+        if (view->povs[i] == p) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// redacts the fresh copy of the source in the view down to what its povs know
+static error_code view_redact(game_view* view)
+{
+    const game_feature_flags ff = game_ff(&view->g);
+    if (ff.random_moves == false && ff.hidden_information == false && ff.simultaneous_moves == false) {
+        return ERR_OK;
+    }
+    return game_redact_keep_state(&view->g, view->pov_count, view->povs);
+}
+
+// makes the action the povs of the view get for the move, the move is legal on source and not made yet
+static error_code view_advance(game_view* view, game* source, player_id player, move_data_sync move)
+{
+    const game_feature_flags ff = game_ff(source);
+    if ((ff.hidden_information == false && ff.simultaneous_moves == false) || view_has_pov(view, PLAYER_ENV) == true) {
+        move.sync_ctr = view->g.sync_ctr;
+        return game_make_move(&view->g, player, move);
+    }
+    move_data_sync* action;
+    error_code ec = game_move_to_action(source, player, move, view->pov_count, view->povs, &action);
+    if (ec != ERR_OK) {
+        return ec;
+    }
+    // the action is owned by source and only valid until its next call, so make it right away
+    return game_make_move(&view->g, player, (move_data_sync){.md = action->md, .sync_ctr = view->g.sync_ctr});
+}
+
+game_view_cache* game_view_cache_create(game* source)
+{
+    assert(source);
+    assert(source->methods);
+    game_view_cache* cache = (game_view_cache*)malloc(sizeof(game_view_cache));
+    if (cache == NULL) {
+        return NULL;
+    }
+    *cache = (game_view_cache){
+        .methods = source->methods,
+        .count = 0,
+        .cap = 0,
+        .views = NULL,
+    };
+    return cache;
+}
+
+void game_view_cache_destroy(game_view_cache* cache)
+{
+    if (cache == NULL) {
+        return;
+    }
+    for (uint32_t i = 0; i < cache->count; i++) {
+        game_destroy(&cache->views[i]->g);
+        free(cache->views[i]);
+    }
+    free(cache->views);
+    free(cache);
+}
+
+error_code game_view_cache_get(game_view_cache* cache, game* source, uint8_t pov_count, const player_id* povs, game** ret_view)
+{
+    assert(cache);
+    assert(source);
+    assert(source->methods == cache->methods);
+    assert(pov_count == 0 || povs);
+    assert(ret_view);
+    player_id key[UINT8_MAX];
+    uint8_t key_count = pov_set(pov_count, povs, key);
+    for (uint32_t i = 0; i < cache->count; i++) {
+        game_view* view = cache->views[i];
+        if (view->pov_count != key_count || memcmp(view->povs, key, key_count) != 0) {
+            continue;
+        }
+        if (view->stale == true) {
+            // reuse the instance, copy_from does not need to allocate like a clone would
+            error_code ec = game_copy_from(&view->g, source);
+            if (ec == ERR_OK) {
+                ec = view_redact(view);
+            }
+            if (ec != ERR_OK) {
+                return ec;
+            }
+            view->stale = false;
+        }
+        *ret_view = &view->g;
+        return ERR_OK;
+    }
+    if (cache->count == cache->cap) {
+        uint32_t new_cap = cache->cap == 0 ? 4 : cache->cap * 2;
+        game_view** new_views = (game_view**)realloc(cache->views, new_cap * sizeof(game_view*));
+        if (new_views == NULL) {
+            return ERR_OUT_OF_MEMORY;
+        }
+        cache->views = new_views;
+        cache->cap = new_cap;
+    }
+    game_view* view = (game_view*)malloc(sizeof(game_view));
+    if (view == NULL) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    view->pov_count = key_count;
+    memcpy(view->povs, key, key_count);
+    view->stale = false;
+    error_code ec = game_clone(source, &view->g);
+    if (ec != ERR_OK) {
+        free(view);
+        return ec;
+    }
+    ec = view_redact(view);
+    if (ec != ERR_OK) {
+        game_destroy(&view->g);
+        free(view);
+        return ec;
+    }
+    // the cache is only an optimization, views work just the same without it
+    game_e_cache_enable(&view->g);
+    cache->views[cache->count++] = view;
+    *ret_view = &view->g;
+    return ERR_OK;
+}
+
+error_code game_view_cache_make_move(game_view_cache* cache, game* source, player_id player, move_data_sync move)
+{
+    assert(cache);
+    assert(source);
+    assert(source->methods == cache->methods);
+    error_code ec = game_is_legal_move(source, player, move);
+    if (ec != ERR_OK) {
+        return ec;
+    }
+    // move_to_action needs the state from before the move, so all views go first
+    for (uint32_t i = 0; i < cache->count; i++) {
+        game_view* view = cache->views[i];
+        if (view->stale == true) {
+            continue;
+        }
+        if (view->pov_count == 0 && (game_ff(source).hidden_information == true || game_ff(source).simultaneous_moves == true)) {
+            // there is no move_to_action for an empty target set, so the public view is rebuilt by copy_from and redact on its next get instead
+            // that is still only one rebuild per move, shared by all spectators, but it costs a full copy instead of one action
+            // game_e_move_to_action_groups does not help here, what one player sees of a move is not necessarily what nobody sees
+            view->stale = true;
+            continue;
+        }
+        if (view_advance(view, source, player, move) != ERR_OK) {
+            view->stale = true;
+        }
+    }
+    ec = game_make_move(source, player, move);
+    if (ec != ERR_OK) {
+        // the views are already one move ahead of source now
+        game_view_cache_invalidate(cache);
+    }
+    return ec;
+}
+
+void game_view_cache_invalidate(game_view_cache* cache)
+{
+    assert(cache);
+    for (uint32_t i = 0; i < cache->count; i++) {
+        cache->views[i]->stale = true;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
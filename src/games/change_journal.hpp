@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+
+// bounded journal of the cells written by the most recent moves, for export_state_delta
+// keeps the cells of at most MOVES moves and at most CELLS cell writes in total, older ones are dropped
+// the journal is plain data, so it is copied along with the state it belongs to (clones, copy_from, arenas)
+// moves are counted from the sync_ctr the first journaled move was made at, every later change that is not a move has to clear the journal
+template <uint32_t CELLS, uint32_t MOVES>
+class change_journal {
+
+  public:
+
+    // drops all moves, deltas are available again for states reached by moves made after this
+    // use for every change that is not a journaled move (import, unmake, internal setters, ..)
+    void clear()
+    {
+        valid = false;
+        recording = false;
+    }
+
+    // starts journaling the move made from the state at sync_ctr, every cell it writes goes through touch until end_move
+    // inside of make_moves the sync_ctr is only advanced afterwards, so it is only read here if the journal was cleared before
+    void begin_move(uint64_t sync_ctr)
+    {
+        if (valid == false) {
+            // the state at sync_ctr itself may have been exported before an import or unmake that kept the same sync_ctr, so it is never a base
+            valid = true;
+            head = sync_ctr;
+            since_min = sync_ctr + 1;
+            move_count = 0;
+        }
+        move_first[head % MOVES] = cell_end;
+        head++;
+        if (move_count < MOVES) {
+            move_count++;
+        }
+        recording = true;
+    }
+
+    void end_move()
+    {
+        recording = false;
+    }
+
+    // every write of a cell has to call this, writes outside of a move clear the journal
+    void touch(uint16_t cell)
+    {
+        if (recording == false) {
+            clear();
+            return;
+        }
+        cells[cell_end % CELLS] = cell;
+        cell_end++;
+    }
+
+    bool is_recording() const
+    {
+        return recording;
+    }
+
+    // calls f(cell) once for every cell written by the moves since the state at since_sync_ctr, in the order of their last write
+    // sync_ctr is the current sync_ctr of the game, returns false (without calling f) if the journal does not reach back to since_sync_ctr
+    template <typename F>
+    bool changes_since(uint64_t since_sync_ctr, uint64_t sync_ctr, F f) const
+    {
+        if (valid == false || head != sync_ctr || since_sync_ctr < since_min || since_sync_ctr > head || head - since_sync_ctr > move_count) {
+            return false;
+        }
+        uint32_t first = (since_sync_ctr == head ? cell_end : move_first[since_sync_ctr % MOVES]);
+        if (cell_end - first > CELLS) {
+            return false;
+        }
+        for (uint32_t i = first; i != cell_end; i++) {
+            uint16_t cell = cells[i % CELLS];
+            bool written_later = false;
+            for (uint32_t j = i + 1; j != cell_end; j++) {
+                written_later |= (cells[j % CELLS] == cell);
+            }
+            if (written_later == false) {
+                f(cell);
+            }
+        }
+        return true;
+    }
+
+  private:
+
+    bool valid = false;
+    bool recording = false;
+    uint64_t head; // sync_ctr of the state after the newest journaled move
+    uint64_t since_min; // oldest sync_ctr a delta may start from
+    uint32_t move_count; // journaled moves, the newest ones up to head
+    uint32_t cell_end = 0; // running count of all touched cells, only used modulo CELLS and in differences
+    uint32_t move_first[MOVES]; // running idx of the first cell of each move, by the sync_ctr it was made at modulo MOVES
+    uint16_t cells[CELLS];
+};
@@ -3,6 +3,8 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <new>
+#include <vector>
 
 #include "rosalia/noise.h"
 #include "rosalia/semver.h"
@@ -11,6 +13,9 @@
 
 #include "surena/games/chess.h"
 
+#include "games/change_journal.hpp"
+#include "games/undo_history.hpp"
+
 // general purpose helpers for opts, data, bufs
 
 namespace {
@@ -19,12 +24,27 @@ namespace {
         char* state;
         player_id* players_to_move;
         move_data* concrete_moves;
+        move_code* concrete_move_codes;
         player_id* results;
         move_data_sync move_out;
         char* move_str;
         char* print;
+        char* state_delta;
     };
 
+    // a move writes at most 4 squares (castling, en passant)
+    const uint32_t JOURNAL_CELLS = 64;
+    const uint32_t JOURNAL_MOVES = 16;
+
+    // export buffer sizes, for size_hint, create_block and the _into size checks
+    const size_t STATE_STR_SIZE = 128;
+    const size_t MOVE_STR_SIZE = 6;
+    const size_t PRINT_STR_SIZE = 256;
+    const size_t STATE_DELTA_STR_SIZE = JOURNAL_CELLS * 4 + 64;
+
+    // moves that games in an arena can unmake, their history is a ring in the block from size_hint
+    const uint32_t ARENA_UNDO_DEPTH = 32;
+
     struct state_repr {
         CHESS_piece board[8][8]; // board[y][x] starting with origin (0,0) on bottom left of the board
         uint32_t halfmove_clock = 0;
@@ -39,8 +59,16 @@ namespace {
     };
 
     struct game_data {
+        bool in_arena; // data1 is one block holding this and all buffers, only freed by us if it was not taken from an arena
         export_buffers bufs;
         state_repr state;
+        // the state is small and flat, so unmake_move just restores the copy taken before each move made while unmake_history is set
+        // clones and copy_from start without history, see undo_history
+        // the history grows on the heap, except for games created in an arena which only keep the last ARENA_UNDO_DEPTH in their block
+        undo_history<state_repr> undo_stack;
+        undo_ring<state_repr> arena_undo_stack;
+        // squares written by the most recent moves as (x << 4) | y, for export_state_delta, kept out of the state so undo copies stay small
+        change_journal<JOURNAL_CELLS, JOURNAL_MOVES> changes;
     };
 
     export_buffers& get_bufs(game* self)
@@ -69,13 +97,26 @@ static error_code count_positions_gf(game* self, int depth, uint64_t* count);
 static error_code apply_move_internal_gf(game* self, move_code move, bool replace_castling_by_kings);
 static error_code get_moves_pseudo_legal_gf(game* self, uint32_t* move_cnt, move_code* move_vec);
 
+// the setters handed out in the internal methods, these drop the wrapper query cache before writing
+static error_code ext_set_cell_gf(game* self, int x, int y, CHESS_piece p);
+static error_code ext_set_current_player_gf(game* self, player_id p);
+static error_code ext_set_result_gf(game* self, player_id p);
+static error_code ext_apply_move_internal_gf(game* self, move_code move, bool replace_castling_by_kings);
+
+// impl hidden helpers
+static error_code create_block(game* self, game_init* init_info, game_arena* arena);
+static uint32_t get_piece_moves_pseudo_legal(state_repr& data, int x, int y, move_code* move_vec);
+static bool is_pseudo_move_legal(game* self, move_code move);
+static uint32_t get_move_codes(game* self, move_code* outbuf);
+static size_t state_flags(game* self, char* str);
+
 static const chess_internal_methods chess_gbe_internal_methods{
     .get_cell = get_cell_gf,
-    .set_cell = set_cell_gf,
-    .set_current_player = set_current_player_gf,
-    .set_result = set_result_gf,
+    .set_cell = ext_set_cell_gf,
+    .set_current_player = ext_set_current_player_gf,
+    .set_result = ext_set_result_gf,
     .count_positions = count_positions_gf,
-    .apply_move_internal = apply_move_internal_gf,
+    .apply_move_internal = ext_apply_move_internal_gf,
     .get_moves_pseudo_legal = get_moves_pseudo_legal_gf,
 };
 
@@ -86,6 +127,13 @@ static const chess_internal_methods chess_gbe_internal_methods{
 #define SURENA_GDD_INAME "surena_default"
 #define SURENA_GDD_VERSION ((semver){1, 0, 0})
 #define SURENA_GDD_INTERNALS &chess_gbe_internal_methods
+#define SURENA_GDD_FF_UNMAKE_MOVE
+#define SURENA_GDD_FF_CREATE_IN
+#define SURENA_GDD_FF_MEMORY_USAGE
+#define SURENA_GDD_FF_EXPORT_STATE_DELTA
+#define SURENA_GDD_FF_LAZY_MOVES
+#define SURENA_GDD_FF_MOVE_CODES
+#define SURENA_GDD_FF_QUERY_INTO
 #define SURENA_GDD_FF_ID
 #define SURENA_GDD_FF_PRINT
 #include "surena/game_decldef.h"
@@ -94,48 +142,20 @@ static const chess_internal_methods chess_gbe_internal_methods{
 
 static error_code create_gf(game* self, game_init* init_info)
 {
-    self->data1 = malloc(sizeof(game_data));
-    if (self->data1 == NULL) {
-        return ERR_OUT_OF_MEMORY;
-    }
-    self->data2 = NULL;
-    {
-        export_buffers& bufs = get_bufs(self);
-        bufs.state = (char*)malloc(128 * sizeof(char));
-        bufs.players_to_move = (player_id*)malloc(1 * sizeof(player_id));
-        bufs.concrete_moves = (move_data*)malloc(CHESS_MAX_MOVES * sizeof(move_data));
-        bufs.results = (player_id*)malloc(1 * sizeof(player_id));
-        bufs.move_str = (char*)malloc(6 * sizeof(char));
-        bufs.print = (char*)malloc(256 * sizeof(char)); // calc proper size
-        if (bufs.state == NULL ||
-            bufs.players_to_move == NULL ||
-            bufs.concrete_moves == NULL ||
-            bufs.results == NULL ||
-            bufs.move_str == NULL ||
-            bufs.print == NULL) {
-            destroy_gf(self);
-            return ERR_OUT_OF_MEMORY;
-        }
-    }
-    const char* initial_state = NULL;
-    if (init_info->source_type == GAME_INIT_SOURCE_TYPE_STANDARD) {
-        initial_state = init_info->source.standard.state;
-    }
-    return import_state_gf(self, initial_state);
+    return create_block(self, init_info, NULL);
 }
 
 static error_code destroy_gf(game* self)
 {
-    {
-        export_buffers& bufs = get_bufs(self);
-        free(bufs.state);
-        free(bufs.players_to_move);
-        free(bufs.concrete_moves);
-        free(bufs.results);
-        free(bufs.move_str);
-        free(bufs.print);
-    }
-    free(self->data1);
+    game_data* data = (game_data*)self->data1;
+    if (data == NULL) {
+        return ERR_OK;
+    }
+    bool in_arena = data->in_arena;
+    data->~game_data();
+    if (in_arena == false) {
+        free(self->data1);
+    }
     self->data1 = NULL;
     return ERR_OK;
 }
@@ -152,9 +172,58 @@ static error_code clone_gf(game* self, game* clone_target)
     return ERR_OK;
 }
 
+static error_code size_hint_gf(game* self, game_init* init_info, size_t* ret_size)
+{
+    // independent of init_info, there are no options
+    *ret_size = game_e_arena_size(sizeof(game_data)) +
+                game_e_arena_size(STATE_STR_SIZE * sizeof(char)) +
+                game_e_arena_size(1 * sizeof(player_id)) +
+                game_e_arena_size(CHESS_MAX_MOVES * sizeof(move_data)) +
+                game_e_arena_size(CHESS_MAX_MOVES * sizeof(move_code)) +
+                game_e_arena_size(1 * sizeof(player_id)) +
+                game_e_arena_size(MOVE_STR_SIZE * sizeof(char)) +
+                game_e_arena_size(PRINT_STR_SIZE * sizeof(char)) +
+                game_e_arena_size(STATE_DELTA_STR_SIZE * sizeof(char)) +
+                game_e_arena_size(ARENA_UNDO_DEPTH * sizeof(state_repr)); // only taken for games in an arena, see create_block
+    return ERR_OK;
+}
+
+static error_code create_in_gf(game* self, game_init* init_info, game_arena* arena)
+{
+    return create_block(self, init_info, arena);
+}
+
+static error_code clone_in_gf(game* self, game* clone_target, game_arena* arena)
+{
+    clone_target->methods = self->methods;
+    game_init init_info = (game_init){.source_type = GAME_INIT_SOURCE_TYPE_DEFAULT};
+    error_code ec = create_block(clone_target, &init_info, arena);
+    if (ec != ERR_OK) {
+        return ec;
+    }
+    copy_from_gf(clone_target, self);
+    return ERR_OK;
+}
+
 static error_code copy_from_gf(game* self, game* other)
 {
     get_repr(self) = get_repr(other);
+    // the moves of other can only be unmade on other
+    ((game_data*)(self->data1))->undo_stack.clear();
+    ((game_data*)(self->data1))->arena_undo_stack.clear();
+    ((game_data*)(self->data1))->changes = ((game_data*)(other->data1))->changes;
+    return ERR_OK;
+}
+
+static error_code memory_usage_gf(game* self, size_t* ret_state, size_t* ret_buffers)
+{
+    // all buffers live in the same block as the game data, see create_block
+    game_data* data = (game_data*)self->data1;
+    size_t block_size;
+    size_hint_gf(self, NULL, &block_size);
+    size_t undo_ring_size = game_e_arena_size(ARENA_UNDO_DEPTH * sizeof(state_repr));
+    *ret_state = game_e_arena_size(sizeof(game_data)) + (data->in_arena == true ? undo_ring_size : data->undo_stack.capacity() * sizeof(state_repr));
+    *ret_buffers = block_size - game_e_arena_size(sizeof(game_data)) - undo_ring_size;
     return ERR_OK;
 }
 
@@ -173,10 +242,39 @@ static error_code player_count_gf(game* self, uint8_t* ret_count)
 static error_code export_state_gf(game* self, player_id player, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
-    char* outbuf = bufs.state;
-    if (outbuf == NULL) {
-        return ERR_INVALID_INPUT;
+    error_code ec = export_state_into_gf(self, STATE_STR_SIZE, ret_size, bufs.state);
+    *ret_str = bufs.state;
+    return ec;
+}
+
+static error_code export_state_delta_gf(game* self, uint64_t since_sync_ctr, size_t* ret_size, const char** ret_str)
+{
+    export_buffers& bufs = get_bufs(self);
+    state_repr& data = get_repr(self);
+    char* outbuf = bufs.state_delta;
+    bool available = ((game_data*)(self->data1))->changes.changes_since(since_sync_ctr, self->sync_ctr, [&](uint16_t cell) {
+        int x = (cell >> 4) & 0x0F;
+        int y = cell & 0x0F;
+        outbuf += sprintf(outbuf, "%s%c%c%c", (outbuf == bufs.state_delta ? "" : ","), 'a' + x, '1' + y, CHESS_PIECE_TYPE_CHARS[data.board[y][x].type] + (data.board[y][x].player == CHESS_PLAYER_BLACK ? 32 : 0));
+    });
+    if (available == false) {
+        *ret_size = 0;
+        *ret_str = NULL;
+        return ERR_OK;
+    }
+    outbuf += state_flags(self, outbuf);
+    *ret_size = outbuf - bufs.state_delta;
+    *ret_str = bufs.state_delta;
+    return ERR_OK;
+}
+
+static error_code export_state_into_gf(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < STATE_STR_SIZE) {
+        *ret_size = STATE_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
     }
+    char* outbuf = str;
     state_repr& data = get_repr(self);
     const char* ostr = outbuf;
     // save board
@@ -204,54 +302,17 @@ static error_code export_state_gf(game* self, player_id player, size_t* ret_size
             outbuf += sprintf(outbuf, "/");
         }
     }
-    // save current player
-    switch (data.current_player) {
-        case CHESS_PLAYER_NONE: {
-            outbuf += sprintf(outbuf, " - ");
-        } break;
-        case CHESS_PLAYER_WHITE: {
-            outbuf += sprintf(outbuf, " w ");
-        } break;
-        case CHESS_PLAYER_BLACK: {
-            outbuf += sprintf(outbuf, " b ");
-        } break;
-        case CHESS_PLAYER_COUNT: {
-            assert(0);
-        }
-    }
-    // save castling rights
-    if (!data.castling_white_king && !data.castling_white_queen && !data.castling_black_king && !data.castling_black_queen) {
-        outbuf += sprintf(outbuf, "-");
-    } else {
-        if (data.castling_white_king) {
-            outbuf += sprintf(outbuf, "K");
-        }
-        if (data.castling_white_queen) {
-            outbuf += sprintf(outbuf, "Q");
-        }
-        if (data.castling_black_king) {
-            outbuf += sprintf(outbuf, "k");
-        }
-        if (data.castling_black_queen) {
-            outbuf += sprintf(outbuf, "q");
-        }
-    }
-    // save enpassant target
-    if (data.enpassant_target == 0xFF) {
-        outbuf += sprintf(outbuf, " - ");
-    } else {
-        outbuf += sprintf(outbuf, " %c%c ", 'a' + ((data.enpassant_target >> 4) & 0x0F), '1' + (data.enpassant_target & 0x0F));
-    }
-    // save halfmove and fullmove clock
-    outbuf += sprintf(outbuf, "%d %d", data.halfmove_clock, data.fullmove_clock);
+    outbuf += state_flags(self, outbuf);
     *ret_size = outbuf - ostr;
-    *ret_str = bufs.state;
     return ERR_OK;
 }
 
 static error_code import_state_gf(game* self, const char* str)
 {
     state_repr& data = get_repr(self);
+    ((game_data*)(self->data1))->undo_stack.clear();
+    ((game_data*)(self->data1))->arena_undo_stack.clear();
+    ((game_data*)(self->data1))->changes.clear();
     for (int y = 0; y < 8; y++) {
         for (int x = 0; x < 8; x++) {
             data.board[y][x] = CHESS_piece{CHESS_PLAYER_NONE, CHESS_PIECE_TYPE_NONE}; // reason for this being CHESS_PIECE_TYPE_KING ?
@@ -475,63 +536,100 @@ static error_code import_state_gf(game* self, const char* str)
 
 static error_code players_to_move_gf(game* self, uint8_t* ret_count, const player_id** ret_players)
 {
-    *ret_count = 1;
+    export_buffers& bufs = get_bufs(self);
+    players_to_move_into_gf(self, 1, ret_count, bufs.players_to_move);
+    *ret_players = bufs.players_to_move;
+    return ERR_OK;
+}
+
+static error_code players_to_move_into_gf(game* self, uint8_t cap, uint8_t* ret_count, player_id* players)
+{
+    if (cap < 1) {
+        *ret_count = 1;
+        return ERR_OUT_OF_MEMORY;
+    }
     state_repr& data = get_repr(self);
     player_id ptm = data.current_player;
     if (ptm == CHESS_PLAYER_NONE) {
         *ret_count = 0;
         return ERR_OK;
     }
-    export_buffers& bufs = get_bufs(self);
-    player_id* outbuf = bufs.players_to_move;
-    *outbuf = ptm;
-    *ret_players = outbuf;
+    *ret_count = 1;
+    *players = ptm;
     return ERR_OK;
 }
 
 static error_code get_concrete_moves_gf(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves)
 {
     export_buffers& bufs = get_bufs(self);
-    move_data* outbuf = bufs.concrete_moves;
-    state_repr& data = get_repr(self);
-    //TODO encode things like check in the move, for move string printing in ptn?
-    //TODO this is an extremely slow and ugly movegen, use bitboards instead of mailbox
-    // if game is over, return empty move list
-    if (data.current_player == CHESS_PLAYER_NONE) {
-        *ret_count = 0;
-        return ERR_OK;
+    get_concrete_moves_into_gf(self, player, CHESS_MAX_MOVES, ret_count, bufs.concrete_moves);
+    *ret_moves = bufs.concrete_moves;
+    return ERR_OK;
+}
+
+static error_code get_concrete_moves_into_gf(game* self, player_id player, uint32_t cap, uint32_t* ret_count, move_data* moves)
+{
+    if (cap < CHESS_MAX_MOVES) {
+        *ret_count = CHESS_MAX_MOVES;
+        return ERR_OUT_OF_MEMORY;
     }
-    uint32_t pseudo_move_cnt;
-    move_code pseudo_moves[CHESS_MAX_MOVES * 4]; //TODO calculate proper size for this
-    get_moves_pseudo_legal_gf(self, &pseudo_move_cnt, pseudo_moves);
-    // check move legality by checking king capture
-    game pseudo_game;
-    clone_gf(self, &pseudo_game);
-    uint32_t move_cnt = 0;
-    for (int i = 0; i < pseudo_move_cnt; i++) {
-        copy_from_gf(&pseudo_game, self);
-        apply_move_internal_gf(&pseudo_game, pseudo_moves[i], true);
-        bool is_legal = true;
-        uint32_t response_move_cnt;
-        move_code response_moves[CHESS_MAX_MOVES];
-        get_moves_pseudo_legal_gf(&pseudo_game, &response_move_cnt, response_moves);
-        for (int j = 0; j < response_move_cnt; j++) {
-            int cm_tx = (response_moves[j] >> 4) & 0x0F;
-            int cm_ty = response_moves[j] & 0x0F;
-            CHESS_piece pseudo_piece;
-            get_cell_gf(&pseudo_game, cm_tx, cm_ty, &pseudo_piece);
-            if (pseudo_piece.type == CHESS_PIECE_TYPE_KING) {
-                is_legal = false;
-                break;
+    move_code codes[CHESS_MAX_MOVES];
+    *ret_count = get_move_codes(self, codes);
+    for (uint32_t i = 0; i < *ret_count; i++) {
+        moves[i] = game_e_create_move_small(codes[i]);
+    }
+    return ERR_OK;
+}
+
+static error_code get_concrete_moves_codes_gf(game* self, player_id player, uint32_t* ret_count, const move_code** ret_moves)
+{
+    export_buffers& bufs = get_bufs(self);
+    *ret_count = get_move_codes(self, bufs.concrete_move_codes);
+    *ret_moves = bufs.concrete_move_codes;
+    return ERR_OK;
+}
+
+static error_code get_moves_begin_gf(game* self, player_id player, move_iterator* it)
+{
+    // stage 0 yields captures and stage 1 quiet moves, idx is the square (y * 8 + x) and sub the next pseudo legal move of its piece
+    it->player = player;
+    it->stage = 0;
+    it->idx = 0;
+    it->sub = 0;
+    return ERR_OK;
+}
+
+static error_code get_moves_next_gf(game* self, move_iterator* it, bool* ret_done, move_data* ret_move)
+{
+    state_repr& data = get_repr(self);
+    move_code piece_moves[32];
+    while (it->stage < 2) {
+        while (it->idx < 64) {
+            int x = it->idx % 8;
+            int y = it->idx / 8;
+            // regenerating the moves of a single piece is cheaper than keeping them around in the cursor
+            uint32_t piece_move_cnt = get_piece_moves_pseudo_legal(data, x, y, piece_moves);
+            while (it->sub < piece_move_cnt) {
+                move_code move = piece_moves[it->sub++];
+                int tx = (move >> 4) & 0x0F;
+                int ty = move & 0x0F;
+                bool capture = (data.board[ty][tx].type != CHESS_PIECE_TYPE_NONE || (data.board[y][x].type == CHESS_PIECE_TYPE_PAWN && tx != x));
+                if (capture != (it->stage == 0)) {
+                    continue;
+                }
+                if (is_pseudo_move_legal(self, move)) {
+                    *ret_done = false;
+                    *ret_move = game_e_create_move_small(move);
+                    return ERR_OK;
+                }
             }
+            it->idx++;
+            it->sub = 0;
         }
-        if (is_legal) {
-            outbuf[move_cnt++] = game_e_create_move_small(pseudo_moves[i]);
-        }
+        it->stage++;
+        it->idx = 0;
     }
-    *ret_count = move_cnt;
-    *ret_moves = bufs.concrete_moves;
-    destroy_gf(&pseudo_game);
+    *ret_done = true;
     return ERR_OK;
 }
 
@@ -548,11 +646,11 @@ static error_code is_legal_move_gf(game* self, player_id player, move_data_sync
         return ERR_INVALID_INPUT;
     }
     uint32_t move_cnt;
-    const move_data* moves;
-    get_concrete_moves_gf(self, *ptm, &move_cnt, &moves);
+    const move_code* moves;
+    get_concrete_moves_codes_gf(self, *ptm, &move_cnt, &moves);
     while (move_cnt > 0) {
         move_cnt--;
-        if (moves[move_cnt].cl.code == move.md.cl.code) {
+        if (moves[move_cnt] == move.md.cl.code) {
             return ERR_OK;
         }
     }
@@ -562,13 +660,35 @@ static error_code is_legal_move_gf(game* self, player_id player, move_data_sync
 static error_code make_move_gf(game* self, player_id player, move_data_sync move)
 {
     state_repr& data = get_repr(self);
+    change_journal<JOURNAL_CELLS, JOURNAL_MOVES>& changes = ((game_data*)(self->data1))->changes;
+    // the squares a move writes depend on castling, en passant and promotions, comparing against the copy from before finds them all
+    const state_repr before = data;
+    game_data* gdata = (game_data*)self->data1;
+    if (self->unmake_history == false) {
+        // the recorded moves can not be unmade past this one
+        gdata->undo_stack.clear();
+        gdata->arena_undo_stack.clear();
+    } else if (gdata->in_arena == true) {
+        gdata->arena_undo_stack.push_back(data);
+    } else {
+        gdata->undo_stack.push_back(data);
+    }
+    changes.begin_move(self->sync_ctr);
     apply_move_internal_gf(self, move.md.cl.code, false); // this swaps players after the move on its own
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            if (data.board[y][x].player != before.board[y][x].player || data.board[y][x].type != before.board[y][x].type) {
+                changes.touch((x << 4) | y);
+            }
+        }
+    }
+    changes.end_move();
     //TODO draw on halfmove clock, should this happen here? probably just offer a move to claim draw, but for both players..
     //TODO does draw on threfold repetition happen here?
     //TODO better detection for win by checkmate and draw by stalemate
     uint32_t available_move_cnt;
-    const move_data* available_moves_data;
-    get_concrete_moves_gf(self, data.current_player, &available_move_cnt, &available_moves_data);
+    const move_code* available_moves_data;
+    get_concrete_moves_codes_gf(self, data.current_player, &available_move_cnt, &available_moves_data);
     move_code available_moves_code[CHESS_MAX_MOVES];
     if (available_move_cnt == 0) {
         // this is at least a stalemate here, now see if the other player would have a way to capture the king next turn
@@ -590,6 +710,25 @@ static error_code make_move_gf(game* self, player_id player, move_data_sync move
     return ERR_OK;
 }
 
+static error_code unmake_move_gf(game* self, player_id player, move_data_sync move)
+{
+    game_data* gdata = (game_data*)self->data1;
+    if (gdata->in_arena == true ? gdata->arena_undo_stack.empty() : gdata->undo_stack.empty()) {
+        // no made move known, e.g. after an import or beyond the depth of the arena history
+        return ERR_INVALID_INPUT;
+    }
+    // the state goes back to a sync_ctr that clients may have seen with a different state, so no delta can start from there
+    gdata->changes.clear();
+    if (gdata->in_arena == true) {
+        get_repr(self) = gdata->arena_undo_stack.back();
+        gdata->arena_undo_stack.pop_back();
+    } else {
+        get_repr(self) = gdata->undo_stack.back();
+        gdata->undo_stack.pop_back();
+    }
+    return ERR_OK;
+}
+
 static error_code get_results_gf(game* self, uint8_t* ret_count, const player_id** ret_players)
 {
     export_buffers& bufs = get_bufs(self);
@@ -666,7 +805,18 @@ static error_code get_move_data_gf(game* self, player_id player, const char* str
 static error_code get_move_str_gf(game* self, player_id player, move_data_sync move, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
-    char* outbuf = bufs.move_str;
+    error_code ec = get_move_str_into_gf(self, player, move, MOVE_STR_SIZE, ret_size, bufs.move_str);
+    *ret_str = bufs.move_str;
+    return ec;
+}
+
+static error_code get_move_str_into_gf(game* self, player_id player, move_data_sync move, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < MOVE_STR_SIZE) {
+        *ret_size = MOVE_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
+    }
+    char* outbuf = str;
     move_code mcode = move.md.cl.code;
     if (mcode == MOVE_NONE) {
         *ret_size = sprintf(outbuf, "-");
@@ -681,14 +831,24 @@ static error_code get_move_str_gf(game* self, player_id player, move_data_sync m
     if (promotion != CHESS_PIECE_TYPE_NONE) {
         *ret_size += sprintf(outbuf + 4, "%c", CHESS_PIECE_TYPE_CHARS[promotion] + 32);
     }
-    *ret_str = bufs.move_str;
     return ERR_OK;
 }
 
 static error_code print_gf(game* self, player_id player, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
-    char* outbuf = bufs.print;
+    error_code ec = print_into_gf(self, PRINT_STR_SIZE, ret_size, bufs.print);
+    *ret_str = bufs.print;
+    return ec;
+}
+
+static error_code print_into_gf(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < PRINT_STR_SIZE) {
+        *ret_size = PRINT_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
+    }
+    char* outbuf = str;
     state_repr& data = get_repr(self);
     const char* ostr = outbuf;
     outbuf += sprintf(outbuf, "castling rights: ");
@@ -722,7 +882,6 @@ static error_code print_gf(game* self, player_id player, size_t* ret_size, const
     }
     outbuf += sprintf(outbuf, "\n");
     *ret_size = outbuf - ostr;
-    *ret_str = bufs.print;
     return ERR_OK;
 }
 
@@ -740,6 +899,7 @@ static error_code set_cell_gf(game* self, int x, int y, CHESS_piece p)
 {
     state_repr& data = get_repr(self);
     data.board[y][x] = p;
+    ((game_data*)(self->data1))->changes.clear();
     return ERR_OK;
 }
 
@@ -757,22 +917,47 @@ static error_code set_result_gf(game* self, player_id p)
     return ERR_OK;
 }
 
+static error_code ext_set_cell_gf(game* self, int x, int y, CHESS_piece p)
+{
+    game_e_cache_invalidate(self);
+    return set_cell_gf(self, x, y, p);
+}
+
+static error_code ext_set_current_player_gf(game* self, player_id p)
+{
+    game_e_cache_invalidate(self);
+    return set_current_player_gf(self, p);
+}
+
+static error_code ext_set_result_gf(game* self, player_id p)
+{
+    game_e_cache_invalidate(self);
+    return set_result_gf(self, p);
+}
+
+static error_code ext_apply_move_internal_gf(game* self, move_code move, bool replace_castling_by_kings)
+{
+    game_e_cache_invalidate(self);
+    return apply_move_internal_gf(self, move, replace_castling_by_kings);
+}
+
 static error_code count_positions_gf(game* self, int depth, uint64_t* count)
 {
     // this chess implementation is valid against all chessprogrammingwiki positions, tested up to depth 4
     state_repr& data = get_repr(self);
     uint32_t move_cnt;
-    const move_data* moves;
-    get_concrete_moves_gf(self, data.current_player, &move_cnt, &moves);
+    const move_code* moves;
+    get_concrete_moves_codes_gf(self, data.current_player, &move_cnt, &moves);
     if (depth == 1) {
         *count = move_cnt; // bulk counting since get_moves generates only legal moves
+        return ERR_OK;
     }
     uint64_t positions = 0;
     game test_game;
     clone_gf(self, &test_game);
     for (int i = 0; i < move_cnt; i++) {
-        copy_from_gf(&test_game, self);
-        apply_move_internal_gf(&test_game, moves[i].cl.code, false);
+        get_repr(&test_game) = get_repr(self);
+        apply_move_internal_gf(&test_game, moves[i], false);
         uint64_t test_game_positions;
         count_positions_gf(&test_game, depth - 1, &test_game_positions);
         positions += test_game_positions;
@@ -784,6 +969,10 @@ static error_code count_positions_gf(game* self, int depth, uint64_t* count)
 
 static error_code apply_move_internal_gf(game* self, move_code move, bool replace_castling_by_kings)
 {
+    if (((game_data*)(self->data1))->changes.is_recording() == false) {
+        // called from outside of make_move, which journals the squares on its own
+        ((game_data*)(self->data1))->changes.clear();
+    }
     state_repr& data = get_repr(self);
     int ox = (move >> 12) & 0x0F;
     int oy = (move >> 8) & 0x0F;
@@ -869,9 +1058,10 @@ static error_code apply_move_internal_gf(game* self, move_code move, bool replac
     return ERR_OK;
 }
 
-static error_code get_moves_pseudo_legal_gf(game* self, uint32_t* move_cnt, move_code* move_vec)
+// impl hidden: writes the pseudo legal moves of the piece on x y, if it belongs to the current player, returns the number of moves written
+// a single piece has at most 27 moves (queen)
+static uint32_t get_piece_moves_pseudo_legal(state_repr& data, int x, int y, move_code* move_vec)
 {
-    state_repr& data = get_repr(self);
     // directions are: N,S,W,E,NW,SE,NE,SW
     const int directions_x[8] = {0, 0, -1, 1, -1, 1, 1, -1};
     const int directions_y[8] = {1, -1, 0, 0, 1, -1, 1, -1};
@@ -881,140 +1071,280 @@ static error_code get_moves_pseudo_legal_gf(game* self, uint32_t* move_cnt, move
     // vector are: WHITE{NW,N,NE,2N}, BLACK{SW,S,SE,2S}
     const int pawn_cvx[8] = {-1, 0, 1, 0, -1, 0, 1, 0};
     const int pawn_cvy[8] = {1, 1, 1, 2, -1, -1, -1, -2};
+    CHESS_piece current_piece = data.board[y][x];
+    if (current_piece.player != data.current_player) {
+        return 0;
+    }
     uint32_t gather_move_cnt = 0;
-    for (int y = 0; y < 8; y++) {
-        for (int x = 0; x < 8; x++) {
-            CHESS_piece current_piece = data.board[y][x];
-            if (current_piece.player != data.current_player) {
-                continue;
+    // gen move for this piece
+    switch (current_piece.type) {
+        case CHESS_PIECE_TYPE_NONE: {
+            // pass
+        } break;
+        case CHESS_PIECE_TYPE_KING: {
+            for (int d = 0; d < 8; d++) {
+                int tx = x + directions_x[d];
+                int ty = y + directions_y[d];
+                if (tx < 0 || tx > 7 || ty < 0 || ty > 7) {
+                    continue;
+                }
+                CHESS_piece target_piece = data.board[ty][tx];
+                if (target_piece.player == data.current_player) {
+                    continue;
+                }
+                move_vec[gather_move_cnt++] = (x << 12) | (y << 8) | (tx << 4) | (ty);
             }
-            // gen move for this piece
-            switch (current_piece.type) {
-                case CHESS_PIECE_TYPE_NONE: {
-                    // pass
-                } break;
-                case CHESS_PIECE_TYPE_KING: {
-                    for (int d = 0; d < 8; d++) {
-                        int tx = x + directions_x[d];
-                        int ty = y + directions_y[d];
-                        if (tx < 0 || tx > 7 || ty < 0 || ty > 7) {
-                            continue;
-                        }
-                        CHESS_piece target_piece = data.board[ty][tx];
-                        if (target_piece.player == data.current_player) {
-                            continue;
-                        }
-                        move_vec[gather_move_cnt++] = (x << 12) | (y << 8) | (tx << 4) | (ty);
-                    }
-                    // king is not allowed to move through attacked squares while castling, this is handled elsewhere for now
-                    if (data.current_player == CHESS_PLAYER_WHITE) {
-                        if (data.castling_white_king && data.board[y][x + 1].type == CHESS_PIECE_TYPE_NONE && data.board[y][x + 2].type == CHESS_PIECE_TYPE_NONE &&
-                            data.board[y][7].player == data.current_player && data.board[y][7].type == CHESS_PIECE_TYPE_ROOK) {
-                            move_vec[gather_move_cnt++] = (x << 12) | (y << 8) | ((x + 2) << 4) | (y);
-                        }
-                        if (data.castling_white_queen && data.board[y][x - 1].type == CHESS_PIECE_TYPE_NONE && data.board[y][x - 2].type == CHESS_PIECE_TYPE_NONE && data.board[y][x - 3].type == CHESS_PIECE_TYPE_NONE &&
-                            data.board[y][0].player == data.current_player && data.board[y][0].type == CHESS_PIECE_TYPE_ROOK) {
-                            move_vec[gather_move_cnt++] = (x << 12) | (y << 8) | ((x - 2) << 4) | (y);
-                        }
-                    }
-                    if (data.current_player == CHESS_PLAYER_BLACK) {
-                        if (data.castling_black_king && data.board[y][x + 1].type == CHESS_PIECE_TYPE_NONE && data.board[y][x + 2].type == CHESS_PIECE_TYPE_NONE &&
-                            data.board[y][7].player == data.current_player && data.board[y][7].type == CHESS_PIECE_TYPE_ROOK) {
-                            move_vec[gather_move_cnt++] = (x << 12) | (y << 8) | ((x + 2) << 4) | (y);
-                        }
-                        if (data.castling_black_queen && data.board[y][x - 1].type == CHESS_PIECE_TYPE_NONE && data.board[y][x - 2].type == CHESS_PIECE_TYPE_NONE && data.board[y][x - 3].type == CHESS_PIECE_TYPE_NONE &&
-                            data.board[y][0].player == data.current_player && data.board[y][0].type == CHESS_PIECE_TYPE_ROOK) {
-                            move_vec[gather_move_cnt++] = (x << 12) | (y << 8) | ((x - 2) << 4) | (y);
-                        }
-                    }
-                } break;
-                case CHESS_PIECE_TYPE_QUEEN:
-                case CHESS_PIECE_TYPE_ROOK:
-                case CHESS_PIECE_TYPE_BISHOP: {
-                    int dmin = current_piece.type == CHESS_PIECE_TYPE_BISHOP ? 4 : 0;
-                    int dmax = current_piece.type == CHESS_PIECE_TYPE_ROOK ? 4 : 8;
-                    for (int d = dmin; d < dmax; d++) {
-                        for (int s = 1; true; s++) {
-                            int tx = x + s * directions_x[d];
-                            int ty = y + s * directions_y[d];
-                            if (tx < 0 || tx > 7 || ty < 0 || ty > 7) {
-                                break;
-                            }
-                            CHESS_piece target_piece = data.board[ty][tx];
-                            if (target_piece.player == data.current_player) {
-                                break;
-                            }
-                            move_vec[gather_move_cnt++] = (x << 12) | (y << 8) | (tx << 4) | (ty);
-                            if (target_piece.player != current_piece.player && target_piece.type != CHESS_PIECE_TYPE_NONE) {
-                                break;
-                            }
-                        }
+            // king is not allowed to move through attacked squares while castling, this is handled elsewhere for now
+            if (data.current_player == CHESS_PLAYER_WHITE) {
+                if (data.castling_white_king && data.board[y][x + 1].type == CHESS_PIECE_TYPE_NONE && data.board[y][x + 2].type == CHESS_PIECE_TYPE_NONE &&
+                    data.board[y][7].player == data.current_player && data.board[y][7].type == CHESS_PIECE_TYPE_ROOK) {
+                    move_vec[gather_move_cnt++] = (x << 12) | (y << 8) | ((x + 2) << 4) | (y);
+                }
+                if (data.castling_white_queen && data.board[y][x - 1].type == CHESS_PIECE_TYPE_NONE && data.board[y][x - 2].type == CHESS_PIECE_TYPE_NONE && data.board[y][x - 3].type == CHESS_PIECE_TYPE_NONE &&
+                    data.board[y][0].player == data.current_player && data.board[y][0].type == CHESS_PIECE_TYPE_ROOK) {
+                    move_vec[gather_move_cnt++] = (x << 12) | (y << 8) | ((x - 2) << 4) | (y);
+                }
+            }
+            if (data.current_player == CHESS_PLAYER_BLACK) {
+                if (data.castling_black_king && data.board[y][x + 1].type == CHESS_PIECE_TYPE_NONE && data.board[y][x + 2].type == CHESS_PIECE_TYPE_NONE &&
+                    data.board[y][7].player == data.current_player && data.board[y][7].type == CHESS_PIECE_TYPE_ROOK) {
+                    move_vec[gather_move_cnt++] = (x << 12) | (y << 8) | ((x + 2) << 4) | (y);
+                }
+                if (data.castling_black_queen && data.board[y][x - 1].type == CHESS_PIECE_TYPE_NONE && data.board[y][x - 2].type == CHESS_PIECE_TYPE_NONE && data.board[y][x - 3].type == CHESS_PIECE_TYPE_NONE &&
+                    data.board[y][0].player == data.current_player && data.board[y][0].type == CHESS_PIECE_TYPE_ROOK) {
+                    move_vec[gather_move_cnt++] = (x << 12) | (y << 8) | ((x - 2) << 4) | (y);
+                }
+            }
+        } break;
+        case CHESS_PIECE_TYPE_QUEEN:
+        case CHESS_PIECE_TYPE_ROOK:
+        case CHESS_PIECE_TYPE_BISHOP: {
+            int dmin = current_piece.type == CHESS_PIECE_TYPE_BISHOP ? 4 : 0;
+            int dmax = current_piece.type == CHESS_PIECE_TYPE_ROOK ? 4 : 8;
+            for (int d = dmin; d < dmax; d++) {
+                for (int s = 1; true; s++) {
+                    int tx = x + s * directions_x[d];
+                    int ty = y + s * directions_y[d];
+                    if (tx < 0 || tx > 7 || ty < 0 || ty > 7) {
+                        break;
                     }
-                } break;
-                case CHESS_PIECE_TYPE_KNIGHT: {
-                    for (int d = 0; d < 8; d++) {
-                        int tx = x + knight_vx[d];
-                        int ty = y + knight_vy[d];
-                        if (tx < 0 || tx > 7 || ty < 0 || ty > 7) {
-                            continue;
-                        }
-                        CHESS_piece target_piece = data.board[ty][tx];
-                        if (target_piece.player == data.current_player) {
-                            continue;
-                        }
-                        move_vec[gather_move_cnt++] = (x << 12) | (y << 8) | (tx << 4) | (ty);
+                    CHESS_piece target_piece = data.board[ty][tx];
+                    if (target_piece.player == data.current_player) {
+                        break;
                     }
-                } break;
-                case CHESS_PIECE_TYPE_PAWN: {
-                    int dmin = data.current_player == CHESS_PLAYER_BLACK ? 4 : 0;
-                    int dmax = data.current_player == CHESS_PLAYER_WHITE ? 4 : 8;
-                    for (int d = dmin; d < dmax; d++) {
-                        int tx = x + pawn_cvx[d];
-                        int ty = y + pawn_cvy[d];
-                        if (tx < 0 || tx > 7 || ty < 0 || ty > 7) {
-                            continue;
-                        }
-                        CHESS_piece target_piece = data.board[ty][tx];
-                        if (target_piece.player == data.current_player) {
-                            continue;
-                        }
-                        if (tx != x && target_piece.type == CHESS_PIECE_TYPE_NONE && data.enpassant_target != ((tx << 4) | (ty))) {
-                            // pawn would move diagonally, but there isnt any piece there to capture, and it also isnt an en passant target
-                            continue;
-                        }
-                        if (y != 1 && y != 6 && (ty - y > 1 || y - ty > 1)) {
-                            // do not allow double pawn push if it isnt in its starting position
-                            continue;
-                        }
-                        if ((y == 1 || y == 6) && (ty - y > 1 || y - ty > 1) && data.board[y + pawn_cvy[d - 2]][tx].type != CHESS_PIECE_TYPE_NONE) {
-                            // double pawn push only allowed over empty squares
-                            continue;
-                        }
-                        if (tx - x == 0 && target_piece.type != CHESS_PIECE_TYPE_NONE) {
-                            // can only advance straight forward into open spaces
-                            continue;
-                        }
-                        if (ty == 0 || ty == 7) {
-                            // pawn promotion, instead add 4 moves for the 4 types of promotions
-                            move_vec[gather_move_cnt++] = (CHESS_PIECE_TYPE_QUEEN << 16) | (x << 12) | (y << 8) | (tx << 4) | (ty);
-                            move_vec[gather_move_cnt++] = (CHESS_PIECE_TYPE_ROOK << 16) | (x << 12) | (y << 8) | (tx << 4) | (ty);
-                            move_vec[gather_move_cnt++] = (CHESS_PIECE_TYPE_BISHOP << 16) | (x << 12) | (y << 8) | (tx << 4) | (ty);
-                            move_vec[gather_move_cnt++] = (CHESS_PIECE_TYPE_KNIGHT << 16) | (x << 12) | (y << 8) | (tx << 4) | (ty);
-                            continue;
-                        }
-                        move_vec[gather_move_cnt++] = (x << 12) | (y << 8) | (tx << 4) | (ty);
+                    move_vec[gather_move_cnt++] = (x << 12) | (y << 8) | (tx << 4) | (ty);
+                    if (target_piece.player != current_piece.player && target_piece.type != CHESS_PIECE_TYPE_NONE) {
+                        break;
                     }
-                } break;
-                case CHESS_PIECE_TYPE_COUNT: {
-                    assert(0);
-                } break;
+                }
+            }
+        } break;
+        case CHESS_PIECE_TYPE_KNIGHT: {
+            for (int d = 0; d < 8; d++) {
+                int tx = x + knight_vx[d];
+                int ty = y + knight_vy[d];
+                if (tx < 0 || tx > 7 || ty < 0 || ty > 7) {
+                    continue;
+                }
+                CHESS_piece target_piece = data.board[ty][tx];
+                if (target_piece.player == data.current_player) {
+                    continue;
+                }
+                move_vec[gather_move_cnt++] = (x << 12) | (y << 8) | (tx << 4) | (ty);
+            }
+        } break;
+        case CHESS_PIECE_TYPE_PAWN: {
+            int dmin = data.current_player == CHESS_PLAYER_BLACK ? 4 : 0;
+            int dmax = data.current_player == CHESS_PLAYER_WHITE ? 4 : 8;
+            for (int d = dmin; d < dmax; d++) {
+                int tx = x + pawn_cvx[d];
+                int ty = y + pawn_cvy[d];
+                if (tx < 0 || tx > 7 || ty < 0 || ty > 7) {
+                    continue;
+                }
+                CHESS_piece target_piece = data.board[ty][tx];
+                if (target_piece.player == data.current_player) {
+                    continue;
+                }
+                if (tx != x && target_piece.type == CHESS_PIECE_TYPE_NONE && data.enpassant_target != ((tx << 4) | (ty))) {
+                    // pawn would move diagonally, but there isnt any piece there to capture, and it also isnt an en passant target
+                    continue;
+                }
+                if (y != 1 && y != 6 && (ty - y > 1 || y - ty > 1)) {
+                    // do not allow double pawn push if it isnt in its starting position
+                    continue;
+                }
+                if ((y == 1 || y == 6) && (ty - y > 1 || y - ty > 1) && data.board[y + pawn_cvy[d - 2]][tx].type != CHESS_PIECE_TYPE_NONE) {
+                    // double pawn push only allowed over empty squares
+                    continue;
+                }
+                if (tx - x == 0 && target_piece.type != CHESS_PIECE_TYPE_NONE) {
+                    // can only advance straight forward into open spaces
+                    continue;
+                }
+                if (ty == 0 || ty == 7) {
+                    // pawn promotion, instead add 4 moves for the 4 types of promotions
+                    move_vec[gather_move_cnt++] = (CHESS_PIECE_TYPE_QUEEN << 16) | (x << 12) | (y << 8) | (tx << 4) | (ty);
+                    move_vec[gather_move_cnt++] = (CHESS_PIECE_TYPE_ROOK << 16) | (x << 12) | (y << 8) | (tx << 4) | (ty);
+                    move_vec[gather_move_cnt++] = (CHESS_PIECE_TYPE_BISHOP << 16) | (x << 12) | (y << 8) | (tx << 4) | (ty);
+                    move_vec[gather_move_cnt++] = (CHESS_PIECE_TYPE_KNIGHT << 16) | (x << 12) | (y << 8) | (tx << 4) | (ty);
+                    continue;
+                }
+                move_vec[gather_move_cnt++] = (x << 12) | (y << 8) | (tx << 4) | (ty);
             }
+        } break;
+        case CHESS_PIECE_TYPE_COUNT: {
+            assert(0);
+        } break;
+    }
+    return gather_move_cnt;
+}
+
+static error_code get_moves_pseudo_legal_gf(game* self, uint32_t* move_cnt, move_code* move_vec)
+{
+    state_repr& data = get_repr(self);
+    uint32_t gather_move_cnt = 0;
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            gather_move_cnt += get_piece_moves_pseudo_legal(data, x, y, move_vec + gather_move_cnt);
         }
     }
     *move_cnt = gather_move_cnt;
     return ERR_OK;
 }
 
+// impl hidden: check move legality of the pseudo legal move by checking king capture, probing on a scratch copy of the state
+static bool is_pseudo_move_legal(game* self, move_code move)
+{
+    game_data probe_data;
+    probe_data.state = get_repr(self);
+    game probe_game{.methods = self->methods, .data1 = &probe_data, .data2 = NULL, .sync_ctr = 0};
+    apply_move_internal_gf(&probe_game, move, true);
+    uint32_t response_move_cnt;
+    move_code response_moves[CHESS_MAX_MOVES];
+    get_moves_pseudo_legal_gf(&probe_game, &response_move_cnt, response_moves);
+    for (int j = 0; j < response_move_cnt; j++) {
+        int cm_tx = (response_moves[j] >> 4) & 0x0F;
+        int cm_ty = response_moves[j] & 0x0F;
+        if (probe_data.state.board[cm_ty][cm_tx].type == CHESS_PIECE_TYPE_KING) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// impl hidden: writes the current player, castling rights, en passant target and clocks that end the state string to str, returns their length
+static size_t state_flags(game* self, char* str)
+{
+    char* outbuf = str;
+    state_repr& data = get_repr(self);
+    // save current player
+    switch (data.current_player) {
+        case CHESS_PLAYER_NONE: {
+            outbuf += sprintf(outbuf, " - ");
+        } break;
+        case CHESS_PLAYER_WHITE: {
+            outbuf += sprintf(outbuf, " w ");
+        } break;
+        case CHESS_PLAYER_BLACK: {
+            outbuf += sprintf(outbuf, " b ");
+        } break;
+        case CHESS_PLAYER_COUNT: {
+            assert(0);
+        }
+    }
+    // save castling rights
+    if (!data.castling_white_king && !data.castling_white_queen && !data.castling_black_king && !data.castling_black_queen) {
+        outbuf += sprintf(outbuf, "-");
+    } else {
+        if (data.castling_white_king) {
+            outbuf += sprintf(outbuf, "K");
+        }
+        if (data.castling_white_queen) {
+            outbuf += sprintf(outbuf, "Q");
+        }
+        if (data.castling_black_king) {
+            outbuf += sprintf(outbuf, "k");
+        }
+        if (data.castling_black_queen) {
+            outbuf += sprintf(outbuf, "q");
+        }
+    }
+    // save enpassant target
+    if (data.enpassant_target == 0xFF) {
+        outbuf += sprintf(outbuf, " - ");
+    } else {
+        outbuf += sprintf(outbuf, " %c%c ", 'a' + ((data.enpassant_target >> 4) & 0x0F), '1' + (data.enpassant_target & 0x0F));
+    }
+    // save halfmove and fullmove clock
+    outbuf += sprintf(outbuf, "%d %d", data.halfmove_clock, data.fullmove_clock);
+    return outbuf - str;
+}
+
+// impl hidden: creates the game data and all buffers in one block of size_hint, taken from the arena or malloc'd if arena is NULL
+// only games in an arena get the undo ring at the end of the block, all others keep their history on the heap
+static error_code create_block(game* self, game_init* init_info, game_arena* arena)
+{
+    size_t block_size;
+    size_hint_gf(self, init_info, &block_size);
+    if (arena == NULL) {
+        block_size -= game_e_arena_size(ARENA_UNDO_DEPTH * sizeof(state_repr));
+    }
+    void* block = (arena == NULL ? malloc(block_size) : game_e_arena_alloc(arena, block_size));
+    if (block == NULL) {
+        self->data1 = NULL;
+        return ERR_OUT_OF_MEMORY;
+    }
+    // the block is sized exactly for these allocations, so none of them can fail
+    game_arena block_arena;
+    game_e_arena_init(&block_arena, block, block_size);
+    self->data1 = game_e_arena_alloc(&block_arena, sizeof(game_data));
+    new (self->data1) game_data();
+    self->data2 = NULL;
+    ((game_data*)self->data1)->in_arena = (arena != NULL);
+    {
+        export_buffers& bufs = get_bufs(self);
+        bufs.state = (char*)game_e_arena_alloc(&block_arena, STATE_STR_SIZE * sizeof(char));
+        bufs.players_to_move = (player_id*)game_e_arena_alloc(&block_arena, 1 * sizeof(player_id));
+        bufs.concrete_moves = (move_data*)game_e_arena_alloc(&block_arena, CHESS_MAX_MOVES * sizeof(move_data));
+        bufs.concrete_move_codes = (move_code*)game_e_arena_alloc(&block_arena, CHESS_MAX_MOVES * sizeof(move_code));
+        bufs.results = (player_id*)game_e_arena_alloc(&block_arena, 1 * sizeof(player_id));
+        bufs.move_str = (char*)game_e_arena_alloc(&block_arena, MOVE_STR_SIZE * sizeof(char));
+        bufs.print = (char*)game_e_arena_alloc(&block_arena, PRINT_STR_SIZE * sizeof(char));
+        bufs.state_delta = (char*)game_e_arena_alloc(&block_arena, STATE_DELTA_STR_SIZE * sizeof(char));
+    }
+    if (arena != NULL) {
+        ((game_data*)self->data1)->arena_undo_stack.set_storage((state_repr*)game_e_arena_alloc(&block_arena, ARENA_UNDO_DEPTH * sizeof(state_repr)), ARENA_UNDO_DEPTH);
+    }
+    const char* initial_state = NULL;
+    if (init_info->source_type == GAME_INIT_SOURCE_TYPE_STANDARD) {
+        initial_state = init_info->source.standard.state;
+    }
+    return import_state_gf(self, initial_state);
+}
+
+// impl hidden: writes the legal move codes for the player to move, read only on the game, returns the number of codes written
+static uint32_t get_move_codes(game* self, move_code* outbuf)
+{
+    state_repr& data = get_repr(self);
+    //TODO encode things like check in the move, for move string printing in ptn?
+    //TODO this is an extremely slow and ugly movegen, use bitboards instead of mailbox
+    // if game is over, return empty move list
+    if (data.current_player == CHESS_PLAYER_NONE) {
+        return 0;
+    }
+    uint32_t pseudo_move_cnt;
+    move_code pseudo_moves[CHESS_MAX_MOVES * 4]; //TODO calculate proper size for this
+    get_moves_pseudo_legal_gf(self, &pseudo_move_cnt, pseudo_moves);
+    uint32_t move_cnt = 0;
+    for (int i = 0; i < pseudo_move_cnt; i++) {
+        if (is_pseudo_move_legal(self, pseudo_moves[i])) {
+            outbuf[move_cnt++] = pseudo_moves[i];
+        }
+    }
+    return move_cnt;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// copy on write board of width * height cells, stored as refcounted blocks of BLOCK_ROWS rows each
+// copies share all blocks, a block is only copied once a board that shares it writes to it
+// so clones of large boards are cheap, and siblings in a search tree only own the few blocks their moves touched
+// reads go through get, every write has to go through set or mut so the written block is unshared first
+// blocks may be shared across threads, only a single board must not be used from multiple threads at once
+template <typename T>
+class cow_board {
+
+    static_assert(std::is_trivially_copyable<T>::value, "cow_board cells are copied bytewise");
+
+  public:
+
+    static const uint32_t BLOCK_ROWS = 4;
+
+    cow_board():
+        w(0),
+        h(0)
+    {}
+
+    cow_board(const cow_board& other):
+        w(other.w),
+        h(other.h),
+        blocks(other.blocks)
+    {
+        for (block* b : blocks) {
+            b->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    cow_board& operator=(const cow_board& other)
+    {
+        if (this == &other) {
+            return *this;
+        }
+        for (block* b : other.blocks) {
+            b->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        release_all();
+        w = other.w;
+        h = other.h;
+        blocks = other.blocks;
+        return *this;
+    }
+
+    ~cow_board()
+    {
+        release_all();
+    }
+
+    // drops all blocks and makes this a fresh unshared board with every cell set to fill
+    // returns false if out of memory, the board is then empty
+    bool reset(uint32_t width, uint32_t height, const T& fill)
+    {
+        release_all();
+        w = width;
+        h = height;
+        uint32_t block_count = (height + BLOCK_ROWS - 1) / BLOCK_ROWS;
+        blocks.reserve(block_count);
+        for (uint32_t bi = 0; bi < block_count; bi++) {
+            block* b = block_alloc(block_cells(bi));
+            if (b == NULL) {
+                release_all();
+                return false;
+            }
+            T* c = block_data(b);
+            for (uint32_t i = 0; i < block_cells(bi); i++) {
+                c[i] = fill;
+            }
+            blocks.push_back(b);
+        }
+        return true;
+    }
+
+    uint32_t width() const
+    {
+        return w;
+    }
+
+    uint32_t height() const
+    {
+        return h;
+    }
+
+    const T& get(uint32_t x, uint32_t y) const
+    {
+        return block_data(blocks[y / BLOCK_ROWS])[(y % BLOCK_ROWS) * w + x];
+    }
+
+    // returns a writable reference to the cell, copying its block first if it is shared
+    // the reference is invalidated by the next copy of this board
+    // only fails (returns NULL) if the copy runs out of memory
+    T* mut(uint32_t x, uint32_t y)
+    {
+        block* b = unshare(y / BLOCK_ROWS);
+        if (b == NULL) {
+            return NULL;
+        }
+        return &block_data(b)[(y % BLOCK_ROWS) * w + x];
+    }
+
+    bool set(uint32_t x, uint32_t y, const T& v)
+    {
+        T* c = mut(x, y);
+        if (c == NULL) {
+            return false;
+        }
+        *c = v;
+        return true;
+    }
+
+    // copies the shared blocks of the rows y_first to y_last (inclusive, clamped to the board), so later writes to them can not fail
+    // returns false if out of memory, blocks unshared before that stay unshared
+    bool unshare_rows(int y_first, int y_last)
+    {
+        if (y_first < 0) {
+            y_first = 0;
+        }
+        if (y_last >= (int)h) {
+            y_last = (int)h - 1;
+        }
+        for (int bi = y_first / (int)BLOCK_ROWS; y_first <= y_last && bi <= y_last / (int)BLOCK_ROWS; bi++) {
+            if (unshare(bi) == NULL) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // bytes held by this board, every shared block is only counted by its share, i.e. its size divided by its current refcount
+    size_t memory_usage() const
+    {
+        size_t bytes = blocks.capacity() * sizeof(block*);
+        for (uint32_t bi = 0; bi < blocks.size(); bi++) {
+            bytes += block_size(block_cells(bi)) / blocks[bi]->refs.load(std::memory_order_relaxed);
+        }
+        return bytes;
+    }
+
+  private:
+
+    struct block {
+        std::atomic<uint32_t> refs;
+        // cells follow the header
+    };
+
+    static_assert(alignof(T) <= alignof(block), "cow_board cells must not need more alignment than the block header");
+
+    uint32_t w;
+    uint32_t h;
+    std::vector<block*> blocks;
+
+    uint32_t block_cells(uint32_t bi) const
+    {
+        uint32_t rows = h - bi * BLOCK_ROWS;
+        return (rows < BLOCK_ROWS ? rows : BLOCK_ROWS) * w;
+    }
+
+    static size_t block_size(uint32_t cells)
+    {
+        return sizeof(block) + cells * sizeof(T);
+    }
+
+    static T* block_data(block* b)
+    {
+        return (T*)(b + 1);
+    }
+
+    static const T* block_data(const block* b)
+    {
+        return (const T*)(b + 1);
+    }
+
+    static block* block_alloc(uint32_t cells)
+    {
+        void* mem = malloc(block_size(cells));
+        if (mem == NULL) {
+            return NULL;
+        }
+        block* b = new (mem) block();
+        b->refs.store(1, std::memory_order_relaxed);
+        return b;
+    }
+
+    static void block_release(block* b)
+    {
+        if (b->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            b->~block();
+            free(b);
+        }
+    }
+
+    // makes sure this board is the only owner of block bi, returns it or NULL on oom
+    block* unshare(uint32_t bi)
+    {
+        block* b = blocks[bi];
+        if (b->refs.load(std::memory_order_acquire) == 1) {
+            return b;
+        }
+        block* nb = block_alloc(block_cells(bi));
+        if (nb == NULL) {
+            return NULL;
+        }
+        memcpy(block_data(nb), block_data(b), block_cells(bi) * sizeof(T));
+        block_release(b);
+        blocks[bi] = nb;
+        return nb;
+    }
+
+    void release_all()
+    {
+        for (block* b : blocks) {
+            block_release(b);
+        }
+        blocks.clear();
+    }
+};
@@ -14,6 +14,11 @@
 
 #include "surena/games/havannah.h"
 
+#include "games/change_journal.hpp"
+#include "games/cow_board.hpp"
+#include "games/row_render.hpp"
+#include "games/undo_history.hpp"
+
 // general purpose helpers for opts, data, bufs
 
 namespace {
@@ -23,14 +28,43 @@ namespace {
         char* state;
         player_id* players_to_move;
         move_data* concrete_moves;
+        move_code* concrete_move_codes;
         player_id* results;
         move_data_sync move_out;
         char* move_str;
         char* print;
+        char* state_delta;
+        // rows of state and print that have to be rendered again, every board row is one row of both
+        row_render state_rows;
+        row_render print_rows;
     };
 
     typedef havannah_options opts_repr;
 
+    // everything a move overwrites besides the placed tile, so unmake_move can restore it
+    struct undo_entry {
+        int remaining_tiles;
+        HAVANNAH_PLAYER current_player;
+        HAVANNAH_PLAYER winning_player;
+        uint8_t next_graph_id;
+        bool pie_swap;
+        uint16_t swap_target;
+        // pre move copies of the root graphs next to the placed tile, roots are their own parent so that is also their key
+        uint8_t graph_count;
+        havannah_graph graphs[6];
+    };
+
+    // every move writes one cell, so the journal reaches back over the same number of cells and moves
+    const uint32_t JOURNAL_CELLS = 64;
+
+    // fixed export buffer sizes, for create_bufs, memory_usage and the _into size checks
+    const size_t OPTIONS_STR_SIZE = 16;
+    const size_t MOVE_STR_SIZE = 5; // "swap" or e.g. "a10"
+    const size_t PRINT_STR_SIZE = 1024; //TODO this may easily overflow on very large boards
+
+    // neighbor offsets as {dx, dy}, in the same order as set_cell discovers them
+    const int NEIGHBOR_OFFSETS[6][2] = {{-1, -1}, {-1, 0}, {0, 1}, {1, 1}, {1, 0}, {0, -1}};
+
     struct state_repr {
         int board_sizer; // 2 * size - 1
 
@@ -43,9 +77,39 @@ namespace {
         // assuming a flat topped board this is [letter * num]
         // such that num goes vertically on the left downwards
         // and letter goes ascending horizontally towards the right
-        std::vector<std::vector<havannah_tile>> gameboard;
+        // clones share the board blocks, only blocks written afterwards are copied, see cow_board
+        cow_board<havannah_tile> gameboard;
         bool pie_swap; // if this is true while it is blacks turn, they may swap move to mirror it as theirs, then set false even if not used
         uint16_t swap_target;
+        undo_history<undo_entry> undo_stack; // one entry per move made while unmake_history is set, cleared on import, copies of the state start without it
+        // zobrist key of the stones under each of the 12 symmetries of the hexagon (see sym_cell), for canonical_id
+        // every write of a tile color has to go through update_sym_keys
+        uint64_t sym_keys[12];
+        // cells written by the most recent moves, for export_state_delta, every write of a tile color has to touch it
+        change_journal<JOURNAL_CELLS, JOURNAL_CELLS> changes;
+    };
+
+    // struct-of-arrays storage of a game_batch, cells are the bits (y * stride + x) of bit planes
+    // stride is board_sizer + 1, so every neighbor is a plain shift and row wraps land in the padding column, which is never a cell
+    // move indices are the cell bits, followed by the swap
+    const uint32_t BATCH_MAX_WORDS = 16; // u64 words per plane, enough for size 16
+
+    struct batch_data {
+        opts_repr opts;
+        int board_sizer;
+        int stride;
+        uint32_t words; // per plane
+        uint64_t valid[BATCH_MAX_WORDS]; // cells of the board
+        uint64_t border[BATCH_MAX_WORDS]; // cells with an off board neighbor, an enclosed area never contains one
+        uint64_t edges[6][BATCH_MAX_WORDS]; // edge cells, without the corners
+        uint32_t corners[6]; // bits of the corner cells
+        uint64_t* planes[2]; // stones of white and black, words per instance
+        HAVANNAH_PLAYER* current_player;
+        HAVANNAH_PLAYER* winning_player;
+        int* remaining_tiles;
+        bool* pie_swap;
+        uint16_t* swap_target;
+        move_code* move_codes;
     };
 
     struct game_data {
@@ -69,6 +133,32 @@ namespace {
         return ((game_data*)(self->data1))->state;
     }
 
+    uint64_t zobrist_noise(int cell, HAVANNAH_PLAYER p)
+    {
+        int32_t pos = cell * 4 + p;
+        return ((uint64_t)squirrelnoise5(pos, 0x5EED) << 32) | (uint64_t)squirrelnoise5(pos, 0x5EEE);
+    }
+
+    // zobrist keys as [cell][player] up to size 16, the board cells are followed by the 3 side keys of canonical_id
+    // built once, so keeping the 12 symmetry keys up to date is only lookups, larger boards compute their keys on the fly
+    const int ZOBRIST_CELLS = 31 * 31 + 3;
+
+    struct zobrist_table {
+        uint64_t keys[ZOBRIST_CELLS][4];
+
+        zobrist_table()
+        {
+            for (int cell = 0; cell < ZOBRIST_CELLS; cell++) {
+                keys[cell][HAVANNAH_PLAYER_NONE] = 0; // the empty cell has none
+                for (int p = HAVANNAH_PLAYER_WHITE; p <= HAVANNAH_PLAYER_INVALID; p++) {
+                    keys[cell][p] = zobrist_noise(cell, (HAVANNAH_PLAYER)p);
+                }
+            }
+        }
+    };
+
+    const zobrist_table zobrist;
+
 } // namespace
 
 #ifdef __cplusplus
@@ -82,9 +172,28 @@ static error_code set_cell_gf(game* self, int x, int y, HAVANNAH_PLAYER p, bool*
 static error_code get_size_gf(game* self, int* size);
 static error_code can_swap_gf(game* self, bool* swap_available);
 
+// the setters handed out in the internal methods, these drop the wrapper query cache before writing
+static error_code ext_set_cell_gf(game* self, int x, int y, HAVANNAH_PLAYER p, bool* wins);
+
+// impl hidden helpers
+static error_code create_bufs(game* self);
+static uint32_t cell_count(game* self);
+static size_t state_str_size(game* self);
+static size_t state_delta_str_size(game* self);
+static size_t state_row(game* self, int y, char* str);
+static size_t state_flags(game* self, char* str);
+static size_t print_row(game* self, int y, char* str);
+static void invalidate_rows(game* self, int y_first, int y_last);
+static int sym_cell(game* self, int t, int x, int y);
+static uint64_t zobrist_key(int cell, HAVANNAH_PLAYER p);
+static void update_sym_keys(game* self, int x, int y, HAVANNAH_PLAYER from, HAVANNAH_PLAYER to);
+static void plane_dilate(const batch_data* bd, const uint64_t* src, uint64_t* dst);
+static void plane_flood(const batch_data* bd, uint64_t* seed, const uint64_t* area);
+static bool batch_move_wins(const batch_data* bd, const uint64_t* own, uint32_t cell);
+
 static const havannah_internal_methods havannah_gbe_internal_methods{
     .get_cell = get_cell_gf,
-    .set_cell = set_cell_gf,
+    .set_cell = ext_set_cell_gf,
     .get_size = get_size_gf,
     .can_swap = can_swap_gf,
 };
@@ -97,8 +206,16 @@ static const havannah_internal_methods havannah_gbe_internal_methods{
 #define SURENA_GDD_VERSION ((semver){1, 0, 0})
 #define SURENA_GDD_INTERNALS &havannah_gbe_internal_methods
 #define SURENA_GDD_FF_OPTIONS
+#define SURENA_GDD_FF_MEMORY_USAGE
+#define SURENA_GDD_FF_EXPORT_STATE_DELTA
+#define SURENA_GDD_FF_UNMAKE_MOVE
+#define SURENA_GDD_FF_CANONICAL_ID
+#define SURENA_GDD_FF_LAZY_MOVES
+#define SURENA_GDD_FF_MOVE_CODES
+#define SURENA_GDD_FF_QUERY_INTO
 #define SURENA_GDD_FF_PLAYOUT
 #define SURENA_GDD_FF_PRINT
+#define SURENA_GDD_FF_BATCH
 #include "surena/game_decldef.h"
 
 // implementation
@@ -134,24 +251,9 @@ static error_code create_gf(game* self, game_init* init_info)
     state_repr& data = get_repr(self);
     data.board_sizer = 2 * opts.size - 1;
 
-    {
-        export_buffers& bufs = get_bufs(self);
-        bufs.options = (char*)malloc(16 * sizeof(char));
-        bufs.state = (char*)malloc((3 * opts.size * opts.size - (3 * opts.size - 1) + data.board_sizer + 5) * sizeof(char));
-        bufs.players_to_move = (player_id*)malloc(1 * sizeof(player_id));
-        bufs.concrete_moves = (move_data*)malloc((3 * opts.size * opts.size - (3 * opts.size - 1)) * sizeof(move_data));
-        bufs.results = (player_id*)malloc(1 * sizeof(player_id));
-        bufs.move_str = (char*)malloc(4 * sizeof(char));
-        bufs.print = (char*)malloc(1024 * sizeof(char)); //TODO this may easily overflow on very large boards
-        if (bufs.state == NULL ||
-            bufs.players_to_move == NULL ||
-            bufs.concrete_moves == NULL ||
-            bufs.results == NULL ||
-            bufs.move_str == NULL ||
-            bufs.print == NULL) {
-            destroy_gf(self);
-            return ERR_OUT_OF_MEMORY;
-        }
+    error_code ec = create_bufs(self);
+    if (ec != ERR_OK) {
+        return ec;
     }
     const char* initial_state = NULL;
     if (init_info->source_type == GAME_INIT_SOURCE_TYPE_STANDARD) {
@@ -168,9 +270,11 @@ static error_code destroy_gf(game* self)
         free(bufs.state);
         free(bufs.players_to_move);
         free(bufs.concrete_moves);
+        free(bufs.concrete_move_codes);
         free(bufs.results);
         free(bufs.move_str);
         free(bufs.print);
+        free(bufs.state_delta);
     }
     delete (game_data*)self->data1;
     // free(self->data); // not required in the vector+map version
@@ -180,33 +284,46 @@ static error_code destroy_gf(game* self)
 
 static error_code clone_gf(game* self, game* clone_target)
 {
-    size_t size_fill;
-    const char* opts_export;
-    export_options_gf(self, PLAYER_NONE, &size_fill, &opts_export);
     clone_target->methods = self->methods;
-    export_buffers& bufs = get_bufs(self);
-    game_init init_info = (game_init){
-        .source_type = GAME_INIT_SOURCE_TYPE_STANDARD,
-        .source = {
-            .standard = {
-                .opts = opts_export,
-                .legacy = NULL,
-                .state = NULL,
-            },
-        },
-    };
-    error_code ec = create_gf(clone_target, &init_info);
-    if (ec != ERR_OK) {
-        return ec;
+    // the copied state shares all board blocks with self, so the clone only pays for the blocks it writes later on
+    clone_target->data1 = malloc(sizeof(game_data));
+    if (clone_target->data1 == NULL) {
+        return ERR_OUT_OF_MEMORY;
     }
-    copy_from_gf(clone_target, self);
-    return ERR_OK;
+    new (clone_target->data1) game_data(*(game_data*)self->data1);
+    clone_target->data2 = NULL;
+    return create_bufs(clone_target);
 }
 
 static error_code copy_from_gf(game* self, game* other)
 {
     get_opts(self) = get_opts(other);
     get_repr(self) = get_repr(other);
+    get_bufs(self).state_rows.invalidate_all();
+    get_bufs(self).print_rows.invalidate_all();
+    return ERR_OK;
+}
+
+static error_code memory_usage_gf(game* self, size_t* ret_state, size_t* ret_buffers)
+{
+    state_repr& data = get_repr(self);
+    size_t state_size = sizeof(game_data);
+    // map nodes are approximated as their value plus one next pointer
+    state_size += data.graph_map.bucket_count() * sizeof(void*);
+    state_size += data.graph_map.size() * (sizeof(std::pair<const uint8_t, havannah_graph>) + sizeof(void*));
+    state_size += data.gameboard.memory_usage() - sizeof(cow_board<havannah_tile>);
+    state_size += data.undo_stack.capacity() * sizeof(undo_entry);
+    *ret_state = state_size;
+    export_buffers& bufs = get_bufs(self);
+    *ret_buffers = bufs.state_rows.memory_usage() + bufs.print_rows.memory_usage() +
+                   OPTIONS_STR_SIZE * sizeof(char) +
+                   state_str_size(self) * sizeof(char) +
+                   1 * sizeof(player_id) +
+                   cell_count(self) * (sizeof(move_data) + sizeof(move_code)) +
+                   1 * sizeof(player_id) +
+                   MOVE_STR_SIZE * sizeof(char) +
+                   PRINT_STR_SIZE * sizeof(char) +
+                   state_delta_str_size(self) * sizeof(char);
     return ERR_OK;
 }
 
@@ -236,84 +353,53 @@ static error_code player_count_gf(game* self, uint8_t* ret_count)
 
 static error_code export_state_gf(game* self, player_id player, size_t* ret_size, const char** ret_str)
 {
+    // only the rows changed since the last export are rendered again, the player flags are cheap enough to always append
     export_buffers& bufs = get_bufs(self);
+    state_repr& data = get_repr(self);
     char* outbuf = bufs.state;
-    if (outbuf == NULL) {
-        return ERR_INVALID_INPUT;
-    }
-    opts_repr& opts = get_opts(self);
+    outbuf += bufs.state_rows.update(bufs.state, data.board_sizer, data.board_sizer + 1, [self](uint32_t y, char* str) {
+        return state_row(self, y, str);
+    });
+    outbuf += state_flags(self, outbuf);
+    *ret_size = outbuf - bufs.state;
+    *ret_str = bufs.state;
+    return ERR_OK;
+}
+
+static error_code export_state_delta_gf(game* self, uint64_t since_sync_ctr, size_t* ret_size, const char** ret_str)
+{
+    export_buffers& bufs = get_bufs(self);
     state_repr& data = get_repr(self);
-    const char* ostr = outbuf;
-    HAVANNAH_PLAYER cell_player;
-    for (int y = 0; y < data.board_sizer; y++) {
-        int empty_cells = 0;
-        for (int x = 0; x < data.board_sizer; x++) {
-            if (!((x - y < opts.size) && (y - x < opts.size))) {
-                continue;
-            }
-            get_cell_gf(self, x, y, &cell_player);
-            if (cell_player == PLAYER_NONE) {
-                empty_cells++;
-            } else {
-                // if the current cell isnt empty, print its representation, before that print empty cells, if any
-                if (empty_cells > 0) {
-                    outbuf += sprintf(outbuf, "%d", empty_cells);
-                    empty_cells = 0;
-                }
-                outbuf += sprintf(outbuf, "%c", (cell_player == HAVANNAH_PLAYER_WHITE ? 'O' : 'X'));
-            }
-        }
-        if (empty_cells > 0) {
-            outbuf += sprintf(outbuf, "%d", empty_cells);
-        }
-        if (y < data.board_sizer - 1) {
-            outbuf += sprintf(outbuf, "/");
-        }
-    }
-    // current player
-    uint8_t ptm_count;
-    const player_id* ptm_buf;
-    players_to_move_gf(self, &ptm_count, &ptm_buf);
-    player_id ptm;
-    if (ptm_count == 0) {
-        ptm = HAVANNAH_PLAYER_NONE;
-    } else {
-        ptm = ptm_buf[0];
-    }
-    switch (ptm) {
-        case HAVANNAH_PLAYER_NONE: {
-            outbuf += sprintf(outbuf, " -");
-        } break;
-        case HAVANNAH_PLAYER_WHITE: {
-            outbuf += sprintf(outbuf, " O");
-        } break;
-        case HAVANNAH_PLAYER_BLACK: {
-            outbuf += sprintf(outbuf, " X");
-        } break;
+    char* outbuf = bufs.state_delta;
+    bool available = data.changes.changes_since(since_sync_ctr, self->sync_ctr, [&](uint16_t cell) {
+        int x = (cell >> 8) & 0xFF;
+        int y = cell & 0xFF;
+        outbuf += sprintf(outbuf, "%s%c%i%c", (outbuf == bufs.state_delta ? "" : ","), 'a' + x, y, HAVANNAH_PLAYER_CHARS[data.gameboard.get(x, y).color]);
+    });
+    if (available == false) {
+        *ret_size = 0;
+        *ret_str = NULL;
+        return ERR_OK;
     }
-    // result player
-    uint8_t res_count;
-    const player_id* res_buf;
-    get_results_gf(self, &res_count, &res_buf);
-    player_id res;
-    if (res_count == 0) {
-        res = HAVANNAH_PLAYER_NONE;
-    } else {
-        res = res_buf[0];
+    outbuf += state_flags(self, outbuf);
+    *ret_size = outbuf - bufs.state_delta;
+    *ret_str = bufs.state_delta;
+    return ERR_OK;
+}
+
+static error_code export_state_into_gf(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < state_str_size(self)) {
+        *ret_size = state_str_size(self);
+        return ERR_OUT_OF_MEMORY;
     }
-    switch (res) {
-        case HAVANNAH_PLAYER_NONE: {
-            outbuf += sprintf(outbuf, " -");
-        } break;
-        case HAVANNAH_PLAYER_WHITE: {
-            outbuf += sprintf(outbuf, " O");
-        } break;
-        case HAVANNAH_PLAYER_BLACK: {
-            outbuf += sprintf(outbuf, " X");
-        } break;
+    char* outbuf = str;
+    state_repr& data = get_repr(self);
+    for (int y = 0; y < data.board_sizer; y++) {
+        outbuf += state_row(self, y, outbuf);
     }
-    *ret_size = outbuf - ostr;
-    *ret_str = bufs.state;
+    outbuf += state_flags(self, outbuf);
+    *ret_size = outbuf - str;
     return ERR_OK;
 }
 
@@ -326,16 +412,20 @@ static error_code import_state_gf(game* self, const char* str)
     data.winning_player = HAVANNAH_PLAYER_INVALID;
     data.graph_map.clear();
     data.next_graph_id = 1;
-    data.gameboard.clear();
-    data.gameboard.reserve(data.board_sizer);
     data.pie_swap = opts.pie_swap;
+    data.undo_stack.clear();
+    data.changes.clear();
+    memset(data.sym_keys, 0, sizeof(data.sym_keys));
+    if (data.gameboard.reset(data.board_sizer, data.board_sizer, havannah_tile{HAVANNAH_PLAYER_INVALID, 0}) == false) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    get_bufs(self).state_rows.invalidate_all();
+    get_bufs(self).print_rows.invalidate_all();
+    // the board was just reset, so it is unshared and writes can not fail
     for (int iy = 0; iy < data.board_sizer; iy++) {
-        std::vector<havannah_tile> tile_row_vector{};
-        tile_row_vector.resize(data.board_sizer, havannah_tile{HAVANNAH_PLAYER_INVALID, 0});
-        data.gameboard.push_back(std::move(tile_row_vector));
         for (int ix = 0; ix < data.board_sizer; ix++) {
             if ((ix - iy < opts.size) && (iy - ix < opts.size)) { // magic formula for only enabling valid cells of the board
-                data.gameboard[iy][ix].color = HAVANNAH_PLAYER_NONE;
+                data.gameboard.mut(ix, iy)->color = HAVANNAH_PLAYER_NONE;
             }
         }
     }
@@ -470,40 +560,114 @@ static error_code import_state_gf(game* self, const char* str)
 
 static error_code players_to_move_gf(game* self, uint8_t* ret_count, const player_id** ret_players)
 {
-    *ret_count = 1;
+    export_buffers& bufs = get_bufs(self);
+    players_to_move_into_gf(self, 1, ret_count, bufs.players_to_move);
+    *ret_players = bufs.players_to_move;
+    return ERR_OK;
+}
+
+static error_code players_to_move_into_gf(game* self, uint8_t cap, uint8_t* ret_count, player_id* players)
+{
+    if (cap < 1) {
+        *ret_count = 1;
+        return ERR_OUT_OF_MEMORY;
+    }
     state_repr& data = get_repr(self);
     player_id ptm = data.current_player;
     if (ptm == HAVANNAH_PLAYER_NONE) {
         *ret_count = 0;
         return ERR_OK;
     }
-    export_buffers& bufs = get_bufs(self);
-    player_id* outbuf = bufs.players_to_move;
-    *outbuf = ptm;
-    *ret_players = outbuf;
+    *ret_count = 1;
+    *players = ptm;
     return ERR_OK;
 }
 
 static error_code get_concrete_moves_gf(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves)
 {
     export_buffers& bufs = get_bufs(self);
-    move_data* outbuf = bufs.concrete_moves;
+    get_concrete_moves_into_gf(self, player, cell_count(self), ret_count, bufs.concrete_moves);
+    *ret_moves = bufs.concrete_moves;
+    return ERR_OK;
+}
+
+static error_code get_concrete_moves_into_gf(game* self, player_id player, uint32_t cap, uint32_t* ret_count, move_data* moves)
+{
+    if (cap < cell_count(self)) {
+        *ret_count = cell_count(self);
+        return ERR_OUT_OF_MEMORY;
+    }
+    state_repr& data = get_repr(self);
+    uint32_t move_cnt = 0;
+    for (int iy = 0; iy < data.board_sizer; iy++) {
+        for (int ix = 0; ix < data.board_sizer; ix++) {
+            if (data.gameboard.get(ix, iy).color == HAVANNAH_PLAYER_NONE) {
+                moves[move_cnt++] = game_e_create_move_small((ix << 8) | iy);
+            }
+        }
+    }
+    if (data.pie_swap == true && data.current_player == HAVANNAH_PLAYER_BLACK) {
+        moves[move_cnt++] = game_e_create_move_small(HAVANNAH_MOVE_SWAP);
+    }
+    *ret_count = move_cnt;
+    return ERR_OK;
+}
+
+static error_code get_concrete_moves_codes_gf(game* self, player_id player, uint32_t* ret_count, const move_code** ret_moves)
+{
+    export_buffers& bufs = get_bufs(self);
+    move_code* outbuf = bufs.concrete_move_codes;
     opts_repr& opts = get_opts(self);
     state_repr& data = get_repr(self);
     uint32_t move_cnt = 0;
     for (int iy = 0; iy < data.board_sizer; iy++) {
         for (int ix = 0; ix < data.board_sizer; ix++) {
-            if (data.gameboard[iy][ix].color == HAVANNAH_PLAYER_NONE) {
+            if (data.gameboard.get(ix, iy).color == HAVANNAH_PLAYER_NONE) {
                 // add the free tile to the return vector
-                outbuf[move_cnt++] = game_e_create_move_small((ix << 8) | iy);
+                outbuf[move_cnt++] = (ix << 8) | iy;
             }
         }
     }
     if (data.pie_swap == true && data.current_player == HAVANNAH_PLAYER_BLACK) {
-        outbuf[move_cnt++] = game_e_create_move_small(HAVANNAH_MOVE_SWAP);
+        outbuf[move_cnt++] = HAVANNAH_MOVE_SWAP;
     }
     *ret_count = move_cnt;
-    *ret_moves = bufs.concrete_moves;
+    *ret_moves = bufs.concrete_move_codes;
+    return ERR_OK;
+}
+
+static error_code get_moves_begin_gf(game* self, player_id player, move_iterator* it)
+{
+    // stage 0 walks the cells with idx as (y * board_sizer + x), stage 1 offers the swap
+    it->player = player;
+    it->stage = 0;
+    it->idx = 0;
+    return ERR_OK;
+}
+
+static error_code get_moves_next_gf(game* self, move_iterator* it, bool* ret_done, move_data* ret_move)
+{
+    state_repr& data = get_repr(self);
+    if (it->stage == 0) {
+        uint32_t cell_count = data.board_sizer * data.board_sizer;
+        while (it->idx < cell_count) {
+            int ix = it->idx % data.board_sizer;
+            int iy = it->idx / data.board_sizer;
+            it->idx++;
+            if (data.gameboard.get(ix, iy).color == HAVANNAH_PLAYER_NONE) {
+                *ret_done = false;
+                *ret_move = game_e_create_move_small((ix << 8) | iy);
+                return ERR_OK;
+            }
+        }
+        it->stage = 1;
+        if (data.pie_swap == true && data.current_player == HAVANNAH_PLAYER_BLACK) {
+            *ret_done = false;
+            *ret_move = game_e_create_move_small(HAVANNAH_MOVE_SWAP);
+            return ERR_OK;
+        }
+    }
+    *ret_done = true;
     return ERR_OK;
 }
 
@@ -528,7 +692,10 @@ static error_code is_legal_move_gf(game* self, player_id player, move_data_sync
     }
     int ix = (mcode >> 8) & 0xFF;
     int iy = mcode & 0xFF;
-    if (data.gameboard[iy][ix].color != HAVANNAH_PLAYER_NONE) {
+    if (mcode > 0xFFFF || ix >= data.board_sizer || iy >= data.board_sizer) {
+        return ERR_INVALID_INPUT;
+    }
+    if (data.gameboard.get(ix, iy).color != HAVANNAH_PLAYER_NONE) {
         return ERR_INVALID_INPUT;
     }
     return ERR_OK;
@@ -539,15 +706,63 @@ static error_code make_move_gf(game* self, player_id player, move_data_sync move
     state_repr& data = get_repr(self);
     move_code mcode = move.md.cl.code;
 
+    // unshare the block of the written cell before changing anything, so running out of memory leaves the state as is
+    uint16_t written_cell = (mcode == HAVANNAH_MOVE_SWAP ? data.swap_target : mcode);
+    if (data.gameboard.mut((written_cell >> 8) & 0xFF, written_cell & 0xFF) == NULL) {
+        return ERR_OUT_OF_MEMORY;
+    }
+
+    if (self->unmake_history == true) {
+        undo_entry ue;
+        ue.remaining_tiles = data.remaining_tiles;
+        ue.current_player = data.current_player;
+        ue.winning_player = data.winning_player;
+        ue.next_graph_id = data.next_graph_id;
+        ue.pie_swap = data.pie_swap;
+        ue.swap_target = data.swap_target;
+        ue.graph_count = 0;
+        if (mcode != HAVANNAH_MOVE_SWAP) {
+            // set_cell only ever writes to the roots of same colored neighbors, or a fresh graph
+            int tx = (mcode >> 8) & 0xFF;
+            int ty = mcode & 0xFF;
+            for (int i = 0; i < 6; i++) {
+                HAVANNAH_PLAYER np;
+                get_cell_gf(self, tx + NEIGHBOR_OFFSETS[i][0], ty + NEIGHBOR_OFFSETS[i][1], &np);
+                if (np != data.current_player) {
+                    continue;
+                }
+                uint8_t root_id = data.gameboard.get(tx + NEIGHBOR_OFFSETS[i][0], ty + NEIGHBOR_OFFSETS[i][1]).parent_graph_id;
+                while (root_id != data.graph_map[root_id].parent_graph_id) {
+                    root_id = data.graph_map[root_id].parent_graph_id;
+                }
+                bool known = false;
+                for (int j = 0; j < ue.graph_count; j++) {
+                    known |= (ue.graphs[j].parent_graph_id == root_id);
+                }
+                if (!known) {
+                    ue.graphs[ue.graph_count++] = data.graph_map[root_id];
+                }
+            }
+        }
+        data.undo_stack.push_back(ue);
+    } else {
+        data.undo_stack.clear(); // the recorded moves can not be unmade past this one
+    }
+    data.changes.begin_move(self->sync_ctr);
+
     if (mcode == HAVANNAH_MOVE_SWAP) {
         // use swap target to give whites move to black
         int sx = (data.swap_target >> 8) & 0xFF;
         int sy = data.swap_target & 0xFF;
 
-        data.gameboard[sy][sx].color = HAVANNAH_PLAYER_BLACK;
+        update_sym_keys(self, sx, sy, HAVANNAH_PLAYER_WHITE, HAVANNAH_PLAYER_BLACK);
+        data.gameboard.mut(sx, sy)->color = HAVANNAH_PLAYER_BLACK;
+        data.changes.touch(data.swap_target);
+        invalidate_rows(self, sy, sy);
 
         data.pie_swap = false;
         data.current_player = HAVANNAH_PLAYER_WHITE;
+        data.changes.end_move();
         return ERR_OK;
     }
 
@@ -566,6 +781,7 @@ static error_code make_move_gf(game* self, player_id player, move_data_sync move
     bool wins;
     // set cell updates graph structures in the backend, and informs us if this move is winning for the current player
     set_cell_gf(self, tx, ty, data.current_player, &wins);
+    data.changes.end_move();
 
     // if current player is winner set appropriate state
     if (wins) {
@@ -590,6 +806,45 @@ static error_code make_move_gf(game* self, player_id player, move_data_sync move
     return ERR_OK;
 }
 
+static error_code unmake_move_gf(game* self, player_id player, move_data_sync move)
+{
+    state_repr& data = get_repr(self);
+    if (data.undo_stack.empty()) {
+        // no made move known, e.g. after an import
+        return ERR_INVALID_INPUT;
+    }
+    undo_entry& ue = data.undo_stack.back();
+    move_code mcode = move.md.cl.code;
+    uint16_t written_cell = (mcode == HAVANNAH_MOVE_SWAP ? ue.swap_target : mcode);
+    // the state goes back to a sync_ctr that clients may have seen with a different state, so no delta can start from there
+    data.changes.clear();
+    havannah_tile* tile = data.gameboard.mut((written_cell >> 8) & 0xFF, written_cell & 0xFF);
+    if (tile == NULL) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    invalidate_rows(self, written_cell & 0xFF, written_cell & 0xFF);
+    update_sym_keys(self, (written_cell >> 8) & 0xFF, written_cell & 0xFF, tile->color, (mcode == HAVANNAH_MOVE_SWAP ? HAVANNAH_PLAYER_WHITE : HAVANNAH_PLAYER_NONE));
+    if (mcode == HAVANNAH_MOVE_SWAP) {
+        tile->color = HAVANNAH_PLAYER_WHITE;
+    } else {
+        *tile = havannah_tile{HAVANNAH_PLAYER_NONE, 0};
+        for (int i = 0; i < ue.graph_count; i++) {
+            data.graph_map[ue.graphs[i].parent_graph_id] = ue.graphs[i];
+        }
+        if (data.next_graph_id != ue.next_graph_id) {
+            data.graph_map.erase(ue.next_graph_id);
+        }
+    }
+    data.remaining_tiles = ue.remaining_tiles;
+    data.current_player = ue.current_player;
+    data.winning_player = ue.winning_player;
+    data.next_graph_id = ue.next_graph_id;
+    data.pie_swap = ue.pie_swap;
+    data.swap_target = ue.swap_target;
+    data.undo_stack.pop_back();
+    return ERR_OK;
+}
+
 static error_code get_results_gf(game* self, uint8_t* ret_count, const player_id** ret_players)
 {
     export_buffers& bufs = get_bufs(self);
@@ -605,9 +860,27 @@ static error_code get_results_gf(game* self, uint8_t* ret_count, const player_id
     return ERR_OK;
 }
 
-static error_code playout_gf(game* self, uint64_t seed)
+static error_code canonical_id_gf(game* self, uint64_t* ret_id, uint8_t* ret_transform)
 {
-    uint32_t ctr = 0;
+    state_repr& data = get_repr(self);
+    // players and the swap rule look the same in every image, the extra cell idxs keep their keys apart from the board
+    // while the swap is available its target is the only white stone, so it moves with the image on its own
+    int cells = data.board_sizer * data.board_sizer;
+    uint64_t side_key = zobrist_key(cells, data.current_player) ^ zobrist_key(cells + 1, data.winning_player) ^ zobrist_key(cells + 2, data.pie_swap ? HAVANNAH_PLAYER_WHITE : HAVANNAH_PLAYER_NONE);
+    *ret_id = data.sym_keys[0] ^ side_key;
+    *ret_transform = 0;
+    for (uint8_t t = 1; t < 12; t++) {
+        if ((data.sym_keys[t] ^ side_key) < *ret_id) {
+            *ret_id = data.sym_keys[t] ^ side_key;
+            *ret_transform = t;
+        }
+    }
+    return ERR_OK;
+}
+
+static error_code playout_gf(game* self, seed128 seed)
+{
+    game_rng rng = game_e_rng_create(seed, 0);
     uint32_t moves_count;
     const move_data* moves;
     uint8_t ptm_count;
@@ -615,7 +888,7 @@ static error_code playout_gf(game* self, uint64_t seed)
     players_to_move_gf(self, &ptm_count, &ptm);
     while (ptm_count > 0) {
         get_concrete_moves_gf(self, ptm[0], &moves_count, &moves);
-        make_move_gf(self, ptm[0], game_e_move_make_sync(self, moves[squirrelnoise5(ctr++, seed) % moves_count])); //BUG this has modulo bias, use proper rand_intn
+        make_move_gf(self, ptm[0], game_e_move_make_sync(self, moves[game_e_rng_intn(&rng, moves_count)]));
         players_to_move_gf(self, &ptm_count, &ptm);
     }
     return ERR_OK;
@@ -662,28 +935,52 @@ static error_code get_move_data_gf(game* self, player_id player, const char* str
 static error_code get_move_str_gf(game* self, player_id player, move_data_sync move, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
-    char* outbuf = bufs.move_str;
+    error_code ec = get_move_str_into_gf(self, player, move, MOVE_STR_SIZE, ret_size, bufs.move_str);
+    *ret_str = bufs.move_str;
+    return ec;
+}
+
+static error_code get_move_str_into_gf(game* self, player_id player, move_data_sync move, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < MOVE_STR_SIZE) {
+        *ret_size = MOVE_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
+    }
     move_code mcode = move.md.cl.code;
     if (mcode == MOVE_NONE) {
-        *ret_size = sprintf(outbuf, "-");
+        *ret_size = sprintf(str, "-");
         return ERR_OK;
     }
     opts_repr& opts = get_opts(self);
     if (opts.pie_swap == true && mcode == HAVANNAH_MOVE_SWAP) {
-        *ret_size = sprintf(outbuf, "swap");
+        *ret_size = sprintf(str, "swap");
         return ERR_OK;
     }
     int x = (mcode >> 8) & 0xFF;
     int y = mcode & 0xFF;
-    *ret_size = sprintf(outbuf, "%c%i", 'a' + x, y);
-    *ret_str = bufs.move_str;
+    *ret_size = sprintf(str, "%c%i", 'a' + x, y);
     return ERR_OK;
 }
 
 static error_code print_gf(game* self, player_id player, size_t* ret_size, const char** ret_str)
 {
+    // same as the horizontal layout of print_into, but only the rows changed since the last print are rendered again
     export_buffers& bufs = get_bufs(self);
-    char* outbuf = bufs.print;
+    state_repr& data = get_repr(self);
+    *ret_size = bufs.print_rows.update(bufs.print, data.board_sizer, 3 * data.board_sizer + 1, [self](uint32_t y, char* str) {
+        return print_row(self, y, str);
+    });
+    *ret_str = bufs.print;
+    return ERR_OK;
+}
+
+static error_code print_into_gf(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < PRINT_STR_SIZE) {
+        *ret_size = PRINT_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
+    }
+    char* outbuf = str;
     opts_repr& opts = get_opts(self);
     state_repr& data = get_repr(self);
     const char* ostr = outbuf;
@@ -692,7 +989,7 @@ static error_code print_gf(game* self, player_id player, size_t* ret_size, const
             // square printing of the full gameboard matrix
             for (int iy = 0; iy < data.board_sizer; iy++) {
                 for (int ix = 0; ix < data.board_sizer; ix++) {
-                    outbuf += sprintf(outbuf, "%c", HAVANNAH_PLAYER_CHARS[data.gameboard[iy][ix].color]);
+                    outbuf += sprintf(outbuf, "%c", HAVANNAH_PLAYER_CHARS[data.gameboard.get(ix, iy).color]);
                 }
                 outbuf += sprintf(outbuf, "\n");
             }
@@ -705,16 +1002,7 @@ static error_code print_gf(game* self, player_id player, size_t* ret_size, const
                  x x
                 */
             for (int iy = 0; iy < data.board_sizer; iy++) {
-                int padding_count = (iy <= opts.size - 1) ? (opts.size - 1) - iy : iy - (opts.size - 1);
-                for (int ip = 0; ip < padding_count; ip++) {
-                    outbuf += sprintf(outbuf, " ");
-                }
-                for (int ix = 0; ix < data.board_sizer; ix++) {
-                    if ((ix - iy < opts.size) && (iy - ix < opts.size)) {
-                        outbuf += sprintf(outbuf, " %c", HAVANNAH_PLAYER_CHARS[data.gameboard[iy][ix].color]);
-                    }
-                }
-                outbuf += sprintf(outbuf, "\n");
+                outbuf += print_row(self, iy, outbuf);
             }
             break;
         case 2:
@@ -735,12 +1023,12 @@ static error_code print_gf(game* self, player_id player, size_t* ret_size, const
                     outbuf += sprintf(outbuf, "    ");
                 }
                 while (r <= r_end) {
-                    if (data.gameboard[r][sum - r].color == HAVANNAH_PLAYER_INVALID) {
+                    if (data.gameboard.get(sum - r, r).color == HAVANNAH_PLAYER_INVALID) {
                         outbuf += sprintf(outbuf, "        ");
                         r++;
                         continue;
                     }
-                    outbuf += sprintf(outbuf, "%c       ", HAVANNAH_PLAYER_CHARS[data.gameboard[r][sum - r].color]);
+                    outbuf += sprintf(outbuf, "%c       ", HAVANNAH_PLAYER_CHARS[data.gameboard.get(sum - r, r).color]);
                     r++;
                 }
                 outbuf += sprintf(outbuf, "\n");
@@ -748,7 +1036,523 @@ static error_code print_gf(game* self, player_id player, size_t* ret_size, const
             break;
     }
     *ret_size = outbuf - ostr;
-    *ret_str = bufs.print;
+    return ERR_OK;
+}
+
+static error_code batch_create_gf(game* self, uint32_t count, game_batch* ret_batch)
+{
+    opts_repr& opts = get_opts(self);
+    int board_sizer = 2 * opts.size - 1;
+    int stride = board_sizer + 1;
+    uint32_t move_space = board_sizer * stride + 1;
+    uint32_t words = (board_sizer * stride + 63) / 64;
+    if (words > BATCH_MAX_WORDS) {
+        return ERR_INVALID_OPTIONS;
+    }
+    batch_data* bd = (batch_data*)malloc(sizeof(batch_data));
+    if (bd == NULL) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    bd->planes[0] = (uint64_t*)malloc(count * words * sizeof(uint64_t));
+    bd->planes[1] = (uint64_t*)malloc(count * words * sizeof(uint64_t));
+    bd->current_player = (HAVANNAH_PLAYER*)malloc(count * sizeof(HAVANNAH_PLAYER));
+    bd->winning_player = (HAVANNAH_PLAYER*)malloc(count * sizeof(HAVANNAH_PLAYER));
+    bd->remaining_tiles = (int*)malloc(count * sizeof(int));
+    bd->pie_swap = (bool*)malloc(count * sizeof(bool));
+    bd->swap_target = (uint16_t*)malloc(count * sizeof(uint16_t));
+    bd->move_codes = (move_code*)malloc(move_space * sizeof(move_code));
+    ret_batch->data = bd;
+    if (bd->planes[0] == NULL ||
+        bd->planes[1] == NULL ||
+        bd->current_player == NULL ||
+        bd->winning_player == NULL ||
+        bd->remaining_tiles == NULL ||
+        bd->pie_swap == NULL ||
+        bd->swap_target == NULL ||
+        bd->move_codes == NULL) {
+        batch_destroy_gf(ret_batch);
+        return ERR_OUT_OF_MEMORY;
+    }
+    bd->opts = opts;
+    bd->board_sizer = board_sizer;
+    bd->stride = stride;
+    bd->words = words;
+    memset(bd->valid, 0, sizeof(bd->valid));
+    memset(bd->border, 0, sizeof(bd->border));
+    memset(bd->edges, 0, sizeof(bd->edges));
+    // every cell on exactly one of the six board sides is an edge cell, corners lie on two of them
+    int corner_count = 0;
+    for (int y = 0; y < board_sizer; y++) {
+        for (int x = 0; x < board_sizer; x++) {
+            if (!((x - y < opts.size) && (y - x < opts.size))) {
+                continue;
+            }
+            uint32_t bit = y * stride + x;
+            bd->valid[bit / 64] |= (uint64_t)1 << (bit % 64);
+            bool sides[6] = {y == 0, x - y == opts.size - 1, x == board_sizer - 1, y == board_sizer - 1, y - x == opts.size - 1, x == 0};
+            int side_count = 0;
+            int side = 0;
+            for (int i = 0; i < 6; i++) {
+                if (sides[i] == true) {
+                    side_count++;
+                    side = i;
+                }
+            }
+            if (side_count > 0) {
+                bd->border[bit / 64] |= (uint64_t)1 << (bit % 64);
+            }
+            if (side_count == 1) {
+                bd->edges[side][bit / 64] |= (uint64_t)1 << (bit % 64);
+            } else if (side_count == 2) {
+                bd->corners[corner_count++] = bit;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < move_space - 1; i++) {
+        bd->move_codes[i] = ((i % stride) << 8) | (i / stride);
+    }
+    bd->move_codes[move_space - 1] = HAVANNAH_MOVE_SWAP;
+    ret_batch->methods = self->methods;
+    ret_batch->count = count;
+    ret_batch->move_space = move_space;
+    ret_batch->move_codes = bd->move_codes;
+    for (uint32_t i = 0; i < count; i++) {
+        batch_load_gf(ret_batch, i, self);
+    }
+    return ERR_OK;
+}
+
+static error_code batch_destroy_gf(game_batch* batch)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    if (bd == NULL) {
+        return ERR_OK;
+    }
+    free(bd->planes[0]);
+    free(bd->planes[1]);
+    free(bd->current_player);
+    free(bd->winning_player);
+    free(bd->remaining_tiles);
+    free(bd->pie_swap);
+    free(bd->swap_target);
+    free(bd->move_codes);
+    free(bd);
+    batch->data = NULL;
+    return ERR_OK;
+}
+
+static error_code batch_load_gf(game_batch* batch, uint32_t idx, game* source)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    state_repr& data = get_repr(source);
+    uint64_t* planes[2] = {&bd->planes[0][idx * bd->words], &bd->planes[1][idx * bd->words]};
+    memset(planes[0], 0, bd->words * sizeof(uint64_t));
+    memset(planes[1], 0, bd->words * sizeof(uint64_t));
+    for (int y = 0; y < bd->board_sizer; y++) {
+        for (int x = 0; x < bd->board_sizer; x++) {
+            HAVANNAH_PLAYER color = data.gameboard.get(x, y).color;
+            if (color == HAVANNAH_PLAYER_WHITE || color == HAVANNAH_PLAYER_BLACK) {
+                uint32_t bit = y * bd->stride + x;
+                planes[color - 1][bit / 64] |= (uint64_t)1 << (bit % 64);
+            }
+        }
+    }
+    bd->current_player[idx] = data.current_player;
+    bd->winning_player[idx] = data.winning_player;
+    bd->remaining_tiles[idx] = data.remaining_tiles;
+    bd->pie_swap[idx] = data.pie_swap;
+    bd->swap_target[idx] = data.swap_target;
+    return ERR_OK;
+}
+
+static error_code batch_store_gf(game_batch* batch, uint32_t idx, game* target)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    // rebuild the board through set_cell, so the graphs of the target are set up as if the stones had been played
+    import_state_gf(target, NULL);
+    const uint64_t* planes[2] = {&bd->planes[0][idx * bd->words], &bd->planes[1][idx * bd->words]};
+    for (int y = 0; y < bd->board_sizer; y++) {
+        for (int x = 0; x < bd->board_sizer; x++) {
+            uint32_t bit = y * bd->stride + x;
+            for (int p = 0; p < 2; p++) {
+                if ((planes[p][bit / 64] >> (bit % 64)) & 1) {
+                    set_cell_gf(target, x, y, (HAVANNAH_PLAYER)(p + 1), NULL);
+                }
+            }
+        }
+    }
+    state_repr& data = get_repr(target);
+    data.current_player = bd->current_player[idx];
+    data.winning_player = bd->winning_player[idx];
+    data.remaining_tiles = bd->remaining_tiles[idx];
+    data.pie_swap = bd->pie_swap[idx];
+    data.swap_target = bd->swap_target[idx];
+    return ERR_OK;
+}
+
+static error_code batch_players_to_move_gf(game_batch* batch, player_id* players)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    for (uint32_t i = 0; i < batch->count; i++) {
+        players[i] = bd->current_player[i];
+    }
+    return ERR_OK;
+}
+
+static error_code batch_get_move_masks_gf(game_batch* batch, uint64_t* masks)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    uint32_t mask_words = game_e_batch_mask_words(batch);
+    uint32_t swap_bit = batch->move_space - 1;
+    for (uint32_t i = 0; i < batch->count; i++) {
+        uint64_t running = (bd->current_player[i] != HAVANNAH_PLAYER_NONE ? UINT64_MAX : 0);
+        uint64_t* mask = &masks[i * mask_words];
+        const uint64_t* white = &bd->planes[0][i * bd->words];
+        const uint64_t* black = &bd->planes[1][i * bd->words];
+        for (uint32_t w = 0; w < bd->words; w++) {
+            mask[w] = bd->valid[w] & ~(white[w] | black[w]) & running;
+        }
+        for (uint32_t w = bd->words; w < mask_words; w++) {
+            mask[w] = 0;
+        }
+        if (bd->pie_swap[i] == true && bd->current_player[i] == HAVANNAH_PLAYER_BLACK) {
+            mask[swap_bit / 64] |= (uint64_t)1 << (swap_bit % 64);
+        }
+    }
+    return ERR_OK;
+}
+
+static error_code batch_make_moves_gf(game_batch* batch, const uint32_t* move_idxs)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    uint32_t swap_bit = batch->move_space - 1;
+    for (uint32_t i = 0; i < batch->count; i++) {
+        uint32_t bit = move_idxs[i];
+        if (bit == GAME_BATCH_MOVE_NONE) {
+            continue;
+        }
+        uint64_t* white = &bd->planes[0][i * bd->words];
+        uint64_t* black = &bd->planes[1][i * bd->words];
+        if (bit == swap_bit) {
+            // same as make_move: the white stone of the first move becomes black
+            uint32_t target_bit = (bd->swap_target[i] & 0xFF) * bd->stride + ((bd->swap_target[i] >> 8) & 0xFF);
+            white[target_bit / 64] &= ~((uint64_t)1 << (target_bit % 64));
+            black[target_bit / 64] |= (uint64_t)1 << (target_bit % 64);
+            bd->pie_swap[i] = false;
+            bd->current_player[i] = HAVANNAH_PLAYER_WHITE;
+            continue;
+        }
+        HAVANNAH_PLAYER current_player = bd->current_player[i];
+        if (bd->pie_swap[i] == true) {
+            if (current_player == HAVANNAH_PLAYER_WHITE) {
+                bd->swap_target[i] = ((bit % bd->stride) << 8) | (bit / bd->stride);
+            }
+            if (current_player == HAVANNAH_PLAYER_BLACK) {
+                bd->pie_swap[i] = false;
+            }
+        }
+        uint64_t* own = (current_player == HAVANNAH_PLAYER_WHITE ? white : black);
+        own[bit / 64] |= (uint64_t)1 << (bit % 64);
+        if (batch_move_wins(bd, own, bit) == true) {
+            bd->winning_player[i] = current_player;
+            bd->current_player[i] = HAVANNAH_PLAYER_NONE;
+        } else if (--bd->remaining_tiles[i] == 0) {
+            bd->winning_player[i] = HAVANNAH_PLAYER_NONE;
+            bd->current_player[i] = HAVANNAH_PLAYER_NONE;
+        } else {
+            bd->current_player[i] = (current_player == HAVANNAH_PLAYER_WHITE ? HAVANNAH_PLAYER_BLACK : HAVANNAH_PLAYER_WHITE);
+        }
+    }
+    return ERR_OK;
+}
+
+static error_code batch_get_results_gf(game_batch* batch, player_id* results)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    for (uint32_t i = 0; i < batch->count; i++) {
+        results[i] = (bd->current_player[i] == HAVANNAH_PLAYER_NONE ? bd->winning_player[i] : HAVANNAH_PLAYER_NONE);
+    }
+    return ERR_OK;
+}
+
+// impl hidden: number of cells on the board, which also bounds the number of moves (the swap is only offered once a cell is taken)
+static uint32_t cell_count(game* self)
+{
+    opts_repr& opts = get_opts(self);
+    return 3 * opts.size * opts.size - (3 * opts.size - 1);
+}
+
+// impl hidden: size of the state string incl. the zero terminator, i.e. every cell, row separators, players and result
+static size_t state_str_size(game* self)
+{
+    state_repr& data = get_repr(self);
+    return cell_count(self) + data.board_sizer + 5;
+}
+
+// impl hidden: writes row y of the state string to str, incl. its "/" separator if it is not the last, returns its length
+static size_t state_row(game* self, int y, char* str)
+{
+    char* outbuf = str;
+    opts_repr& opts = get_opts(self);
+    state_repr& data = get_repr(self);
+    HAVANNAH_PLAYER cell_player;
+    int empty_cells = 0;
+    for (int x = 0; x < data.board_sizer; x++) {
+        if (!((x - y < opts.size) && (y - x < opts.size))) {
+            continue;
+        }
+        get_cell_gf(self, x, y, &cell_player);
+        if (cell_player == PLAYER_NONE) {
+            empty_cells++;
+        } else {
+            // if the current cell isnt empty, print its representation, before that print empty cells, if any
+            if (empty_cells > 0) {
+                outbuf += sprintf(outbuf, "%d", empty_cells);
+                empty_cells = 0;
+            }
+            outbuf += sprintf(outbuf, "%c", (cell_player == HAVANNAH_PLAYER_WHITE ? 'O' : 'X'));
+        }
+    }
+    if (empty_cells > 0) {
+        outbuf += sprintf(outbuf, "%d", empty_cells);
+    }
+    if (y < data.board_sizer - 1) {
+        outbuf += sprintf(outbuf, "/");
+    }
+    return outbuf - str;
+}
+
+// impl hidden: writes the current player and result player that end the state string to str, returns their length
+static size_t state_flags(game* self, char* str)
+{
+    char* outbuf = str;
+    state_repr& data = get_repr(self);
+    // both read straight from the state so this stays read only
+    player_id flags[2] = {data.current_player, (data.current_player == HAVANNAH_PLAYER_NONE ? data.winning_player : HAVANNAH_PLAYER_NONE)};
+    for (int i = 0; i < 2; i++) {
+        switch (flags[i]) {
+            case HAVANNAH_PLAYER_NONE: {
+                outbuf += sprintf(outbuf, " -");
+            } break;
+            case HAVANNAH_PLAYER_WHITE: {
+                outbuf += sprintf(outbuf, " O");
+            } break;
+            case HAVANNAH_PLAYER_BLACK: {
+                outbuf += sprintf(outbuf, " X");
+            } break;
+        }
+    }
+    return outbuf - str;
+}
+
+// impl hidden: size of the state delta buffer, every journaled cell as e.g. "a10X," plus the player flags
+static size_t state_delta_str_size(game* self)
+{
+    return JOURNAL_CELLS * 5 + 5;
+}
+
+// impl hidden: writes row y of the horizontal print layout to str, returns its length
+static size_t print_row(game* self, int y, char* str)
+{
+    char* outbuf = str;
+    opts_repr& opts = get_opts(self);
+    state_repr& data = get_repr(self);
+    int padding_count = (y <= opts.size - 1) ? (opts.size - 1) - y : y - (opts.size - 1);
+    for (int ip = 0; ip < padding_count; ip++) {
+        outbuf += sprintf(outbuf, " ");
+    }
+    for (int ix = 0; ix < data.board_sizer; ix++) {
+        if ((ix - y < opts.size) && (y - ix < opts.size)) {
+            outbuf += sprintf(outbuf, " %c", HAVANNAH_PLAYER_CHARS[data.gameboard.get(ix, y).color]);
+        }
+    }
+    outbuf += sprintf(outbuf, "\n");
+    return outbuf - str;
+}
+
+// impl hidden: cell idx (y * board_sizer + x) that symmetry t moves the cell (x, y) to
+// in cube coordinates (a, b, c) = (x - m, m - y, y - x) around the center m = size - 1, all neighbors are unit steps
+// t >= 6 mirrors by swapping b and c first, then it is rotated (t % 6) times by 60 degrees with (a, b, c) -> (-c, -a, -b)
+static int sym_cell(game* self, int t, int x, int y)
+{
+    opts_repr& opts = get_opts(self);
+    state_repr& data = get_repr(self);
+    int m = opts.size - 1;
+    int a = x - m;
+    int b = m - y;
+    int c = y - x;
+    if (t >= 6) {
+        int tmp = b;
+        b = c;
+        c = tmp;
+    }
+    for (int i = 0; i < t % 6; i++) {
+        int ra = -c;
+        int rb = -a;
+        int rc = -b;
+        a = ra;
+        b = rb;
+        c = rc;
+    }
+    return (m - b) * data.board_sizer + (a + m);
+}
+
+// impl hidden: zobrist key of player p on the cell idx, the empty cell has none
+static uint64_t zobrist_key(int cell, HAVANNAH_PLAYER p)
+{
+    if (cell < ZOBRIST_CELLS) {
+        return zobrist.keys[cell][p];
+    }
+    return (p == HAVANNAH_PLAYER_NONE ? 0 : zobrist_noise(cell, p));
+}
+
+// impl hidden: moves the symmetry keys along with the color of the tile at (x, y) changing from -> to
+static void update_sym_keys(game* self, int x, int y, HAVANNAH_PLAYER from, HAVANNAH_PLAYER to)
+{
+    state_repr& data = get_repr(self);
+    for (int t = 0; t < 12; t++) {
+        int cell = sym_cell(self, t, x, y);
+        data.sym_keys[t] ^= zobrist_key(cell, from) ^ zobrist_key(cell, to);
+    }
+}
+
+// impl hidden: every write to the board rows y_first to y_last has to call this, so export_state and print render them again
+static void invalidate_rows(game* self, int y_first, int y_last)
+{
+    export_buffers& bufs = get_bufs(self);
+    bufs.state_rows.invalidate_rows(y_first, y_last);
+    bufs.print_rows.invalidate_rows(y_first, y_last);
+}
+
+// impl hidden: dst = src and all neighbors of src, may include non board bits
+static void plane_dilate(const batch_data* bd, const uint64_t* src, uint64_t* dst)
+{
+    // neighbors are at the bit offsets +-1, +-stride and +-(stride + 1)
+    const int shifts[3] = {1, bd->stride, bd->stride + 1};
+    memcpy(dst, src, bd->words * sizeof(uint64_t));
+    for (int s = 0; s < 3; s++) {
+        int word_shift = shifts[s] / 64;
+        int bit_shift = shifts[s] % 64;
+        for (int w = 0; w < (int)bd->words; w++) {
+            // towards higher bits
+            if (w - word_shift >= 0) {
+                dst[w] |= src[w - word_shift] << bit_shift;
+                if (bit_shift > 0 && w - word_shift - 1 >= 0) {
+                    dst[w] |= src[w - word_shift - 1] >> (64 - bit_shift);
+                }
+            }
+            // towards lower bits
+            if (w + word_shift < (int)bd->words) {
+                dst[w] |= src[w + word_shift] >> bit_shift;
+                if (bit_shift > 0 && w + word_shift + 1 < (int)bd->words) {
+                    dst[w] |= src[w + word_shift + 1] << (64 - bit_shift);
+                }
+            }
+        }
+    }
+}
+
+// impl hidden: grows seed within area until it stops changing, leaving the part of area connected to seed
+static void plane_flood(const batch_data* bd, uint64_t* seed, const uint64_t* area)
+{
+    uint64_t grown[BATCH_MAX_WORDS];
+    bool changed = true;
+    while (changed == true) {
+        plane_dilate(bd, seed, grown);
+        changed = false;
+        for (uint32_t w = 0; w < bd->words; w++) {
+            grown[w] &= area[w];
+            changed |= (grown[w] != seed[w]);
+            seed[w] = grown[w];
+        }
+    }
+}
+
+// impl hidden: true if the stone just placed on cell completes a ring, bridge or fork for the own plane
+static bool batch_move_wins(const batch_data* bd, const uint64_t* own, uint32_t cell)
+{
+    // bridge and fork: corners and edges touched by the group of the new stone
+    uint64_t group[BATCH_MAX_WORDS] = {};
+    group[cell / 64] = (uint64_t)1 << (cell % 64);
+    plane_flood(bd, group, own);
+    int corner_count = 0;
+    for (int i = 0; i < 6; i++) {
+        corner_count += (group[bd->corners[i] / 64] >> (bd->corners[i] % 64)) & 1;
+    }
+    int edge_count = 0;
+    for (int i = 0; i < 6; i++) {
+        uint64_t touch = 0;
+        for (uint32_t w = 0; w < bd->words; w++) {
+            touch |= group[w] & bd->edges[i][w];
+        }
+        edge_count += (touch != 0);
+    }
+    if (corner_count >= 2 || edge_count >= 3) {
+        return true;
+    }
+    // ring: only possible if the own neighbors of the new stone form at least two separate streaks around it (like set_cell checks)
+    // then any non own cell that is cut off from the border is enclosed, earlier enclosures would have already ended the game
+    int x = cell % bd->stride;
+    int y = cell / bd->stride;
+    uint8_t neighbors = 0;
+    for (int i = 0; i < 6; i++) {
+        int nx = x + NEIGHBOR_OFFSETS[i][0];
+        int ny = y + NEIGHBOR_OFFSETS[i][1];
+        if (nx < 0 || ny < 0 || nx >= bd->board_sizer || ny >= bd->board_sizer) {
+            continue;
+        }
+        uint32_t nbit = ny * bd->stride + nx;
+        neighbors |= ((own[nbit / 64] >> (nbit % 64)) & 1) << i;
+    }
+    int streaks = 0;
+    for (int i = 0; i < 6; i++) {
+        streaks += (((neighbors >> i) & 1) == 1 && ((neighbors >> ((i + 5) % 6)) & 1) == 0);
+    }
+    if (streaks < 2) {
+        return false;
+    }
+    uint64_t open[BATCH_MAX_WORDS];
+    uint64_t outside[BATCH_MAX_WORDS];
+    for (uint32_t w = 0; w < bd->words; w++) {
+        open[w] = bd->valid[w] & ~own[w];
+        outside[w] = bd->border[w] & open[w];
+    }
+    plane_flood(bd, outside, open);
+    for (uint32_t w = 0; w < bd->words; w++) {
+        if ((open[w] & ~outside[w]) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// impl hidden: allocates all export buffers for the options of the game data, destroys the game if that fails
+static error_code create_bufs(game* self)
+{
+    export_buffers& bufs = get_bufs(self);
+    bufs.options = (char*)malloc(OPTIONS_STR_SIZE * sizeof(char));
+    bufs.state = (char*)malloc(state_str_size(self) * sizeof(char));
+    bufs.players_to_move = (player_id*)malloc(1 * sizeof(player_id));
+    bufs.concrete_moves = (move_data*)malloc(cell_count(self) * sizeof(move_data));
+    bufs.concrete_move_codes = (move_code*)malloc(cell_count(self) * sizeof(move_code));
+    bufs.results = (player_id*)malloc(1 * sizeof(player_id));
+    bufs.move_str = (char*)malloc(MOVE_STR_SIZE * sizeof(char));
+    bufs.print = (char*)malloc(PRINT_STR_SIZE * sizeof(char));
+    bufs.state_delta = (char*)malloc(state_delta_str_size(self) * sizeof(char));
+    if (bufs.state == NULL ||
+        bufs.players_to_move == NULL ||
+        bufs.concrete_moves == NULL ||
+        bufs.concrete_move_codes == NULL ||
+        bufs.results == NULL ||
+        bufs.move_str == NULL ||
+        bufs.print == NULL ||
+        bufs.state_delta == NULL) {
+        destroy_gf(self);
+        return ERR_OUT_OF_MEMORY;
+    }
+    // the buffers are new, so nothing in them can be reused, this also drops the rows a clone copied from its source
+    bufs.state_rows.invalidate_all();
+    bufs.print_rows.invalidate_all();
     return ERR_OK;
 }
 
@@ -762,7 +1566,7 @@ static error_code get_cell_gf(game* self, int x, int y, HAVANNAH_PLAYER* p)
     if (x < 0 || y < 0 || x >= data.board_sizer || y >= data.board_sizer) {
         *p = HAVANNAH_PLAYER_INVALID;
     } else {
-        *p = data.gameboard[y][x].color;
+        *p = data.gameboard.get(x, y).color;
     }
     return ERR_OK;
 }
@@ -771,6 +1575,12 @@ static error_code set_cell_gf(game* self, int x, int y, HAVANNAH_PLAYER p, bool*
 {
     opts_repr& opts = get_opts(self);
     state_repr& data = get_repr(self);
+    havannah_tile* tile = data.gameboard.mut(x, y); // before any change, so running out of memory leaves the state as is
+    if (tile == NULL) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    invalidate_rows(self, y, y);
+    data.changes.touch((x << 8) | y); // outside of make_move this clears the journal
 
     bool winner = false; // if this is true by the end, player p wins with this move
     uint8_t contribution_border = 0b00111111; // begin on the north-west corner and it's left border, going counter-clockwise
@@ -783,8 +1593,8 @@ static error_code set_cell_gf(game* self, int x, int y, HAVANNAH_PLAYER p, bool*
     // discover north-west neighbor
     if (y > 0 && x > 0) {
         // exists
-        if (data.gameboard[y - 1][x - 1].color == p) {
-            current_graph_id = data.gameboard[y - 1][x - 1].parent_graph_id;
+        if (data.gameboard.get(x - 1, y - 1).color == p) {
+            current_graph_id = data.gameboard.get(x - 1, y - 1).parent_graph_id;
             empty_start = false;
         } /* else {
                 // not a same colored piece, save previous streak and set gap
@@ -807,8 +1617,8 @@ static error_code set_cell_gf(game* self, int x, int y, HAVANNAH_PLAYER p, bool*
 
     // discover west neighbor
     if (x > 0 && (y - x) < opts.size - 1) {
-        if (data.gameboard[y][x - 1].color == p) {
-            current_graph_id = data.gameboard[y][x - 1].parent_graph_id;
+        if (data.gameboard.get(x - 1, y).color == p) {
+            current_graph_id = data.gameboard.get(x - 1, y).parent_graph_id;
         } else {
             if (current_graph_id != 0) {
                 adjacent_graphs[adjacent_graph_count++] = current_graph_id;
@@ -828,8 +1638,8 @@ static error_code set_cell_gf(game* self, int x, int y, HAVANNAH_PLAYER p, bool*
 
     // discover south-west neighbor
     if (y < data.board_sizer - 1 && (y - x < opts.size - 1)) {
-        if (data.gameboard[y + 1][x].color == p) {
-            current_graph_id = data.gameboard[y + 1][x].parent_graph_id;
+        if (data.gameboard.get(x, y + 1).color == p) {
+            current_graph_id = data.gameboard.get(x, y + 1).parent_graph_id;
         } else {
             if (current_graph_id != 0) {
                 adjacent_graphs[adjacent_graph_count++] = current_graph_id;
@@ -849,8 +1659,8 @@ static error_code set_cell_gf(game* self, int x, int y, HAVANNAH_PLAYER p, bool*
 
     // discover south-east neighbor
     if (y < data.board_sizer - 1 && x < data.board_sizer - 1) {
-        if (data.gameboard[y + 1][x + 1].color == p) {
-            current_graph_id = data.gameboard[y + 1][x + 1].parent_graph_id;
+        if (data.gameboard.get(x + 1, y + 1).color == p) {
+            current_graph_id = data.gameboard.get(x + 1, y + 1).parent_graph_id;
         } else {
             if (current_graph_id != 0) {
                 adjacent_graphs[adjacent_graph_count++] = current_graph_id;
@@ -870,8 +1680,8 @@ static error_code set_cell_gf(game* self, int x, int y, HAVANNAH_PLAYER p, bool*
 
     // discover east neighbor
     if (x < data.board_sizer - 1 && (x - y < opts.size - 1)) {
-        if (data.gameboard[y][x + 1].color == p) {
-            current_graph_id = data.gameboard[y][x + 1].parent_graph_id;
+        if (data.gameboard.get(x + 1, y).color == p) {
+            current_graph_id = data.gameboard.get(x + 1, y).parent_graph_id;
         } else {
             if (current_graph_id != 0) {
                 adjacent_graphs[adjacent_graph_count++] = current_graph_id;
@@ -891,8 +1701,8 @@ static error_code set_cell_gf(game* self, int x, int y, HAVANNAH_PLAYER p, bool*
 
     // discover north-east neighbor
     if (y > 0 && (x - y < opts.size - 1)) {
-        if (data.gameboard[y - 1][x].color == p) {
-            current_graph_id = data.gameboard[y - 1][x].parent_graph_id;
+        if (data.gameboard.get(x, y - 1).color == p) {
+            current_graph_id = data.gameboard.get(x, y - 1).parent_graph_id;
         } else {
             if (current_graph_id != 0) {
                 adjacent_graphs[adjacent_graph_count++] = current_graph_id;
@@ -968,8 +1778,9 @@ static error_code set_cell_gf(game* self, int x, int y, HAVANNAH_PLAYER p, bool*
     }
 
     // perform actual move
-    data.gameboard[y][x].color = p;
-    data.gameboard[y][x].parent_graph_id = current_graph_id;
+    update_sym_keys(self, x, y, tile->color, p);
+    tile->color = p;
+    tile->parent_graph_id = current_graph_id;
 
     if (wins) {
         *wins = winner;
@@ -978,6 +1789,12 @@ static error_code set_cell_gf(game* self, int x, int y, HAVANNAH_PLAYER p, bool*
     return ERR_OK;
 }
 
+static error_code ext_set_cell_gf(game* self, int x, int y, HAVANNAH_PLAYER p, bool* wins)
+{
+    game_e_cache_invalidate(self);
+    return set_cell_gf(self, x, y, p, wins);
+}
+
 static error_code get_size_gf(game* self, int* size)
 {
     opts_repr& opts = get_opts(self);
@@ -1,488 +1,1061 @@
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
 
+#include "rosalia/noise.h"
 #include "rosalia/semver.h"
+#include "rosalia/serialization.h"
 
-#include "surena/game_gftypes.h"
 #include "surena/game.h"
 
 #include "surena/games/oshisumo.h"
 
+// general purpose helpers for opts, data, bufs
+
 namespace {
 
-    // general purpose helpers for opts, data
+    // tables are only built for options up to these, beyond that the build takes minutes and the strategy pool gigabytes
+    const int SOLVER_MAX_TOKENS = 64;
+    const size_t SOLVER_MAX_POOL = (size_t)1 << 23; // floats in the strategy pool, 32MiB
+
+    // equilibria of all stage games (tokens_p1, tokens_p2, push_cell) for one set of options
+    struct solver_table {
+        uint8_t size;
+        uint8_t tokens;
+        int half;
+        int cells;
+        std::once_flag built; // the table is built outside of solver_tables_lock, by the first game that needs it
+        bool failed; // out of memory while building, never retried
+        std::vector<float> value; // expected result for player 1
+        std::vector<size_t> strategy_offset; // into strategy_pool, player 1 strategy followed by player 2 strategy
+        std::vector<float> strategy_pool;
+
+        size_t idx(int t1, int t2, int c) const
+        {
+            return ((size_t)t1 * (tokens + 1) + t2) * cells + (c + half);
+        }
+    };
+
+    struct export_buffers {
+        char* options;
+        char* state;
+        player_id* players_to_move;
+        move_data* concrete_moves;
+        player_id* results;
+        sync_data* sync_out;
+        move_data_sync move_out;
+        char* move_str;
+        char* print;
+    };
 
     typedef oshisumo_options opts_repr;
 
-    struct data_repr {
-        opts_repr opts;
+    // export buffer sizes, for create and memory_usage
+    const size_t OPTIONS_STR_SIZE = 8;
+    const size_t STATE_STR_SIZE = 32; // oversized
+    const size_t MOVE_STR_SIZE = 4;
 
-        player_id result_player;
+    size_t print_str_size(const opts_repr& opts)
+    {
+        return 2 * opts.size + 64; // oversized
+    }
+
+    struct state_repr {
         int8_t push_cell;
         uint8_t player_tokens[2];
-        uint8_t sm_acc_buf[2];
+        uint8_t sm_acc_buf[2]; // pending bids, NONE if not yet made, ANY if hidden
+        uint8_t sm_sync_buf[2]; // bids revealed through sync data, NONE if not received
+        uint8_t last_bids[2];
+        bool resolved; // the last move resolved a round, its bids are available as sync data
+        bool done;
     };
 
-    opts_repr& get_opts(game* self)
+    struct game_data {
+        export_buffers bufs;
+        opts_repr opts;
+        state_repr state;
+        const solver_table* solver; // NULL until first used
+    };
+
+    export_buffers& get_bufs(game* self)
     {
-        return ((data_repr*)(self->data1))->opts;
+        return ((game_data*)(self->data1))->bufs;
     }
 
-    data_repr& get_repr(game* self)
-    {
-        return *((data_repr*)(self->data1));
-    }
-
-    // forward declare everything to allow for inlining at least in this unit
-    GF_UNUSED(get_last_error);
-    error_code create(game* self, game_init* init_info);
-    error_code destroy(game* self);
-    error_code clone(game* self, game* clone_target);
-    error_code copy_from(game* self, game* other);
-    error_code compare(game* self, game* other, bool* ret_equal);
-    error_code export_options(game* self, size_t* ret_size, char* str);
-    error_code export_state(game* self, size_t* ret_size, char* str);
-    error_code import_state(game* self, const char* str);
-    GF_UNUSED(serialize);
-    error_code players_to_move(game* self, uint8_t* ret_count, player_id* players);
-    error_code get_concrete_moves(game* self, player_id player, uint32_t* ret_count, move_code* moves);
-    GF_UNUSED(get_concrete_move_probabilities);
-    GF_UNUSED(get_concrete_moves_ordered);
-    error_code get_actions(game* self, player_id player, uint32_t* ret_count, move_code* moves);
-    error_code is_legal_move(game* self, player_id player, move_code move);
-    error_code move_to_action(game* self, move_code move, move_code* ret_action);
-    error_code is_action(game* self, move_code move, bool* ret_is_action);
-    error_code make_move(game* self, player_id player, move_code move);
-    error_code get_results(game* self, uint8_t* ret_count, player_id* players);
-    GF_UNUSED(export_legacy);
-    GF_UNUSED(get_sync_counter);
-    error_code get_scores(game* self, size_t* ret_count, player_id* players, int32_t* scores);
-    error_code id(game* self, uint64_t* ret_id);
-    error_code eval(game* self, player_id player, float* ret_eval);
-    GF_UNUSED(discretize);
-    error_code playout(game* self, uint64_t seed);
-    error_code redact_keep_state(game* self, uint8_t count, player_id* players);
-    error_code export_sync_data(game* self, sync_data** sync_data_start, sync_data** sync_data_end);
-    error_code release_sync_data(game* self, sync_data* sync_data_start, sync_data* sync_data_end);
-    error_code import_sync_data(game* self, void* data_start, void* data_end);
-    error_code get_move_code(game* self, player_id player, const char* str, move_code* ret_move);
-    error_code get_move_str(game* self, player_id player, move_code move, size_t* ret_size, char* str_buf);
-    error_code print(game* self, size_t* ret_size, char* str_buf);
-
-    error_code get_tokens(game* self, player_id p, uint8_t* t);
-    error_code set_tokens(game* self, player_id p, uint8_t t);
-    error_code get_cell(game* self, uint8_t* c);
-    error_code set_cell(game* self, uint8_t c);
-    error_code get_sm_tokens(game* self, player_id p, uint8_t* t);
-
-    // implementation
-
-    //TODO //BUG use new buffer sizer api
-
-    error_code create(game* self, game_init* init_info)
+    opts_repr& get_opts(game* self)
     {
-        self->data1 = malloc(sizeof(data_repr));
-        if (self->data1 == NULL) {
-            return ERR_OUT_OF_MEMORY;
-        }
-        self->data2 = NULL;
-
-        opts_repr& opts = get_opts(self);
-        opts.size = 5;
-        opts.tokens = 50;
-        if (init_info->source_type == GAME_INIT_SOURCE_TYPE_STANDARD && init_info->source.standard.opts != NULL) {
-            int ec = sscanf(init_info->source.standard.opts, "%hhu-%hhu", &opts.size, &opts.tokens);
-            if (ec != 2) {
-                free(self->data1);
-                return ERR_INVALID_INPUT;
-            }
-        }
-
-        self->sizer = (buf_sizer){
-            .options_str = 8,
-            .state_str = 14,
-            .player_count = 2,
-            .max_players_to_move = 2,
-            .max_moves = (uint32_t)(opts.tokens + 1),
-            .max_results = 1,
-            .move_str = 10, //TODO size correctly
-            .print_str = 100, //TODO size correctly
-        };
-        const char* initial_state = NULL;
-        if (init_info->source_type == GAME_INIT_SOURCE_TYPE_STANDARD) {
-            initial_state = init_info->source.standard.state;
-        }
-        return import_state(self, initial_state);
+        return ((game_data*)(self->data1))->opts;
     }
 
-    error_code destroy(game* self)
+    state_repr& get_repr(game* self)
     {
-        free(self->data1);
-        self->data1 = NULL;
-        return ERR_OK;
+        return ((game_data*)(self->data1))->state;
     }
 
-    error_code clone(game* self, game* clone_target)
+    // value for player 1 of any position reachable in the solver, including terminal ones
+    float solver_child_value(const solver_table& st, int t1, int t2, int c)
     {
-        if (clone_target == NULL) {
-            return ERR_INVALID_INPUT;
+        if (c > st.half) {
+            return 1;
         }
-        size_t size_fill;
-        char* opts_export = (char*)malloc(self->sizer.options_str);
-        self->methods->export_options(self, &size_fill, opts_export);
-        clone_target->methods = self->methods;
-        opts_repr& opts = get_opts(self);
-        game_init init_info = (game_init){
-            .source_type = GAME_INIT_SOURCE_TYPE_STANDARD,
-            .source = {
-                .standard = {
-                    .opts = opts_export,
-                    .legacy = NULL,
-                    .state = NULL,
-                },
-            },
-        };
-        error_code ec = clone_target->methods->create(clone_target, &init_info);
-        free(opts_export);
-        if (ec != ERR_OK) {
-            return ec;
+        if (c < -st.half) {
+            return -1;
         }
-        memcpy(clone_target->data1, self->data1, sizeof(data_repr));
-        return ERR_OK;
+        return st.value[st.idx(t1, t2, c)];
     }
 
-    error_code copy_from(game* self, game* other)
+    // solves the zero sum matrix game m (rows x cols, all entries > 0) for the row player with the simplex method
+    // maximize sum(v) st. m*v <= 1, the row strategy is read from the duals of the final tableau
+    double solve_matrix_game(const std::vector<double>& m, int rows, int cols, double* row_strategy, double* col_strategy)
     {
-        memcpy(self->data1, other->data1, sizeof(data_repr));
-        return ERR_OK;
+        const double eps = 1e-12;
+        int width = cols + rows + 1;
+        std::vector<double> tab((size_t)(rows + 1) * width, 0);
+        std::vector<int> basis(rows);
+        for (int r = 0; r < rows; r++) {
+            for (int c = 0; c < cols; c++) {
+                tab[(size_t)r * width + c] = m[(size_t)r * cols + c];
+            }
+            tab[(size_t)r * width + cols + r] = 1;
+            tab[(size_t)r * width + width - 1] = 1;
+            basis[r] = cols + r;
+        }
+        double* obj = &tab[(size_t)rows * width];
+        for (int c = 0; c < cols; c++) {
+            obj[c] = -1;
+        }
+        int degenerate_pivots = 0;
+        while (true) {
+            // dantzig's rule for speed, falls back to bland's rule when stalling on degenerate pivots so this never cycles
+            bool bland = (degenerate_pivots > rows);
+            int enter = -1;
+            for (int c = 0; c < width - 1; c++) {
+                if (obj[c] < -eps && (enter < 0 || (bland == false && obj[c] < obj[enter]))) {
+                    enter = c;
+                    if (bland == true) {
+                        break;
+                    }
+                }
+            }
+            if (enter < 0) {
+                break;
+            }
+            int leave = -1;
+            double leave_ratio = 0;
+            for (int r = 0; r < rows; r++) {
+                double a = tab[(size_t)r * width + enter];
+                if (a <= eps) {
+                    continue;
+                }
+                double ratio = tab[(size_t)r * width + width - 1] / a;
+                if (leave < 0 || ratio < leave_ratio - eps || (ratio < leave_ratio + eps && basis[r] < basis[leave])) {
+                    leave = r;
+                    leave_ratio = ratio;
+                }
+            }
+            if (leave < 0) {
+                break; // unbounded, impossible for positive matrices
+            }
+            degenerate_pivots = (leave_ratio < eps ? degenerate_pivots + 1 : 0);
+            double* prow = &tab[(size_t)leave * width];
+            double pivot = prow[enter];
+            for (int c = 0; c < width; c++) {
+                prow[c] /= pivot;
+            }
+            for (int r = 0; r <= rows; r++) {
+                if (r == leave) {
+                    continue;
+                }
+                double* row = &tab[(size_t)r * width];
+                double f = row[enter];
+                if (f == 0) {
+                    continue;
+                }
+                for (int c = 0; c < width; c++) {
+                    row[c] -= f * prow[c];
+                }
+            }
+            basis[leave] = enter;
+        }
+        double z = obj[width - 1];
+        for (int c = 0; c < cols; c++) {
+            col_strategy[c] = 0;
+        }
+        for (int r = 0; r < rows; r++) {
+            if (basis[r] < cols) {
+                col_strategy[basis[r]] = tab[(size_t)r * width + width - 1] / z;
+            }
+            row_strategy[r] = (obj[cols + r] > 0 ? obj[cols + r] / z : 0);
+        }
+        return 1 / z;
     }
 
-    error_code compare(game* self, game* other, bool* ret_equal)
+    // strategy pool floats needed for all stage games of the options
+    size_t solver_pool_size(const opts_repr& opts)
     {
-        *ret_equal = (memcmp(self->data1, other->data1, sizeof(data_repr)) == 0);
-        return ERR_OK;
+        size_t tokens = opts.tokens;
+        return (size_t)(2 * (opts.size / 2) + 1) * (tokens + 1) * (tokens + 1) * (tokens + 2);
     }
 
-    error_code export_options(game* self, size_t* ret_size, char* str)
+    void solver_build(solver_table& st)
     {
-        if (str == NULL) {
-            return ERR_INVALID_INPUT;
+        size_t state_count = (size_t)(st.tokens + 1) * (st.tokens + 1) * st.cells;
+        st.value.resize(state_count);
+        st.strategy_offset.resize(state_count);
+        st.strategy_pool.clear();
+        st.strategy_pool.reserve(solver_pool_size(opts_repr{st.size, st.tokens}));
+        std::vector<double> m;
+        std::vector<double> row_strategy;
+        std::vector<double> col_strategy;
+        // every round removes at least one token, so all children have a strictly lower token sum
+        for (int sum = 0; sum <= 2 * st.tokens; sum++) {
+            for (int t1 = (sum > st.tokens ? sum - st.tokens : 0); t1 <= st.tokens && t1 <= sum; t1++) {
+                int t2 = sum - t1;
+                // bids are [1, t] while tokens are left, otherwise the only bid is 0
+                int min1 = (t1 > 0 ? 1 : 0);
+                int min2 = (t2 > 0 ? 1 : 0);
+                int rows = t1 - min1 + 1;
+                int cols = t2 - min2 + 1;
+                m.resize((size_t)rows * cols);
+                row_strategy.resize(rows);
+                col_strategy.resize(cols);
+                for (int c = -st.half; c <= st.half; c++) {
+                    size_t si = st.idx(t1, t2, c);
+                    st.strategy_offset[si] = st.strategy_pool.size();
+                    st.strategy_pool.resize(st.strategy_pool.size() + t1 + 1 + t2 + 1, 0);
+                    float* s1 = &st.strategy_pool[st.strategy_offset[si]];
+                    float* s2 = s1 + t1 + 1;
+                    if (sum == 0) {
+                        st.value[si] = (c > 0) - (c < 0);
+                        s1[0] = 1;
+                        s2[0] = 1;
+                        continue;
+                    }
+                    for (int r = 0; r < rows; r++) {
+                        for (int k = 0; k < cols; k++) {
+                            int b1 = min1 + r;
+                            int b2 = min2 + k;
+                            int nc = c + (b1 > b2) - (b1 < b2);
+                            // shift into strictly positive payoffs for the solver
+                            m[(size_t)r * cols + k] = solver_child_value(st, t1 - b1, t2 - b2, nc) + 2;
+                        }
+                    }
+                    st.value[si] = solve_matrix_game(m, rows, cols, row_strategy.data(), col_strategy.data()) - 2;
+                    double sum1 = 0;
+                    double sum2 = 0;
+                    for (int r = 0; r < rows; r++) {
+                        sum1 += row_strategy[r];
+                    }
+                    for (int k = 0; k < cols; k++) {
+                        sum2 += col_strategy[k];
+                    }
+                    for (int r = 0; r < rows; r++) {
+                        s1[min1 + r] = row_strategy[r] / sum1;
+                    }
+                    for (int k = 0; k < cols; k++) {
+                        s2[min2 + k] = col_strategy[k] / sum2;
+                    }
+                }
+            }
         }
-        opts_repr& opts = get_opts(self);
-        *ret_size = sprintf(str, "%hhu-%hhu", opts.size, opts.tokens);
-        return ERR_OK;
     }
 
-    error_code export_state(game* self, size_t* ret_size, char* str)
+    std::mutex solver_tables_lock; // only guards the list, not the builds
+    // never released, read only once built, the list is not destroyed at exit either, so the tables stay valid for games used during exit
+    std::vector<solver_table*>& solver_tables = *new std::vector<solver_table*>();
+
+    // returns NULL if the options are too big for a table (ec ERR_FEATURE_UNSUPPORTED) or it could not be built (ec ERR_OUT_OF_MEMORY)
+    const solver_table* get_solver(game* self, error_code* ret_ec = NULL)
     {
-        if (str == NULL) {
-            return ERR_INVALID_INPUT;
+        game_data& gd = *(game_data*)(self->data1);
+        if (gd.solver != NULL) {
+            return gd.solver;
         }
-        data_repr& data = get_repr(self);
-        char* ostr = str;
-        str += sprintf(str, "%hhu>%hhd<%hhu ", data.player_tokens[0], data.push_cell, data.player_tokens[1]);
-        if (data.result_player > PLAYER_NONE) {
-            str += sprintf(str, "%hhu", data.result_player);
+        error_code ec = ERR_OK;
+        solver_table* st = NULL;
+        if (gd.opts.tokens > SOLVER_MAX_TOKENS || solver_pool_size(gd.opts) > SOLVER_MAX_POOL) {
+            ec = ERR_FEATURE_UNSUPPORTED;
         } else {
-            str += sprintf(str, "-");
+            std::lock_guard<std::mutex> guard(solver_tables_lock);
+            for (size_t i = 0; i < solver_tables.size(); i++) {
+                if (solver_tables[i]->size == gd.opts.size && solver_tables[i]->tokens == gd.opts.tokens) {
+                    st = solver_tables[i];
+                    break;
+                }
+            }
+            if (st == NULL) {
+                try {
+                    st = new solver_table();
+                    solver_tables.push_back(st);
+                } catch (const std::bad_alloc&) {
+                    delete st;
+                    st = NULL;
+                    ec = ERR_OUT_OF_MEMORY;
+                }
+                if (st != NULL) {
+                    st->size = gd.opts.size;
+                    st->tokens = gd.opts.tokens;
+                    st->half = gd.opts.size / 2;
+                    st->cells = 2 * st->half + 1;
+                    st->failed = false;
+                }
+            }
         }
-        *ret_size = ostr - str;
-        return ERR_OK;
+        if (st != NULL) {
+            // games with the same options wait here for the build, all others go on
+            std::call_once(st->built, [st]() {
+                try {
+                    solver_build(*st);
+                } catch (const std::bad_alloc&) {
+                    st->value = std::vector<float>();
+                    st->strategy_offset = std::vector<size_t>();
+                    st->strategy_pool = std::vector<float>();
+                    st->failed = true;
+                }
+            });
+            if (st->failed == true) {
+                st = NULL;
+                ec = ERR_OUT_OF_MEMORY;
+            }
+        }
+        gd.solver = st;
+        if (ret_ec != NULL) {
+            *ret_ec = ec;
+        }
+        return gd.solver;
     }
 
-    error_code import_state(game* self, const char* str)
-    {
-        data_repr& data = get_repr(self);
-        if (str == NULL) {
-            opts_repr& opts = get_opts(self);
-            data = data_repr{
-                .result_player = PLAYER_NONE,
-                .push_cell = 0,
-                .player_tokens = {opts.tokens, opts.tokens},
-                .sm_acc_buf = {OSHISUMO_NONE, OSHISUMO_NONE},
-            };
-            return ERR_OK;
-        }
-        int ec = sscanf(str, "%hhu>%hhd<%hhu %hhu", &data.player_tokens[0], &data.push_cell, &data.player_tokens[1], &data.result_player);
-        if (ec < 3) {
+} // namespace
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// impl internal declarations
+static error_code get_tokens_gf(game* self, player_id p, uint8_t* t);
+static error_code set_tokens_gf(game* self, player_id p, uint8_t t);
+static error_code get_cell_gf(game* self, int8_t* c);
+static error_code set_cell_gf(game* self, int8_t c);
+static error_code get_sm_tokens_gf(game* self, player_id p, uint8_t* t);
+static error_code get_equilibrium_gf(game* self, uint8_t tokens_p1, uint8_t tokens_p2, int8_t push_cell, float* ret_value, const float** ret_strategy_p1, const float** ret_strategy_p2);
+
+// the setters handed out in the internal methods, these drop the wrapper query cache before writing
+static error_code ext_set_tokens_gf(game* self, player_id p, uint8_t t);
+static error_code ext_set_cell_gf(game* self, int8_t c);
+
+static error_code resolve_round(game* self);
+
+// need internal function pointer struct here
+static const oshisumo_internal_methods oshisumo_gbe_internal_methods{
+    .get_tokens = get_tokens_gf,
+    .set_tokens = ext_set_tokens_gf,
+    .get_cell = get_cell_gf,
+    .set_cell = ext_set_cell_gf,
+    .get_sm_tokens = get_sm_tokens_gf,
+    .get_equilibrium = get_equilibrium_gf,
+};
+
+// declare and form game
+#define SURENA_GDD_BENAME oshisumo_gbe
+#define SURENA_GDD_GNAME "Oshisumo"
+#define SURENA_GDD_VNAME "Standard"
+#define SURENA_GDD_INAME "surena_default"
+#define SURENA_GDD_VERSION ((semver){0, 2, 0})
+#define SURENA_GDD_INTERNALS &oshisumo_gbe_internal_methods
+#define SURENA_GDD_FF_OPTIONS
+#define SURENA_GDD_FF_MEMORY_USAGE
+#define SURENA_GDD_FF_SYNC_DATA
+#define SURENA_GDD_FF_SIMULTANEOUS_MOVES
+#define SURENA_GDD_FF_ID
+#define SURENA_GDD_FF_EVAL
+#define SURENA_GDD_FF_DISCRETIZE
+#define SURENA_GDD_FF_PLAYOUT
+#define SURENA_GDD_FF_QUERY_INTO
+#define SURENA_GDD_FF_PRINT
+#include "surena/game_decldef.h"
+
+// implementation
+
+static error_code create_gf(game* self, game_init* init_info)
+{
+    self->data1 = malloc(sizeof(game_data));
+    if (self->data1 == NULL) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    self->data2 = NULL;
+    ((game_data*)(self->data1))->solver = NULL;
+
+    opts_repr& opts = get_opts(self);
+    opts.size = 5;
+    opts.tokens = 50;
+    if (init_info->source_type == GAME_INIT_SOURCE_TYPE_STANDARD && init_info->source.standard.opts != NULL) {
+        int ec = sscanf(init_info->source.standard.opts, "%hhu-%hhu", &opts.size, &opts.tokens);
+        if (ec != 2 || opts.size < 2 || opts.size > 120 || opts.tokens < 1 || opts.tokens > 253) {
+            free(self->data1);
+            self->data1 = NULL;
             return ERR_INVALID_INPUT;
         }
-        if (ec < 4) {
-            data.result_player = PLAYER_NONE;
-        }
-        return ERR_OK;
     }
 
-    error_code players_to_move(game* self, uint8_t* ret_count, player_id* players)
     {
-        if (players == NULL) {
-            return ERR_INVALID_INPUT;
-        }
-        data_repr& data = get_repr(self);
-        uint8_t pc = 0;
-        while (pc < 2) {
-            if (data.sm_acc_buf[pc++] == OSHISUMO_NONE) {
-                continue;
+        export_buffers& bufs = get_bufs(self);
+        bufs.options = (char*)malloc(OPTIONS_STR_SIZE * sizeof(char));
+        bufs.state = (char*)malloc(STATE_STR_SIZE * sizeof(char));
+        bufs.players_to_move = (player_id*)malloc(2 * sizeof(player_id));
+        bufs.concrete_moves = (move_data*)malloc((opts.tokens + 1) * sizeof(move_data));
+        bufs.results = (player_id*)malloc(1 * sizeof(player_id));
+        {
+            // we know there is only ever one sync data
+            bufs.sync_out = (sync_data*)malloc(1 * sizeof(sync_data));
+            if (bufs.sync_out != NULL) {
+                bufs.sync_out->player_c = 2;
+                bufs.sync_out->players = (player_id*)malloc(2 * sizeof(player_id));
+                if (bufs.sync_out->players != NULL) {
+                    bufs.sync_out->players[0] = 1;
+                    bufs.sync_out->players[1] = 2;
+                }
+                blob_create(&bufs.sync_out->b, 2 * sizeof(uint8_t));
             }
-            players[pc - 1] = pc;
         }
-        return ERR_OK;
+        bufs.move_str = (char*)malloc(MOVE_STR_SIZE * sizeof(char));
+        bufs.print = (char*)malloc(print_str_size(opts) * sizeof(char));
+        if (bufs.options == NULL ||
+            bufs.state == NULL ||
+            bufs.players_to_move == NULL ||
+            bufs.concrete_moves == NULL ||
+            bufs.results == NULL ||
+            bufs.sync_out == NULL ||
+            bufs.sync_out->players == NULL ||
+            bufs.move_str == NULL ||
+            bufs.print == NULL) {
+            destroy_gf(self);
+            return ERR_OUT_OF_MEMORY;
+        }
     }
+    const char* initial_state = NULL;
+    if (init_info->source_type == GAME_INIT_SOURCE_TYPE_STANDARD) {
+        initial_state = init_info->source.standard.state;
+    }
+    return import_state_gf(self, initial_state);
+}
 
-    error_code get_concrete_moves(game* self, player_id player, uint32_t* ret_count, move_code* moves)
-    {
-        data_repr& data = get_repr(self);
-        for (int i = 0; i <= data.player_tokens[player - 1]; i++) {
-            moves[i] = i;
-        }
-        *ret_count = data.player_tokens[player - 1] + 1;
+static error_code destroy_gf(game* self)
+{
+    if (self->data1 == NULL) {
         return ERR_OK;
     }
-
-    error_code get_actions(game* self, player_id player, uint32_t* ret_count, move_code* moves)
     {
-        //TODO
-        return ERR_FEATURE_UNSUPPORTED;
+        export_buffers& bufs = get_bufs(self);
+        free(bufs.options);
+        free(bufs.state);
+        free(bufs.players_to_move);
+        free(bufs.concrete_moves);
+        free(bufs.results);
+        if (bufs.sync_out != NULL) {
+            // we know there is only ever one sync data
+            free(bufs.sync_out->players);
+            blob_destroy(&bufs.sync_out->b);
+            free(bufs.sync_out);
+        }
+        free(bufs.move_str);
+        free(bufs.print);
     }
+    free(self->data1);
+    self->data1 = NULL;
+    return ERR_OK;
+}
 
-    error_code is_legal_move(game* self, player_id player, move_code move)
-    {
-        //TODO
-        return ERR_FEATURE_UNSUPPORTED;
+static error_code clone_gf(game* self, game* clone_target)
+{
+    size_t size_fill;
+    const char* opts_export;
+    export_options_gf(self, &size_fill, &opts_export);
+    clone_target->methods = self->methods;
+    game_init init_info;
+    game_init_create_standard(&init_info, opts_export, 0, NULL, NULL, NULL, SYNC_CTR_DEFAULT);
+    error_code ec = create_gf(clone_target, &init_info);
+    free((char*)init_info.source.standard.opts);
+    if (ec != ERR_OK) {
+        return ec;
     }
+    copy_from_gf(clone_target, self);
+    return ERR_OK;
+}
 
-    error_code move_to_action(game* self, move_code move, move_code* ret_action)
-    {
-        //TODO
-        return ERR_FEATURE_UNSUPPORTED;
-    }
+static error_code copy_from_gf(game* self, game* other)
+{
+    get_repr(self) = get_repr(other);
+    ((game_data*)(self->data1))->solver = ((game_data*)(other->data1))->solver;
+    return ERR_OK;
+}
 
-    error_code is_action(game* self, move_code move, bool* ret_is_action)
-    {
-        //TODO
-        return ERR_FEATURE_UNSUPPORTED;
-    }
+static error_code memory_usage_gf(game* self, size_t* ret_state, size_t* ret_buffers)
+{
+    opts_repr& opts = get_opts(self);
+    // the solver tables are shared by all games with the same options and never released, so they are not owned by this game
+    *ret_state = sizeof(game_data);
+    *ret_buffers = OPTIONS_STR_SIZE * sizeof(char) +
+                   STATE_STR_SIZE * sizeof(char) +
+                   2 * sizeof(player_id) +
+                   (opts.tokens + 1) * sizeof(move_data) +
+                   1 * sizeof(player_id) +
+                   sizeof(sync_data) + 2 * sizeof(player_id) + 2 * sizeof(uint8_t) +
+                   MOVE_STR_SIZE * sizeof(char) +
+                   print_str_size(opts) * sizeof(char);
+    return ERR_OK;
+}
 
-    error_code make_move(game* self, player_id player, move_code move)
-    {
-        //TODO
-        return ERR_FEATURE_UNSUPPORTED;
-    }
+static error_code export_options_gf(game* self, size_t* ret_size, const char** ret_str)
+{
+    export_buffers& bufs = get_bufs(self);
+    opts_repr& opts = get_opts(self);
+    *ret_size = sprintf(bufs.options, "%hhu-%hhu", opts.size, opts.tokens);
+    *ret_str = bufs.options;
+    return ERR_OK;
+}
 
-    error_code get_results(game* self, uint8_t* ret_count, player_id* players)
-    {
-        //TODO
-        return ERR_FEATURE_UNSUPPORTED;
-    }
+static error_code player_count_gf(game* self, uint8_t* ret_count)
+{
+    *ret_count = 2;
+    return ERR_OK;
+}
 
-    error_code get_scores(game* self, size_t* ret_count, player_id* players, int32_t* scores)
-    {
-        //TODO
-        return ERR_FEATURE_UNSUPPORTED;
-    }
+static error_code export_state_gf(game* self, size_t* ret_size, const char** ret_str)
+{
+    export_buffers& bufs = get_bufs(self);
+    error_code ec = export_state_into_gf(self, STATE_STR_SIZE, ret_size, bufs.state);
+    *ret_str = bufs.state;
+    return ec;
+}
 
-    error_code id(game* self, uint64_t* ret_id)
-    {
-        //TODO
-        return ERR_FEATURE_UNSUPPORTED;
+static error_code export_state_into_gf(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < STATE_STR_SIZE) {
+        *ret_size = STATE_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
     }
-
-    error_code eval(game* self, player_id player, float* ret_eval)
-    {
-        //TODO
-        return ERR_FEATURE_UNSUPPORTED;
+    // format is: "T1>C<T2 B1 B2", where the pending bids B are '-' for none, '*' for hidden or the number of tokens bid
+    state_repr& data = get_repr(self);
+    char* outbuf = str;
+    outbuf += sprintf(outbuf, "%hhu>%hhd<%hhu", data.player_tokens[0], data.push_cell, data.player_tokens[1]);
+    for (int i = 0; i < 2; i++) {
+        if (data.sm_acc_buf[i] == OSHISUMO_NONE) {
+            outbuf += sprintf(outbuf, " -");
+        } else if (data.sm_acc_buf[i] == OSHISUMO_ANY) {
+            outbuf += sprintf(outbuf, " *");
+        } else {
+            outbuf += sprintf(outbuf, " %hhu", data.sm_acc_buf[i]);
+        }
     }
+    *ret_size = outbuf - str;
+    return ERR_OK;
+}
 
-    error_code playout(game* self, uint64_t seed)
-    {
-        //TODO
-        return ERR_FEATURE_UNSUPPORTED;
+static error_code import_state_gf(game* self, const char* str)
+{
+    opts_repr& opts = get_opts(self);
+    state_repr& data = get_repr(self);
+    state_repr new_data = (state_repr){
+        .push_cell = 0,
+        .player_tokens = {opts.tokens, opts.tokens},
+        .sm_acc_buf = {OSHISUMO_NONE, OSHISUMO_NONE},
+        .sm_sync_buf = {OSHISUMO_NONE, OSHISUMO_NONE},
+        .last_bids = {OSHISUMO_NONE, OSHISUMO_NONE},
+        .resolved = false,
+        .done = false,
+    };
+    if (str == NULL) {
+        data = new_data;
+        return ERR_OK;
     }
-
-    error_code redact_keep_state(game* self, uint8_t count, player_id* players)
-    {
-        //TODO
-        return ERR_FEATURE_UNSUPPORTED;
+    char bid_str[2][4];
+    int ec = sscanf(str, "%hhu>%hhd<%hhu %3s %3s", &new_data.player_tokens[0], &new_data.push_cell, &new_data.player_tokens[1], bid_str[0], bid_str[1]);
+    if (ec != 3 && ec != 5) {
+        return ERR_INVALID_INPUT;
     }
+    int half = opts.size / 2;
+    if (new_data.player_tokens[0] > opts.tokens || new_data.player_tokens[1] > opts.tokens || new_data.push_cell > half + 1 || new_data.push_cell < -half - 1) {
+        return ERR_INVALID_INPUT;
+    }
+    for (int i = 0; i < 2 && ec == 5; i++) {
+        if (strcmp(bid_str[i], "-") == 0) {
+            new_data.sm_acc_buf[i] = OSHISUMO_NONE;
+        } else if (strcmp(bid_str[i], "*") == 0) {
+            new_data.sm_acc_buf[i] = OSHISUMO_ANY;
+        } else {
+            unsigned bid;
+            if (sscanf(bid_str[i], "%u", &bid) != 1 || bid > new_data.player_tokens[i]) {
+                return ERR_INVALID_INPUT;
+            }
+            new_data.sm_acc_buf[i] = bid;
+        }
+    }
+    new_data.done = (new_data.push_cell > half || new_data.push_cell < -half || (new_data.player_tokens[0] == 0 && new_data.player_tokens[1] == 0));
+    if (new_data.done == true && (new_data.sm_acc_buf[0] != OSHISUMO_NONE || new_data.sm_acc_buf[1] != OSHISUMO_NONE)) {
+        return ERR_INVALID_INPUT;
+    }
+    data = new_data;
+    if (data.sm_acc_buf[0] != OSHISUMO_NONE && data.sm_acc_buf[1] != OSHISUMO_NONE) {
+        resolve_round(self);
+        data.resolved = false;
+    }
+    return ERR_OK;
+}
 
-    error_code export_sync_data(game* self, sync_data** sync_data_start, sync_data** sync_data_end)
-    {
-        //TODO
-        return ERR_FEATURE_UNSUPPORTED;
+static error_code players_to_move_gf(game* self, uint8_t* ret_count, const player_id** ret_players)
+{
+    export_buffers& bufs = get_bufs(self);
+    players_to_move_into_gf(self, 2, ret_count, bufs.players_to_move);
+    *ret_players = bufs.players_to_move;
+    return ERR_OK;
+}
+
+static error_code players_to_move_into_gf(game* self, uint8_t cap, uint8_t* ret_count, player_id* players)
+{
+    if (cap < 2) {
+        *ret_count = 2;
+        return ERR_OUT_OF_MEMORY;
     }
+    state_repr& data = get_repr(self);
+    if (data.done == true) {
+        *ret_count = 0;
+        return ERR_OK;
+    }
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < 2; i++) {
+        if (data.sm_acc_buf[i] == OSHISUMO_NONE) {
+            players[count++] = i + 1;
+        }
+    }
+    *ret_count = count;
+    return ERR_OK;
+}
 
-    error_code release_sync_data(game* self, sync_data* sync_data_start, sync_data* sync_data_end)
-    {
-        //TODO
-        return ERR_FEATURE_UNSUPPORTED;
+static error_code get_concrete_moves_gf(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves)
+{
+    export_buffers& bufs = get_bufs(self);
+    get_concrete_moves_into_gf(self, player, get_opts(self).tokens + 1, ret_count, bufs.concrete_moves);
+    *ret_moves = bufs.concrete_moves;
+    return ERR_OK;
+}
+
+static error_code get_concrete_moves_into_gf(game* self, player_id player, uint32_t cap, uint32_t* ret_count, move_data* moves)
+{
+    uint32_t max_moves = get_opts(self).tokens + 1;
+    if (cap < max_moves) {
+        *ret_count = max_moves;
+        return ERR_OUT_OF_MEMORY;
+    }
+    state_repr& data = get_repr(self);
+    uint32_t count = 0;
+    // at least one token has to be bid while any are left
+    uint8_t tokens = data.player_tokens[player - 1];
+    for (uint8_t bid = (tokens > 0 ? 1 : 0); bid <= tokens; bid++) {
+        moves[count++] = game_e_create_move_small(bid);
     }
+    *ret_count = count;
+    return ERR_OK;
+}
 
-    error_code import_sync_data(game* self, void* data_start, void* data_end)
-    {
-        //TODO
-        return ERR_FEATURE_UNSUPPORTED;
+static error_code is_legal_move_gf(game* self, player_id player, move_data_sync move)
+{
+    state_repr& data = get_repr(self);
+    if (data.done == true || data.sm_acc_buf[player - 1] != OSHISUMO_NONE) {
+        return ERR_INVALID_INPUT;
+    }
+    move_code mcode = move.md.cl.code;
+    if (mcode == OSHISUMO_ANY) {
+        return ERR_OK; // hidden bid action of another player
     }
+    uint8_t tokens = data.player_tokens[player - 1];
+    if (mcode > tokens || (mcode == 0 && tokens > 0)) {
+        return ERR_INVALID_INPUT;
+    }
+    return ERR_OK;
+}
 
-    error_code get_move_code(game* self, player_id player, const char* str, move_code* ret_move)
-    {
-        //TODO
-        return ERR_FEATURE_UNSUPPORTED;
+static error_code move_to_action_gf(game* self, player_id player, move_data_sync move, uint8_t target_count, const player_id* target_players, move_data_sync** ret_action)
+{
+    export_buffers& bufs = get_bufs(self);
+    // the bidding player keeps their bid, everyone else only learns that a bid was made
+    move_code action = OSHISUMO_ANY;
+    for (uint8_t i = 0; i < target_count; i++) {
+        if (target_players[i] == player) {
+            action = move.md.cl.code;
+            break;
+        }
     }
+    bufs.move_out = game_e_create_move_sync_small(self, action);
+    *ret_action = &bufs.move_out;
+    return ERR_OK;
+}
 
-    error_code get_move_str(game* self, player_id player, move_code move, size_t* ret_size, char* str_buf)
-    {
-        //TODO
-        return ERR_FEATURE_UNSUPPORTED;
+static error_code make_move_gf(game* self, player_id player, move_data_sync move)
+{
+    state_repr& data = get_repr(self);
+    data.resolved = false;
+    data.sm_acc_buf[player - 1] = move.md.cl.code;
+    return resolve_round(self);
+}
+
+static error_code get_results_gf(game* self, uint8_t* ret_count, const player_id** ret_players)
+{
+    export_buffers& bufs = get_bufs(self);
+    state_repr& data = get_repr(self);
+    *ret_count = 0;
+    if (data.done == false || data.push_cell == 0) {
+        return ERR_OK;
     }
+    bufs.results[0] = (data.push_cell > 0 ? 1 : 2);
+    *ret_count = 1;
+    *ret_players = bufs.results;
+    return ERR_OK;
+}
 
-    error_code print(game* self, size_t* ret_size, char* str_buf)
-    {
-        //TODO
-        /* pad the board and inner spacing on the tokens line, '^' just shows the center
-        size 5
-        (5)
-        -| | |X| | |-
-        45    ^    33
-        */
-        if (str_buf == NULL) {
-            return ERR_INVALID_INPUT;
-        }
-        opts_repr& opts = get_opts(self);
-        data_repr& data = get_repr(self);
-        char* ostr = str_buf;
-        char acc_str_buf[6][2];
-        for (int i = 0; i < 2; i++) {
-            if (data.sm_acc_buf[i] == OSHISUMO_ANY) {
-                sprintf(acc_str_buf[i], "(#)");
-            } else if (data.sm_acc_buf[i] != OSHISUMO_NONE) {
-                sprintf(acc_str_buf[i], "(%hhu)", data.sm_acc_buf[i]);
-            }
+static error_code id_gf(game* self, uint64_t* ret_id)
+{
+    state_repr& data = get_repr(self);
+    *ret_id = (uint64_t)data.player_tokens[0] |
+              ((uint64_t)data.player_tokens[1] << 8) |
+              ((uint64_t)(uint8_t)data.push_cell << 16) |
+              ((uint64_t)data.sm_acc_buf[0] << 24) |
+              ((uint64_t)data.sm_acc_buf[1] << 32);
+    return ERR_OK;
+}
+
+static error_code eval_gf(game* self, player_id player, float* ret_eval)
+{
+    state_repr& data = get_repr(self);
+    float value;
+    if (data.done == true) {
+        value = (data.push_cell > 0) - (data.push_cell < 0);
+    } else {
+        const float* strategies[2];
+        error_code ec = get_equilibrium_gf(self, data.player_tokens[0], data.player_tokens[1], data.push_cell, &value, &strategies[0], &strategies[1]);
+        if (ec == ERR_FEATURE_UNSUPPORTED) {
+            // no solver table for options this big, estimate from the cell and the token balance instead
+            int half = get_opts(self).size / 2;
+            int tokens = data.player_tokens[0] + data.player_tokens[1];
+            value = (float)data.push_cell / (half + 1) + (tokens > 0 ? (float)(data.player_tokens[0] - data.player_tokens[1]) / tokens : 0);
+            value = (value > 1 ? 1 : (value < -1 ? -1 : value));
+            *ret_eval = (player == 1 ? value : -value);
+            return ERR_OK;
         }
-        if (data.sm_acc_buf[0] != OSHISUMO_NONE) {
-            str_buf += sprintf(str_buf, "%s", acc_str_buf[0]);
+        if (ec != ERR_OK) {
+            return ec;
         }
-        if (data.sm_acc_buf[1] != OSHISUMO_NONE) {
-            if (data.sm_acc_buf[0] != OSHISUMO_NONE) {
-                str_buf += sprintf(str_buf, " ");
+        // a single known pending bid is played out against the equilibrium of the other player
+        for (int i = 0; i < 2; i++) {
+            uint8_t bid = data.sm_acc_buf[i];
+            if (bid == OSHISUMO_NONE || bid == OSHISUMO_ANY || data.sm_acc_buf[1 - i] != OSHISUMO_NONE) {
+                continue;
             }
-            str_buf += sprintf(str_buf, "%s", acc_str_buf[1]);
-        }
-        if (data.sm_acc_buf[0] != OSHISUMO_NONE || data.sm_acc_buf[1] != OSHISUMO_NONE) {
-            str_buf += sprintf(str_buf, "\n");
-        }
-        //TODO padding
-        if (opts.size % 2 == 0) {
-            for (int i = -1; i <= opts.size; i++) {
-                bool mid_skip = false;
-                if (data.push_cell + opts.size / 2 == i && i == opts.size / 2) {
-                    mid_skip = true;
-                    str_buf += sprintf(str_buf, "!");
-                } else if (i >= 0) {
-                    str_buf += sprintf(str_buf, "|");
-                }
-                if (data.push_cell + (opts.size - ((data.push_cell > 0) ? 1 : 0)) / 2 == i && !mid_skip) {
-                    str_buf += sprintf(str_buf, "X");
-                } else {
-                    if (i == -1 || i == opts.size) {
-                        str_buf += sprintf(str_buf, "-");
-                    } else {
-                        str_buf += sprintf(str_buf, " ");
-                    }
+            const solver_table& st = *get_solver(self);
+            value = 0;
+            for (int other_bid = 0; other_bid <= data.player_tokens[1 - i]; other_bid++) {
+                float p = strategies[1 - i][other_bid];
+                if (p == 0) {
+                    continue;
                 }
+                int b1 = (i == 0 ? bid : other_bid);
+                int b2 = (i == 0 ? other_bid : bid);
+                int nc = data.push_cell + (b1 > b2) - (b1 < b2);
+                value += p * solver_child_value(st, data.player_tokens[0] - b1, data.player_tokens[1] - b2, nc);
             }
-        } else {
-            for (int i = -1; i <= opts.size; i++) {
-                if (data.push_cell + opts.size / 2 == i) {
-                    str_buf += sprintf(str_buf, "X");
-                } else {
-                    if (i == -1 || i == opts.size) {
-                        str_buf += sprintf(str_buf, "-");
-                    } else {
-                        str_buf += sprintf(str_buf, " ");
-                    }
-                }
-                if (i < opts.size) {
-                    str_buf += sprintf(str_buf, "|");
-                }
+        }
+    }
+    *ret_eval = (player == 1 ? value : -value);
+    return ERR_OK;
+}
+
+static error_code discretize_gf(game* self, seed128 seed)
+{
+    state_repr& data = get_repr(self);
+    for (int i = 0; i < 2; i++) {
+        if (data.sm_acc_buf[i] != OSHISUMO_ANY || data.sm_sync_buf[i] != OSHISUMO_NONE) {
+            continue;
+        }
+        uint8_t tokens = data.player_tokens[i];
+        game_rng rng = game_e_rng_create(seed, i); // one stream per player
+        data.sm_acc_buf[i] = (tokens > 0 ? 1 + game_e_rng_intn(&rng, tokens) : 0);
+    }
+    return resolve_round(self);
+}
+
+static error_code playout_gf(game* self, seed128 seed)
+{
+    state_repr& data = get_repr(self);
+    game_rng rng = game_e_rng_create(seed, 0);
+    while (data.done == false) {
+        for (int i = 0; i < 2; i++) {
+            if (data.sm_acc_buf[i] != OSHISUMO_NONE) {
+                continue;
             }
+            uint8_t tokens = data.player_tokens[i];
+            data.sm_acc_buf[i] = (tokens > 0 ? 1 + game_e_rng_intn(&rng, tokens) : 0);
         }
-        str_buf += sprintf(str_buf, "\n%hhu - %hhu\n", data.player_tokens[0], data.player_tokens[1]);
-        return ERR_OK;
+        if (data.sm_acc_buf[0] == OSHISUMO_ANY || data.sm_acc_buf[1] == OSHISUMO_ANY) {
+            return ERR_MISSING_HIDDEN_STATE;
+        }
+        resolve_round(self);
     }
+    return ERR_OK;
+}
 
-    //=====
-    // game internal methods
+static error_code redact_keep_state_gf(game* self, uint8_t count, const player_id* players)
+{
+    state_repr& data = get_repr(self);
+    bool keep[2] = {false, false};
+    for (uint8_t i = 0; i < count; i++) {
+        if (players[i] == PLAYER_ENV) {
+            return ERR_OK;
+        }
+        if (players[i] == 1 || players[i] == 2) {
+            keep[players[i] - 1] = true;
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        if (keep[i] == false && data.sm_acc_buf[i] != OSHISUMO_NONE) {
+            data.sm_acc_buf[i] = OSHISUMO_ANY;
+            data.sm_sync_buf[i] = OSHISUMO_NONE;
+        }
+    }
+    return ERR_OK;
+}
 
-    error_code get_tokens(game* self, player_id p, uint8_t* t)
-    {
-        data_repr& data = get_repr(self);
-        *t = data.player_tokens[p - 1];
+static error_code export_sync_data_gf(game* self, uint32_t* ret_count, const sync_data** ret_sync_data)
+{
+    export_buffers& bufs = get_bufs(self);
+    state_repr& data = get_repr(self);
+    *ret_count = 0;
+    if (data.resolved == false) {
         return ERR_OK;
     }
+    for (int i = 0; i < 2; i++) {
+        ((uint8_t*)bufs.sync_out->b.data)[i] = data.last_bids[i];
+    }
+    *ret_count = 1;
+    *ret_sync_data = bufs.sync_out;
+    return ERR_OK;
+}
 
-    error_code set_tokens(game* self, player_id p, uint8_t t)
-    {
-        data_repr& data = get_repr(self);
-        data.player_tokens[p - 1] = t;
-        return ERR_OK;
+static error_code import_sync_data_gf(game* self, blob b)
+{
+    if (b.len != 2) {
+        return ERR_INVALID_INPUT;
+    }
+    state_repr& data = get_repr(self);
+    for (int i = 0; i < 2; i++) {
+        data.sm_sync_buf[i] = ((uint8_t*)b.data)[i];
     }
+    // sync data may arrive before or after the hidden action it reveals
+    return resolve_round(self);
+}
 
-    error_code get_cell(game* self, int8_t* c)
-    {
-        data_repr& data = get_repr(self);
-        *c = data.push_cell;
-        return ERR_OK;
+static error_code get_move_data_gf(game* self, player_id player, const char* str, move_data_sync** ret_move)
+{
+    export_buffers& bufs = get_bufs(self);
+    move_code mcode;
+    if (strcmp(str, "*") == 0) {
+        mcode = OSHISUMO_ANY;
+    } else {
+        unsigned bid;
+        char tail;
+        if (sscanf(str, "%u%c", &bid, &tail) != 1 || bid > 253) {
+            return ERR_INVALID_INPUT;
+        }
+        mcode = bid;
     }
+    bufs.move_out = game_e_create_move_sync_small(self, mcode);
+    *ret_move = &bufs.move_out;
+    return ERR_OK;
+}
 
-    error_code set_cell(game* self, int8_t c)
-    {
-        data_repr& data = get_repr(self);
-        data.push_cell = c;
-        return ERR_OK;
+static error_code get_move_str_gf(game* self, player_id player, move_data_sync move, size_t* ret_size, const char** ret_str)
+{
+    export_buffers& bufs = get_bufs(self);
+    error_code ec = get_move_str_into_gf(self, player, move, MOVE_STR_SIZE, ret_size, bufs.move_str);
+    *ret_str = bufs.move_str;
+    return ec;
+}
+
+static error_code get_move_str_into_gf(game* self, player_id player, move_data_sync move, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < MOVE_STR_SIZE) {
+        *ret_size = MOVE_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
     }
+    move_code mcode = move.md.cl.code;
+    if (mcode == OSHISUMO_ANY) {
+        *ret_size = sprintf(str, "*");
+    } else {
+        *ret_size = sprintf(str, "%hhu", (uint8_t)mcode);
+    }
+    return ERR_OK;
+}
 
-    error_code get_sm_tokens(game* self, player_id p, uint8_t* t)
-    {
-        data_repr& data = get_repr(self);
-        *t = data.sm_acc_buf[p - 1];
-        return ERR_OK;
+static error_code print_gf(game* self, size_t* ret_size, const char** ret_str)
+{
+    export_buffers& bufs = get_bufs(self);
+    error_code ec = print_into_gf(self, print_str_size(get_opts(self)), ret_size, bufs.print);
+    *ret_str = bufs.print;
+    return ec;
+}
+
+static error_code print_into_gf(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    /* pending bids, then the ring with the wrestler, then the remaining tokens
+    (5) (#)
+    -| | |X| | |-
+    45 - 33
+    */
+    opts_repr& opts = get_opts(self);
+    if (cap < print_str_size(opts)) {
+        *ret_size = print_str_size(opts);
+        return ERR_OUT_OF_MEMORY;
+    }
+    state_repr& data = get_repr(self);
+    char* outbuf = str;
+    bool any_pending = false;
+    for (int i = 0; i < 2; i++) {
+        if (data.sm_acc_buf[i] == OSHISUMO_NONE) {
+            continue;
+        }
+        if (any_pending == true) {
+            outbuf += sprintf(outbuf, " ");
+        }
+        if (data.sm_acc_buf[i] == OSHISUMO_ANY) {
+            outbuf += sprintf(outbuf, "(%c#)", i == 0 ? '<' : '>');
+        } else {
+            outbuf += sprintf(outbuf, "(%c%hhu)", i == 0 ? '<' : '>', data.sm_acc_buf[i]);
+        }
+        any_pending = true;
+    }
+    if (any_pending == true) {
+        outbuf += sprintf(outbuf, "\n");
     }
+    int half = opts.size / 2;
+    for (int i = -half - 1; i <= half + 1; i++) {
+        if (i == data.push_cell) {
+            outbuf += sprintf(outbuf, "X");
+        } else if (i == -half - 1 || i == half + 1) {
+            outbuf += sprintf(outbuf, "-");
+        } else {
+            outbuf += sprintf(outbuf, " ");
+        }
+        if (i <= half) {
+            outbuf += sprintf(outbuf, (i == 0 && opts.size % 2 == 0) ? "!" : "|");
+        }
+    }
+    outbuf += sprintf(outbuf, "\n%hhu - %hhu\n", data.player_tokens[0], data.player_tokens[1]);
+    *ret_size = outbuf - str;
+    return ERR_OK;
+}
 
-} // namespace
+//=====
+// game internal methods
 
-static const oshisumo_internal_methods oshisumo_gbe_internal_methods{
-    .get_tokens = get_tokens,
-    .set_tokens = set_tokens,
-    .get_cell = get_cell,
-    .set_cell = set_cell,
-    .get_sm_tokens = get_sm_tokens,
-};
+static error_code get_tokens_gf(game* self, player_id p, uint8_t* t)
+{
+    state_repr& data = get_repr(self);
+    *t = data.player_tokens[p - 1];
+    return ERR_OK;
+}
 
-const game_methods oshisumo_gbe{
-
-    .game_name = "Oshisumo",
-    .variant_name = "Standard",
-    .impl_name = "surena_default",
-    .version = semver{0, 1, 0},
-    .features = game_feature_flags{
-        .error_strings = false,
-        .options = true,
-        .serializable = false,
-        .legacy = false,
-        .random_moves = false,
-        .hidden_information = false,
-        .simultaneous_moves = true,
-        .move_ordering = false,
-        .scores = true,
-        .id = true,
-        .eval = true,
-        .playout = true,
-        .print = true,
-    },
-    .internal_methods = (void*)&oshisumo_gbe_internal_methods,
-
-#include "surena/game_impl.h"
+static error_code set_tokens_gf(game* self, player_id p, uint8_t t)
+{
+    state_repr& data = get_repr(self);
+    data.player_tokens[p - 1] = t;
+    return ERR_OK;
+}
 
-};
+static error_code ext_set_tokens_gf(game* self, player_id p, uint8_t t)
+{
+    game_e_cache_invalidate(self);
+    return set_tokens_gf(self, p, t);
+}
+
+static error_code get_cell_gf(game* self, int8_t* c)
+{
+    state_repr& data = get_repr(self);
+    *c = data.push_cell;
+    return ERR_OK;
+}
+
+static error_code set_cell_gf(game* self, int8_t c)
+{
+    state_repr& data = get_repr(self);
+    data.push_cell = c;
+    return ERR_OK;
+}
+
+static error_code ext_set_cell_gf(game* self, int8_t c)
+{
+    game_e_cache_invalidate(self);
+    return set_cell_gf(self, c);
+}
+
+static error_code get_sm_tokens_gf(game* self, player_id p, uint8_t* t)
+{
+    state_repr& data = get_repr(self);
+    *t = data.sm_acc_buf[p - 1];
+    return ERR_OK;
+}
+
+static error_code get_equilibrium_gf(game* self, uint8_t tokens_p1, uint8_t tokens_p2, int8_t push_cell, float* ret_value, const float** ret_strategy_p1, const float** ret_strategy_p2)
+{
+    opts_repr& opts = get_opts(self);
+    int half = opts.size / 2;
+    if (tokens_p1 > opts.tokens || tokens_p2 > opts.tokens || push_cell > half || push_cell < -half) {
+        return ERR_INVALID_INPUT;
+    }
+    error_code ec;
+    const solver_table* stp = get_solver(self, &ec);
+    if (stp == NULL) {
+        return ec;
+    }
+    const solver_table& st = *stp;
+    size_t si = st.idx(tokens_p1, tokens_p2, push_cell);
+    *ret_value = st.value[si];
+    *ret_strategy_p1 = &st.strategy_pool[st.strategy_offset[si]];
+    *ret_strategy_p2 = *ret_strategy_p1 + tokens_p1 + 1;
+    return ERR_OK;
+}
+
+// applies the pending bids once both are known, either directly or through sync data
+static error_code resolve_round(game* self)
+{
+    opts_repr& opts = get_opts(self);
+    state_repr& data = get_repr(self);
+    uint8_t bids[2];
+    for (int i = 0; i < 2; i++) {
+        bids[i] = data.sm_acc_buf[i];
+        if (bids[i] == OSHISUMO_ANY) {
+            bids[i] = data.sm_sync_buf[i];
+        }
+        if (bids[i] == OSHISUMO_NONE || bids[i] == OSHISUMO_ANY) {
+            return ERR_OK; // wait for the other bid or the sync data
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        data.player_tokens[i] -= bids[i];
+        data.sm_acc_buf[i] = OSHISUMO_NONE;
+        data.sm_sync_buf[i] = OSHISUMO_NONE;
+        data.last_bids[i] = bids[i];
+    }
+    data.push_cell += (bids[0] > bids[1]) - (bids[0] < bids[1]);
+    data.resolved = true;
+    int half = opts.size / 2;
+    data.done = (data.push_cell > half || data.push_cell < -half || (data.player_tokens[0] == 0 && data.player_tokens[1] == 0));
+    return ERR_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,7 +4,6 @@
 #include <cstdlib>
 #include <cstring>
 
-#include "rosalia/noise.h"
 #include "rosalia/semver.h"
 
 #include "surena/game.h"
@@ -15,6 +14,12 @@
 
 namespace {
 
+    // export buffer sizes, for create and memory_usage
+    const size_t STATE_STR_SIZE = 32; // oversized
+    const uint32_t MAX_MOVES = 8; // generating 1-8 has the most moves
+    const size_t MOVE_STR_SIZE = 2;
+    const size_t PRINT_STR_SIZE = 96; // oversized
+
     struct export_buffers {
         char* state;
         player_id* players_to_move;
@@ -27,7 +32,7 @@ namespace {
     };
 
     struct state_repr {
-        uint64_t seed;
+        seed128 seed; // SEED128_NONE unless discretized, then the generated values are drawn from its stream move_ctr
         uint64_t move_ctr;
         uint8_t num;
         uint8_t generating; // 0 if not, 1 if 1-8, 2 if 4-7
@@ -49,6 +54,108 @@ namespace {
         return ((game_data*)(self->data1))->state;
     }
 
+    bool is_discretized(const state_repr& data)
+    {
+        return memcmp(&data.seed, &SEED128_NONE, sizeof(seed128)) != 0;
+    }
+
+    // generation ranges indexed by state_repr::generating, each value in [min,min+range) is equally likely
+    const int GENERATING_MIN[3] = {0, 1, 4};
+    const int GENERATING_RANGE[3] = {0, 8, 4};
+
+    int num_score(uint8_t num)
+    {
+        int score = -200;
+        switch (num) {
+            case 15: {
+                score += 50;
+            } break;
+            case 16: {
+                score += 100;
+            } break;
+            case 17: {
+                score += 200;
+            } break;
+            case 18: {
+                score += 250;
+            } break;
+            case 19: {
+                score += 300;
+            } break;
+            case 20: {
+                score += 400;
+            } break;
+            default: {
+                score += 0;
+            } break;
+        }
+        return score;
+    }
+
+    bool num_can_big(uint8_t num)
+    {
+        return num <= 19;
+    }
+
+    bool num_can_payout(uint8_t num)
+    {
+        return num > 15;
+    }
+
+    bool num_can_small(uint8_t num)
+    {
+        return num <= 16;
+    }
+
+    // highest reachable num is 19 + 8, everything from 20 upwards is terminal
+    const uint8_t POLICY_NUM_COUNT = 28;
+
+    // exact expected value optimal policy over all (num, generating) states
+    // solved by backward induction, num only ever grows so every chance outcome is already known when it is needed
+    struct policy_table {
+        float ev[POLICY_NUM_COUNT][3]; // [num][generating]
+        move_code best[POLICY_NUM_COUNT]; // optimal decision for generating == 0
+
+        policy_table()
+        {
+            for (int n = POLICY_NUM_COUNT - 1; n >= 0; n--) {
+                if (n >= 20) {
+                    for (int g = 0; g < 3; g++) {
+                        ev[n][g] = num_score(n);
+                    }
+                    best[n] = QUASAR_MOVE_PAYOUT;
+                    continue;
+                }
+                ev[n][0] = 0;
+                for (int g = 1; g < 3; g++) {
+                    float acc = 0;
+                    for (int v = GENERATING_MIN[g]; v < GENERATING_MIN[g] + GENERATING_RANGE[g]; v++) {
+                        acc += ev[n + v][0];
+                    }
+                    ev[n][g] = acc / GENERATING_RANGE[g];
+                }
+                // prefer the safe payout on ties
+                bool have_best = false;
+                if (num_can_payout(n) == true) {
+                    ev[n][0] = num_score(n);
+                    best[n] = QUASAR_MOVE_PAYOUT;
+                    have_best = true;
+                }
+                if (num_can_big(n) == true && (have_best == false || ev[n][1] > ev[n][0])) {
+                    ev[n][0] = ev[n][1];
+                    best[n] = QUASAR_MOVE_BIG;
+                    have_best = true;
+                }
+                if (num_can_small(n) == true && (have_best == false || ev[n][2] > ev[n][0])) {
+                    ev[n][0] = ev[n][2];
+                    best[n] = QUASAR_MOVE_SMALL;
+                }
+            }
+        }
+    };
+
+    const policy_table quasar_policy;
+
 } // namespace
 
 #ifdef __cplusplus
@@ -61,6 +168,8 @@ static error_code get_score_gf(game* self, int* s);
 static error_code can_big_gf(game* self, bool* r);
 static error_code can_payout_gf(game* self, bool* r);
 static error_code can_small_gf(game* self, bool* r);
+static error_code get_exact_ev_gf(game* self, float* ev);
+static error_code get_optimal_move_gf(game* self, move_code* m);
 
 // need internal function pointer struct here
 static const quasar_internal_methods quasar_gbe_internal_methods{
@@ -68,19 +177,24 @@ static const quasar_internal_methods quasar_gbe_internal_methods{
     .get_score = get_score_gf,
     .can_big = can_big_gf,
     .can_payout = can_payout_gf,
-    .can_small = can_small_gf};
+    .can_small = can_small_gf,
+    .get_exact_ev = get_exact_ev_gf,
+    .get_optimal_move = get_optimal_move_gf,
+};
 
 // declare and form game
 #define SURENA_GDD_BENAME quasar_standard_gbe
 #define SURENA_GDD_GNAME "Quasar"
 #define SURENA_GDD_VNAME "Standard"
 #define SURENA_GDD_INAME "surena_default"
-#define SURENA_GDD_VERSION ((semver){1, 0, 1})
+#define SURENA_GDD_VERSION ((semver){1, 1, 0})
 #define SURENA_GDD_INTERNALS &quasar_gbe_internal_methods
 #define SURENA_GDD_FF_RANDOM_MOVES
+#define SURENA_GDD_FF_MEMORY_USAGE
 #define SURENA_GDD_FF_ID
 #define SURENA_GDD_FF_EVAL
 #define SURENA_GDD_FF_DISCRETIZE
+#define SURENA_GDD_FF_QUERY_INTO
 #define SURENA_GDD_FF_PRINT
 #include "surena/game_decldef.h"
 
@@ -95,13 +209,13 @@ static error_code create_gf(game* self, game_init* init_info)
     self->data2 = NULL;
     {
         export_buffers& bufs = get_bufs(self);
-        bufs.state = (char*)malloc(32 * sizeof(char)); // oversized
+        bufs.state = (char*)malloc(STATE_STR_SIZE * sizeof(char));
         bufs.players_to_move = (player_id*)malloc(1 * sizeof(player_id));
-        bufs.concrete_moves = (move_data*)malloc(8 * sizeof(move_data));
-        bufs.move_probabilities = (float*)malloc(8 * sizeof(float));
+        bufs.concrete_moves = (move_data*)malloc(MAX_MOVES * sizeof(move_data));
+        bufs.move_probabilities = (float*)malloc(MAX_MOVES * sizeof(float));
         bufs.results = (player_id*)malloc(1 * sizeof(char));
-        bufs.move_str = (char*)malloc(2 * sizeof(char));
-        bufs.print = (char*)malloc(64 * sizeof(char)); // oversized
+        bufs.move_str = (char*)malloc(MOVE_STR_SIZE * sizeof(char));
+        bufs.print = (char*)malloc(PRINT_STR_SIZE * sizeof(char));
         if (bufs.state == NULL ||
             bufs.players_to_move == NULL ||
             bufs.concrete_moves == NULL ||
@@ -132,6 +246,8 @@ static error_code destroy_gf(game* self)
         free(bufs.move_str);
         free(bufs.print);
     }
+    free(self->data1);
+    self->data1 = NULL;
     return grerrorf(self, ERR_OK, NULL);
 }
 
@@ -153,6 +269,19 @@ static error_code copy_from_gf(game* self, game* other)
     return ERR_OK;
 }
 
+static error_code memory_usage_gf(game* self, size_t* ret_state, size_t* ret_buffers)
+{
+    *ret_state = sizeof(game_data);
+    *ret_buffers = STATE_STR_SIZE * sizeof(char) +
+                   1 * sizeof(player_id) +
+                   MAX_MOVES * sizeof(move_data) +
+                   MAX_MOVES * sizeof(float) +
+                   1 * sizeof(player_id) +
+                   MOVE_STR_SIZE * sizeof(char) +
+                   PRINT_STR_SIZE * sizeof(char);
+    return ERR_OK;
+}
+
 static error_code compare_gf(game* self, game* other, bool* ret_equal)
 {
     *ret_equal = (memcmp(&get_repr(self), &get_repr(other), sizeof(state_repr)) == 0);
@@ -168,8 +297,19 @@ static error_code player_count_gf(game* self, uint8_t* ret_count)
 static error_code export_state_gf(game* self, player_id player, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
+    error_code ec = export_state_into_gf(self, STATE_STR_SIZE, ret_size, bufs.state);
+    *ret_str = bufs.state;
+    return ec;
+}
+
+static error_code export_state_into_gf(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < STATE_STR_SIZE) {
+        *ret_size = STATE_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
+    }
     state_repr& data = get_repr(self);
-    char* outbuf = bufs.state;
+    char* outbuf = str;
     outbuf += sprintf(outbuf, "%hhu", data.num);
     if (data.done == true) {
         outbuf += sprintf(outbuf, " D");
@@ -183,8 +323,7 @@ static error_code export_state_gf(game* self, player_id player, size_t* ret_size
         }
     }
     outbuf += sprintf(outbuf, " %lu", data.move_ctr);
-    *ret_size = outbuf - bufs.state;
-    *ret_str = bufs.state;
+    *ret_size = outbuf - str;
     return ERR_OK;
 }
 
@@ -228,24 +367,44 @@ static error_code import_state_gf(game* self, const char* str)
 
 static error_code players_to_move_gf(game* self, uint8_t* ret_count, const player_id** ret_players)
 {
+    export_buffers& bufs = get_bufs(self);
+    players_to_move_into_gf(self, 1, ret_count, bufs.players_to_move);
+    *ret_players = bufs.players_to_move;
+    return ERR_OK;
+}
+
+static error_code players_to_move_into_gf(game* self, uint8_t cap, uint8_t* ret_count, player_id* players)
+{
+    if (cap < 1) {
+        *ret_count = 1;
+        return ERR_OUT_OF_MEMORY;
+    }
     state_repr& data = get_repr(self);
     *ret_count = 1;
     if (data.done == true) {
         *ret_count = 0;
         return ERR_OK;
     }
-    export_buffers& bufs = get_bufs(self);
-    player_id* outbuf = bufs.players_to_move;
-    *outbuf = (data.generating == 0 ? 1 : PLAYER_RAND);
-    *ret_players = outbuf;
+    *players = (data.generating == 0 ? 1 : PLAYER_ENV);
     return ERR_OK;
 }
 
 static error_code get_concrete_moves_gf(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves)
 {
     export_buffers& bufs = get_bufs(self);
+    get_concrete_moves_into_gf(self, player, MAX_MOVES, ret_count, bufs.concrete_moves);
+    *ret_moves = bufs.concrete_moves;
+    return ERR_OK;
+}
+
+static error_code get_concrete_moves_into_gf(game* self, player_id player, uint32_t cap, uint32_t* ret_count, move_data* moves)
+{
+    if (cap < MAX_MOVES) {
+        *ret_count = MAX_MOVES;
+        return ERR_OUT_OF_MEMORY;
+    }
     state_repr& data = get_repr(self);
-    move_data* outbuf = bufs.concrete_moves;
+    move_data* outbuf = moves;
     uint32_t count = 0;
     if (data.generating == 0) {
         bool can_big;
@@ -264,10 +423,10 @@ static error_code get_concrete_moves_gf(game* self, player_id player, uint32_t*
             outbuf[count++] = game_e_create_move_small(QUASAR_MOVE_SMALL);
         }
     } else {
-        if (data.seed != SEED128_NONE) {
-            int min = (data.generating == 1 ? 1 : 4);
-            int range = (data.generating == 1 ? 8 : 4);
-            int val = min + squirrelnoise5(data.move_ctr, data.seed) % range; //BUG this has modulo bias, use proper rand_intn
+        if (is_discretized(data) == true) {
+            // the one value already decided, the probabilities list just this one as well
+            game_rng rng = game_e_rng_create(data.seed, data.move_ctr);
+            int val = GENERATING_MIN[data.generating] + game_e_rng_intn(&rng, GENERATING_RANGE[data.generating]);
             outbuf[count++] = game_e_create_move_small(val);
         } else {
             if (data.generating == 1) {
@@ -282,7 +441,6 @@ static error_code get_concrete_moves_gf(game* self, player_id player, uint32_t*
         }
     }
     *ret_count = count;
-    *ret_moves = bufs.concrete_moves;
     return ERR_OK;
 }
 
@@ -292,13 +450,12 @@ static error_code get_concrete_move_probabilities_gf(game* self, uint32_t* ret_c
     state_repr& data = get_repr(self);
     float* outbuf = bufs.move_probabilities;
     uint32_t count = 0;
-    if (data.generating == 1) {
-        for (int i = 1; i < 9; i++) {
-            outbuf[count++] = 0.125;
-        }
+    if (is_discretized(data) == true) {
+        outbuf[count++] = 1.0f;
     } else {
-        for (int i = 4; i < 8; i++) {
-            outbuf[count++] = 0.25;
+        int range = GENERATING_RANGE[data.generating == 1 ? 1 : 2];
+        for (int i = 0; i < range; i++) {
+            outbuf[count++] = 1.0f / range;
         }
     }
     *ret_count = count;
@@ -306,7 +463,7 @@ static error_code get_concrete_move_probabilities_gf(game* self, uint32_t* ret_c
     return ERR_OK;
 }
 
-static error_code get_random_move_gf(game* self, uint64_t seed, move_data_sync** ret_move)
+static error_code get_random_move_gf(game* self, seed128 seed, move_data_sync** ret_move)
 {
     export_buffers& bufs = get_bufs(self);
     move_data_sync* outbuf = &bufs.move_out;
@@ -406,24 +563,10 @@ static error_code id_gf(game* self, uint64_t* ret_id)
 
 static error_code eval_gf(game* self, player_id player, float* ret_eval)
 {
-    state_repr& data = get_repr(self);
-    if (data.done == true) {
-        int score;
-        get_score_gf(self, &score);
-        *ret_eval = score;
-    } else {
-        // from the wiki https://masseffect.fandom.com/wiki/Quasar
-        if (data.num > 20) {
-            *ret_eval = -200;
-            return ERR_OK;
-        }
-        float lut[] = {45, 38, 36, 37, 43, 47, 51, 37, 18, 22, 30, 17, 18, 19, -25, -56, 50, 100, 150, 200};
-        *ret_eval = lut[data.num];
-    }
-    return ERR_OK;
+    return get_exact_ev_gf(self, ret_eval);
 }
 
-static error_code discretize_gf(game* self, uint64_t seed)
+static error_code discretize_gf(game* self, seed128 seed)
 {
     state_repr& data = get_repr(self);
     data.seed = seed;
@@ -434,7 +577,7 @@ static error_code redact_keep_state_gf(game* self, uint8_t count, const player_i
 {
     bool keep_rand = false;
     for (uint8_t i = 0; i < count; i++) {
-        if (players[i] == PLAYER_RAND) {
+        if (players[i] == PLAYER_ENV) {
             keep_rand = true;
             break;
         }
@@ -482,7 +625,18 @@ static error_code get_move_data_gf(game* self, player_id player, const char* str
 static error_code get_move_str_gf(game* self, player_id player, move_data_sync move, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
-    char* outbuf = bufs.move_str;
+    error_code ec = get_move_str_into_gf(self, player, move, MOVE_STR_SIZE, ret_size, bufs.move_str);
+    *ret_str = bufs.move_str;
+    return ec;
+}
+
+static error_code get_move_str_into_gf(game* self, player_id player, move_data_sync move, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < MOVE_STR_SIZE) {
+        *ret_size = MOVE_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
+    }
+    char* outbuf = str;
     move_code mcode = move.md.cl.code;
     if (mcode == QUASAR_MOVE_BIG) {
         outbuf += sprintf(outbuf, "B");
@@ -494,22 +648,36 @@ static error_code get_move_str_gf(game* self, player_id player, move_data_sync m
         uint8_t val = mcode & 0xFF;
         outbuf += sprintf(outbuf, "%hhu", val);
     }
-    *ret_size = outbuf - bufs.move_str;
-    *ret_str = bufs.move_str;
+    *ret_size = outbuf - str;
     return ERR_OK;
 }
 
 static error_code print_gf(game* self, player_id player, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
+    error_code ec = print_into_gf(self, PRINT_STR_SIZE, ret_size, bufs.print);
+    *ret_str = bufs.print;
+    return ec;
+}
+
+static error_code print_into_gf(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < PRINT_STR_SIZE) {
+        *ret_size = PRINT_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
+    }
     state_repr& data = get_repr(self);
-    char* outbuf = bufs.print;
+    char* outbuf = str;
     {
         int score;
         get_score_gf(self, &score);
         outbuf += sprintf(outbuf, "%hhu: %d", data.num, score);
-        if (data.seed != SEED128_NONE) {
-            outbuf += sprintf(outbuf, "(%016lx)\n", data.seed);
+        if (is_discretized(data) == true) {
+            outbuf += sprintf(outbuf, "(");
+            for (int i = 0; i < 16; i++) {
+                outbuf += sprintf(outbuf, "%02hhx", data.seed.bytes[i]);
+            }
+            outbuf += sprintf(outbuf, ")\n");
         } else {
             outbuf += sprintf(outbuf, "\n");
         }
@@ -558,8 +726,7 @@ static error_code print_gf(game* self, player_id player, size_t* ret_size, const
             }
         }
     }
-    *ret_size = outbuf - bufs.print;
-    *ret_str = bufs.print;
+    *ret_size = outbuf - str;
     return ERR_OK;
 }
 
@@ -576,52 +743,49 @@ static error_code get_num_gf(game* self, uint8_t* n)
 static error_code get_score_gf(game* self, int* s)
 {
     state_repr& data = get_repr(self);
-    int score = -200;
-    switch (data.num) {
-        case 15: {
-            score += 50;
-        } break;
-        case 16: {
-            score += 100;
-        } break;
-        case 17: {
-            score += 200;
-        } break;
-        case 18: {
-            score += 250;
-        } break;
-        case 19: {
-            score += 300;
-        } break;
-        case 20: {
-            score += 400;
-        } break;
-        default: {
-            score += 0;
-        } break;
-    }
-    *s = score;
+    *s = num_score(data.num);
     return ERR_OK;
 }
 
 static error_code can_big_gf(game* self, bool* r)
 {
     state_repr& data = get_repr(self);
-    *r = (data.num <= 19 && data.generating == 0 && data.done == false);
+    *r = (num_can_big(data.num) && data.generating == 0 && data.done == false);
     return ERR_OK;
 }
 
 static error_code can_payout_gf(game* self, bool* r)
 {
     state_repr& data = get_repr(self);
-    *r = (data.num > 15 && data.generating == 0 && data.done == false);
+    *r = (num_can_payout(data.num) && data.generating == 0 && data.done == false);
     return ERR_OK;
 }
 
 static error_code can_small_gf(game* self, bool* r)
 {
     state_repr& data = get_repr(self);
-    *r = (data.num <= 16 && data.generating == 0 && data.done == false);
+    *r = (num_can_small(data.num) && data.generating == 0 && data.done == false);
+    return ERR_OK;
+}
+
+static error_code get_exact_ev_gf(game* self, float* ev)
+{
+    state_repr& data = get_repr(self);
+    if (data.done == true || data.num >= POLICY_NUM_COUNT) {
+        *ev = num_score(data.num);
+        return ERR_OK;
+    }
+    *ev = quasar_policy.ev[data.num][data.generating];
+    return ERR_OK;
+}
+
+static error_code get_optimal_move_gf(game* self, move_code* m)
+{
+    state_repr& data = get_repr(self);
+    if (data.done == true || data.generating != 0 || data.num >= POLICY_NUM_COUNT) {
+        return ERR_INVALID_INPUT;
+    }
+    *m = quasar_policy.best[data.num];
     return ERR_OK;
 }
 
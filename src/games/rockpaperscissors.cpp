@@ -16,16 +16,31 @@
 
 namespace {
 
+    // sync data and actions are handed out from small rings inside the game data
+    // so the outputs of the last few rounds stay valid and no allocations happen after create
+    const uint8_t OUT_RING_SIZE = 4;
+
+    // export buffer sizes, for create and memory_usage
+    const size_t STATE_STR_SIZE = 8; // oversized
+    const uint32_t MOVE_COUNT = 3; // rock, paper, scissors
+    const size_t MOVE_STR_SIZE = 2;
+    const size_t PRINT_STR_SIZE = 8; // oversized
+
     struct export_buffers {
         char* state;
         player_id* players_to_move;
         move_data* concrete_moves;
         move_data* actions;
         player_id* results;
-        sync_data* sync_out;
         move_data_sync move_out;
         char* move_str;
         char* print;
+        sync_data sync_ring[OUT_RING_SIZE];
+        player_id sync_ring_players[OUT_RING_SIZE][2];
+        uint8_t sync_ring_data[OUT_RING_SIZE][2];
+        uint8_t sync_ring_idx;
+        move_data_sync action_ring[OUT_RING_SIZE];
+        uint8_t action_ring_idx;
     };
 
     struct state_repr {
@@ -59,6 +74,10 @@ extern "C" {
 static error_code get_played_gf(game* self, player_id p, uint8_t* m);
 static error_code calc_done_gf(game* self);
 
+// impl hidden helpers
+static size_t write_state(game* self, player_id player, char* str);
+static size_t write_print(game* self, player_id player, char* str);
+
 // need internal function pointer struct here
 static const rockpaperscissors_internal_methods rockpaperscissors_gbe_internal_methods{
     .get_played = get_played_gf,
@@ -70,10 +89,13 @@ static const rockpaperscissors_internal_methods rockpaperscissors_gbe_internal_m
 #define SURENA_GDD_GNAME "RockPaperScissors"
 #define SURENA_GDD_VNAME "Standard"
 #define SURENA_GDD_INAME "surena_default"
-#define SURENA_GDD_VERSION ((semver){1, 0, 1})
+#define SURENA_GDD_VERSION ((semver){1, 1, 0})
 #define SURENA_GDD_INTERNALS &rockpaperscissors_gbe_internal_methods
+#define SURENA_GDD_FF_SYNC_DATA
+#define SURENA_GDD_FF_MEMORY_USAGE
 #define SURENA_GDD_FF_SIMULTANEOUS_MOVES
 #define SURENA_GDD_FF_DISCRETIZE
+#define SURENA_GDD_FF_QUERY_INTO
 #define SURENA_GDD_FF_PRINT
 #include "surena/game_decldef.h"
 
@@ -88,22 +110,28 @@ static error_code create_gf(game* self, game_init* init_info)
     self->data2 = NULL;
     {
         export_buffers& bufs = get_bufs(self);
-        bufs.state = (char*)malloc(8 * sizeof(char)); // oversized
+        bufs.state = (char*)malloc(STATE_STR_SIZE * sizeof(char));
         bufs.players_to_move = (player_id*)malloc(2 * sizeof(player_id));
-        bufs.concrete_moves = (move_data*)malloc(3 * sizeof(move_data));
+        bufs.concrete_moves = (move_data*)malloc(MOVE_COUNT * sizeof(move_data));
         bufs.actions = (move_data*)malloc(1 * sizeof(move_data));
         bufs.results = (player_id*)malloc(1 * sizeof(char));
-        {
-            // we know there is only ever one sync data
-            bufs.sync_out = (sync_data*)malloc(1 * sizeof(sync_data));
-            bufs.sync_out->player_c = 1;
-            bufs.sync_out->players = (player_id*)malloc(2 * sizeof(player_id));
-            bufs.sync_out->players[0] = 1;
-            bufs.sync_out->players[1] = 2;
-            blob_create(&bufs.sync_out->b, 2 * sizeof(uint8_t));
+        for (uint8_t i = 0; i < OUT_RING_SIZE; i++) {
+            // there is only ever one sync data per round, it goes to both players
+            bufs.sync_ring_players[i][0] = 1;
+            bufs.sync_ring_players[i][1] = 2;
+            bufs.sync_ring[i] = (sync_data){
+                .player_c = 2,
+                .players = bufs.sync_ring_players[i],
+                .b = (blob){
+                    .len = 2 * sizeof(uint8_t),
+                    .data = bufs.sync_ring_data[i],
+                },
+            };
         }
-        bufs.move_str = (char*)malloc(2 * sizeof(char));
-        bufs.print = (char*)malloc(8 * sizeof(char)); // oversized
+        bufs.sync_ring_idx = 0;
+        bufs.action_ring_idx = 0;
+        bufs.move_str = (char*)malloc(MOVE_STR_SIZE * sizeof(char));
+        bufs.print = (char*)malloc(PRINT_STR_SIZE * sizeof(char));
         if (bufs.state == NULL ||
             bufs.players_to_move == NULL ||
             bufs.concrete_moves == NULL ||
@@ -131,15 +159,11 @@ static error_code destroy_gf(game* self)
         free(bufs.concrete_moves);
         free(bufs.actions);
         free(bufs.results);
-        {
-            // we know there is only ever one sync data
-            free(bufs.sync_out->players);
-            blob_destroy(&bufs.sync_out->b);
-            free(bufs.sync_out);
-        }
         free(bufs.move_str);
         free(bufs.print);
     }
+    free(self->data1);
+    self->data1 = NULL;
     return grerrorf(self, ERR_OK, NULL);
 }
 
@@ -161,6 +185,20 @@ static error_code copy_from_gf(game* self, game* other)
     return ERR_OK;
 }
 
+static error_code memory_usage_gf(game* self, size_t* ret_state, size_t* ret_buffers)
+{
+    // the sync data and action rings live inside the game data and are counted with it
+    *ret_state = sizeof(game_data);
+    *ret_buffers = STATE_STR_SIZE * sizeof(char) +
+                   2 * sizeof(player_id) +
+                   MOVE_COUNT * sizeof(move_data) +
+                   1 * sizeof(move_data) +
+                   1 * sizeof(player_id) +
+                   MOVE_STR_SIZE * sizeof(char) +
+                   PRINT_STR_SIZE * sizeof(char);
+    return ERR_OK;
+}
+
 static error_code compare_gf(game* self, game* other, bool* ret_equal)
 {
     *ret_equal = (memcmp(&get_repr(self), &get_repr(other), sizeof(state_repr)) == 0);
@@ -176,56 +214,21 @@ static error_code player_count_gf(game* self, uint8_t* ret_count)
 static error_code export_state_gf(game* self, player_id player, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
-    state_repr& data = get_repr(self);
-    char* outbuf = bufs.state;
-    uint8_t acc1 = data.acc[0];
-    if (data.done == false && acc1 != ROCKPAPERSCISSORS_NONE && (player != 1 && player != PLAYER_NONE)) {
-        acc1 = ROCKPAPERSCISSORS_ANY;
-    }
-    switch (acc1) {
-        case ROCKPAPERSCISSORS_NONE: {
-            outbuf += sprintf(outbuf, "-");
-        } break;
-        case ROCKPAPERSCISSORS_ANY: {
-            outbuf += sprintf(outbuf, "*");
-        } break;
-        case ROCKPAPERSCISSORS_ROCK: {
-            outbuf += sprintf(outbuf, "R");
-        } break;
-        case ROCKPAPERSCISSORS_PAPER: {
-            outbuf += sprintf(outbuf, "P");
-        } break;
-        case ROCKPAPERSCISSORS_SCISSOR: {
-            outbuf += sprintf(outbuf, "S");
-        } break;
-    }
-    outbuf += sprintf(outbuf, "-");
-    uint8_t acc2 = data.acc[1];
-    if (data.done == false && acc2 != ROCKPAPERSCISSORS_NONE && (player != 2 && player != PLAYER_NONE)) {
-        acc2 = ROCKPAPERSCISSORS_ANY;
-    }
-    switch (acc2) {
-        case ROCKPAPERSCISSORS_NONE: {
-            outbuf += sprintf(outbuf, "-");
-        } break;
-        case ROCKPAPERSCISSORS_ANY: {
-            outbuf += sprintf(outbuf, "*");
-        } break;
-        case ROCKPAPERSCISSORS_ROCK: {
-            outbuf += sprintf(outbuf, "R");
-        } break;
-        case ROCKPAPERSCISSORS_PAPER: {
-            outbuf += sprintf(outbuf, "P");
-        } break;
-        case ROCKPAPERSCISSORS_SCISSOR: {
-            outbuf += sprintf(outbuf, "S");
-        } break;
-    }
-    *ret_size = outbuf - bufs.state;
+    *ret_size = write_state(self, player, bufs.state);
     *ret_str = bufs.state;
     return ERR_OK;
 }
 
+static error_code export_state_into_gf(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < STATE_STR_SIZE) {
+        *ret_size = STATE_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
+    }
+    *ret_size = write_state(self, PLAYER_NONE, str);
+    return ERR_OK;
+}
+
 static error_code import_state_gf(game* self, const char* str)
 {
     state_repr& data = get_repr(self);
@@ -270,35 +273,52 @@ static error_code import_state_gf(game* self, const char* str)
 
 static error_code players_to_move_gf(game* self, uint8_t* ret_count, const player_id** ret_players)
 {
+    export_buffers& bufs = get_bufs(self);
+    players_to_move_into_gf(self, 2, ret_count, bufs.players_to_move);
+    *ret_players = bufs.players_to_move;
+    return ERR_OK;
+}
+
+static error_code players_to_move_into_gf(game* self, uint8_t cap, uint8_t* ret_count, player_id* players)
+{
+    if (cap < 2) {
+        *ret_count = 2;
+        return ERR_OUT_OF_MEMORY;
+    }
     state_repr& data = get_repr(self);
     if (data.done == true) {
         *ret_count = 0;
         return ERR_OK;
     }
-    export_buffers& bufs = get_bufs(self);
     uint8_t count = 0;
-    player_id* outbuf = bufs.players_to_move;
     for (uint8_t i = 0; i < 2; i++) {
         if (data.acc[i] == ROCKPAPERSCISSORS_NONE) {
-            outbuf[count++] = i + 1;
+            players[count++] = i + 1;
         }
     }
     *ret_count = count;
-    *ret_players = outbuf;
     return ERR_OK;
 }
 
 static error_code get_concrete_moves_gf(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves)
 {
     export_buffers& bufs = get_bufs(self);
-    state_repr& data = get_repr(self);
-    uint8_t count = 0;
-    move_data* outbuf = bufs.concrete_moves;
-    outbuf[count++] = game_e_create_move_small(ROCKPAPERSCISSORS_ROCK);
-    outbuf[count++] = game_e_create_move_small(ROCKPAPERSCISSORS_PAPER);
-    outbuf[count++] = game_e_create_move_small(ROCKPAPERSCISSORS_SCISSOR);
+    get_concrete_moves_into_gf(self, player, MOVE_COUNT, ret_count, bufs.concrete_moves);
+    *ret_moves = bufs.concrete_moves;
+    return ERR_OK;
+}
+
+static error_code get_concrete_moves_into_gf(game* self, player_id player, uint32_t cap, uint32_t* ret_count, move_data* moves)
+{
+    if (cap < MOVE_COUNT) {
+        *ret_count = MOVE_COUNT;
+        return ERR_OUT_OF_MEMORY;
+    }
+    uint32_t count = 0;
+    moves[count++] = game_e_create_move_small(ROCKPAPERSCISSORS_ROCK);
+    moves[count++] = game_e_create_move_small(ROCKPAPERSCISSORS_PAPER);
+    moves[count++] = game_e_create_move_small(ROCKPAPERSCISSORS_SCISSOR);
     *ret_count = count;
-    *ret_moves = outbuf;
     return ERR_OK;
 }
 
@@ -324,16 +344,24 @@ static error_code is_legal_move_gf(game* self, player_id player, move_data_sync
     return ERR_OK;
 }
 
-static error_code move_to_action_gf(game* self, player_id player, move_data_sync move, player_id target_player, move_data_sync** ret_action)
+static error_code move_to_action_gf(game* self, player_id player, move_data_sync move, uint8_t target_count, const player_id* target_players, move_data_sync** ret_action)
 {
-    //TODO is this ok?
     export_buffers& bufs = get_bufs(self);
-    if (player == target_player) { // playing player gets their move, everyone else gets the any action
-        bufs.move_out = game_e_create_move_sync_small(self, move.md.cl.code);
-    } else {
-        bufs.move_out = game_e_create_move_sync_small(self, ROCKPAPERSCISSORS_ANY);
+    // playing player gets their move, everyone else gets the any action
+    move_code action = ROCKPAPERSCISSORS_ANY;
+    for (uint8_t i = 0; i < target_count; i++) {
+        if (target_players[i] == player) {
+            action = move.md.cl.code;
+            break;
+        }
     }
-    *ret_action = &bufs.move_out;
+    move_data_sync* outbuf = &bufs.action_ring[bufs.action_ring_idx];
+    bufs.action_ring_idx = (bufs.action_ring_idx + 1) % OUT_RING_SIZE;
+    *outbuf = (move_data_sync){
+        .md = {.cl = {.code = action}, .data = NULL},
+        .sync_ctr = move.sync_ctr,
+    };
+    *ret_action = outbuf;
     return ERR_OK;
 }
 
@@ -395,19 +423,25 @@ static error_code export_sync_data_gf(game* self, uint32_t* ret_count, const syn
 {
     export_buffers& bufs = get_bufs(self);
     state_repr& data = get_repr(self);
+    *ret_count = 0;
     if (data.done == false) {
         return ERR_OK;
     }
+    sync_data* outbuf = &bufs.sync_ring[bufs.sync_ring_idx];
+    bufs.sync_ring_idx = (bufs.sync_ring_idx + 1) % OUT_RING_SIZE;
     for (int i = 0; i < 2; i++) {
-        ((uint8_t*)bufs.sync_out->b.data)[i] = data.acc[i];
+        ((uint8_t*)outbuf->b.data)[i] = data.acc[i];
     }
     *ret_count = 1;
-    *ret_sync_data = bufs.sync_out;
+    *ret_sync_data = outbuf;
     return ERR_OK;
 }
 
 static error_code import_sync_data_gf(game* self, blob b)
 {
+    if (b.len != 2) {
+        return ERR_INVALID_INPUT;
+    }
     state_repr& data = get_repr(self);
     for (int i = 0; i < 2; i++) {
         data.acc[i] = ((uint8_t*)b.data)[i];
@@ -450,7 +484,18 @@ static error_code get_move_data_gf(game* self, player_id player, const char* str
 static error_code get_move_str_gf(game* self, player_id player, move_data_sync move, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
-    char* outbuf = bufs.move_str;
+    error_code ec = get_move_str_into_gf(self, player, move, MOVE_STR_SIZE, ret_size, bufs.move_str);
+    *ret_str = bufs.move_str;
+    return ec;
+}
+
+static error_code get_move_str_into_gf(game* self, player_id player, move_data_sync move, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < MOVE_STR_SIZE) {
+        *ret_size = MOVE_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
+    }
+    char* outbuf = str;
     move_code mcode = move.md.cl.code;
     switch (mcode) {
         case ROCKPAPERSCISSORS_ANY: {
@@ -466,16 +511,84 @@ static error_code get_move_str_gf(game* self, player_id player, move_data_sync m
             outbuf += sprintf(outbuf, "S");
         } break;
     }
-    *ret_size = outbuf - bufs.move_str;
-    *ret_str = bufs.move_str;
+    *ret_size = outbuf - str;
     return ERR_OK;
 }
 
 static error_code print_gf(game* self, player_id player, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
+    *ret_size = write_print(self, player, bufs.print);
+    *ret_str = bufs.print;
+    return ERR_OK;
+}
+
+static error_code print_into_gf(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < PRINT_STR_SIZE) {
+        *ret_size = PRINT_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
+    }
+    *ret_size = write_print(self, PLAYER_NONE, str);
+    return ERR_OK;
+}
+
+// impl hidden: writes the state string as seen by player, the pending move of the other player is hidden, PLAYER_NONE sees everything
+static size_t write_state(game* self, player_id player, char* str)
+{
+    state_repr& data = get_repr(self);
+    char* outbuf = str;
+    uint8_t acc1 = data.acc[0];
+    if (data.done == false && acc1 != ROCKPAPERSCISSORS_NONE && (player != 1 && player != PLAYER_NONE)) {
+        acc1 = ROCKPAPERSCISSORS_ANY;
+    }
+    switch (acc1) {
+        case ROCKPAPERSCISSORS_NONE: {
+            outbuf += sprintf(outbuf, "-");
+        } break;
+        case ROCKPAPERSCISSORS_ANY: {
+            outbuf += sprintf(outbuf, "*");
+        } break;
+        case ROCKPAPERSCISSORS_ROCK: {
+            outbuf += sprintf(outbuf, "R");
+        } break;
+        case ROCKPAPERSCISSORS_PAPER: {
+            outbuf += sprintf(outbuf, "P");
+        } break;
+        case ROCKPAPERSCISSORS_SCISSOR: {
+            outbuf += sprintf(outbuf, "S");
+        } break;
+    }
+    outbuf += sprintf(outbuf, "-");
+    uint8_t acc2 = data.acc[1];
+    if (data.done == false && acc2 != ROCKPAPERSCISSORS_NONE && (player != 2 && player != PLAYER_NONE)) {
+        acc2 = ROCKPAPERSCISSORS_ANY;
+    }
+    switch (acc2) {
+        case ROCKPAPERSCISSORS_NONE: {
+            outbuf += sprintf(outbuf, "-");
+        } break;
+        case ROCKPAPERSCISSORS_ANY: {
+            outbuf += sprintf(outbuf, "*");
+        } break;
+        case ROCKPAPERSCISSORS_ROCK: {
+            outbuf += sprintf(outbuf, "R");
+        } break;
+        case ROCKPAPERSCISSORS_PAPER: {
+            outbuf += sprintf(outbuf, "P");
+        } break;
+        case ROCKPAPERSCISSORS_SCISSOR: {
+            outbuf += sprintf(outbuf, "S");
+        } break;
+    }
+    return outbuf - str;
+}
+
+// impl hidden: writes the printed board as seen by player, same hiding as write_state
+static size_t write_print(game* self, player_id player, char* str)
+{
     state_repr& data = get_repr(self);
-    char* outbuf = bufs.state;
+    char* outbuf = str;
     uint8_t acc1 = data.acc[0];
     if (data.done == false && acc1 != ROCKPAPERSCISSORS_NONE && (player != 1 && player != PLAYER_NONE)) {
         acc1 = ROCKPAPERSCISSORS_ANY;
@@ -534,9 +647,7 @@ static error_code print_gf(game* self, player_id player, size_t* ret_size, const
         } break;
     }
     outbuf += sprintf(outbuf, "\n");
-    *ret_size = outbuf - bufs.state;
-    *ret_str = bufs.state;
-    return ERR_OK;
+    return outbuf - str;
 }
 
 //=====
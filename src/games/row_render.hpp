@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// incremental rendering of a string that is made up of rows, e.g. one per board row of a state or print string
+// after one full render only the rows marked dirty are rendered again, and spliced into the string in place
+// lives next to the export buffer holding the string, every change of what a row shows has to mark that row dirty
+class row_render {
+
+  public:
+
+    row_render():
+        valid(false)
+    {}
+
+    // the rendered rows belong to one string buffer, so a copy (e.g. of a cloned game) starts out without any
+    row_render(const row_render& other):
+        valid(false)
+    {}
+
+    row_render& operator=(const row_render& other)
+    {
+        valid = false;
+        return *this;
+    }
+
+    // the next update renders all rows, use after imports and copies, or whenever the string buffer is new
+    void invalidate_all()
+    {
+        valid = false;
+    }
+
+    // marks the rows first to last (inclusive, clamped to the rows) for rendering on the next update
+    void invalidate_rows(int first, int last)
+    {
+        if (valid == false) {
+            return;
+        }
+        if (first < 0) {
+            first = 0;
+        }
+        if (last >= (int)dirty.size()) {
+            last = (int)dirty.size() - 1;
+        }
+        for (int y = first; y <= last; y++) {
+            dirty[y] = true;
+        }
+    }
+
+    // brings the rows of str up to date, zero terminates them and returns their length, anything appended after that is not kept
+    // render_row(y, out) writes row y to out (may zero terminate) and returns the number of chars written, at most max_row_size
+    // str must be able to hold the rows of any state, with every row at its own maximum size
+    template <typename F>
+    size_t update(char* str, uint32_t rows, size_t max_row_size, F render_row)
+    {
+        if (valid == false || row_start.size() != rows + 1) {
+            row_start.resize(rows + 1);
+            dirty.assign(rows, false);
+            size_t pos = 0;
+            for (uint32_t y = 0; y < rows; y++) {
+                row_start[y] = pos;
+                pos += render_row(y, str + pos);
+            }
+            row_start[rows] = pos;
+            str[pos] = '\0';
+            valid = true;
+            return pos;
+        }
+        scratch.resize(max_row_size + 1);
+        // splice shrinking rows first, so the string never grows past the size of the old or new state while mixing them
+        for (int pass = 0; pass < 2; pass++) {
+            for (uint32_t y = 0; y < rows; y++) {
+                if (dirty[y] == false) {
+                    continue;
+                }
+                size_t old_size = row_start[y + 1] - row_start[y];
+                size_t new_size = render_row(y, scratch.data());
+                if (pass == 0 && new_size > old_size) {
+                    continue;
+                }
+                if (new_size != old_size) {
+                    memmove(str + row_start[y] + new_size, str + row_start[y + 1], row_start[rows] - row_start[y + 1]);
+                    for (uint32_t i = y + 1; i <= rows; i++) {
+                        row_start[i] = row_start[i] + new_size - old_size;
+                    }
+                }
+                memcpy(str + row_start[y], scratch.data(), new_size);
+                dirty[y] = false;
+            }
+        }
+        str[row_start[rows]] = '\0';
+        return row_start[rows];
+    }
+
+    size_t memory_usage() const
+    {
+        return row_start.capacity() * sizeof(size_t) + dirty.capacity() / 8 + scratch.capacity();
+    }
+
+  private:
+
+    bool valid;
+    std::vector<size_t> row_start; // one past the last row is the end of all rows
+    std::vector<bool> dirty;
+    std::vector<char> scratch;
+};
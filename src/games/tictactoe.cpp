@@ -17,10 +17,17 @@
 
 namespace {
 
+    // export buffer sizes, for size_hint, create_block and the _into size checks
+    const size_t STATE_STR_SIZE = 16;
+    const uint32_t MAX_MOVES = 9;
+    const size_t MOVE_STR_SIZE = 3;
+    const size_t PRINT_STR_SIZE = 13;
+
     struct export_buffers {
         char* state;
         player_id* players_to_move;
         move_data* concrete_moves;
+        move_code* concrete_move_codes;
         player_id* results;
         move_data_sync move_out;
         char* move_str;
@@ -37,13 +44,24 @@ namespace {
         where RR is results and CC is current player
         */
         uint32_t state;
+        // zobrist key of the board under each of the 8 symmetries (see sym_cell), updated by set_cell, for canonical_id
+        uint64_t sym_keys[8];
     };
 
     struct game_data {
+        bool in_arena; // data1 is one block holding this and all buffers, only freed by us if it was not taken from an arena
         export_buffers bufs;
         state_repr state;
     };
 
+    // struct-of-arrays storage of a game_batch, one plane bit per cell with the move index (y * 3 + x) as bit index
+    struct batch_data {
+        uint16_t* planes[2]; // cells of player 1 and 2
+        player_id* current_player;
+        player_id* result;
+        move_code move_codes[9];
+    };
+
     export_buffers& get_bufs(game* self)
     {
         return ((game_data*)(self->data1))->bufs;
@@ -54,6 +72,26 @@ namespace {
         return ((game_data*)(self->data1))->state;
     }
 
+    const int ZOBRIST_CELLS = 11;
+    // zobrist keys as [cell][player], the board cells are followed by the current player and the result
+    // built once, so keeping the symmetry keys up to date is only lookups
+    struct zobrist_table {
+        uint64_t keys[ZOBRIST_CELLS][4];
+
+        zobrist_table()
+        {
+            for (int cell = 0; cell < ZOBRIST_CELLS; cell++) {
+                keys[cell][0] = 0; // the empty cell has none
+                for (int p = 1; p < 4; p++) {
+                    int32_t pos = cell * 4 + p;
+                    keys[cell][p] = ((uint64_t)squirrelnoise5(pos, 0x5EED) << 32) | (uint64_t)squirrelnoise5(pos, 0x5EEE);
+                }
+            }
+        }
+    };
+
+    const zobrist_table zobrist;
+
 } // namespace
 
 #ifdef __cplusplus
@@ -66,12 +104,25 @@ static error_code set_cell_gf(game* self, int x, int y, player_id p);
 static error_code set_current_player_gf(game* self, player_id p);
 static error_code set_result_gf(game* self, player_id p);
 
+// the setters handed out in the internal methods, these drop the wrapper query cache before writing
+static error_code ext_set_cell_gf(game* self, int x, int y, player_id p);
+static error_code ext_set_current_player_gf(game* self, player_id p);
+static error_code ext_set_result_gf(game* self, player_id p);
+
+// impl hidden helpers
+static error_code create_block(game* self, game_init* init_info, game_arena* arena);
+static uint32_t get_move_codes(game* self, player_id player, move_code* outbuf);
+static bool plane_has_line(uint16_t plane);
+static int sym_cell(int t, int x, int y);
+static uint64_t zobrist_key(int cell, player_id p);
+static void rebuild_sym_keys(game* self);
+
 // need internal function pointer struct here
 static const tictactoe_internal_methods tictactoe_gbe_internal_methods{
     .get_cell = get_cell_gf,
-    .set_cell = set_cell_gf,
-    .set_current_player = set_current_player_gf,
-    .set_result = set_result_gf,
+    .set_cell = ext_set_cell_gf,
+    .set_current_player = ext_set_current_player_gf,
+    .set_result = ext_set_result_gf,
 };
 
 // declare and form game
@@ -81,57 +132,36 @@ static const tictactoe_internal_methods tictactoe_gbe_internal_methods{
 #define SURENA_GDD_INAME "surena_default"
 #define SURENA_GDD_VERSION ((semver){1, 0, 0})
 #define SURENA_GDD_INTERNALS &tictactoe_gbe_internal_methods
+#define SURENA_GDD_FF_CREATE_IN
+#define SURENA_GDD_FF_MEMORY_USAGE
+#define SURENA_GDD_FF_QUERY_INTO
+#define SURENA_GDD_FF_UNMAKE_MOVE
+#define SURENA_GDD_FF_LAZY_MOVES
+#define SURENA_GDD_FF_MOVE_CODES
 #define SURENA_GDD_FF_ID
+#define SURENA_GDD_FF_CANONICAL_ID
 #define SURENA_GDD_FF_PLAYOUT
 #define SURENA_GDD_FF_PRINT
+#define SURENA_GDD_FF_BATCH
 #include "surena/game_decldef.h"
 
 // implementation
 
 static error_code create_gf(game* self, game_init* init_info)
 {
-    self->data1 = malloc(sizeof(game_data));
-    if (self->data1 == NULL) {
-        return ERR_OUT_OF_MEMORY;
-    }
-    self->data2 = NULL;
-    {
-        export_buffers& bufs = get_bufs(self);
-        bufs.state = (char*)malloc(16 * sizeof(char));
-        bufs.players_to_move = (player_id*)malloc(1 * sizeof(player_id));
-        bufs.concrete_moves = (move_data*)malloc(9 * sizeof(move_data));
-        bufs.results = (player_id*)malloc(1 * sizeof(char));
-        bufs.move_str = (char*)malloc(3 * sizeof(char));
-        bufs.print = (char*)malloc(13 * sizeof(char));
-        if (bufs.state == NULL ||
-            bufs.players_to_move == NULL ||
-            bufs.concrete_moves == NULL ||
-            bufs.results == NULL ||
-            bufs.move_str == NULL ||
-            bufs.print == NULL) {
-            destroy_gf(self);
-            return ERR_OUT_OF_MEMORY;
-        }
-    }
-    const char* initial_state = NULL;
-    if (init_info->source_type == GAME_INIT_SOURCE_TYPE_STANDARD) {
-        initial_state = init_info->source.standard.state;
-    }
-    return import_state_gf(self, initial_state);
+    return create_block(self, init_info, NULL);
 }
 
 static error_code destroy_gf(game* self)
 {
-    {
-        export_buffers& bufs = get_bufs(self);
-        free(bufs.state);
-        free(bufs.players_to_move);
-        free(bufs.concrete_moves);
-        free(bufs.results);
-        free(bufs.move_str);
-        free(bufs.print);
-    }
-    free(self->data1);
+    game_data* data = (game_data*)self->data1;
+    if (data == NULL) {
+        return ERR_OK;
+    }
+    bool in_arena = data->in_arena;
+    if (in_arena == false) {
+        free(self->data1);
+    }
     self->data1 = NULL;
     return ERR_OK;
 }
@@ -148,12 +178,53 @@ static error_code clone_gf(game* self, game* clone_target)
     return ERR_OK;
 }
 
+static error_code size_hint_gf(game* self, game_init* init_info, size_t* ret_size)
+{
+    // independent of init_info, there are no options
+    *ret_size = game_e_arena_size(sizeof(game_data)) +
+                game_e_arena_size(STATE_STR_SIZE * sizeof(char)) +
+                game_e_arena_size(1 * sizeof(player_id)) +
+                game_e_arena_size(MAX_MOVES * sizeof(move_data)) +
+                game_e_arena_size(MAX_MOVES * sizeof(move_code)) +
+                game_e_arena_size(1 * sizeof(player_id)) +
+                game_e_arena_size(MOVE_STR_SIZE * sizeof(char)) +
+                game_e_arena_size(PRINT_STR_SIZE * sizeof(char));
+    return ERR_OK;
+}
+
+static error_code create_in_gf(game* self, game_init* init_info, game_arena* arena)
+{
+    return create_block(self, init_info, arena);
+}
+
+static error_code clone_in_gf(game* self, game* clone_target, game_arena* arena)
+{
+    clone_target->methods = self->methods;
+    game_init init_info = (game_init){.source_type = GAME_INIT_SOURCE_TYPE_DEFAULT};
+    error_code ec = create_block(clone_target, &init_info, arena);
+    if (ec != ERR_OK) {
+        return ec;
+    }
+    copy_from_gf(clone_target, self);
+    return ERR_OK;
+}
+
 static error_code copy_from_gf(game* self, game* other)
 {
     get_repr(self) = get_repr(other);
     return ERR_OK;
 }
 
+static error_code memory_usage_gf(game* self, size_t* ret_state, size_t* ret_buffers)
+{
+    // all buffers live in the same block as the game data, see create_block
+    size_t block_size;
+    size_hint_gf(self, NULL, &block_size);
+    *ret_state = game_e_arena_size(sizeof(game_data));
+    *ret_buffers = block_size - *ret_state;
+    return ERR_OK;
+}
+
 static error_code compare_gf(game* self, game* other, bool* ret_equal)
 {
     *ret_equal = (memcmp(&get_repr(self), &get_repr(other), sizeof(state_repr)) == 0);
@@ -169,12 +240,19 @@ static error_code player_count_gf(game* self, uint8_t* ret_count)
 static error_code export_state_gf(game* self, player_id player, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
-    char* outbuf = bufs.state;
-    // save to diy tictactoe format, somewhat like chess fen
-    if (outbuf == NULL) {
-        return ERR_INVALID_INPUT;
+    error_code ec = export_state_into_gf(self, STATE_STR_SIZE, ret_size, bufs.state);
+    *ret_str = bufs.state;
+    return ec;
+}
+
+static error_code export_state_into_gf(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < STATE_STR_SIZE) {
+        *ret_size = STATE_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
     }
-    const char* ostr = outbuf;
+    char* outbuf = str;
+    // save to diy tictactoe format, somewhat like chess fen
     // save board
     player_id cell_player;
     for (int y = 2; y >= 0; y--) {
@@ -199,56 +277,32 @@ static error_code export_state_gf(game* self, player_id player, size_t* ret_size
             outbuf += sprintf(outbuf, "/");
         }
     }
-    // current player
-    uint8_t ptm_count;
-    const player_id* ptm_buf;
-    players_to_move_gf(self, &ptm_count, &ptm_buf);
-    player_id ptm;
-    if (ptm_count == 0) {
-        ptm = PLAYER_NONE;
-    } else {
-        ptm = ptm_buf[0];
-    }
-    switch (ptm) {
-        case PLAYER_NONE: {
-            outbuf += sprintf(outbuf, " -");
-        } break;
-        case 1: {
-            outbuf += sprintf(outbuf, " X");
-        } break;
-        case 2: {
-            outbuf += sprintf(outbuf, " O");
-        } break;
-    }
-    // result player
-    uint8_t res_count;
-    const player_id* res_buf;
-    get_results_gf(self, &res_count, &res_buf);
-    player_id res;
-    if (res_count == 0) {
-        res = PLAYER_NONE;
-    } else {
-        res = res_buf[0];
-    }
-    switch (res) {
-        case PLAYER_NONE: {
-            outbuf += sprintf(outbuf, " -");
-        } break;
-        case 1: {
-            outbuf += sprintf(outbuf, " X");
-        } break;
-        case 2: {
-            outbuf += sprintf(outbuf, " O");
-        } break;
+    // current player and result player, both read straight from the state so this stays read only
+    state_repr& data = get_repr(self);
+    player_id ptm = (data.state >> 18) & 0b11;
+    player_id res = (data.state >> 20) & 0b11;
+    player_id flags[2] = {ptm, res};
+    for (int i = 0; i < 2; i++) {
+        switch (flags[i]) {
+            case PLAYER_NONE: {
+                outbuf += sprintf(outbuf, " -");
+            } break;
+            case 1: {
+                outbuf += sprintf(outbuf, " X");
+            } break;
+            case 2: {
+                outbuf += sprintf(outbuf, " O");
+            } break;
+        }
     }
-    *ret_size = outbuf - ostr;
-    *ret_str = bufs.state;
+    *ret_size = outbuf - str;
     return ERR_OK;
 }
 
 static error_code import_state_gf(game* self, const char* str)
 {
     state_repr& data = get_repr(self);
+    memset(data.sym_keys, 0, sizeof(data.sym_keys));
     if (str == NULL) {
         data.state = 1 << 18; // player one starts
         return ERR_OK;
@@ -343,43 +397,82 @@ static error_code import_state_gf(game* self, const char* str)
 
 static error_code players_to_move_gf(game* self, uint8_t* ret_count, const player_id** ret_players)
 {
-    *ret_count = 1;
+    export_buffers& bufs = get_bufs(self);
+    players_to_move_into_gf(self, 1, ret_count, bufs.players_to_move);
+    *ret_players = bufs.players_to_move;
+    return ERR_OK;
+}
+
+static error_code players_to_move_into_gf(game* self, uint8_t cap, uint8_t* ret_count, player_id* players)
+{
+    if (cap < 1) {
+        *ret_count = 1;
+        return ERR_OUT_OF_MEMORY;
+    }
     state_repr& data = get_repr(self);
     player_id ptm = (data.state >> 18) & 0b11;
     if (ptm == PLAYER_NONE) {
         *ret_count = 0;
         return ERR_OK;
     }
-    export_buffers& bufs = get_bufs(self);
-    player_id* outbuf = bufs.players_to_move;
-    *outbuf = ptm;
-    *ret_players = outbuf;
+    *ret_count = 1;
+    *players = ptm;
     return ERR_OK;
 }
 
 static error_code get_concrete_moves_gf(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves)
 {
     export_buffers& bufs = get_bufs(self);
-    move_data* outbuf = bufs.concrete_moves;
-    uint8_t ptm_count;
-    const player_id* ptm;
-    players_to_move_gf(self, &ptm_count, &ptm);
-    if (ptm_count == 0 || player != *ptm) {
-        *ret_count = 0;
-        return ERR_OK;
+    get_concrete_moves_into_gf(self, player, MAX_MOVES, ret_count, bufs.concrete_moves);
+    *ret_moves = bufs.concrete_moves;
+    return ERR_OK;
+}
+
+static error_code get_concrete_moves_into_gf(game* self, player_id player, uint32_t cap, uint32_t* ret_count, move_data* moves)
+{
+    if (cap < MAX_MOVES) {
+        *ret_count = MAX_MOVES;
+        return ERR_OUT_OF_MEMORY;
     }
-    uint32_t count = 0;
+    move_code codes[9];
+    *ret_count = get_move_codes(self, player, codes);
+    for (uint32_t i = 0; i < *ret_count; i++) {
+        moves[i] = game_e_create_move_small(codes[i]);
+    }
+    return ERR_OK;
+}
+
+static error_code get_concrete_moves_codes_gf(game* self, player_id player, uint32_t* ret_count, const move_code** ret_moves)
+{
+    export_buffers& bufs = get_bufs(self);
+    *ret_count = get_move_codes(self, player, bufs.concrete_move_codes);
+    *ret_moves = bufs.concrete_move_codes;
+    return ERR_OK;
+}
+
+static error_code get_moves_begin_gf(game* self, player_id player, move_iterator* it)
+{
+    // idx is the next cell to look at, in the same order as get_concrete_moves
+    it->player = player;
+    it->idx = 0;
+    return ERR_OK;
+}
+
+static error_code get_moves_next_gf(game* self, move_iterator* it, bool* ret_done, move_data* ret_move)
+{
     player_id cell_player;
-    for (int y = 0; y < 3; y++) {
-        for (int x = 0; x < 3; x++) {
-            get_cell_gf(self, x, y, &cell_player);
-            if (cell_player == PLAYER_NONE) {
-                outbuf[count++] = game_e_create_move_small((y << 2) | x);
-            }
+    while (it->idx < 9) {
+        int x = it->idx % 3;
+        int y = it->idx / 3;
+        it->idx++;
+        get_cell_gf(self, x, y, &cell_player);
+        if (cell_player == PLAYER_NONE) {
+            *ret_done = false;
+            *ret_move = game_e_create_move_small((y << 2) | x);
+            return ERR_OK;
         }
     }
-    *ret_count = count;
-    *ret_moves = bufs.concrete_moves;
+    *ret_done = true;
     return ERR_OK;
 }
 
@@ -474,6 +567,18 @@ static error_code make_move_gf(game* self, player_id player, move_data_sync move
     return ERR_OK;
 }
 
+static error_code unmake_move_gf(game* self, player_id player, move_data_sync move)
+{
+    // the whole state is the board, so clearing the cell and handing the turn back restores it exactly
+    move_code mcode = move.md.cl.code;
+    int x = mcode & 0b11;
+    int y = (mcode >> 2) & 0b11;
+    set_cell_gf(self, x, y, PLAYER_NONE);
+    set_result_gf(self, PLAYER_NONE);
+    set_current_player_gf(self, player);
+    return ERR_OK;
+}
+
 static error_code get_results_gf(game* self, uint8_t* ret_count, const player_id** ret_players)
 {
     export_buffers& bufs = get_bufs(self);
@@ -498,10 +603,25 @@ static error_code id_gf(game* self, uint64_t* ret_id)
     return ERR_OK;
 }
 
-static error_code playout_gf(game* self, uint64_t seed)
+static error_code canonical_id_gf(game* self, uint64_t* ret_id, uint8_t* ret_transform)
 {
-    fast_prng rng;
-    fprng_srand(&rng, seed);
+    state_repr& data = get_repr(self);
+    // current player and result look the same in every image, the extra cell idxs keep their keys apart from the board
+    uint64_t side_key = zobrist_key(9, (data.state >> 18) & 0b11) ^ zobrist_key(10, (data.state >> 20) & 0b11);
+    *ret_id = data.sym_keys[0] ^ side_key;
+    *ret_transform = 0;
+    for (uint8_t t = 1; t < 8; t++) {
+        if ((data.sym_keys[t] ^ side_key) < *ret_id) {
+            *ret_id = data.sym_keys[t] ^ side_key;
+            *ret_transform = t;
+        }
+    }
+    return ERR_OK;
+}
+
+static error_code playout_gf(game* self, seed128 seed)
+{
+    game_rng rng = game_e_rng_create(seed, 0);
     uint32_t moves_count;
     const move_data* moves;
     uint8_t ptm_count;
@@ -509,7 +629,7 @@ static error_code playout_gf(game* self, uint64_t seed)
     players_to_move_gf(self, &ptm_count, &ptm);
     while (ptm_count > 0) {
         get_concrete_moves_gf(self, ptm[0], &moves_count, &moves);
-        make_move_gf(self, ptm[0], game_e_move_make_sync(self, moves[fprng_rand(&rng) % moves_count])); //BUG this has modulo bias, use proper rand_intn
+        make_move_gf(self, ptm[0], game_e_move_make_sync(self, moves[game_e_rng_intn(&rng, moves_count)]));
         players_to_move_gf(self, &ptm_count, &ptm);
     }
     return ERR_OK;
@@ -546,23 +666,43 @@ static error_code get_move_data_gf(game* self, player_id player, const char* str
 static error_code get_move_str_gf(game* self, player_id player, move_data_sync move, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
-    char* outbuf = bufs.move_str;
+    error_code ec = get_move_str_into_gf(self, player, move, MOVE_STR_SIZE, ret_size, bufs.move_str);
+    *ret_str = bufs.move_str;
+    return ec;
+}
+
+static error_code get_move_str_into_gf(game* self, player_id player, move_data_sync move, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < MOVE_STR_SIZE) {
+        *ret_size = MOVE_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
+    }
     move_code mcode = move.md.cl.code;
     if (mcode == MOVE_NONE) {
-        *ret_size = sprintf(outbuf, "-");
+        *ret_size = sprintf(str, "-");
         return ERR_OK;
     }
     int x = mcode & 0b11;
     int y = (mcode >> 2) & 0b11;
-    *ret_size = sprintf(outbuf, "%c%c", 'a' + x, '0' + y);
-    *ret_str = bufs.move_str;
+    *ret_size = sprintf(str, "%c%c", 'a' + x, '0' + y);
     return ERR_OK;
 }
 
 static error_code print_gf(game* self, player_id player, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
-    char* outbuf = bufs.print;
+    error_code ec = print_into_gf(self, PRINT_STR_SIZE, ret_size, bufs.print);
+    *ret_str = bufs.print;
+    return ec;
+}
+
+static error_code print_into_gf(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < PRINT_STR_SIZE) {
+        *ret_size = PRINT_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
+    }
+    char* outbuf = str;
     player_id cell_player;
     for (int y = 2; y >= 0; y--) {
         for (int x = 0; x < 3; x++) {
@@ -581,11 +721,233 @@ static error_code print_gf(game* self, player_id player, size_t* ret_size, const
         }
         outbuf += sprintf(outbuf, "\n");
     }
-    *ret_size = outbuf - bufs.print;
-    *ret_str = bufs.print;
+    *ret_size = outbuf - str;
+    return ERR_OK;
+}
+
+static error_code batch_create_gf(game* self, uint32_t count, game_batch* ret_batch)
+{
+    // one block for the batch data and all its arrays
+    size_t block_size = game_e_arena_size(sizeof(batch_data)) +
+                        2 * game_e_arena_size(count * sizeof(uint16_t)) +
+                        2 * game_e_arena_size(count * sizeof(player_id));
+    void* block = malloc(block_size);
+    if (block == NULL) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    game_arena block_arena;
+    game_e_arena_init(&block_arena, block, block_size);
+    batch_data* bd = (batch_data*)game_e_arena_alloc(&block_arena, sizeof(batch_data));
+    bd->planes[0] = (uint16_t*)game_e_arena_alloc(&block_arena, count * sizeof(uint16_t));
+    bd->planes[1] = (uint16_t*)game_e_arena_alloc(&block_arena, count * sizeof(uint16_t));
+    bd->current_player = (player_id*)game_e_arena_alloc(&block_arena, count * sizeof(player_id));
+    bd->result = (player_id*)game_e_arena_alloc(&block_arena, count * sizeof(player_id));
+    for (int i = 0; i < 9; i++) {
+        bd->move_codes[i] = ((i / 3) << 2) | (i % 3);
+    }
+    ret_batch->methods = self->methods;
+    ret_batch->count = count;
+    ret_batch->move_space = 9;
+    ret_batch->move_codes = bd->move_codes;
+    ret_batch->data = bd;
+    for (uint32_t i = 0; i < count; i++) {
+        batch_load_gf(ret_batch, i, self);
+    }
+    return ERR_OK;
+}
+
+static error_code batch_destroy_gf(game_batch* batch)
+{
+    free(batch->data);
+    batch->data = NULL;
+    return ERR_OK;
+}
+
+static error_code batch_load_gf(game_batch* batch, uint32_t idx, game* source)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    uint32_t state = get_repr(source).state;
+    uint16_t planes[2] = {0, 0};
+    for (int i = 0; i < 9; i++) {
+        player_id cell_player = (state >> (i * 2)) & 0b11;
+        if (cell_player == 1 || cell_player == 2) {
+            planes[cell_player - 1] |= 1 << i;
+        }
+    }
+    bd->planes[0][idx] = planes[0];
+    bd->planes[1][idx] = planes[1];
+    bd->current_player[idx] = (state >> 18) & 0b11;
+    bd->result[idx] = (state >> 20) & 0b11;
+    return ERR_OK;
+}
+
+static error_code batch_store_gf(game_batch* batch, uint32_t idx, game* target)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    uint32_t state = 0;
+    for (int i = 0; i < 9; i++) {
+        if ((bd->planes[0][idx] >> i) & 1) {
+            state |= 1 << (i * 2);
+        } else if ((bd->planes[1][idx] >> i) & 1) {
+            state |= 2 << (i * 2);
+        }
+    }
+    state |= (uint32_t)bd->current_player[idx] << 18;
+    state |= (uint32_t)bd->result[idx] << 20;
+    get_repr(target).state = state;
+    rebuild_sym_keys(target);
+    return ERR_OK;
+}
+
+static error_code batch_players_to_move_gf(game_batch* batch, player_id* players)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    memcpy(players, bd->current_player, batch->count * sizeof(player_id));
+    return ERR_OK;
+}
+
+static error_code batch_get_move_masks_gf(game_batch* batch, uint64_t* masks)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    // branchless over all instances, so this vectorises
+    for (uint32_t i = 0; i < batch->count; i++) {
+        uint64_t running = (bd->current_player[i] != PLAYER_NONE);
+        masks[i] = (~(uint64_t)(bd->planes[0][i] | bd->planes[1][i]) & 0x1FF) * running;
+    }
+    return ERR_OK;
+}
+
+static error_code batch_make_moves_gf(game_batch* batch, const uint32_t* move_idxs)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    for (uint32_t i = 0; i < batch->count; i++) {
+        if (move_idxs[i] == GAME_BATCH_MOVE_NONE) {
+            continue;
+        }
+        player_id current_player = bd->current_player[i];
+        uint16_t plane = bd->planes[current_player - 1][i] | (1 << move_idxs[i]);
+        bd->planes[current_player - 1][i] = plane;
+        if (plane_has_line(plane) == true) {
+            bd->result[i] = current_player;
+            bd->current_player[i] = PLAYER_NONE;
+        } else if ((bd->planes[0][i] | bd->planes[1][i]) == 0x1FF) {
+            bd->current_player[i] = PLAYER_NONE;
+        } else {
+            bd->current_player[i] = (current_player == 1) ? 2 : 1;
+        }
+    }
+    return ERR_OK;
+}
+
+static error_code batch_get_results_gf(game_batch* batch, player_id* results)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    memcpy(results, bd->result, batch->count * sizeof(player_id));
     return ERR_OK;
 }
 
+// impl hidden: creates the game data and all buffers in one block of size_hint, taken from the arena or malloc'd if arena is NULL
+static error_code create_block(game* self, game_init* init_info, game_arena* arena)
+{
+    size_t block_size;
+    size_hint_gf(self, init_info, &block_size);
+    void* block = (arena == NULL ? malloc(block_size) : game_e_arena_alloc(arena, block_size));
+    if (block == NULL) {
+        self->data1 = NULL;
+        return ERR_OUT_OF_MEMORY;
+    }
+    // the block is sized exactly for these allocations, so none of them can fail
+    game_arena block_arena;
+    game_e_arena_init(&block_arena, block, block_size);
+    self->data1 = game_e_arena_alloc(&block_arena, sizeof(game_data));
+    self->data2 = NULL;
+    ((game_data*)self->data1)->in_arena = (arena != NULL);
+    {
+        export_buffers& bufs = get_bufs(self);
+        bufs.state = (char*)game_e_arena_alloc(&block_arena, STATE_STR_SIZE * sizeof(char));
+        bufs.players_to_move = (player_id*)game_e_arena_alloc(&block_arena, 1 * sizeof(player_id));
+        bufs.concrete_moves = (move_data*)game_e_arena_alloc(&block_arena, MAX_MOVES * sizeof(move_data));
+        bufs.concrete_move_codes = (move_code*)game_e_arena_alloc(&block_arena, MAX_MOVES * sizeof(move_code));
+        bufs.results = (player_id*)game_e_arena_alloc(&block_arena, 1 * sizeof(player_id));
+        bufs.move_str = (char*)game_e_arena_alloc(&block_arena, MOVE_STR_SIZE * sizeof(char));
+        bufs.print = (char*)game_e_arena_alloc(&block_arena, PRINT_STR_SIZE * sizeof(char));
+    }
+    const char* initial_state = NULL;
+    if (init_info->source_type == GAME_INIT_SOURCE_TYPE_STANDARD) {
+        initial_state = init_info->source.standard.state;
+    }
+    return import_state_gf(self, initial_state);
+}
+
+// impl hidden: writes the move codes of the free cells if player is to move, read only on the game, returns the number of codes written
+static uint32_t get_move_codes(game* self, player_id player, move_code* outbuf)
+{
+    state_repr& data = get_repr(self);
+    player_id ptm = (data.state >> 18) & 0b11;
+    if (ptm == PLAYER_NONE || player != ptm) {
+        return 0;
+    }
+    uint32_t count = 0;
+    player_id cell_player;
+    for (int y = 0; y < 3; y++) {
+        for (int x = 0; x < 3; x++) {
+            get_cell_gf(self, x, y, &cell_player);
+            if (cell_player == PLAYER_NONE) {
+                outbuf[count++] = (y << 2) | x;
+            }
+        }
+    }
+    return count;
+}
+
+// impl hidden: true if the cell plane (bit index y * 3 + x) contains any full row, column or diagonal
+static bool plane_has_line(uint16_t plane)
+{
+    static const uint16_t lines[8] = {0x007, 0x038, 0x1C0, 0x049, 0x092, 0x124, 0x111, 0x054};
+    bool line = false;
+    for (int i = 0; i < 8; i++) {
+        line |= ((plane & lines[i]) == lines[i]);
+    }
+    return line;
+}
+
+// impl hidden: cell idx (y * 3 + x) that symmetry t moves the cell (x, y) to
+// t & 4 mirrors x -> 2 - x first, then it is rotated counter clockwise (t & 3) times by (x, y) -> (2 - y, x)
+static int sym_cell(int t, int x, int y)
+{
+    if ((t & 4) != 0) {
+        x = 2 - x;
+    }
+    for (int i = 0; i < (t & 3); i++) {
+        int rx = 2 - y;
+        y = x;
+        x = rx;
+    }
+    return y * 3 + x;
+}
+
+// impl hidden: zobrist key of player p on the cell idx, the empty cell has none
+static uint64_t zobrist_key(int cell, player_id p)
+{
+    return zobrist.keys[cell][p];
+}
+
+// impl hidden: recomputes all symmetry keys from the board, for writes that skip set_cell
+static void rebuild_sym_keys(game* self)
+{
+    state_repr& data = get_repr(self);
+    memset(data.sym_keys, 0, sizeof(data.sym_keys));
+    player_id cell_player;
+    for (int y = 0; y < 3; y++) {
+        for (int x = 0; x < 3; x++) {
+            get_cell_gf(self, x, y, &cell_player);
+            for (int t = 0; t < 8; t++) {
+                data.sym_keys[t] ^= zobrist_key(sym_cell(t, x, y), cell_player);
+            }
+        }
+    }
+}
+
 //=====
 // game internal methods
 
@@ -605,6 +967,10 @@ static error_code set_cell_gf(game* self, int x, int y, player_id p)
     int offset = (y * 6 + x * 2);
     // new_state = current_value xor (current_value xor new_value)
     data.state ^= ((((uint32_t)pc) << offset) ^ (((uint32_t)p) << offset));
+    for (int t = 0; t < 8; t++) {
+        int cell = sym_cell(t, x, y);
+        data.sym_keys[t] ^= zobrist_key(cell, pc) ^ zobrist_key(cell, p);
+    }
     return ERR_OK;
 }
 
@@ -624,6 +990,24 @@ static error_code set_result_gf(game* self, player_id p)
     return ERR_OK;
 }
 
+static error_code ext_set_cell_gf(game* self, int x, int y, player_id p)
+{
+    game_e_cache_invalidate(self);
+    return set_cell_gf(self, x, y, p);
+}
+
+static error_code ext_set_current_player_gf(game* self, player_id p)
+{
+    game_e_cache_invalidate(self);
+    return set_current_player_gf(self, p);
+}
+
+static error_code ext_set_result_gf(game* self, player_id p)
+{
+    game_e_cache_invalidate(self);
+    return set_result_gf(self, p);
+}
+
 #ifdef __cplusplus
 }
 #endif
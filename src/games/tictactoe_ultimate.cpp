@@ -1,3 +1,4 @@
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
@@ -15,10 +16,17 @@
 
 namespace {
 
+    // export buffer sizes, for size_hint, create_block and the _into size checks
+    const size_t STATE_STR_SIZE = 37;
+    const uint32_t MAX_MOVES = 81;
+    const size_t MOVE_STR_SIZE = 3;
+    const size_t PRINT_STR_SIZE = 180;
+
     struct export_buffers {
         char* state;
         player_id* players_to_move;
         move_data* concrete_moves;
+        move_code* concrete_move_codes;
         player_id* results;
         move_data_sync move_out;
         char* move_str;
@@ -35,13 +43,32 @@ namespace {
         int8_t global_target_y;
         player_id current_player;
         player_id winning_player;
+        // global targets from before each made move, for unmake_move, not part of the compared state
+        uint8_t undo_count;
+        int8_t undo_targets[81][2];
+        // zobrist key of the cells under each of the 8 symmetries (see sym_cell), updated by set_cell_local, for canonical_id
+        // derived from the board, so also not part of the compared state
+        uint64_t sym_keys[8];
     };
 
     struct game_data {
+        bool in_arena; // data1 is one block holding this and all buffers, only freed by us if it was not taken from an arena
         export_buffers bufs;
         state_repr state;
     };
 
+    // struct-of-arrays storage of a game_batch
+    // local boards are planes with the cell bit (cy * 3 + cx), the global board is split into planes with the local board bit (gy * 3 + gx)
+    // move indices are (local board * 9 + cell), i.e. mask bit order matches get_moves_next
+    struct batch_data {
+        uint16_t* planes[2]; // cells of player 1 and 2, 9 local boards per instance
+        uint16_t* global_planes[3]; // local boards won by player 1, 2 and drawn ones
+        int8_t* target; // local board to play in, -1 if any
+        player_id* current_player;
+        player_id* winning_player;
+        move_code move_codes[81];
+    };
+
     export_buffers& get_bufs(game* self)
     {
         return ((game_data*)(self->data1))->bufs;
@@ -52,6 +79,26 @@ namespace {
         return ((game_data*)(self->data1))->state;
     }
 
+    const int ZOBRIST_CELLS = 81 + 11;
+    // zobrist keys as [cell][player], the local cells are followed by the global target and then the current and winning player
+    // built once, so keeping the symmetry keys up to date is only lookups
+    struct zobrist_table {
+        uint64_t keys[ZOBRIST_CELLS][4];
+
+        zobrist_table()
+        {
+            for (int cell = 0; cell < ZOBRIST_CELLS; cell++) {
+                keys[cell][0] = 0; // the empty cell has none
+                for (int p = 1; p < 4; p++) {
+                    int32_t pos = cell * 4 + p;
+                    keys[cell][p] = ((uint64_t)squirrelnoise5(pos, 0x5EED) << 32) | (uint64_t)squirrelnoise5(pos, 0x5EEE);
+                }
+            }
+        }
+    };
+
+    const zobrist_table zobrist;
+
 } // namespace
 
 #ifdef __cplusplus
@@ -70,18 +117,34 @@ static error_code set_global_target_gf(game* self, int x, int y);
 static error_code set_current_player_gf(game* self, player_id p);
 static error_code set_result_gf(game* self, player_id p);
 
+// the setters handed out in the internal methods, these drop the wrapper query cache before writing
+static error_code ext_set_cell_gf(game* self, uint32_t* state, int x, int y, player_id p);
+static error_code ext_set_cell_global_gf(game* self, int x, int y, player_id p);
+static error_code ext_set_cell_local_gf(game* self, int x, int y, player_id p);
+static error_code ext_set_global_target_gf(game* self, int x, int y);
+static error_code ext_set_current_player_gf(game* self, player_id p);
+static error_code ext_set_result_gf(game* self, player_id p);
+
+// impl hidden helpers
+static error_code create_block(game* self, game_init* init_info, game_arena* arena);
+static uint32_t get_move_codes(game* self, player_id player, move_code* outbuf);
+static bool plane_has_line(uint16_t plane);
+static int sym_cell(int t, int n, int x, int y);
+static uint64_t zobrist_key(int cell, player_id p);
+static void rebuild_sym_keys(game* self);
+
 static const tictactoe_ultimate_internal_methods tictactoe_ultimate_gbe_internal_methods{
     .check_result = check_result_gf,
     .get_cell = get_cell_gf,
-    .set_cell = set_cell_gf,
+    .set_cell = ext_set_cell_gf,
     .get_cell_global = get_cell_global_gf,
-    .set_cell_global = set_cell_global_gf,
+    .set_cell_global = ext_set_cell_global_gf,
     .get_cell_local = get_cell_local_gf,
-    .set_cell_local = set_cell_local_gf,
+    .set_cell_local = ext_set_cell_local_gf,
     .get_global_target = get_global_target_gf,
-    .set_global_target = set_global_target_gf,
-    .set_current_player = set_current_player_gf,
-    .set_result = set_result_gf,
+    .set_global_target = ext_set_global_target_gf,
+    .set_current_player = ext_set_current_player_gf,
+    .set_result = ext_set_result_gf,
 };
 
 // declare and form game
@@ -91,57 +154,36 @@ static const tictactoe_ultimate_internal_methods tictactoe_ultimate_gbe_internal
 #define SURENA_GDD_INAME "surena_default"
 #define SURENA_GDD_VERSION ((semver){1, 0, 0})
 #define SURENA_GDD_INTERNALS &tictactoe_ultimate_gbe_internal_methods
+#define SURENA_GDD_FF_CREATE_IN
+#define SURENA_GDD_FF_MEMORY_USAGE
+#define SURENA_GDD_FF_QUERY_INTO
+#define SURENA_GDD_FF_UNMAKE_MOVE
+#define SURENA_GDD_FF_LAZY_MOVES
+#define SURENA_GDD_FF_MOVE_CODES
 #define SURENA_GDD_FF_ID
+#define SURENA_GDD_FF_CANONICAL_ID
 #define SURENA_GDD_FF_PLAYOUT
 #define SURENA_GDD_FF_PRINT
+#define SURENA_GDD_FF_BATCH
 #include "surena/game_decldef.h"
 
 // implementation
 
 static error_code create_gf(game* self, game_init* init_info)
 {
-    self->data1 = malloc(sizeof(game_data));
-    if (self->data1 == NULL) {
-        return ERR_OUT_OF_MEMORY;
-    }
-    self->data2 = NULL;
-    {
-        export_buffers& bufs = get_bufs(self);
-        bufs.state = (char*)malloc(37 * sizeof(char));
-        bufs.players_to_move = (player_id*)malloc(1 * sizeof(player_id));
-        bufs.concrete_moves = (move_data*)malloc(81 * sizeof(move_data));
-        bufs.results = (player_id*)malloc(1 * sizeof(player_id));
-        bufs.move_str = (char*)malloc(3 * sizeof(char));
-        bufs.print = (char*)malloc(180 * sizeof(char)); // slightly oversized
-        if (bufs.state == NULL ||
-            bufs.players_to_move == NULL ||
-            bufs.concrete_moves == NULL ||
-            bufs.results == NULL ||
-            bufs.move_str == NULL ||
-            bufs.print == NULL) {
-            destroy_gf(self);
-            return ERR_OUT_OF_MEMORY;
-        }
-    }
-    const char* initial_state = NULL;
-    if (init_info->source_type == GAME_INIT_SOURCE_TYPE_STANDARD) {
-        initial_state = init_info->source.standard.state;
-    }
-    return import_state_gf(self, initial_state);
+    return create_block(self, init_info, NULL);
 }
 
 static error_code destroy_gf(game* self)
 {
-    {
-        export_buffers& bufs = get_bufs(self);
-        free(bufs.state);
-        free(bufs.players_to_move);
-        free(bufs.concrete_moves);
-        free(bufs.results);
-        free(bufs.move_str);
-        free(bufs.print);
-    }
-    free(self->data1);
+    game_data* data = (game_data*)self->data1;
+    if (data == NULL) {
+        return ERR_OK;
+    }
+    bool in_arena = data->in_arena;
+    if (in_arena == false) {
+        free(self->data1);
+    }
     self->data1 = NULL;
     return ERR_OK;
 }
@@ -158,15 +200,57 @@ static error_code clone_gf(game* self, game* clone_target)
     return ERR_OK;
 }
 
+static error_code size_hint_gf(game* self, game_init* init_info, size_t* ret_size)
+{
+    // independent of init_info, there are no options
+    *ret_size = game_e_arena_size(sizeof(game_data)) +
+                game_e_arena_size(STATE_STR_SIZE * sizeof(char)) +
+                game_e_arena_size(1 * sizeof(player_id)) +
+                game_e_arena_size(MAX_MOVES * sizeof(move_data)) +
+                game_e_arena_size(MAX_MOVES * sizeof(move_code)) +
+                game_e_arena_size(1 * sizeof(player_id)) +
+                game_e_arena_size(MOVE_STR_SIZE * sizeof(char)) +
+                game_e_arena_size(PRINT_STR_SIZE * sizeof(char));
+    return ERR_OK;
+}
+
+static error_code create_in_gf(game* self, game_init* init_info, game_arena* arena)
+{
+    return create_block(self, init_info, arena);
+}
+
+static error_code clone_in_gf(game* self, game* clone_target, game_arena* arena)
+{
+    clone_target->methods = self->methods;
+    game_init init_info = (game_init){.source_type = GAME_INIT_SOURCE_TYPE_DEFAULT};
+    error_code ec = create_block(clone_target, &init_info, arena);
+    if (ec != ERR_OK) {
+        return ec;
+    }
+    copy_from_gf(clone_target, self);
+    return ERR_OK;
+}
+
 static error_code copy_from_gf(game* self, game* other)
 {
     get_repr(self) = get_repr(other);
+    get_repr(self).undo_count = 0; // the moves of other can only be unmade on other
+    return ERR_OK;
+}
+
+static error_code memory_usage_gf(game* self, size_t* ret_state, size_t* ret_buffers)
+{
+    // all buffers live in the same block as the game data, see create_block
+    size_t block_size;
+    size_hint_gf(self, NULL, &block_size);
+    *ret_state = game_e_arena_size(sizeof(game_data));
+    *ret_buffers = block_size - *ret_state;
     return ERR_OK;
 }
 
 static error_code compare_gf(game* self, game* other, bool* ret_equal)
 {
-    *ret_equal = (memcmp(&get_repr(self), &get_repr(other), sizeof(state_repr)) == 0);
+    *ret_equal = (memcmp(&get_repr(self), &get_repr(other), offsetof(state_repr, undo_count)) == 0);
     return ERR_OK;
 }
 
@@ -179,12 +263,19 @@ static error_code player_count_gf(game* self, uint8_t* ret_count)
 static error_code export_state_gf(game* self, player_id player, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
-    char* outbuf = bufs.state;
-    if (outbuf == NULL) {
-        return ERR_INVALID_INPUT;
+    error_code ec = export_state_into_gf(self, STATE_STR_SIZE, ret_size, bufs.state);
+    *ret_str = bufs.state;
+    return ec;
+}
+
+static error_code export_state_into_gf(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < STATE_STR_SIZE) {
+        *ret_size = STATE_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
     }
+    char* outbuf = str;
     state_repr& data = get_repr(self);
-    const char* ostr = outbuf;
     player_id cell_player;
     for (int y = 8; y >= 0; y--) {
         int empty_squares = 0;
@@ -214,50 +305,22 @@ static error_code export_state_gf(game* self, player_id player, size_t* ret_size
     } else {
         outbuf += sprintf(outbuf, " -");
     }
-    // current player
-    uint8_t ptm_count;
-    const player_id* ptm_buf;
-    players_to_move_gf(self, &ptm_count, &ptm_buf);
-    player_id ptm;
-    if (ptm_count == 0) {
-        ptm = PLAYER_NONE;
-    } else {
-        ptm = ptm_buf[0];
-    }
-    switch (ptm) {
-        case PLAYER_NONE: {
-            outbuf += sprintf(outbuf, " -");
-        } break;
-        case 1: {
-            outbuf += sprintf(outbuf, " X");
-        } break;
-        case 2: {
-            outbuf += sprintf(outbuf, " O");
-        } break;
-    }
-    // result player
-    uint8_t res_count;
-    const player_id* res_buf;
-    get_results_gf(self, &res_count, &res_buf);
-    player_id res;
-    if (res_count == 0) {
-        res = PLAYER_NONE;
-    } else {
-        res = res_buf[0];
-    }
-    switch (res) {
-        case PLAYER_NONE: {
-            outbuf += sprintf(outbuf, " -");
-        } break;
-        case 1: {
-            outbuf += sprintf(outbuf, " X");
-        } break;
-        case 2: {
-            outbuf += sprintf(outbuf, " O");
-        } break;
+    // current player and result player, both read straight from the state so this stays read only
+    player_id flags[2] = {data.current_player, data.winning_player};
+    for (int i = 0; i < 2; i++) {
+        switch (flags[i]) {
+            case PLAYER_NONE: {
+                outbuf += sprintf(outbuf, " -");
+            } break;
+            case 1: {
+                outbuf += sprintf(outbuf, " X");
+            } break;
+            case 2: {
+                outbuf += sprintf(outbuf, " O");
+            } break;
+        }
     }
-    *ret_size = outbuf - ostr;
-    *ret_str = bufs.state;
+    *ret_size = outbuf - str;
     return ERR_OK;
 }
 
@@ -272,6 +335,8 @@ static error_code import_state_gf(game* self, const char* str)
     data.global_board = 0;
     data.global_target_x = -1;
     data.global_target_y = -1;
+    data.undo_count = 0;
+    memset(data.sym_keys, 0, sizeof(data.sym_keys));
     if (str == NULL) {
         data.current_player = 1;
         data.winning_player = 0;
@@ -343,7 +408,7 @@ static error_code import_state_gf(game* self, const char* str)
     if (*str != '-') {
         data.global_target_x = (*str) - 'a';
         str++;
-        data.global_target_y = (*str) - '1';
+        data.global_target_y = (*str) - '0';
         if (data.global_target_x < 0 || data.global_target_x > 2 || data.global_target_y < 0 || data.global_target_y > 2) {
             return ERR_INVALID_INPUT;
         }
@@ -397,63 +462,99 @@ static error_code import_state_gf(game* self, const char* str)
 
 static error_code players_to_move_gf(game* self, uint8_t* ret_count, const player_id** ret_players)
 {
-    *ret_count = 1;
+    export_buffers& bufs = get_bufs(self);
+    players_to_move_into_gf(self, 1, ret_count, bufs.players_to_move);
+    *ret_players = bufs.players_to_move;
+    return ERR_OK;
+}
+
+static error_code players_to_move_into_gf(game* self, uint8_t cap, uint8_t* ret_count, player_id* players)
+{
+    if (cap < 1) {
+        *ret_count = 1;
+        return ERR_OUT_OF_MEMORY;
+    }
     state_repr& data = get_repr(self);
     player_id ptm = data.current_player;
     if (ptm == PLAYER_NONE) {
         *ret_count = 0;
         return ERR_OK;
     }
-    export_buffers& bufs = get_bufs(self);
-    player_id* outbuf = bufs.players_to_move;
-    *outbuf = ptm;
-    *ret_players = outbuf;
+    *ret_count = 1;
+    *players = ptm;
     return ERR_OK;
 }
 
 static error_code get_concrete_moves_gf(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves)
 {
     export_buffers& bufs = get_bufs(self);
-    move_data* outbuf = bufs.concrete_moves;
-    uint8_t ptm_count;
-    const player_id* ptm;
-    players_to_move_gf(self, &ptm_count, &ptm);
-    if (ptm_count == 0 || player != *ptm) {
-        *ret_count = 0;
-        return ERR_OK;
+    get_concrete_moves_into_gf(self, player, MAX_MOVES, ret_count, bufs.concrete_moves);
+    *ret_moves = bufs.concrete_moves;
+    return ERR_OK;
+}
+
+static error_code get_concrete_moves_into_gf(game* self, player_id player, uint32_t cap, uint32_t* ret_count, move_data* moves)
+{
+    if (cap < MAX_MOVES) {
+        *ret_count = MAX_MOVES;
+        return ERR_OUT_OF_MEMORY;
+    }
+    move_code codes[81];
+    *ret_count = get_move_codes(self, player, codes);
+    for (uint32_t i = 0; i < *ret_count; i++) {
+        moves[i] = game_e_create_move_small(codes[i]);
     }
+    return ERR_OK;
+}
+
+static error_code get_concrete_moves_codes_gf(game* self, player_id player, uint32_t* ret_count, const move_code** ret_moves)
+{
+    export_buffers& bufs = get_bufs(self);
+    *ret_count = get_move_codes(self, player, bufs.concrete_move_codes);
+    *ret_moves = bufs.concrete_move_codes;
+    return ERR_OK;
+}
+
+static error_code get_moves_begin_gf(game* self, player_id player, move_iterator* it)
+{
+    // idx is the next cell to look at as (local board * 9 + cell in that board), sub is the end of the range to look at
     state_repr& data = get_repr(self);
-    uint32_t count = 0;
-    player_id cell_player;
+    it->player = player;
     if (data.global_target_x >= 0 && data.global_target_y >= 0) {
-        // only give moves for the target local board
-        for (int ly = data.global_target_y * 3; ly < data.global_target_y * 3 + 3; ly++) {
-            for (int lx = data.global_target_x * 3; lx < data.global_target_x * 3 + 3; lx++) {
-                get_cell_local_gf(self, lx, ly, &cell_player);
-                if (cell_player == PLAYER_NONE) {
-                    outbuf[count++] = game_e_create_move_small((ly << 4) | lx);
-                }
-            }
-        }
+        it->idx = (data.global_target_y * 3 + data.global_target_x) * 9;
+        it->sub = it->idx + 9;
     } else {
-        for (int gy = 0; gy < 3; gy++) {
-            for (int gx = 0; gx < 3; gx++) {
-                get_cell_global_gf(self, gx, gy, &cell_player);
-                if (cell_player == PLAYER_NONE) {
-                    for (int ly = gy * 3; ly < gy * 3 + 3; ly++) {
-                        for (int lx = gx * 3; lx < gx * 3 + 3; lx++) {
-                            get_cell_local_gf(self, lx, ly, &cell_player);
-                            if (cell_player == PLAYER_NONE) {
-                                outbuf[count++] = game_e_create_move_small((ly << 4) | lx);
-                            }
-                        }
-                    }
-                }
+        it->idx = 0;
+        it->sub = 81;
+    }
+    return ERR_OK;
+}
+
+static error_code get_moves_next_gf(game* self, move_iterator* it, bool* ret_done, move_data* ret_move)
+{
+    player_id cell_player;
+    while (it->idx < it->sub) {
+        int gx = (it->idx / 9) % 3;
+        int gy = (it->idx / 9) / 3;
+        if (it->idx % 9 == 0) {
+            // skip decided local boards as a whole
+            get_cell_global_gf(self, gx, gy, &cell_player);
+            if (cell_player != PLAYER_NONE) {
+                it->idx += 9;
+                continue;
             }
         }
+        int lx = gx * 3 + (it->idx % 9) % 3;
+        int ly = gy * 3 + (it->idx % 9) / 3;
+        it->idx++;
+        get_cell_local_gf(self, lx, ly, &cell_player);
+        if (cell_player == PLAYER_NONE) {
+            *ret_done = false;
+            *ret_move = game_e_create_move_small((ly << 4) | lx);
+            return ERR_OK;
+        }
     }
-    *ret_count = count;
-    *ret_moves = bufs.concrete_moves;
+    *ret_done = true;
     return ERR_OK;
 }
 
@@ -496,6 +597,9 @@ static error_code make_move_gf(game* self, player_id player, move_data_sync move
     move_code mcode = move.md.cl.code;
     int x = mcode & 0b1111;
     int y = (mcode >> 4) & 0b1111;
+    data.undo_targets[data.undo_count][0] = data.global_target_x;
+    data.undo_targets[data.undo_count][1] = data.global_target_y;
+    data.undo_count++;
     set_cell_local_gf(self, x, y, data.current_player);
     int gx = x / 3;
     int gy = y / 3;
@@ -535,6 +639,27 @@ static error_code make_move_gf(game* self, player_id player, move_data_sync move
     return ERR_OK;
 }
 
+static error_code unmake_move_gf(game* self, player_id player, move_data_sync move)
+{
+    state_repr& data = get_repr(self);
+    if (data.undo_count == 0) {
+        // no made move known, e.g. after an import
+        return ERR_INVALID_INPUT;
+    }
+    move_code mcode = move.md.cl.code;
+    int x = mcode & 0b1111;
+    int y = (mcode >> 4) & 0b1111;
+    set_cell_local_gf(self, x, y, PLAYER_NONE);
+    // moves are only legal on undecided local boards, so the local result can only have been created by this move
+    set_cell_global_gf(self, x / 3, y / 3, PLAYER_NONE);
+    data.undo_count--;
+    data.global_target_x = data.undo_targets[data.undo_count][0];
+    data.global_target_y = data.undo_targets[data.undo_count][1];
+    data.winning_player = PLAYER_NONE;
+    data.current_player = player;
+    return ERR_OK;
+}
+
 static error_code get_results_gf(game* self, uint8_t* ret_count, const player_id** ret_players)
 {
     export_buffers& bufs = get_bufs(self);
@@ -562,10 +687,29 @@ static error_code id_gf(game* self, uint64_t* ret_id)
     return ERR_OK;
 }
 
-static error_code playout_gf(game* self, uint64_t seed)
+static error_code canonical_id_gf(game* self, uint64_t* ret_id, uint8_t* ret_transform)
+{
+    state_repr& data = get_repr(self);
+    // the local board results follow from the cells, current player and result look the same in every image
+    // the global target moves with the image, its keys use the cell idxs after the board
+    uint64_t side_key = zobrist_key(81 + 9, data.current_player) ^ zobrist_key(81 + 10, data.winning_player);
+    bool has_target = (data.global_target_x >= 0 && data.global_target_y >= 0);
+    for (uint8_t t = 0; t < 8; t++) {
+        uint64_t t_id = data.sym_keys[t] ^ side_key;
+        if (has_target == true) {
+            t_id ^= zobrist_key(81 + sym_cell(t, 3, data.global_target_x, data.global_target_y), 1);
+        }
+        if (t == 0 || t_id < *ret_id) {
+            *ret_id = t_id;
+            *ret_transform = t;
+        }
+    }
+    return ERR_OK;
+}
+
+static error_code playout_gf(game* self, seed128 seed)
 {
-    fast_prng rng;
-    fprng_srand(&rng, seed);
+    game_rng rng = game_e_rng_create(seed, 0);
     uint32_t moves_count;
     const move_data* moves;
     uint8_t ptm_count;
@@ -573,7 +717,7 @@ static error_code playout_gf(game* self, uint64_t seed)
     players_to_move_gf(self, &ptm_count, &ptm);
     while (ptm_count > 0) {
         get_concrete_moves_gf(self, ptm[0], &moves_count, &moves);
-        make_move_gf(self, ptm[0], game_e_move_make_sync(self, moves[fprng_rand(&rng) % moves_count])); //BUG this has modulo bias, use proper rand_intn
+        make_move_gf(self, ptm[0], game_e_move_make_sync(self, moves[game_e_rng_intn(&rng, moves_count)]));
         players_to_move_gf(self, &ptm_count, &ptm);
     }
     return ERR_OK;
@@ -610,28 +754,48 @@ static error_code get_move_data_gf(game* self, player_id player, const char* str
 static error_code get_move_str_gf(game* self, player_id player, move_data_sync move, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
-    char* outbuf = bufs.move_str;
+    error_code ec = get_move_str_into_gf(self, player, move, MOVE_STR_SIZE, ret_size, bufs.move_str);
+    *ret_str = bufs.move_str;
+    return ec;
+}
+
+static error_code get_move_str_into_gf(game* self, player_id player, move_data_sync move, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < MOVE_STR_SIZE) {
+        *ret_size = MOVE_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
+    }
     move_code mcode = move.md.cl.code;
     if (mcode == MOVE_NONE) {
-        *ret_size = sprintf(outbuf, "-");
+        *ret_size = sprintf(str, "-");
         return ERR_OK;
     }
     int x = mcode & 0b1111;
     int y = (mcode >> 4) & 0b1111;
-    *ret_size = sprintf(outbuf, "%c%c", 'a' + x, '0' + y);
-    *ret_str = bufs.move_str;
+    *ret_size = sprintf(str, "%c%c", 'a' + x, '0' + y);
     return ERR_OK;
 }
 
 static error_code print_gf(game* self, player_id player, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
-    char* outbuf = bufs.print;
+    error_code ec = print_into_gf(self, PRINT_STR_SIZE, ret_size, bufs.print);
+    *ret_str = bufs.print;
+    return ec;
+}
+
+static error_code print_into_gf(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < PRINT_STR_SIZE) {
+        *ret_size = PRINT_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
+    }
+    char* outbuf = str;
     state_repr& data = get_repr(self);
     player_id cell_player;
     size_t global_target_str_len;
-    const char* global_target_str;
-    get_move_str_gf(self, data.current_player, game_e_create_move_sync_small(self, (data.global_target_y << 4) | data.global_target_x), &global_target_str_len, &global_target_str);
+    char global_target_str[3];
+    get_move_str_into_gf(self, data.current_player, game_e_create_move_sync_small(self, (data.global_target_y << 4) | data.global_target_x), sizeof(global_target_str), &global_target_str_len, global_target_str);
     outbuf += sprintf(outbuf, "global target: %s\n", (data.global_target_x >= 0 && data.global_target_y >= 0) ? global_target_str : "-");
     for (int gy = 2; gy >= 0; gy--) {
         for (int ly = 2; ly >= 0; ly--) {
@@ -673,11 +837,321 @@ static error_code print_gf(game* self, player_id player, size_t* ret_size, const
         outbuf += sprintf(outbuf, " ");
     }
     outbuf += sprintf(outbuf, "\n");
-    *ret_size = outbuf - bufs.print;
-    *ret_str = bufs.print;
+    *ret_size = outbuf - str;
+    return ERR_OK;
+}
+
+static error_code batch_create_gf(game* self, uint32_t count, game_batch* ret_batch)
+{
+    // one block for the batch data and all its arrays
+    size_t block_size = game_e_arena_size(sizeof(batch_data)) +
+                        2 * game_e_arena_size(count * 9 * sizeof(uint16_t)) +
+                        3 * game_e_arena_size(count * sizeof(uint16_t)) +
+                        game_e_arena_size(count * sizeof(int8_t)) +
+                        2 * game_e_arena_size(count * sizeof(player_id));
+    void* block = malloc(block_size);
+    if (block == NULL) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    game_arena block_arena;
+    game_e_arena_init(&block_arena, block, block_size);
+    batch_data* bd = (batch_data*)game_e_arena_alloc(&block_arena, sizeof(batch_data));
+    bd->planes[0] = (uint16_t*)game_e_arena_alloc(&block_arena, count * 9 * sizeof(uint16_t));
+    bd->planes[1] = (uint16_t*)game_e_arena_alloc(&block_arena, count * 9 * sizeof(uint16_t));
+    for (int i = 0; i < 3; i++) {
+        bd->global_planes[i] = (uint16_t*)game_e_arena_alloc(&block_arena, count * sizeof(uint16_t));
+    }
+    bd->target = (int8_t*)game_e_arena_alloc(&block_arena, count * sizeof(int8_t));
+    bd->current_player = (player_id*)game_e_arena_alloc(&block_arena, count * sizeof(player_id));
+    bd->winning_player = (player_id*)game_e_arena_alloc(&block_arena, count * sizeof(player_id));
+    for (int i = 0; i < 81; i++) {
+        int x = (i / 9 % 3) * 3 + (i % 9 % 3);
+        int y = (i / 9 / 3) * 3 + (i % 9 / 3);
+        bd->move_codes[i] = (y << 4) | x;
+    }
+    ret_batch->methods = self->methods;
+    ret_batch->count = count;
+    ret_batch->move_space = 81;
+    ret_batch->move_codes = bd->move_codes;
+    ret_batch->data = bd;
+    for (uint32_t i = 0; i < count; i++) {
+        batch_load_gf(ret_batch, i, self);
+    }
+    return ERR_OK;
+}
+
+static error_code batch_destroy_gf(game_batch* batch)
+{
+    free(batch->data);
+    batch->data = NULL;
+    return ERR_OK;
+}
+
+static error_code batch_load_gf(game_batch* batch, uint32_t idx, game* source)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    state_repr& data = get_repr(source);
+    uint16_t global_planes[3] = {0, 0, 0};
+    for (int b = 0; b < 9; b++) {
+        uint16_t planes[2] = {0, 0};
+        for (int c = 0; c < 9; c++) {
+            player_id cell_player = (data.board[b / 3][b % 3] >> (c * 2)) & 0b11;
+            if (cell_player == 1 || cell_player == 2) {
+                planes[cell_player - 1] |= 1 << c;
+            }
+        }
+        bd->planes[0][idx * 9 + b] = planes[0];
+        bd->planes[1][idx * 9 + b] = planes[1];
+        player_id global_player = (data.global_board >> (b * 2)) & 0b11;
+        if (global_player != PLAYER_NONE) {
+            global_planes[global_player - 1] |= 1 << b;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        bd->global_planes[i][idx] = global_planes[i];
+    }
+    bd->target[idx] = (data.global_target_x >= 0 && data.global_target_y >= 0 ? data.global_target_y * 3 + data.global_target_x : -1);
+    bd->current_player[idx] = data.current_player;
+    bd->winning_player[idx] = data.winning_player;
+    return ERR_OK;
+}
+
+static error_code batch_store_gf(game_batch* batch, uint32_t idx, game* target)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    state_repr& data = get_repr(target);
+    data.global_board = 0;
+    for (int b = 0; b < 9; b++) {
+        uint32_t local_board = 0;
+        for (int c = 0; c < 9; c++) {
+            if ((bd->planes[0][idx * 9 + b] >> c) & 1) {
+                local_board |= 1 << (c * 2);
+            } else if ((bd->planes[1][idx * 9 + b] >> c) & 1) {
+                local_board |= 2 << (c * 2);
+            }
+        }
+        data.board[b / 3][b % 3] = local_board;
+        for (int i = 0; i < 3; i++) {
+            if ((bd->global_planes[i][idx] >> b) & 1) {
+                data.global_board |= (uint32_t)(i + 1) << (b * 2);
+            }
+        }
+    }
+    data.global_target_x = (bd->target[idx] >= 0 ? bd->target[idx] % 3 : -1);
+    data.global_target_y = (bd->target[idx] >= 0 ? bd->target[idx] / 3 : -1);
+    data.current_player = bd->current_player[idx];
+    data.winning_player = bd->winning_player[idx];
+    data.undo_count = 0; // the batch keeps no history, so there is nothing to unmake
+    rebuild_sym_keys(target);
+    return ERR_OK;
+}
+
+static error_code batch_players_to_move_gf(game_batch* batch, player_id* players)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    memcpy(players, bd->current_player, batch->count * sizeof(player_id));
+    return ERR_OK;
+}
+
+static error_code batch_get_move_masks_gf(game_batch* batch, uint64_t* masks)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    for (uint32_t i = 0; i < batch->count; i++) {
+        uint64_t running = (bd->current_player[i] != PLAYER_NONE);
+        uint16_t decided = bd->global_planes[0][i] | bd->global_planes[1][i] | bd->global_planes[2][i];
+        // boards open for this move, either just the target or all undecided ones
+        uint16_t open = (bd->target[i] >= 0 ? 1 << bd->target[i] : ~decided & 0x1FF);
+        uint64_t lo = 0;
+        uint64_t hi = 0;
+        for (int b = 0; b < 9; b++) {
+            uint64_t free_cells = (~(uint64_t)(bd->planes[0][i * 9 + b] | bd->planes[1][i * 9 + b]) & 0x1FF) * ((open >> b) & 1);
+            // 81 bits over two words, board 7 straddles them
+            int shift = b * 9;
+            if (shift < 64) {
+                lo |= free_cells << shift;
+                hi |= (shift + 9 > 64 ? free_cells >> (64 - shift) : 0);
+            } else {
+                hi |= free_cells << (shift - 64);
+            }
+        }
+        masks[i * 2] = lo * running;
+        masks[i * 2 + 1] = hi * running;
+    }
+    return ERR_OK;
+}
+
+static error_code batch_make_moves_gf(game_batch* batch, const uint32_t* move_idxs)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    for (uint32_t i = 0; i < batch->count; i++) {
+        if (move_idxs[i] == GAME_BATCH_MOVE_NONE) {
+            continue;
+        }
+        int b = move_idxs[i] / 9;
+        int c = move_idxs[i] % 9;
+        player_id current_player = bd->current_player[i];
+        uint16_t plane = bd->planes[current_player - 1][i * 9 + b] | (1 << c);
+        bd->planes[current_player - 1][i * 9 + b] = plane;
+        // same order as make_move: local result first, then the next target (which may be the board just decided)
+        player_id local_result = PLAYER_NONE;
+        if (plane_has_line(plane) == true) {
+            local_result = current_player;
+        } else if ((bd->planes[0][i * 9 + b] | bd->planes[1][i * 9 + b]) == 0x1FF) {
+            local_result = 3;
+        }
+        if (local_result != PLAYER_NONE) {
+            bd->global_planes[local_result - 1][i] |= 1 << b;
+        }
+        uint16_t decided = bd->global_planes[0][i] | bd->global_planes[1][i] | bd->global_planes[2][i];
+        bd->target[i] = (((decided >> c) & 1) == 0 ? c : -1);
+        if (local_result != PLAYER_NONE) {
+            // only lines through the board just decided can be new, and they all carry its result
+            if (plane_has_line(bd->global_planes[local_result - 1][i]) == true) {
+                bd->winning_player[i] = local_result;
+                bd->current_player[i] = PLAYER_NONE;
+                continue;
+            }
+            if (decided == 0x1FF) {
+                bd->winning_player[i] = 3;
+                bd->current_player[i] = PLAYER_NONE;
+                continue;
+            }
+        }
+        bd->current_player[i] = (current_player == 1) ? 2 : 1;
+    }
+    return ERR_OK;
+}
+
+static error_code batch_get_results_gf(game_batch* batch, player_id* results)
+{
+    batch_data* bd = (batch_data*)batch->data;
+    for (uint32_t i = 0; i < batch->count; i++) {
+        // the game reports global draws as result 3
+        results[i] = (bd->winning_player[i] == 3 ? PLAYER_NONE : bd->winning_player[i]);
+    }
     return ERR_OK;
 }
 
+// impl hidden: creates the game data and all buffers in one block of size_hint, taken from the arena or malloc'd if arena is NULL
+static error_code create_block(game* self, game_init* init_info, game_arena* arena)
+{
+    size_t block_size;
+    size_hint_gf(self, init_info, &block_size);
+    void* block = (arena == NULL ? malloc(block_size) : game_e_arena_alloc(arena, block_size));
+    if (block == NULL) {
+        self->data1 = NULL;
+        return ERR_OUT_OF_MEMORY;
+    }
+    // the block is sized exactly for these allocations, so none of them can fail
+    game_arena block_arena;
+    game_e_arena_init(&block_arena, block, block_size);
+    self->data1 = game_e_arena_alloc(&block_arena, sizeof(game_data));
+    self->data2 = NULL;
+    ((game_data*)self->data1)->in_arena = (arena != NULL);
+    {
+        export_buffers& bufs = get_bufs(self);
+        bufs.state = (char*)game_e_arena_alloc(&block_arena, STATE_STR_SIZE * sizeof(char));
+        bufs.players_to_move = (player_id*)game_e_arena_alloc(&block_arena, 1 * sizeof(player_id));
+        bufs.concrete_moves = (move_data*)game_e_arena_alloc(&block_arena, MAX_MOVES * sizeof(move_data));
+        bufs.concrete_move_codes = (move_code*)game_e_arena_alloc(&block_arena, MAX_MOVES * sizeof(move_code));
+        bufs.results = (player_id*)game_e_arena_alloc(&block_arena, 1 * sizeof(player_id));
+        bufs.move_str = (char*)game_e_arena_alloc(&block_arena, MOVE_STR_SIZE * sizeof(char));
+        bufs.print = (char*)game_e_arena_alloc(&block_arena, PRINT_STR_SIZE * sizeof(char));
+    }
+    const char* initial_state = NULL;
+    if (init_info->source_type == GAME_INIT_SOURCE_TYPE_STANDARD) {
+        initial_state = init_info->source.standard.state;
+    }
+    return import_state_gf(self, initial_state);
+}
+
+// impl hidden: writes the move codes of all free cells playable under the global target if player is to move, read only on the game, returns the number of codes written
+static uint32_t get_move_codes(game* self, player_id player, move_code* outbuf)
+{
+    state_repr& data = get_repr(self);
+    if (data.current_player == PLAYER_NONE || player != data.current_player) {
+        return 0;
+    }
+    uint32_t count = 0;
+    player_id cell_player;
+    if (data.global_target_x >= 0 && data.global_target_y >= 0) {
+        // only give moves for the target local board
+        for (int ly = data.global_target_y * 3; ly < data.global_target_y * 3 + 3; ly++) {
+            for (int lx = data.global_target_x * 3; lx < data.global_target_x * 3 + 3; lx++) {
+                get_cell_local_gf(self, lx, ly, &cell_player);
+                if (cell_player == PLAYER_NONE) {
+                    outbuf[count++] = (ly << 4) | lx;
+                }
+            }
+        }
+    } else {
+        for (int gy = 0; gy < 3; gy++) {
+            for (int gx = 0; gx < 3; gx++) {
+                get_cell_global_gf(self, gx, gy, &cell_player);
+                if (cell_player == PLAYER_NONE) {
+                    for (int ly = gy * 3; ly < gy * 3 + 3; ly++) {
+                        for (int lx = gx * 3; lx < gx * 3 + 3; lx++) {
+                            get_cell_local_gf(self, lx, ly, &cell_player);
+                            if (cell_player == PLAYER_NONE) {
+                                outbuf[count++] = (ly << 4) | lx;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return count;
+}
+
+// impl hidden: true if the cell plane (bit index y * 3 + x) contains any full row, column or diagonal
+static bool plane_has_line(uint16_t plane)
+{
+    static const uint16_t lines[8] = {0x007, 0x038, 0x1C0, 0x049, 0x092, 0x124, 0x111, 0x054};
+    bool line = false;
+    for (int i = 0; i < 8; i++) {
+        line |= ((plane & lines[i]) == lines[i]);
+    }
+    return line;
+}
+
+// impl hidden: cell idx (y * n + x) that symmetry t moves the cell (x, y) of an n by n board to
+// t & 4 mirrors x -> n - 1 - x first, then it is rotated counter clockwise (t & 3) times by (x, y) -> (n - 1 - y, x)
+static int sym_cell(int t, int n, int x, int y)
+{
+    if ((t & 4) != 0) {
+        x = n - 1 - x;
+    }
+    for (int i = 0; i < (t & 3); i++) {
+        int rx = n - 1 - y;
+        y = x;
+        x = rx;
+    }
+    return y * n + x;
+}
+
+// impl hidden: zobrist key of player p on the cell idx, the empty cell has none
+static uint64_t zobrist_key(int cell, player_id p)
+{
+    return zobrist.keys[cell][p];
+}
+
+// impl hidden: recomputes all symmetry keys from the board, for writes that skip set_cell_local
+static void rebuild_sym_keys(game* self)
+{
+    state_repr& data = get_repr(self);
+    memset(data.sym_keys, 0, sizeof(data.sym_keys));
+    player_id cell_player;
+    for (int y = 0; y < 9; y++) {
+        for (int x = 0; x < 9; x++) {
+            get_cell_local_gf(self, x, y, &cell_player);
+            for (int t = 0; t < 8; t++) {
+                data.sym_keys[t] ^= zobrist_key(sym_cell(t, 9, x, y), cell_player);
+            }
+        }
+    }
+}
+
 //=====
 // game internal methods
 
@@ -756,6 +1230,12 @@ static error_code set_cell_gf(game* self, uint32_t* state, int x, int y, player_
     return ERR_OK;
 }
 
+static error_code ext_set_cell_gf(game* self, uint32_t* state, int x, int y, player_id p)
+{
+    game_e_cache_invalidate(self);
+    return set_cell_gf(self, state, x, y, p);
+}
+
 static error_code get_cell_global_gf(game* self, int x, int y, player_id* ret_p)
 {
     state_repr& data = get_repr(self);
@@ -770,6 +1250,12 @@ static error_code set_cell_global_gf(game* self, int x, int y, player_id p)
     return ERR_OK;
 }
 
+static error_code ext_set_cell_global_gf(game* self, int x, int y, player_id p)
+{
+    game_e_cache_invalidate(self);
+    return set_cell_global_gf(self, x, y, p);
+}
+
 static error_code get_cell_local_gf(game* self, int x, int y, player_id* ret_p)
 {
     state_repr& data = get_repr(self);
@@ -780,10 +1266,22 @@ static error_code get_cell_local_gf(game* self, int x, int y, player_id* ret_p)
 static error_code set_cell_local_gf(game* self, int x, int y, player_id p)
 {
     state_repr& data = get_repr(self);
+    player_id pc;
+    get_cell_local_gf(self, x, y, &pc);
+    for (int t = 0; t < 8; t++) {
+        int cell = sym_cell(t, 9, x, y);
+        data.sym_keys[t] ^= zobrist_key(cell, pc) ^ zobrist_key(cell, p);
+    }
     set_cell_gf(self, &(data.board[y / 3][x / 3]), x % 3, y % 3, p);
     return ERR_OK;
 }
 
+static error_code ext_set_cell_local_gf(game* self, int x, int y, player_id p)
+{
+    game_e_cache_invalidate(self);
+    return set_cell_local_gf(self, x, y, p);
+}
+
 static error_code get_global_target_gf(game* self, uint8_t* ret)
 {
     state_repr& data = get_repr(self);
@@ -799,6 +1297,12 @@ static error_code set_global_target_gf(game* self, int x, int y)
     return ERR_OK;
 }
 
+static error_code ext_set_global_target_gf(game* self, int x, int y)
+{
+    game_e_cache_invalidate(self);
+    return set_global_target_gf(self, x, y);
+}
+
 static error_code set_current_player_gf(game* self, player_id p)
 {
     state_repr& data = get_repr(self);
@@ -806,6 +1310,12 @@ static error_code set_current_player_gf(game* self, player_id p)
     return ERR_OK;
 }
 
+static error_code ext_set_current_player_gf(game* self, player_id p)
+{
+    game_e_cache_invalidate(self);
+    return set_current_player_gf(self, p);
+}
+
 static error_code set_result_gf(game* self, player_id p)
 {
     state_repr& data = get_repr(self);
@@ -813,6 +1323,12 @@ static error_code set_result_gf(game* self, player_id p)
     return ERR_OK;
 }
 
+static error_code ext_set_result_gf(game* self, player_id p)
+{
+    game_e_cache_invalidate(self);
+    return set_result_gf(self, p);
+}
+
 //TODO fix X/O enum, same as tictactoe_standard
 
 #ifdef __cplusplus
@@ -5,13 +5,17 @@
 #include <unordered_map>
 #include <vector>
 
-#include "rosalia/noise.h"
 #include "rosalia/semver.h"
 
 #include "surena/game.h"
 
 #include "surena/games/twixt_pp.h"
 
+#include "games/change_journal.hpp"
+#include "games/cow_board.hpp"
+#include "games/row_render.hpp"
+#include "games/undo_history.hpp"
+
 // general purpose helpers for opts, data, bufs
 
 namespace {
@@ -21,23 +25,63 @@ namespace {
         char* state;
         player_id* players_to_move;
         move_data* concrete_moves;
+        move_code* concrete_move_codes;
         player_id* results;
         move_data_sync move_out;
         char* move_str;
         char* print;
+        char* state_delta;
+        // rows of state and print that have to be rendered again, every board row is one row of both
+        row_render state_rows;
+        row_render print_rows;
     };
 
     typedef twixt_pp_options opts_repr;
 
+    struct undo_node {
+        uint8_t x;
+        uint8_t y;
+        twixt_pp_node node;
+    };
+
+    // scalar state from before a made move, its overwritten nodes and graphs are in the journals starting at the given idx
+    struct undo_entry {
+        TWIXT_PP_PLAYER current_player;
+        TWIXT_PP_PLAYER winning_player;
+        uint16_t remaining_inner_nodes;
+        uint16_t next_graph_id;
+        bool pie_swap;
+        uint16_t swap_target;
+        size_t node_journal_idx;
+        size_t graph_journal_idx;
+    };
+
+    // a move writes its node and the first node of each of its up to 8 connections, usually far less
+    const uint32_t JOURNAL_CELLS = 256;
+    const uint32_t JOURNAL_MOVES = 32;
+
+    // fixed export buffer sizes, for create_bufs, memory_usage and the _into size checks
+    const size_t OPTIONS_STR_SIZE = 9;
+    const size_t MOVE_STR_SIZE = 6;
+
     struct state_repr {
         TWIXT_PP_PLAYER current_player;
         TWIXT_PP_PLAYER winning_player;
         uint16_t remaining_inner_nodes;
         std::unordered_map<uint16_t, twixt_pp_graph> graph_map;
         uint16_t next_graph_id;
-        std::vector<std::vector<twixt_pp_node>> gameboard; // white plays vertical and black horizontal per default, gameboard[iy][ix]
+        // white plays vertical and black horizontal per default
+        // clones share the board blocks, only blocks written afterwards are copied, see cow_board
+        cow_board<twixt_pp_node> gameboard;
         bool pie_swap; // if this is true while it is blacks turn, they may swap move to mirror it as theirs, then set false even if not used
         uint16_t swap_target;
+        // one entry per move made while unmake_history is set, cleared on import, only while there are entries are changes journaled
+        // copies of the state start without any of these, see undo_history
+        undo_history<undo_entry> undo_stack;
+        undo_history<undo_node> node_journal;
+        undo_history<twixt_pp_graph> graph_journal; // only root graphs are ever changed, so their graph_id is also their key
+        // nodes whose player or connections were written by the most recent moves, for export_state_delta
+        change_journal<JOURNAL_CELLS, JOURNAL_MOVES> changes;
     };
 
     struct game_data {
@@ -61,6 +105,22 @@ namespace {
         return ((game_data*)(self->data1))->state;
     }
 
+    // save the node before it is written to, if a move is being made
+    void journal_node(state_repr& data, uint8_t x, uint8_t y)
+    {
+        if (data.undo_stack.empty() == false) {
+            data.node_journal.push_back(undo_node{x, y, data.gameboard.get(x, y)});
+        }
+    }
+
+    // save the root graph before it is written to, if a move is being made
+    void journal_graph(state_repr& data, uint16_t graph_id)
+    {
+        if (data.undo_stack.empty() == false) {
+            data.graph_journal.push_back(data.graph_map[graph_id]);
+        }
+    }
+
 } // namespace
 
 #ifdef __cplusplus
@@ -75,12 +135,27 @@ static error_code get_node_collisions_gf(game* self, uint8_t x, uint8_t y, uint8
 static error_code set_connection_gf(game* self, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, bool* wins);
 static error_code can_swap_gf(game* self, bool* swap_available);
 
+// the setters handed out in the internal methods, these drop the wrapper query cache before writing
+static error_code ext_set_node_gf(game* self, uint8_t x, uint8_t y, TWIXT_PP_PLAYER p, uint8_t connection_mask, bool* wins);
+static error_code ext_set_connection_gf(game* self, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, bool* wins);
+
+// impl hidden helpers
+static error_code create_bufs(game* self);
+static uint32_t max_move_count(game* self);
+static size_t state_str_size(game* self);
+static size_t state_delta_str_size(game* self);
+static size_t print_str_size(game* self);
+static size_t state_row(game* self, int y, char* str);
+static size_t state_flags(game* self, char* str);
+static size_t print_row(game* self, int y, char* str);
+static void invalidate_rows(game* self, int y_first, int y_last);
+
 static const twixt_pp_internal_methods twixt_pp_gbe_internal_methods{
     .get_node = get_node_gf,
-    .set_node = set_node_gf,
+    .set_node = ext_set_node_gf,
     .get_node_connections = get_node_connections_gf,
     .get_node_collisions = get_node_collisions_gf,
-    .set_connection = set_connection_gf,
+    .set_connection = ext_set_connection_gf,
     .can_swap = can_swap_gf,
 };
 
@@ -92,6 +167,12 @@ static const twixt_pp_internal_methods twixt_pp_gbe_internal_methods{
 #define SURENA_GDD_VERSION ((semver){1, 0, 0})
 #define SURENA_GDD_INTERNALS &twixt_pp_gbe_internal_methods
 #define SURENA_GDD_FF_OPTIONS
+#define SURENA_GDD_FF_MEMORY_USAGE
+#define SURENA_GDD_FF_EXPORT_STATE_DELTA
+#define SURENA_GDD_FF_UNMAKE_MOVE
+#define SURENA_GDD_FF_LAZY_MOVES
+#define SURENA_GDD_FF_MOVE_CODES
+#define SURENA_GDD_FF_QUERY_INTO
 #define SURENA_GDD_FF_PLAYOUT
 #define SURENA_GDD_FF_PRINT
 #include "surena/game_decldef.h"
@@ -147,24 +228,9 @@ static error_code create_gf(game* self, game_init* init_info)
         return ERR_INVALID_INPUT;
     }
 
-    {
-        export_buffers& bufs = get_bufs(self);
-        bufs.options = (char*)malloc(9 * sizeof(char));
-        bufs.state = (char*)malloc((opts.wy * opts.wx * 5 + 1 + 4) * sizeof(char));
-        bufs.players_to_move = (player_id*)malloc(1 * sizeof(player_id));
-        bufs.concrete_moves = (move_data*)malloc((opts.wx * opts.wy - 3) * sizeof(move_data));
-        bufs.results = (player_id*)malloc(1 * sizeof(player_id));
-        bufs.move_str = (char*)malloc(6 * sizeof(char));
-        bufs.print = (char*)malloc((opts.wx * opts.wy + opts.wy + 1) * sizeof(char));
-        if (bufs.state == NULL ||
-            bufs.players_to_move == NULL ||
-            bufs.concrete_moves == NULL ||
-            bufs.results == NULL ||
-            bufs.move_str == NULL ||
-            bufs.print == NULL) {
-            destroy_gf(self);
-            return ERR_OUT_OF_MEMORY;
-        }
+    error_code ec = create_bufs(self);
+    if (ec != ERR_OK) {
+        return ec;
     }
     const char* initial_state = NULL;
     if (init_info->source_type == GAME_INIT_SOURCE_TYPE_STANDARD) {
@@ -181,9 +247,11 @@ static error_code destroy_gf(game* self)
         free(bufs.state);
         free(bufs.players_to_move);
         free(bufs.concrete_moves);
+        free(bufs.concrete_move_codes);
         free(bufs.results);
         free(bufs.move_str);
         free(bufs.print);
+        free(bufs.state_delta);
     }
     delete (game_data*)self->data1;
     self->data1 = NULL;
@@ -192,33 +260,48 @@ static error_code destroy_gf(game* self)
 
 static error_code clone_gf(game* self, game* clone_target)
 {
-    size_t size_fill;
-    const char* opts_export;
-    export_options_gf(self, PLAYER_NONE, &size_fill, &opts_export);
     clone_target->methods = self->methods;
-    export_buffers& bufs = get_bufs(self);
-    game_init init_info = (game_init){
-        .source_type = GAME_INIT_SOURCE_TYPE_STANDARD,
-        .source = {
-            .standard = {
-                .opts = opts_export,
-                .legacy = NULL,
-                .state = NULL,
-            },
-        },
-    };
-    error_code ec = create_gf(clone_target, &init_info);
-    if (ec != ERR_OK) {
-        return ec;
+    // the copied state shares all board blocks with self, so the clone only pays for the blocks it writes later on
+    clone_target->data1 = malloc(sizeof(game_data));
+    if (clone_target->data1 == NULL) {
+        return ERR_OUT_OF_MEMORY;
     }
-    copy_from_gf(clone_target, self);
-    return ERR_OK;
+    new (clone_target->data1) game_data(*(game_data*)self->data1);
+    clone_target->data2 = NULL;
+    return create_bufs(clone_target);
 }
 
 static error_code copy_from_gf(game* self, game* other)
 {
     get_opts(self) = get_opts(other);
     get_repr(self) = get_repr(other);
+    get_bufs(self).state_rows.invalidate_all();
+    get_bufs(self).print_rows.invalidate_all();
+    return ERR_OK;
+}
+
+static error_code memory_usage_gf(game* self, size_t* ret_state, size_t* ret_buffers)
+{
+    state_repr& data = get_repr(self);
+    size_t state_size = sizeof(game_data);
+    // map nodes are approximated as their value plus one next pointer
+    state_size += data.graph_map.bucket_count() * sizeof(void*);
+    state_size += data.graph_map.size() * (sizeof(std::pair<const uint16_t, twixt_pp_graph>) + sizeof(void*));
+    state_size += data.gameboard.memory_usage() - sizeof(cow_board<twixt_pp_node>);
+    state_size += data.undo_stack.capacity() * sizeof(undo_entry);
+    state_size += data.node_journal.capacity() * sizeof(undo_node);
+    state_size += data.graph_journal.capacity() * sizeof(twixt_pp_graph);
+    *ret_state = state_size;
+    export_buffers& bufs = get_bufs(self);
+    *ret_buffers = bufs.state_rows.memory_usage() + bufs.print_rows.memory_usage() +
+                   OPTIONS_STR_SIZE * sizeof(char) +
+                   state_str_size(self) * sizeof(char) +
+                   1 * sizeof(player_id) +
+                   max_move_count(self) * (sizeof(move_data) + sizeof(move_code)) +
+                   1 * sizeof(player_id) +
+                   MOVE_STR_SIZE * sizeof(char) +
+                   print_str_size(self) * sizeof(char) +
+                   state_delta_str_size(self) * sizeof(char);
     return ERR_OK;
 }
 
@@ -249,101 +332,58 @@ static error_code player_count_gf(game* self, uint8_t* ret_count)
 
 static error_code export_state_gf(game* self, player_id player, size_t* ret_size, const char** ret_str)
 {
+    // only the rows changed since the last export are rendered again, the player flags are cheap enough to always append
     export_buffers& bufs = get_bufs(self);
-    char* outbuf = bufs.state;
-    if (outbuf == NULL) {
-        return ERR_INVALID_INPUT;
-    }
     opts_repr& opts = get_opts(self);
+    char* outbuf = bufs.state;
+    outbuf += bufs.state_rows.update(bufs.state, opts.wy, opts.wx * 5 + 1, [self](uint32_t y, char* str) {
+        return state_row(self, y, str);
+    });
+    outbuf += state_flags(self, outbuf);
+    *ret_size = outbuf - bufs.state;
+    *ret_str = bufs.state;
+    return ERR_OK;
+}
+
+static error_code export_state_delta_gf(game* self, uint64_t since_sync_ctr, size_t* ret_size, const char** ret_str)
+{
+    export_buffers& bufs = get_bufs(self);
     state_repr& data = get_repr(self);
-    const char* ostr = outbuf;
-    TWIXT_PP_PLAYER cell_player;
-    for (int y = 0; y < opts.wy; y++) {
-        int empty_cells = 0;
-        for (int x = 0; x < opts.wx; x++) {
-            get_node_gf(self, x, y, &cell_player);
-            if (cell_player == TWIXT_PP_PLAYER_INVALID) {
-                continue;
-            }
-            if (cell_player == TWIXT_PP_PLAYER_NONE) {
-                empty_cells++;
-            } else {
-                // if the current cell isnt empty, print its representation, before that print empty cells, if any
-                if (empty_cells > 0) {
-                    outbuf += sprintf(outbuf, "%d", empty_cells);
-                    empty_cells = 0;
-                }
-                outbuf += sprintf(outbuf, "%c", (cell_player == TWIXT_PP_PLAYER_WHITE ? 'O' : 'X'));
-                // if the current node does not have all right/bottom dir connections available actually placed, add the connection pattern
-                uint8_t dir_available = 0;
-                TWIXT_PP_PLAYER avail_player;
-                get_node_gf(self, x + 2, y - 1, &avail_player);
-                dir_available |= (cell_player == avail_player ? TWIXT_PP_DIR_RT : 0);
-                get_node_gf(self, x + 2, y + 1, &avail_player);
-                dir_available |= (cell_player == avail_player ? TWIXT_PP_DIR_RB : 0);
-                get_node_gf(self, x + 1, y + 2, &avail_player);
-                dir_available |= (cell_player == avail_player ? TWIXT_PP_DIR_BR : 0);
-                get_node_gf(self, x - 1, y + 2, &avail_player);
-                dir_available |= (cell_player == avail_player ? TWIXT_PP_DIR_BL : 0);
-                uint8_t realized_conns;
-                get_node_connections_gf(self, x, y, &realized_conns);
-                if (dir_available & ~realized_conns) {
-                    // there exist available connections that are not realized, emit connection pattern
-                    outbuf += sprintf(outbuf, "%c%c%c%c", (realized_conns & TWIXT_PP_DIR_RT) ? ':' : '.', (realized_conns & TWIXT_PP_DIR_RB) ? ':' : '.', (realized_conns & TWIXT_PP_DIR_BR) ? ':' : '.', (realized_conns & TWIXT_PP_DIR_BL) ? ':' : '.');
-                }
-            }
-        }
-        if (empty_cells > 0) {
-            outbuf += sprintf(outbuf, "%d", empty_cells);
+    char* outbuf = bufs.state_delta;
+    bool available = data.changes.changes_since(since_sync_ctr, self->sync_ctr, [&](uint16_t cell) {
+        if (outbuf != bufs.state_delta) {
+            outbuf += sprintf(outbuf, ",");
         }
-        if (y < opts.wy - 1) {
-            outbuf += sprintf(outbuf, "/");
-        }
-    }
-    // current player
-    uint8_t ptm_count;
-    const player_id* ptm_buf;
-    players_to_move_gf(self, &ptm_count, &ptm_buf);
-    player_id ptm;
-    if (ptm_count == 0) {
-        ptm = TWIXT_PP_PLAYER_NONE;
-    } else {
-        ptm = ptm_buf[0];
-    }
-    switch (ptm) {
-        case TWIXT_PP_PLAYER_NONE: {
-            outbuf += sprintf(outbuf, " -");
-        } break;
-        case TWIXT_PP_PLAYER_WHITE: {
-            outbuf += sprintf(outbuf, " O");
-        } break;
-        case TWIXT_PP_PLAYER_BLACK: {
-            outbuf += sprintf(outbuf, " X");
-        } break;
+        size_t cell_size;
+        get_move_str_into_gf(self, PLAYER_NONE, (move_data_sync){.md = game_e_create_move_small(cell), .sync_ctr = self->sync_ctr}, MOVE_STR_SIZE, &cell_size, outbuf);
+        outbuf += cell_size;
+        twixt_pp_node node = data.gameboard.get((cell >> 8) & 0xFF, cell & 0xFF);
+        outbuf += sprintf(outbuf, "%c%x", (node.player == TWIXT_PP_PLAYER_WHITE ? 'O' : (node.player == TWIXT_PP_PLAYER_BLACK ? 'X' : '.')), node.connections);
+    });
+    if (available == false) {
+        *ret_size = 0;
+        *ret_str = NULL;
+        return ERR_OK;
     }
-    // result player
-    uint8_t res_count;
-    const player_id* res_buf;
-    get_results_gf(self, &res_count, &res_buf);
-    player_id res;
-    if (res_count == 0) {
-        res = TWIXT_PP_PLAYER_NONE;
-    } else {
-        res = res_buf[0];
+    outbuf += state_flags(self, outbuf);
+    *ret_size = outbuf - bufs.state_delta;
+    *ret_str = bufs.state_delta;
+    return ERR_OK;
+}
+
+static error_code export_state_into_gf(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < state_str_size(self)) {
+        *ret_size = state_str_size(self);
+        return ERR_OUT_OF_MEMORY;
     }
-    switch (res) {
-        case TWIXT_PP_PLAYER_NONE: {
-            outbuf += sprintf(outbuf, " -");
-        } break;
-        case TWIXT_PP_PLAYER_WHITE: {
-            outbuf += sprintf(outbuf, " O");
-        } break;
-        case TWIXT_PP_PLAYER_BLACK: {
-            outbuf += sprintf(outbuf, " X");
-        } break;
+    char* outbuf = str;
+    opts_repr& opts = get_opts(self);
+    for (int y = 0; y < opts.wy; y++) {
+        outbuf += state_row(self, y, outbuf);
     }
-    *ret_size = outbuf - ostr;
-    *ret_str = bufs.state;
+    outbuf += state_flags(self, outbuf);
+    *ret_size = outbuf - str;
     return ERR_OK;
 }
 
@@ -356,18 +396,21 @@ static error_code import_state_gf(game* self, const char* str)
     data.remaining_inner_nodes = opts.wx * opts.wy;
     data.graph_map.clear();
     data.next_graph_id = 1;
-    data.gameboard.clear();
-    data.gameboard.reserve(opts.wy);
-    for (int iy = 0; iy < opts.wy; iy++) {
-        std::vector<twixt_pp_node> tile_row_vector{};
-        tile_row_vector.resize(opts.wx, twixt_pp_node{TWIXT_PP_PLAYER_NONE, 0, 0, 0});
-        data.gameboard.push_back(std::move(tile_row_vector));
-    }
-    data.gameboard[0][0].player = TWIXT_PP_PLAYER_INVALID;
-    data.gameboard[0][opts.wx - 1].player = TWIXT_PP_PLAYER_INVALID;
-    data.gameboard[opts.wy - 1][0].player = TWIXT_PP_PLAYER_INVALID;
-    data.gameboard[opts.wy - 1][opts.wx - 1].player = TWIXT_PP_PLAYER_INVALID;
+    if (data.gameboard.reset(opts.wx, opts.wy, twixt_pp_node{TWIXT_PP_PLAYER_NONE, 0, 0, 0}) == false) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    get_bufs(self).state_rows.invalidate_all();
+    get_bufs(self).print_rows.invalidate_all();
+    // the board was just reset, so it is unshared and writes can not fail
+    data.gameboard.mut(0, 0)->player = TWIXT_PP_PLAYER_INVALID;
+    data.gameboard.mut(opts.wx - 1, 0)->player = TWIXT_PP_PLAYER_INVALID;
+    data.gameboard.mut(0, opts.wy - 1)->player = TWIXT_PP_PLAYER_INVALID;
+    data.gameboard.mut(opts.wx - 1, opts.wy - 1)->player = TWIXT_PP_PLAYER_INVALID;
     data.pie_swap = opts.pie_swap;
+    data.undo_stack.clear();
+    data.changes.clear();
+    data.node_journal.clear();
+    data.graph_journal.clear();
     if (str == NULL) {
         return ERR_OK;
     }
@@ -567,24 +610,70 @@ static error_code import_state_gf(game* self, const char* str)
 
 static error_code players_to_move_gf(game* self, uint8_t* ret_count, const player_id** ret_players)
 {
-    *ret_count = 1;
+    export_buffers& bufs = get_bufs(self);
+    players_to_move_into_gf(self, 1, ret_count, bufs.players_to_move);
+    *ret_players = bufs.players_to_move;
+    return ERR_OK;
+}
+
+static error_code players_to_move_into_gf(game* self, uint8_t cap, uint8_t* ret_count, player_id* players)
+{
+    if (cap < 1) {
+        *ret_count = 1;
+        return ERR_OUT_OF_MEMORY;
+    }
     state_repr& data = get_repr(self);
     player_id ptm = data.current_player;
     if (ptm == TWIXT_PP_PLAYER_NONE) {
         *ret_count = 0;
         return ERR_OK;
     }
-    export_buffers& bufs = get_bufs(self);
-    player_id* outbuf = bufs.players_to_move;
-    *outbuf = ptm;
-    *ret_players = outbuf;
+    *ret_count = 1;
+    *players = ptm;
     return ERR_OK;
 }
 
 static error_code get_concrete_moves_gf(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves)
 {
     export_buffers& bufs = get_bufs(self);
-    move_data* outbuf = bufs.concrete_moves;
+    get_concrete_moves_into_gf(self, player, max_move_count(self), ret_count, bufs.concrete_moves);
+    *ret_moves = bufs.concrete_moves;
+    return ERR_OK;
+}
+
+static error_code get_concrete_moves_into_gf(game* self, player_id player, uint32_t cap, uint32_t* ret_count, move_data* moves)
+{
+    if (cap < max_move_count(self)) {
+        *ret_count = max_move_count(self);
+        return ERR_OUT_OF_MEMORY;
+    }
+    opts_repr& opts = get_opts(self);
+    state_repr& data = get_repr(self);
+    uint32_t move_cnt = 0;
+    for (int iy = 0; iy < opts.wy; iy++) {
+        if ((iy == 0 || iy == opts.wy - 1) && player == TWIXT_PP_PLAYER_BLACK) {
+            continue;
+        }
+        for (int ix = 0; ix < opts.wx; ix++) {
+            if ((ix == 0 || ix == opts.wx - 1) && player == TWIXT_PP_PLAYER_WHITE) {
+                continue;
+            }
+            if (data.gameboard.get(ix, iy).player == TWIXT_PP_PLAYER_NONE) {
+                moves[move_cnt++] = game_e_create_move_small((ix << 8) | iy);
+            }
+        }
+    }
+    if (data.pie_swap == true && data.current_player == TWIXT_PP_PLAYER_BLACK) {
+        moves[move_cnt++] = game_e_create_move_small(TWIXT_PP_MOVE_SWAP);
+    }
+    *ret_count = move_cnt;
+    return ERR_OK;
+}
+
+static error_code get_concrete_moves_codes_gf(game* self, player_id player, uint32_t* ret_count, const move_code** ret_moves)
+{
+    export_buffers& bufs = get_bufs(self);
+    move_code* outbuf = bufs.concrete_move_codes;
     opts_repr& opts = get_opts(self);
     state_repr& data = get_repr(self);
     uint32_t move_cnt = 0;
@@ -596,17 +685,59 @@ static error_code get_concrete_moves_gf(game* self, player_id player, uint32_t*
             if ((ix == 0 || ix == opts.wx - 1) && player == TWIXT_PP_PLAYER_WHITE) {
                 continue;
             }
-            if (data.gameboard[iy][ix].player == TWIXT_PP_PLAYER_NONE) {
+            if (data.gameboard.get(ix, iy).player == TWIXT_PP_PLAYER_NONE) {
                 // add the free tile to the return vector
-                outbuf[move_cnt++] = game_e_create_move_small((ix << 8) | iy);
+                outbuf[move_cnt++] = (ix << 8) | iy;
             }
         }
     }
     if (data.pie_swap == true && data.current_player == TWIXT_PP_PLAYER_BLACK) {
-        outbuf[move_cnt++] = game_e_create_move_small(TWIXT_PP_MOVE_SWAP);
+        outbuf[move_cnt++] = TWIXT_PP_MOVE_SWAP;
     }
     *ret_count = move_cnt;
-    *ret_moves = bufs.concrete_moves;
+    *ret_moves = bufs.concrete_move_codes;
+    return ERR_OK;
+}
+
+static error_code get_moves_begin_gf(game* self, player_id player, move_iterator* it)
+{
+    // stage 0 walks the nodes with idx as (y * wx + x), stage 1 offers the swap
+    it->player = player;
+    it->stage = 0;
+    it->idx = 0;
+    return ERR_OK;
+}
+
+static error_code get_moves_next_gf(game* self, move_iterator* it, bool* ret_done, move_data* ret_move)
+{
+    opts_repr& opts = get_opts(self);
+    state_repr& data = get_repr(self);
+    if (it->stage == 0) {
+        uint32_t node_count = opts.wx * opts.wy;
+        while (it->idx < node_count) {
+            int ix = it->idx % opts.wx;
+            int iy = it->idx / opts.wx;
+            it->idx++;
+            if ((iy == 0 || iy == opts.wy - 1) && it->player == TWIXT_PP_PLAYER_BLACK) {
+                continue;
+            }
+            if ((ix == 0 || ix == opts.wx - 1) && it->player == TWIXT_PP_PLAYER_WHITE) {
+                continue;
+            }
+            if (data.gameboard.get(ix, iy).player == TWIXT_PP_PLAYER_NONE) {
+                *ret_done = false;
+                *ret_move = game_e_create_move_small((ix << 8) | iy);
+                return ERR_OK;
+            }
+        }
+        it->stage = 1;
+        if (data.pie_swap == true && data.current_player == TWIXT_PP_PLAYER_BLACK) {
+            *ret_done = false;
+            *ret_move = game_e_create_move_small(TWIXT_PP_MOVE_SWAP);
+            return ERR_OK;
+        }
+    }
+    *ret_done = true;
     return ERR_OK;
 }
 
@@ -631,10 +762,13 @@ static error_code is_legal_move_gf(game* self, player_id player, move_data_sync
     }
     int ix = (mcode >> 8) & 0xFF;
     int iy = mcode & 0xFF;
-    if (data.gameboard[iy][ix].player != TWIXT_PP_PLAYER_NONE) {
+    opts_repr& opts = get_opts(self);
+    if (mcode > 0xFFFF || ix >= opts.wx || iy >= opts.wy) {
+        return ERR_INVALID_INPUT;
+    }
+    if (data.gameboard.get(ix, iy).player != TWIXT_PP_PLAYER_NONE) {
         return ERR_INVALID_INPUT;
     }
-    opts_repr& opts = get_opts(self);
     if (((ix == 0 || ix == opts.wx - 1) && player == TWIXT_PP_PLAYER_WHITE) || ((iy == 0 || iy == opts.wy - 1) && player == TWIXT_PP_PLAYER_BLACK)) {
         return ERR_INVALID_INPUT;
     }
@@ -647,20 +781,57 @@ static error_code make_move_gf(game* self, player_id player, move_data_sync move
     state_repr& data = get_repr(self);
     move_code mcode = move.md.cl.code;
 
+    // unshare every row the move can write to before changing anything, so running out of memory leaves the state as is
+    if (mcode == TWIXT_PP_MOVE_SWAP) {
+        int sx = (data.swap_target >> 8) & 0xFF;
+        int sy = data.swap_target & 0xFF;
+        if (data.gameboard.unshare_rows(sy, sy) == false || data.gameboard.unshare_rows(sx, sx) == false) {
+            return ERR_OUT_OF_MEMORY;
+        }
+    } else if (data.gameboard.unshare_rows((mcode & 0xFF) - 2, (mcode & 0xFF) + 2) == false) {
+        return ERR_OUT_OF_MEMORY;
+    }
+
+    if (self->unmake_history == true) {
+        data.undo_stack.push_back(undo_entry{
+            .current_player = data.current_player,
+            .winning_player = data.winning_player,
+            .remaining_inner_nodes = data.remaining_inner_nodes,
+            .next_graph_id = data.next_graph_id,
+            .pie_swap = data.pie_swap,
+            .swap_target = data.swap_target,
+            .node_journal_idx = data.node_journal.size(),
+            .graph_journal_idx = data.graph_journal.size(),
+        });
+    } else {
+        // the recorded moves can not be unmade past this one, and with no entries nothing is journaled
+        data.undo_stack.clear();
+        data.node_journal.clear();
+        data.graph_journal.clear();
+    }
+    data.changes.begin_move(self->sync_ctr);
+
     if (mcode == TWIXT_PP_MOVE_SWAP) {
         // use swap target to give whites move to black
         int sx = (data.swap_target >> 8) & 0xFF;
         int sy = data.swap_target & 0xFF;
 
         //BUG on non-square board this swap can access out of bounds elements
-        data.gameboard[sy][sx].player = TWIXT_PP_PLAYER_BLACK;
+        journal_node(data, sx, sy);
+        journal_node(data, sy, sx);
+        data.changes.touch((sx << 8) | sy);
+        data.changes.touch((sy << 8) | sx);
+        data.gameboard.mut(sx, sy)->player = TWIXT_PP_PLAYER_BLACK;
         if (sx != sy) {
-            data.gameboard[sx][sy] = data.gameboard[sy][sx];
-            data.gameboard[sy][sx] = (twixt_pp_node){TWIXT_PP_PLAYER_NONE, 0, 0, 0};
+            data.gameboard.set(sy, sx, data.gameboard.get(sx, sy));
+            data.gameboard.set(sx, sy, (twixt_pp_node){TWIXT_PP_PLAYER_NONE, 0, 0, 0});
         }
+        invalidate_rows(self, sy, sy);
+        invalidate_rows(self, sx, sx);
 
         data.pie_swap = false;
         data.current_player = TWIXT_PP_PLAYER_WHITE;
+        data.changes.end_move();
         return ERR_OK;
     }
 
@@ -679,6 +850,7 @@ static error_code make_move_gf(game* self, player_id player, move_data_sync move
     bool wins;
     // set node updates graph structures in the backend, and informs us if this move is winning for the current player
     set_node_gf(self, tx, ty, data.current_player, 0xFF, &wins);
+    data.changes.end_move();
 
     if (tx > 0 && tx < opts.wx - 1 && ty > 0 && ty < opts.wy) {
         data.remaining_inner_nodes--;
@@ -698,6 +870,46 @@ static error_code make_move_gf(game* self, player_id player, move_data_sync move
     return ERR_OK;
 }
 
+static error_code unmake_move_gf(game* self, player_id player, move_data_sync move)
+{
+    state_repr& data = get_repr(self);
+    if (data.undo_stack.empty()) {
+        // no made move known, e.g. after an import
+        return ERR_INVALID_INPUT;
+    }
+    undo_entry& ue = data.undo_stack.back();
+    // the state goes back to a sync_ctr that clients may have seen with a different state, so no delta can start from there
+    data.changes.clear();
+    for (size_t i = ue.node_journal_idx; i < data.node_journal.size(); i++) {
+        if (data.gameboard.unshare_rows(data.node_journal[i].y, data.node_journal[i].y) == false) {
+            return ERR_OUT_OF_MEMORY;
+        }
+    }
+    // replay the journals backwards, so nodes and graphs written multiple times end up with their oldest value
+    while (data.node_journal.size() > ue.node_journal_idx) {
+        undo_node& un = data.node_journal.back();
+        data.gameboard.set(un.x, un.y, un.node);
+        invalidate_rows(self, un.y, un.y);
+        data.node_journal.pop_back();
+    }
+    while (data.graph_journal.size() > ue.graph_journal_idx) {
+        twixt_pp_graph& ug = data.graph_journal.back();
+        data.graph_map[ug.graph_id] = ug;
+        data.graph_journal.pop_back();
+    }
+    if (data.next_graph_id != ue.next_graph_id) {
+        data.graph_map.erase(ue.next_graph_id);
+    }
+    data.current_player = ue.current_player;
+    data.winning_player = ue.winning_player;
+    data.remaining_inner_nodes = ue.remaining_inner_nodes;
+    data.next_graph_id = ue.next_graph_id;
+    data.pie_swap = ue.pie_swap;
+    data.swap_target = ue.swap_target;
+    data.undo_stack.pop_back();
+    return ERR_OK;
+}
+
 static error_code get_results_gf(game* self, uint8_t* ret_count, const player_id** ret_players)
 {
     export_buffers& bufs = get_bufs(self);
@@ -713,9 +925,9 @@ static error_code get_results_gf(game* self, uint8_t* ret_count, const player_id
     return ERR_OK;
 }
 
-static error_code playout_gf(game* self, uint64_t seed)
+static error_code playout_gf(game* self, seed128 seed)
 {
-    uint32_t ctr = 0;
+    game_rng rng = game_e_rng_create(seed, 0);
     uint32_t moves_count;
     const move_data* moves;
     uint8_t ptm_count;
@@ -723,7 +935,7 @@ static error_code playout_gf(game* self, uint64_t seed)
     players_to_move_gf(self, &ptm_count, &ptm);
     while (ptm_count > 0) {
         get_concrete_moves_gf(self, ptm[0], &moves_count, &moves);
-        make_move_gf(self, ptm[0], game_e_move_make_sync(self, moves[squirrelnoise5(ctr++, seed) % moves_count])); //BUG this has modulo bias, use proper rand_intn
+        make_move_gf(self, ptm[0], game_e_move_make_sync(self, moves[game_e_rng_intn(&rng, moves_count)]));
         players_to_move_gf(self, &ptm_count, &ptm);
     }
     return ERR_OK;
@@ -777,7 +989,18 @@ static error_code get_move_data_gf(game* self, player_id player, const char* str
 static error_code get_move_str_gf(game* self, player_id player, move_data_sync move, size_t* ret_size, const char** ret_str)
 {
     export_buffers& bufs = get_bufs(self);
-    char* outbuf = bufs.move_str;
+    error_code ec = get_move_str_into_gf(self, player, move, MOVE_STR_SIZE, ret_size, bufs.move_str);
+    *ret_str = bufs.move_str;
+    return ec;
+}
+
+static error_code get_move_str_into_gf(game* self, player_id player, move_data_sync move, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < MOVE_STR_SIZE) {
+        *ret_size = MOVE_STR_SIZE;
+        return ERR_OUT_OF_MEMORY;
+    }
+    char* outbuf = str;
     move_code mcode = move.md.cl.code;
     if (mcode == MOVE_NONE) {
         *ret_size = sprintf(outbuf, "-");
@@ -802,15 +1025,29 @@ static error_code get_move_str_gf(game* self, player_id player, move_data_sync m
     } else {
         *ret_size = sprintf(outbuf, "%c%c%hhu", msc, 'a' + x, y);
     }
-    *ret_str = bufs.move_str;
     return ERR_OK;
 }
 
 //TODO somehow needs to display disambiguation information for position where realized connections of nodes are not clear
 static error_code print_gf(game* self, player_id player, size_t* ret_size, const char** ret_str)
 {
+    // only the rows changed since the last print are rendered again
     export_buffers& bufs = get_bufs(self);
-    char* outbuf = bufs.print;
+    opts_repr& opts = get_opts(self);
+    *ret_size = bufs.print_rows.update(bufs.print, opts.wy, opts.wx + 1, [self](uint32_t y, char* str) {
+        return print_row(self, y, str);
+    });
+    *ret_str = bufs.print;
+    return ERR_OK;
+}
+
+static error_code print_into_gf(game* self, size_t cap, size_t* ret_size, char* str)
+{
+    if (cap < print_str_size(self)) {
+        *ret_size = print_str_size(self);
+        return ERR_OUT_OF_MEMORY;
+    }
+    char* outbuf = str;
     opts_repr& opts = get_opts(self);
     state_repr& data = get_repr(self);
     const char* ostr = outbuf;
@@ -818,8 +1055,8 @@ static error_code print_gf(game* self, player_id player, size_t* ret_size, const
     // print all node infos and all graphs for debugging purposes
     // for (int iy = 0; iy < opts.wy; iy++) {
     //     for (int ix = 0; ix < opts.wy; ix++) {
-    //         if (data.gameboard[iy][ix].player != TWIXT_PP_PLAYER_INVALID && data.gameboard[iy][ix].player != TWIXT_PP_PLAYER_NONE) {
-    //             printf("%d-%d: (%c) %hu, CON:%hhu COL:%hhu\n", ix, iy, data.gameboard[iy][ix].player == TWIXT_PP_PLAYER_WHITE ? 'O' : 'X' ,data.gameboard[iy][ix].graph_id, data.gameboard[iy][ix].connections, data.gameboard[iy][ix].collisions);
+    //         if (data.gameboard.get(ix, iy).player != TWIXT_PP_PLAYER_INVALID && data.gameboard.get(ix, iy).player != TWIXT_PP_PLAYER_NONE) {
+    //             printf("%d-%d: (%c) %hu, CON:%hhu COL:%hhu\n", ix, iy, data.gameboard.get(ix, iy).player == TWIXT_PP_PLAYER_WHITE ? 'O' : 'X' ,data.gameboard.get(ix, iy).graph_id, data.gameboard.get(ix, iy).connections, data.gameboard.get(ix, iy).collisions);
     //         }
     //     }
     // }
@@ -828,28 +1065,175 @@ static error_code print_gf(game* self, player_id player, size_t* ret_size, const
     // }
 
     for (int iy = 0; iy < opts.wy; iy++) {
-        for (int ix = 0; ix < opts.wy; ix++) {
-            TWIXT_PP_PLAYER node_player = TWIXT_PP_PLAYER_INVALID;
-            get_node_gf(self, ix, iy, &node_player);
-            switch (node_player) {
-                case TWIXT_PP_PLAYER_INVALID: {
-                    outbuf += sprintf(outbuf, " ");
-                } break;
-                case TWIXT_PP_PLAYER_WHITE: {
-                    outbuf += sprintf(outbuf, "O");
-                } break;
-                case TWIXT_PP_PLAYER_BLACK: {
-                    outbuf += sprintf(outbuf, "X");
-                } break;
-                case TWIXT_PP_PLAYER_NONE: {
-                    outbuf += sprintf(outbuf, ".");
-                } break;
+        outbuf += print_row(self, iy, outbuf);
+    }
+    *ret_size = outbuf - ostr;
+    return ERR_OK;
+}
+
+// impl hidden: bound on the number of moves, every node except the corners plus the swap
+static uint32_t max_move_count(game* self)
+{
+    opts_repr& opts = get_opts(self);
+    return opts.wx * opts.wy - 3;
+}
+
+// impl hidden: size of the state string incl. the zero terminator, i.e. every node with its connection pattern, row separators, players and result
+static size_t state_str_size(game* self)
+{
+    opts_repr& opts = get_opts(self);
+    return opts.wy * opts.wx * 5 + 1 + 4;
+}
+
+// impl hidden: size of the state delta buffer, every journaled node as e.g. "ab12X3," plus the player flags
+static size_t state_delta_str_size(game* self)
+{
+    return JOURNAL_CELLS * 8 + 5;
+}
+
+// impl hidden: size of the print string incl. the zero terminator, one char per node and a newline per row
+static size_t print_str_size(game* self)
+{
+    opts_repr& opts = get_opts(self);
+    return opts.wx * opts.wy + opts.wy + 1;
+}
+
+// impl hidden: writes row y of the state string to str, incl. its "/" separator if it is not the last, returns its length
+// the connection patterns of a row depend on the nodes up to two rows below and one row above it
+static size_t state_row(game* self, int y, char* str)
+{
+    char* outbuf = str;
+    opts_repr& opts = get_opts(self);
+    TWIXT_PP_PLAYER cell_player;
+    int empty_cells = 0;
+    for (int x = 0; x < opts.wx; x++) {
+        get_node_gf(self, x, y, &cell_player);
+        if (cell_player == TWIXT_PP_PLAYER_INVALID) {
+            continue;
+        }
+        if (cell_player == TWIXT_PP_PLAYER_NONE) {
+            empty_cells++;
+        } else {
+            // if the current cell isnt empty, print its representation, before that print empty cells, if any
+            if (empty_cells > 0) {
+                outbuf += sprintf(outbuf, "%d", empty_cells);
+                empty_cells = 0;
+            }
+            outbuf += sprintf(outbuf, "%c", (cell_player == TWIXT_PP_PLAYER_WHITE ? 'O' : 'X'));
+            // if the current node does not have all right/bottom dir connections available actually placed, add the connection pattern
+            uint8_t dir_available = 0;
+            TWIXT_PP_PLAYER avail_player;
+            get_node_gf(self, x + 2, y - 1, &avail_player);
+            dir_available |= (cell_player == avail_player ? TWIXT_PP_DIR_RT : 0);
+            get_node_gf(self, x + 2, y + 1, &avail_player);
+            dir_available |= (cell_player == avail_player ? TWIXT_PP_DIR_RB : 0);
+            get_node_gf(self, x + 1, y + 2, &avail_player);
+            dir_available |= (cell_player == avail_player ? TWIXT_PP_DIR_BR : 0);
+            get_node_gf(self, x - 1, y + 2, &avail_player);
+            dir_available |= (cell_player == avail_player ? TWIXT_PP_DIR_BL : 0);
+            uint8_t realized_conns;
+            get_node_connections_gf(self, x, y, &realized_conns);
+            if (dir_available & ~realized_conns) {
+                // there exist available connections that are not realized, emit connection pattern
+                outbuf += sprintf(outbuf, "%c%c%c%c", (realized_conns & TWIXT_PP_DIR_RT) ? ':' : '.', (realized_conns & TWIXT_PP_DIR_RB) ? ':' : '.', (realized_conns & TWIXT_PP_DIR_BR) ? ':' : '.', (realized_conns & TWIXT_PP_DIR_BL) ? ':' : '.');
             }
         }
-        outbuf += sprintf(outbuf, "\n");
     }
-    *ret_size = outbuf - ostr;
-    *ret_str = bufs.print;
+    if (empty_cells > 0) {
+        outbuf += sprintf(outbuf, "%d", empty_cells);
+    }
+    if (y < opts.wy - 1) {
+        outbuf += sprintf(outbuf, "/");
+    }
+    return outbuf - str;
+}
+
+// impl hidden: writes the current player and result player that end the state string to str, returns their length
+static size_t state_flags(game* self, char* str)
+{
+    char* outbuf = str;
+    state_repr& data = get_repr(self);
+    // both read straight from the state so this stays read only
+    player_id flags[2] = {data.current_player, (data.current_player == TWIXT_PP_PLAYER_NONE ? data.winning_player : TWIXT_PP_PLAYER_NONE)};
+    for (int i = 0; i < 2; i++) {
+        switch (flags[i]) {
+            case TWIXT_PP_PLAYER_NONE: {
+                outbuf += sprintf(outbuf, " -");
+            } break;
+            case TWIXT_PP_PLAYER_WHITE: {
+                outbuf += sprintf(outbuf, " O");
+            } break;
+            case TWIXT_PP_PLAYER_BLACK: {
+                outbuf += sprintf(outbuf, " X");
+            } break;
+        }
+    }
+    return outbuf - str;
+}
+
+// impl hidden: writes row y of the print string to str, returns its length
+static size_t print_row(game* self, int y, char* str)
+{
+    char* outbuf = str;
+    opts_repr& opts = get_opts(self);
+    for (int ix = 0; ix < opts.wx; ix++) {
+        TWIXT_PP_PLAYER node_player = TWIXT_PP_PLAYER_INVALID;
+        get_node_gf(self, ix, y, &node_player);
+        switch (node_player) {
+            case TWIXT_PP_PLAYER_INVALID: {
+                outbuf += sprintf(outbuf, " ");
+            } break;
+            case TWIXT_PP_PLAYER_WHITE: {
+                outbuf += sprintf(outbuf, "O");
+            } break;
+            case TWIXT_PP_PLAYER_BLACK: {
+                outbuf += sprintf(outbuf, "X");
+            } break;
+            case TWIXT_PP_PLAYER_NONE: {
+                outbuf += sprintf(outbuf, ".");
+            } break;
+        }
+    }
+    outbuf += sprintf(outbuf, "\n");
+    return outbuf - str;
+}
+
+// impl hidden: every change to the players or connections of nodes in the board rows y_first to y_last has to call this, so export_state and print render them again
+static void invalidate_rows(game* self, int y_first, int y_last)
+{
+    export_buffers& bufs = get_bufs(self);
+    // state rows show the connection patterns of their nodes, which check the players of nodes up to two rows below and one above
+    bufs.state_rows.invalidate_rows(y_first - 2, y_last + 1);
+    bufs.print_rows.invalidate_rows(y_first, y_last);
+}
+
+// impl hidden: allocates all export buffers for the options of the game data, destroys the game if that fails
+static error_code create_bufs(game* self)
+{
+    export_buffers& bufs = get_bufs(self);
+    bufs.options = (char*)malloc(OPTIONS_STR_SIZE * sizeof(char));
+    bufs.state = (char*)malloc(state_str_size(self) * sizeof(char));
+    bufs.players_to_move = (player_id*)malloc(1 * sizeof(player_id));
+    bufs.concrete_moves = (move_data*)malloc(max_move_count(self) * sizeof(move_data));
+    bufs.concrete_move_codes = (move_code*)malloc(max_move_count(self) * sizeof(move_code));
+    bufs.results = (player_id*)malloc(1 * sizeof(player_id));
+    bufs.move_str = (char*)malloc(MOVE_STR_SIZE * sizeof(char));
+    bufs.print = (char*)malloc(print_str_size(self) * sizeof(char));
+    bufs.state_delta = (char*)malloc(state_delta_str_size(self) * sizeof(char));
+    if (bufs.state == NULL ||
+        bufs.players_to_move == NULL ||
+        bufs.concrete_moves == NULL ||
+        bufs.concrete_move_codes == NULL ||
+        bufs.results == NULL ||
+        bufs.move_str == NULL ||
+        bufs.print == NULL ||
+        bufs.state_delta == NULL) {
+        destroy_gf(self);
+        return ERR_OUT_OF_MEMORY;
+    }
+    // the buffers are new, so nothing in them can be reused, this also drops the rows a clone copied from its source
+    bufs.state_rows.invalidate_all();
+    bufs.print_rows.invalidate_all();
     return ERR_OK;
 }
 
@@ -863,7 +1247,7 @@ static error_code get_node_gf(game* self, uint8_t x, uint8_t y, TWIXT_PP_PLAYER*
     if (x < 0 || y < 0 || x >= opts.wx || y >= opts.wy) {
         *p = TWIXT_PP_PLAYER_INVALID;
     } else {
-        *p = data.gameboard[y][x].player;
+        *p = data.gameboard.get(x, y).player;
     }
     return ERR_OK;
 }
@@ -872,7 +1256,14 @@ static error_code set_node_gf(game* self, uint8_t x, uint8_t y, TWIXT_PP_PLAYER
 {
     opts_repr& opts = get_opts(self);
     state_repr& data = get_repr(self);
-    data.gameboard[y][x].player = p;
+    // connections and their collisions reach at most two rows away, unsharing them first means the writes below can not fail
+    if (data.gameboard.unshare_rows(y - 2, y + 2) == false) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    journal_node(data, x, y);
+    data.changes.touch((x << 8) | y); // outside of make_move this clears the journal
+    data.gameboard.mut(x, y)->player = p;
+    invalidate_rows(self, y, y);
     if (p == TWIXT_PP_PLAYER_NONE) {
         if (wins) {
             *wins = false;
@@ -914,9 +1305,9 @@ static error_code set_node_gf(game* self, uint8_t x, uint8_t y, TWIXT_PP_PLAYER
         set_connection_gf(self, x + 1, y - 2, x, y, &rwins);
         win |= rwins;
     }
-    if (data.gameboard[y][x].graph_id == 0) {
+    if (data.gameboard.get(x, y).graph_id == 0) {
         // no connection created, so this node was not joined into another graph, create a new graph for it, and give it the nodes connect qualities
-        data.gameboard[y][x].graph_id = data.next_graph_id;
+        data.gameboard.mut(x, y)->graph_id = data.next_graph_id;
         data.graph_map[data.next_graph_id] = (twixt_pp_graph){
             .graph_id = data.next_graph_id,
             .connect_low = (x == 0 || y == 0),
@@ -930,6 +1321,12 @@ static error_code set_node_gf(game* self, uint8_t x, uint8_t y, TWIXT_PP_PLAYER
     return ERR_OK;
 }
 
+static error_code ext_set_node_gf(game* self, uint8_t x, uint8_t y, TWIXT_PP_PLAYER p, uint8_t connection_mask, bool* wins)
+{
+    game_e_cache_invalidate(self);
+    return set_node_gf(self, x, y, p, connection_mask, wins);
+}
+
 static error_code get_node_connections_gf(game* self, uint8_t x, uint8_t y, uint8_t* connections)
 {
     opts_repr& opts = get_opts(self);
@@ -937,7 +1334,7 @@ static error_code get_node_connections_gf(game* self, uint8_t x, uint8_t y, uint
     if (x < 0 || y < 0 || x >= opts.wx || y >= opts.wy) {
         *connections = 0;
     } else {
-        *connections = data.gameboard[y][x].connections;
+        *connections = data.gameboard.get(x, y).connections;
     }
     return ERR_OK;
 }
@@ -949,7 +1346,7 @@ static error_code get_node_collisions_gf(game* self, uint8_t x, uint8_t y, uint8
     if (x < 0 || y < 0 || x >= opts.wx || y >= opts.wy) {
         *collisions = 0;
     } else {
-        *collisions = data.gameboard[y][x].collisions;
+        *collisions = data.gameboard.get(x, y).collisions;
     }
     return ERR_OK;
 }
@@ -962,7 +1359,8 @@ void add_collision(game* self, uint8_t x, uint8_t y, uint8_t dir, TWIXT_PP_PLAYE
     if (x < 0 || y < 0 || x >= opts.wx || y >= opts.wy) {
         return;
     }
-    data.gameboard[y][x].collisions |= (dir << (np == TWIXT_PP_PLAYER_WHITE ? 4 : 0));
+    journal_node(data, x, y);
+    data.gameboard.mut(x, y)->collisions |= (dir << (np == TWIXT_PP_PLAYER_WHITE ? 4 : 0));
 }
 
 static error_code set_connection_gf(game* self, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, bool* wins)
@@ -994,11 +1392,20 @@ static error_code set_connection_gf(game* self, uint8_t x1, uint8_t y1, uint8_t
         conn_dir = TWIXT_PP_DIR_BR;
     }
 
+    // collisions are at most two rows away from the first node, the second node is in between
+    if (data.gameboard.unshare_rows(y1 - 2, y1 + 2) == false) {
+        return ERR_OUT_OF_MEMORY;
+    }
+
     // place only if collision bit is not set
-    if ((data.gameboard[y1][x1].collisions & (conn_dir << (np1 == TWIXT_PP_PLAYER_WHITE ? 4 : 0))) != 0) {
+    if ((data.gameboard.get(x1, y1).collisions & (conn_dir << (np1 == TWIXT_PP_PLAYER_WHITE ? 4 : 0))) != 0) {
         return ERR_OK;
     }
-    data.gameboard[y1][x1].connections |= conn_dir;
+    journal_node(data, x1, y1);
+    journal_node(data, x2, y2);
+    data.changes.touch((x1 << 8) | y1); // only the first node stores the connection
+    data.gameboard.mut(x1, y1)->connections |= conn_dir;
+    invalidate_rows(self, y1, y1);
 
     // invalidate the opponents collision bits for all of the 9 crossing connections
     TWIXT_PP_PLAYER op = (np1 == TWIXT_PP_PLAYER_WHITE ? TWIXT_PP_PLAYER_BLACK : TWIXT_PP_PLAYER_WHITE);
@@ -1054,8 +1461,8 @@ static error_code set_connection_gf(game* self, uint8_t x1, uint8_t y1, uint8_t
     }
 
     // get graph id of both nodes, at least one will exist
-    uint16_t graph_id1 = data.gameboard[y1][x1].graph_id;
-    uint16_t graph_id2 = data.gameboard[y2][x2].graph_id;
+    uint16_t graph_id1 = data.gameboard.get(x1, y1).graph_id;
+    uint16_t graph_id2 = data.gameboard.get(x2, y2).graph_id;
 
     // get merged connect quality for both from graph, or from node if no parent graph, save in cq_*1
     // also, while in the check, resolve graph ids to their true parent graph if applicable
@@ -1082,15 +1489,21 @@ static error_code set_connection_gf(game* self, uint8_t x1, uint8_t y1, uint8_t
         cq_high |= (x2 == opts.wx - 1 || y2 == opts.wy - 1);
     }
 
+    if (graph_id1 > 0) {
+        journal_graph(data, graph_id1);
+    }
+    if (graph_id2 > 0) {
+        journal_graph(data, graph_id2);
+    }
     if (graph_id1 == 0) {
         // one node has no parent graph, merge it into the other graph AND merge any connect qualities
-        data.gameboard[y1][x1].graph_id = graph_id2;
+        data.gameboard.mut(x1, y1)->graph_id = graph_id2;
         data.graph_map[graph_id2].connect_low |= cq_low;
         data.graph_map[graph_id2].connect_high |= cq_high;
         graph_id1 = graph_id2; // swap ids for win check later
     } else if (graph_id2 == 0) {
         // same as above but for graph_id2
-        data.gameboard[y2][x2].graph_id = graph_id1;
+        data.gameboard.mut(x2, y2)->graph_id = graph_id1;
         data.graph_map[graph_id1].connect_low |= cq_low;
         data.graph_map[graph_id1].connect_high |= cq_high;
     } else {
@@ -1111,6 +1524,12 @@ static error_code set_connection_gf(game* self, uint8_t x1, uint8_t y1, uint8_t
     return ERR_OK;
 }
 
+static error_code ext_set_connection_gf(game* self, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, bool* wins)
+{
+    game_e_cache_invalidate(self);
+    return set_connection_gf(self, x1, y1, x2, y2, wins);
+}
+
 static error_code can_swap_gf(game* self, bool* swap_available)
 {
     state_repr& data = get_repr(self);
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// history of the moves made on one instance, for unmake_move
+// undo is only valid on the instance that made the moves, so copies (clones, copy_from) start out empty instead of duplicating the history
+// a copy assignment keeps the capacity of the target, so copy_from into a reused instance does not allocate either
+template <typename T>
+class undo_history : public std::vector<T> {
+
+  public:
+
+    undo_history() = default;
+
+    undo_history(const undo_history& other):
+        std::vector<T>()
+    {}
+
+    undo_history(undo_history&& other) = default;
+
+    undo_history& operator=(const undo_history& other)
+    {
+        this->clear();
+        return *this;
+    }
+
+    undo_history& operator=(undo_history&& other) = default;
+};
+
+// history of the moves made on one instance over a fixed caller owned buffer (e.g. from an arena), it never allocates
+// recording onto a full history drops its oldest entry, so only the most recent cap moves can be unmade
+// the buffer belongs to exactly one instance, so the ring itself can not be copied
+template <typename T>
+class undo_ring {
+
+  public:
+
+    undo_ring() = default;
+
+    undo_ring(const undo_ring& other) = delete;
+
+    undo_ring& operator=(const undo_ring& other) = delete;
+
+    void set_storage(T* buf, uint32_t cap)
+    {
+        this->buf = buf;
+        this->cap = cap;
+        clear();
+    }
+
+    uint32_t capacity() const
+    {
+        return cap;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    void clear()
+    {
+        start = 0;
+        count = 0;
+    }
+
+    void push_back(const T& entry)
+    {
+        if (cap == 0) {
+            return;
+        }
+        buf[(start + count) % cap] = entry;
+        if (count < cap) {
+            count++;
+        } else {
+            start = (start + 1) % cap;
+        }
+    }
+
+    T& back()
+    {
+        return buf[(start + count - 1) % cap];
+    }
+
+    void pop_back()
+    {
+        count--;
+    }
+
+  private:
+
+    T* buf = nullptr;
+    uint32_t cap = 0;
+    uint32_t start = 0;
+    uint32_t count = 0;
+};
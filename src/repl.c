@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <dlfcn.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -11,6 +12,7 @@
 
 #include "surena/games/chess.h"
 #include "surena/games/havannah.h"
+#include "surena/games/oshisumo.h"
 #include "surena/games/quasar.h"
 #include "surena/games/rockpaperscissors.h"
 #include "surena/games/tictactoe_ultimate.h"
@@ -18,6 +20,7 @@
 #include "surena/games/twixt_pp.h"
 #include "surena/game_plugin.h"
 #include "surena/game.h"
+#include "surena/game_stats.h"
 #include "surena/move_history.h"
 
 #include "repl.h"
@@ -132,6 +135,7 @@ const game_methods* load_plugin_game_methods(const char* file, uint32_t idx)
 const game_methods* static_game_methods[] = {
     &chess_standard_gbe,
     &havannah_standard_gbe,
+    &oshisumo_gbe,
     &quasar_standard_gbe,
     &rockpaperscissors_standard_gbe,
     &tictactoe_standard_gbe,
@@ -250,6 +254,7 @@ typedef enum REPL_CMD_E {
     REPL_CMD_M_GET,
     REPL_CMD_M_SET,
     REPL_CMD_M_POV,
+    REPL_CMD_M_STATS,
     //TODO REPL_CMD_M_RS,
     //TODO REPL_CMD_M_GINFO,
     REPL_CMD_G_CREATE,
@@ -282,6 +287,7 @@ typedef enum REPL_CMD_E {
     // REPL_CMD_G_GET_MOVE_DATA,
     // REPL_CMD_G_GET_MOVE_STR,
     REPL_CMD_G_PRINT,
+    REPL_CMD_G_MEMORY_USAGE,
     REPL_CMD_GS_HISTORY,
     REPL_CMD_GS_RESOLVE_RANDOM,
     REPL_CMD_COUNT,
@@ -297,6 +303,7 @@ repl_cmd_func_t repl_cmd_handle_m_exit;
 repl_cmd_func_t repl_cmd_handle_m_get;
 repl_cmd_func_t repl_cmd_handle_m_set;
 repl_cmd_func_t repl_cmd_handle_m_pov;
+repl_cmd_func_t repl_cmd_handle_m_stats;
 repl_cmd_func_t repl_cmd_handle_g_create;
 repl_cmd_func_t repl_cmd_handle_g_destroy;
 repl_cmd_func_t repl_cmd_handle_g_players_to_move;
@@ -304,6 +311,7 @@ repl_cmd_func_t repl_cmd_handle_g_get_concrete_moves;
 repl_cmd_func_t repl_cmd_handle_g_make_move;
 repl_cmd_func_t repl_cmd_handle_g_get_results;
 repl_cmd_func_t repl_cmd_handle_g_print;
+repl_cmd_func_t repl_cmd_handle_g_memory_usage;
 repl_cmd_func_t repl_cmd_handle_gs_history;
 repl_cmd_func_t repl_cmd_handle_gs_resolve_random;
 
@@ -322,6 +330,7 @@ game_command_info game_command_infos[REPL_CMD_COUNT] = {
     [REPL_CMD_M_GET] = {"get", repl_cmd_handle_m_get},
     [REPL_CMD_M_SET] = {"set", repl_cmd_handle_m_set},
     [REPL_CMD_M_POV] = {"pov", repl_cmd_handle_m_pov},
+    [REPL_CMD_M_STATS] = {"stats", repl_cmd_handle_m_stats},
     [REPL_CMD_G_CREATE] = {"create", repl_cmd_handle_g_create},
     [REPL_CMD_G_DESTROY] = {"destroy", repl_cmd_handle_g_destroy},
     // [REPL_CMD_G_EXPORT_OPTIONS] = {"export_options", NULL},
@@ -352,6 +361,7 @@ game_command_info game_command_infos[REPL_CMD_COUNT] = {
     // [REPL_CMD_G_GET_MOVE_DATA] = {"get_move_data", NULL},
     // [REPL_CMD_G_GET_MOVE_STR] = {"get_move_str", NULL},
     [REPL_CMD_G_PRINT] = {"print", repl_cmd_handle_g_print},
+    [REPL_CMD_G_MEMORY_USAGE] = {"memory_usage", repl_cmd_handle_g_memory_usage},
     [REPL_CMD_GS_HISTORY] = {"history", repl_cmd_handle_gs_history},
     [REPL_CMD_GS_RESOLVE_RANDOM] = {"resolve_random", repl_cmd_handle_gs_resolve_random},
 };
@@ -595,6 +605,71 @@ void repl_cmd_handle_m_pov(repl_state* rs, int argc, char** argv)
     rs->pov = pov;
 }
 
+// returns the upper bound in ns of the bucket that contains the calls at fraction q of all calls
+static uint64_t stats_percentile(const game_stats_entry* entry, double q)
+{
+    uint64_t target = (uint64_t)(q * (double)entry->calls);
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < GAME_STATS_BUCKETS; i++) {
+        seen += entry->buckets[i];
+        if (seen > target) {
+            return (uint64_t)1 << (i + 1);
+        }
+    }
+    return (uint64_t)1 << GAME_STATS_BUCKETS;
+}
+
+void repl_cmd_handle_m_stats(repl_state* rs, int argc, char** argv)
+{
+    if (rs == NULL) { // print help
+        printf("usage: stats [reset]\n");
+        printf("show calls and latencies of every game method called since the last reset, for all loaded games\n");
+        printf("hist lists the calls per latency bucket as log2(ns):calls\n");
+        printf("needs a build with SURENA_GAME_STATS\n");
+        return;
+    }
+    if (game_stats_enabled() == false) {
+        printf("stats are not compiled in, rebuild with SURENA_GAME_STATS\n");
+        return;
+    }
+    if (argc == 1 && strcmp(argv[0], "reset") == 0) {
+        game_stats_reset();
+        printf("stats reset\n");
+        return;
+    }
+    if (argc > 0) {
+        printf("unknown stats argument\n");
+        return;
+    }
+    uint32_t count;
+    const game_stats_entry* entries;
+    error_code ec = game_stats_snapshot(&count, &entries);
+    if (ec != ERR_OK) {
+        printf("could not take snapshot: %s\n", get_general_error_string(ec, "unknown error"));
+        return;
+    }
+    if (count == 0) {
+        printf("no calls recorded\n");
+        return;
+    }
+    const game_methods* gm = NULL;
+    for (uint32_t i = 0; i < count; i++) {
+        const game_stats_entry* entry = &entries[i];
+        if (entry->methods != gm) {
+            gm = entry->methods;
+            printf("%s.%s.%s v%u.%u.%u\n", gm->game_name, gm->variant_name, gm->impl_name, gm->version.major, gm->version.minor, gm->version.patch);
+        }
+        printf("  %s: %" PRIu64 " calls, %.3fms total, %" PRIu64 "ns avg, p50 <%" PRIu64 "ns, p99 <%" PRIu64 "ns\n", game_stats_method_names[entry->method], entry->calls, (double)entry->total_ns / 1000000.0, entry->total_ns / entry->calls, stats_percentile(entry, 0.5), stats_percentile(entry, 0.99));
+        printf("    hist:");
+        for (uint32_t b = 0; b < GAME_STATS_BUCKETS; b++) {
+            if (entry->buckets[b] > 0) {
+                printf(" %u:%" PRIu64, b, entry->buckets[b]);
+            }
+        }
+        printf("\n");
+    }
+}
+
 void repl_cmd_handle_g_create(repl_state* rs, int argc, char** argv)
 {
     if (rs == NULL) { // print help
@@ -1050,6 +1125,34 @@ void repl_cmd_handle_g_print(repl_state* rs, int argc, char** argv)
     printf("%s", print_str);
 }
 
+void repl_cmd_handle_g_memory_usage(repl_state* rs, int argc, char** argv)
+{
+    if (rs == NULL) { // print help
+        printf("usage: memory_usage\n");
+        printf("show the bytes owned by the game, split into state and export buffers\n");
+        return;
+    }
+    if (rs->g.methods == NULL) {
+        printf("no game running\n");
+        return;
+    }
+    if (game_ff(&rs->g).memory_usage == false) {
+        printf("game does not support feature: memory_usage\n");
+        return;
+    }
+    error_code ec;
+    size_t state_size;
+    size_t buffers_size;
+    ec = game_memory_usage(&rs->g, &state_size, &buffers_size);
+    if (ec != ERR_OK) {
+        print_game_error(&rs->g, ec);
+        return;
+    }
+    printf("state: %zu bytes\n", state_size);
+    printf("buffers: %zu bytes\n", buffers_size);
+    printf("total: %zu bytes\n", state_size + buffers_size);
+}
+
 void repl_cmd_handle_gs_history(repl_state* rs, int argc, char** argv)
 {
     if (rs == NULL) { // print help
@@ -0,0 +1,2289 @@
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rosalia/serialization.h"
+
+#include "surena/games/chess.h"
+#include "surena/games/havannah.h"
+#include "surena/games/oshisumo.h"
+#include "surena/games/quasar.h"
+#include "surena/games/rockpaperscissors.h"
+#include "surena/games/tictactoe_ultimate.h"
+#include "surena/games/tictactoe.h"
+#include "surena/games/twixt_pp.h"
+#include "surena/game_pool.h"
+#include "surena/game_stats.h"
+#include "surena/game_trace.h"
+#include "surena/game_view_cache.h"
+#include "surena/game.h"
+
+// plays seeded random games on the built-in games and checks the invariants the features promise
+// every failed check is printed, the exit code is non zero if any failed (run through ctest)
+
+static uint32_t check_failures = 0;
+
+#define CHECK(cond, ...)                                                      \
+    do {                                                                      \
+        if (!(cond)) {                                                        \
+            check_failures++;                                                 \
+            printf("%s:%d: check failed: %s: ", __FILE__, __LINE__, #cond); \
+            printf(__VA_ARGS__);                                              \
+            printf("\n");                                                     \
+        }                                                                     \
+    } while (0)
+
+typedef struct test_game_s {
+    const game_methods* methods;
+    const char* opts;
+} test_game;
+
+static const test_game test_games[] = {
+    {&chess_standard_gbe, NULL},
+    {&havannah_standard_gbe, "5"},
+    {&havannah_standard_gbe, "4+"},
+    {&tictactoe_standard_gbe, NULL},
+    {&tictactoe_ultimate_gbe, NULL},
+    {&twixt_pp_gbe, "12"},
+};
+
+static const uint32_t TEST_GAME_COUNT = sizeof(test_games) / sizeof(test_game);
+
+static const char* test_game_name(const test_game* tg)
+{
+    return tg->methods->game_name;
+}
+
+static game_rng test_rng(uint64_t seed)
+{
+    seed128 s = SEED128_NONE;
+    memcpy(s.bytes, &seed, sizeof(seed));
+    s.bytes[15] = 0x5E;
+    return game_e_rng_create(s, 0);
+}
+
+static bool test_game_create(game* self, const test_game* tg)
+{
+    *self = (game){.methods = tg->methods};
+    game_init init_info;
+    game_init_create_standard(&init_info, tg->opts, 0, NULL, NULL, NULL, 0);
+    error_code ec = game_create(self, &init_info);
+    layout_serializer(GSIT_DESTROY, sl_game_init_info, &init_info, NULL, NULL, NULL);
+    CHECK(ec == ERR_OK, "%s: create returned %d", test_game_name(tg), ec);
+    return ec == ERR_OK;
+}
+
+// draws a random move for the player to move, returns false if the game is over
+static bool test_random_move(game* self, game_rng* rng, player_id* ret_player, move_data_sync* ret_move)
+{
+    uint8_t ptm_count;
+    const player_id* ptm;
+    game_players_to_move(self, &ptm_count, &ptm);
+    if (ptm_count == 0) {
+        return false;
+    }
+    uint32_t move_count;
+    const move_data* moves;
+    error_code ec = game_get_concrete_moves(self, ptm[0], &move_count, &moves);
+    if (ec != ERR_OK || move_count == 0) {
+        return false;
+    }
+    *ret_player = ptm[0];
+    *ret_move = game_e_move_make_sync(self, moves[game_e_rng_intn(rng, move_count)]);
+    return true;
+}
+
+// plays up to count random moves, returns the number of moves made
+static uint32_t test_play(game* self, game_rng* rng, uint32_t count)
+{
+    uint32_t made = 0;
+    player_id player;
+    move_data_sync move;
+    while (made < count && test_random_move(self, rng, &player, &move) == true) {
+        if (game_make_move(self, player, move) != ERR_OK) {
+            break;
+        }
+        made++;
+    }
+    return made;
+}
+
+// compares the exported state (and print) of the game against the expected copies, one of which may be NULL
+static void test_check_strs(game* self, const char* what, const char* state, const char* print)
+{
+    size_t size;
+    const char* str;
+    game_export_state(self, &size, &str);
+    CHECK(strcmp(str, state) == 0, "%s: %s: state \"%s\", expected \"%s\"", game_gname(self), what, str, state);
+    if (print != NULL) {
+        game_print(self, &size, &str);
+        CHECK(strcmp(str, print) == 0, "%s: %s: print \"%s\", expected \"%s\"", game_gname(self), what, str, print);
+    }
+}
+
+// a game with the query cache answers every query exactly like the same game without it, also for repeated queries on one state
+static void test_cache_queries(const test_game* tg)
+{
+    game cached;
+    game plain;
+    if (test_game_create(&cached, tg) == false) {
+        return;
+    }
+    if (test_game_create(&plain, tg) == false) {
+        game_destroy(&cached);
+        return;
+    }
+    game_e_cache_enable(&cached);
+    game_rng rng = test_rng(33);
+    const bool has_print = game_ff(&plain).print;
+    for (uint32_t ply = 0; ply < 200; ply++) {
+        size_t size;
+        const char* str;
+        game_export_state(&plain, &size, &str);
+        char* state = strdup(str);
+        char* print = NULL;
+        if (has_print == true) {
+            game_print(&plain, &size, &str);
+            print = strdup(str);
+        }
+        for (int repeat = 0; repeat < 2; repeat++) {
+            test_check_strs(&cached, "cached", state, print);
+        }
+        free(state);
+        free(print);
+        uint8_t ptm_count;
+        const player_id* ptm;
+        game_players_to_move(&plain, &ptm_count, &ptm);
+        if (ptm_count == 0) {
+            break;
+        }
+        player_id player = ptm[0];
+        uint8_t cached_ptm_count;
+        const player_id* cached_ptm;
+        game_players_to_move(&cached, &cached_ptm_count, &cached_ptm);
+        CHECK(cached_ptm_count == ptm_count && cached_ptm[0] == player, "%s: ply %u: cached players to move differ", test_game_name(tg), ply);
+        uint32_t move_count;
+        const move_data* moves;
+        game_get_concrete_moves(&plain, player, &move_count, &moves);
+        move_code* codes = (move_code*)malloc((move_count + 1) * sizeof(move_code));
+        move_code max_code = 0;
+        for (uint32_t i = 0; i < move_count; i++) {
+            codes[i] = moves[i].cl.code;
+            max_code = (codes[i] > max_code ? codes[i] : max_code);
+        }
+        uint32_t cached_count;
+        const move_data* cached_moves;
+        game_get_concrete_moves(&cached, player, &cached_count, &cached_moves);
+        CHECK(cached_count == move_count, "%s: ply %u: %u cached moves, %u moves", test_game_name(tg), ply, cached_count, move_count);
+        for (uint32_t i = 0; i < cached_count && i < move_count; i++) {
+            CHECK(cached_moves[i].cl.code == codes[i], "%s: ply %u: cached move %u differs", test_game_name(tg), ply, i);
+        }
+        // legality of every listed move and of codes around them, the unlisted ones are mostly illegal
+        for (move_code code = 0; code <= max_code + 2; code += (max_code > 512 ? max_code / 256 : 1)) {
+            error_code plain_ec = game_is_legal_move(&plain, player, game_e_create_move_sync_small(&plain, code));
+            error_code cached_ec = game_is_legal_move(&cached, player, game_e_create_move_sync_small(&cached, code));
+            CHECK((plain_ec == ERR_OK) == (cached_ec == ERR_OK), "%s: ply %u: move %" PRIu64 " is_legal_move %d, cached %d", test_game_name(tg), ply, code, plain_ec, cached_ec);
+        }
+        for (uint32_t i = 0; i < move_count; i++) {
+            error_code ec = game_is_legal_move(&cached, player, game_e_create_move_sync_small(&cached, codes[i]));
+            CHECK(ec == ERR_OK, "%s: ply %u: listed move %" PRIu64 " not legal with the cache", test_game_name(tg), ply, codes[i]);
+        }
+        move_code code = codes[game_e_rng_intn(&rng, move_count)];
+        free(codes);
+        game_make_move(&plain, player, game_e_create_move_sync_small(&plain, code));
+        error_code ec = game_make_move(&cached, player, game_e_create_move_sync_small(&cached, code));
+        CHECK(ec == ERR_OK, "%s: ply %u: cached make_move returned %d", test_game_name(tg), ply, ec);
+    }
+    game_destroy(&plain);
+    game_destroy(&cached);
+}
+
+// writes through the internal methods bypass the wrapper, the cached state, print and move list must still follow them
+static void test_cache_internal_setters(void)
+{
+    const test_game tg = {&tictactoe_standard_gbe, NULL};
+    game g;
+    if (test_game_create(&g, &tg) == false) {
+        return;
+    }
+    game_e_cache_enable(&g);
+    const tictactoe_internal_methods* im = (const tictactoe_internal_methods*)g.methods->internal_methods;
+    // fill all cached results for the empty board
+    size_t size;
+    const char* str;
+    game_export_state(&g, &size, &str);
+    game_print(&g, &size, &str);
+    const move_code center = 1 | (1 << 2);
+    CHECK(game_is_legal_move(&g, 1, game_e_create_move_sync_small(&g, center)) == ERR_OK, "tictactoe: center not legal on the empty board");
+    // X in the center and O to move, without a move through the wrapper
+    im->set_cell(&g, 1, 1, 1);
+    im->set_current_player(&g, 2);
+    game expected;
+    if (test_game_create(&expected, &tg) == true) {
+        game_import_state(&expected, "3/1X1/3 O -");
+        game_print(&expected, &size, &str);
+        char* print = strdup(str);
+        game_export_state(&expected, &size, &str);
+        char* state = strdup(str);
+        test_check_strs(&g, "after set_cell", state, print);
+        free(state);
+        free(print);
+        game_destroy(&expected);
+    }
+    uint8_t ptm_count;
+    const player_id* ptm;
+    game_players_to_move(&g, &ptm_count, &ptm);
+    CHECK(ptm_count == 1 && ptm[0] == 2, "tictactoe: cached players to move did not follow set_current_player");
+    CHECK(game_is_legal_move(&g, 2, game_e_create_move_sync_small(&g, center)) != ERR_OK, "tictactoe: occupied center still legal from the cache");
+    uint32_t move_count;
+    const move_data* moves;
+    game_get_concrete_moves(&g, 2, &move_count, &moves);
+    CHECK(move_count == 8, "tictactoe: %u cached moves after set_cell, expected 8", move_count);
+    game_destroy(&g);
+}
+
+// minimal hidden information game: player 1 makes 4 moves, listed are the concrete moves 1 and 2
+// the action move HIDDEN_MOVE_ACTION (e.g. "play some card facedown") is legal as well, but never listed
+// other players see a move as HIDDEN_MOVE_ACTION if they are on the team of the mover (same parity), HIDDEN_MOVE_OPPONENT otherwise
+typedef struct hidden_data_s {
+    uint32_t made;
+    player_id ptm;
+    move_data moves[2];
+    move_data_sync action;
+} hidden_data;
+
+static const move_code HIDDEN_MOVE_ACTION = 7;
+static const move_code HIDDEN_MOVE_OPPONENT = 8;
+
+static error_code hidden_create(game* self, game_init* init_info)
+{
+    self->data1 = calloc(1, sizeof(hidden_data));
+    self->data2 = NULL;
+    return (self->data1 == NULL ? ERR_OUT_OF_MEMORY : ERR_OK);
+}
+
+static error_code hidden_destroy(game* self)
+{
+    free(self->data1);
+    self->data1 = NULL;
+    return ERR_OK;
+}
+
+static error_code hidden_players_to_move(game* self, uint8_t* ret_count, const player_id** ret_players)
+{
+    hidden_data* data = (hidden_data*)self->data1;
+    data->ptm = 1;
+    *ret_count = (data->made < 4 ? 1 : 0);
+    *ret_players = &data->ptm;
+    return ERR_OK;
+}
+
+static error_code hidden_get_concrete_moves(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves)
+{
+    hidden_data* data = (hidden_data*)self->data1;
+    data->moves[0] = game_e_create_move_small(1);
+    data->moves[1] = game_e_create_move_small(2);
+    *ret_count = 2;
+    *ret_moves = data->moves;
+    return ERR_OK;
+}
+
+static error_code hidden_is_legal_move(game* self, player_id player, move_data_sync move)
+{
+    move_code code = move.md.cl.code;
+    return (code == 1 || code == 2 || code == HIDDEN_MOVE_ACTION ? ERR_OK : ERR_INVALID_MOVE);
+}
+
+static error_code hidden_make_move(game* self, player_id player, move_data_sync move)
+{
+    ((hidden_data*)self->data1)->made++;
+    return ERR_OK;
+}
+
+static error_code hidden_move_to_action(game* self, player_id player, move_data_sync move, uint8_t target_count, const player_id* target_players, move_data_sync** ret_action)
+{
+    hidden_data* data = (hidden_data*)self->data1;
+    move_code action = move.md.cl.code;
+    if (target_players[0] != player) {
+        action = (target_players[0] % 2 == player % 2 ? HIDDEN_MOVE_ACTION : HIDDEN_MOVE_OPPONENT);
+    }
+    // the action is only valid until the next call, like in the real games
+    data->action = (move_data_sync){.md = game_e_create_move_small(action), .sync_ctr = move.sync_ctr};
+    *ret_action = &data->action;
+    return ERR_OK;
+}
+
+static const game_methods hidden_gbe = {
+    .game_name = "Hidden",
+    .variant_name = "Test",
+    .impl_name = "game_tests",
+    .version = (semver){1, 0, 0},
+    .features = (game_feature_flags){.hidden_information = true},
+    .create = hidden_create,
+    .destroy = hidden_destroy,
+    .players_to_move = hidden_players_to_move,
+    .get_concrete_moves = hidden_get_concrete_moves,
+    .is_legal_move = hidden_is_legal_move,
+    .move_to_action = hidden_move_to_action,
+    .make_move = hidden_make_move,
+};
+
+// with the query cache on, moves that are legal but not listed (here the action of a hidden information game) are still accepted
+static void test_cache_unlisted_moves(void)
+{
+    const test_game tg = {&hidden_gbe, NULL};
+    game g;
+    if (test_game_create(&g, &tg) == false) {
+        return;
+    }
+    game_e_cache_enable(&g);
+    for (uint32_t i = 0; i < 4; i++) {
+        // fill the cached move list first, it must not be taken as the complete legal set
+        uint32_t move_count;
+        const move_data* moves;
+        game_get_concrete_moves(&g, 1, &move_count, &moves);
+        CHECK(move_count == 2, "hidden: %u concrete moves", move_count);
+        error_code ec = game_is_legal_move(&g, 1, game_e_create_move_sync_small(&g, HIDDEN_MOVE_ACTION));
+        CHECK(ec == ERR_OK, "hidden: move %u: unlisted action is_legal_move returned %d", i, ec);
+        ec = game_is_legal_move(&g, 1, game_e_create_move_sync_small(&g, 3));
+        CHECK(ec != ERR_OK, "hidden: move %u: illegal move was accepted", i);
+        ec = game_make_move(&g, 1, game_e_create_move_sync_small(&g, (i % 2 == 0 ? HIDDEN_MOVE_ACTION : 1)));
+        CHECK(ec == ERR_OK, "hidden: move %u: make_move returned %d", i, ec);
+    }
+    uint8_t ptm_count;
+    const player_id* ptm;
+    game_players_to_move(&g, &ptm_count, &ptm);
+    CHECK(ptm_count == 0, "hidden: game not over after all moves");
+    game_destroy(&g);
+}
+
+// fanning a move out groups the target players by identical action, in order of their first appearance, with every action serialized once
+static void test_action_groups(void)
+{
+    const test_game tg = {&hidden_gbe, NULL};
+    game g;
+    if (test_game_create(&g, &tg) == false) {
+        return;
+    }
+    const player_id targets[8] = {4, 1, 6, 3, 8, 2, 5, 7};
+    const player_id expected_players[3][4] = {{4, 6, 8, 2}, {1, 5, 7}, {3}};
+    const uint8_t expected_counts[3] = {4, 3, 1};
+    const move_code expected_actions[3] = {HIDDEN_MOVE_OPPONENT, HIDDEN_MOVE_ACTION, 2};
+    move_data_sync move = game_e_create_move_sync_small(&g, 2);
+    uint8_t group_count = 0;
+    const action_group* groups = NULL;
+    error_code ec = game_e_move_to_action_groups(&g, 3, move, 8, targets, &group_count, &groups);
+    CHECK(ec == ERR_OK && group_count == 3, "hidden: action groups returned %d with %hhu groups, expected 3", ec, group_count);
+    if (ec != ERR_OK || group_count != 3) {
+        game_destroy(&g);
+        game_e_thread_cleanup();
+        return;
+    }
+    for (uint8_t i = 0; i < group_count; i++) {
+        CHECK(groups[i].player_count == expected_counts[i] && memcmp(groups[i].players, expected_players[i], expected_counts[i] * sizeof(player_id)) == 0, "hidden: group %hhu has %hhu players, expected %hhu in order", i, groups[i].player_count, expected_counts[i]);
+        move_data_sync action;
+        size_t read = layout_serializer(GSIT_DESERIALIZE, sl_move_data_sync, NULL, &action, (void*)groups[i].buf, (void*)(groups[i].buf + groups[i].size));
+        CHECK(read == groups[i].size, "hidden: group %hhu read %zu of %zu bytes", i, read, groups[i].size);
+        CHECK(action.md.cl.code == expected_actions[i] && action.sync_ctr == move.sync_ctr, "hidden: group %hhu action %" PRIu64 ", expected %" PRIu64, i, action.md.cl.code, expected_actions[i]);
+        layout_serializer(GSIT_DESTROY, sl_move_data_sync, &action, NULL, NULL, NULL);
+        for (uint8_t o = 0; o < i; o++) {
+            CHECK(groups[o].buf + groups[o].size <= groups[i].buf || groups[i].buf + groups[i].size <= groups[o].buf, "hidden: buffers of groups %hhu and %hhu overlap", o, i);
+        }
+    }
+    // a single target is a single group
+    const player_id own = 3;
+    ec = game_e_move_to_action_groups(&g, 3, move, 1, &own, &group_count, &groups);
+    CHECK(ec == ERR_OK && group_count == 1 && groups[0].player_count == 1 && groups[0].players[0] == 3, "hidden: single target returned %d with %hhu groups", ec, group_count);
+    game_destroy(&g);
+    game_e_thread_cleanup();
+}
+
+// records on a thread of its own, its counts have to show up in the snapshot of the main thread
+static void* test_stats_thread(void* arg)
+{
+    for (int i = 0; i < 4; i++) {
+        game_stats_record(&hidden_gbe, GAME_STATS_METHOD_EVAL, 7);
+    }
+    return NULL;
+}
+
+// the wrappers count every call per game_methods and method, snapshots sum up all threads and reset starts over from zero
+static void test_game_stats(void)
+{
+    uint32_t entry_count;
+    const game_stats_entry* entries;
+    if (game_stats_enabled() == false) {
+        CHECK(game_stats_snapshot(&entry_count, &entries) == ERR_FEATURE_UNSUPPORTED, "stats: snapshot without the stats compiled in did not fail");
+        return;
+    }
+    game_stats_reset();
+    const test_game tg = {&hidden_gbe, NULL};
+    game g;
+    if (test_game_create(&g, &tg) == false) {
+        return;
+    }
+    for (int i = 0; i < 5; i++) {
+        game_is_legal_move(&g, 1, game_e_create_move_sync_small(&g, 1));
+    }
+    // one per bucket edge: 0 and 1 both go to bucket 0, 3 to bucket 1, 1000 to bucket 9, anything past the last bucket to it
+    const uint64_t durations[5] = {0, 1, 3, 1000, (uint64_t)1 << 40};
+    for (int i = 0; i < 5; i++) {
+        game_stats_record(&hidden_gbe, GAME_STATS_METHOD_EVAL, durations[i]);
+    }
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, test_stats_thread, NULL) == 0) {
+        pthread_join(thread, NULL);
+    } else {
+        test_stats_thread(NULL);
+    }
+    error_code ec = game_stats_snapshot(&entry_count, &entries);
+    CHECK(ec == ERR_OK, "stats: snapshot returned %d", ec);
+    if (ec != ERR_OK) {
+        game_destroy(&g);
+        return;
+    }
+    const game_stats_entry* create = NULL;
+    const game_stats_entry* legal = NULL;
+    const game_stats_entry* eval = NULL;
+    int hidden_runs = 0;
+    for (uint32_t i = 0; i < entry_count; i++) {
+        const game_stats_entry* e = &entries[i];
+        uint64_t bucket_sum = 0;
+        for (uint32_t b = 0; b < GAME_STATS_BUCKETS; b++) {
+            bucket_sum += e->buckets[b];
+        }
+        CHECK(e->calls > 0 && bucket_sum == e->calls, "stats: %s.%s has %" PRIu64 " calls and %" PRIu64 " in its buckets", e->methods->game_name, game_stats_method_names[e->method], e->calls, bucket_sum);
+        if (e->methods != &hidden_gbe) {
+            continue;
+        }
+        hidden_runs += (i == 0 || entries[i - 1].methods != &hidden_gbe);
+        CHECK(i == 0 || entries[i - 1].methods != &hidden_gbe || entries[i - 1].method < e->method, "stats: hidden entries out of method order at %u", i);
+        create = (e->method == GAME_STATS_METHOD_CREATE ? e : create);
+        legal = (e->method == GAME_STATS_METHOD_IS_LEGAL_MOVE ? e : legal);
+        eval = (e->method == GAME_STATS_METHOD_EVAL ? e : eval);
+    }
+    CHECK(hidden_runs == 1, "stats: hidden entries are split into %d runs", hidden_runs);
+    CHECK(create != NULL && create->calls == 1, "stats: %" PRIu64 " create calls, expected 1", (create == NULL ? 0 : create->calls));
+    CHECK(legal != NULL && legal->calls == 5, "stats: %" PRIu64 " is_legal_move calls, expected 5", (legal == NULL ? 0 : legal->calls));
+    CHECK(eval != NULL && eval->calls == 9, "stats: %" PRIu64 " recorded eval calls, expected 9", (eval == NULL ? 0 : eval->calls));
+    if (eval != NULL) {
+        CHECK(eval->total_ns == 1 + 3 + 1000 + ((uint64_t)1 << 40) + 4 * 7, "stats: recorded eval total of %" PRIu64 " ns", eval->total_ns);
+        CHECK(eval->buckets[0] == 2 && eval->buckets[1] == 1 && eval->buckets[2] == 4 && eval->buckets[9] == 1 && eval->buckets[GAME_STATS_BUCKETS - 1] == 1, "stats: recorded eval buckets %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64, eval->buckets[0], eval->buckets[1], eval->buckets[2], eval->buckets[9], eval->buckets[GAME_STATS_BUCKETS - 1]);
+    }
+    game_stats_reset();
+    game_is_legal_move(&g, 1, game_e_create_move_sync_small(&g, 1));
+    ec = game_stats_snapshot(&entry_count, &entries);
+    // is_legal_move also asks for the players to move, so only the calls from before the reset must be gone
+    uint64_t legal_calls = 0;
+    for (uint32_t i = 0; ec == ERR_OK && i < entry_count; i++) {
+        if (entries[i].methods == &hidden_gbe) {
+            CHECK(entries[i].method != GAME_STATS_METHOD_CREATE && entries[i].method != GAME_STATS_METHOD_EVAL, "stats: %s still counted after reset", game_stats_method_names[entries[i].method]);
+            legal_calls += (entries[i].method == GAME_STATS_METHOD_IS_LEGAL_MOVE ? entries[i].calls : 0);
+        }
+    }
+    CHECK(ec == ERR_OK && legal_calls == 1, "stats: %" PRIu64 " is_legal_move calls after reset, expected 1", legal_calls);
+    game_destroy(&g);
+}
+
+// minimal random game: the environment rolls a skewed 5 sided die DICE_ROLLS times, every roll is a new state with the same distribution
+typedef struct dice_data_s {
+    uint32_t rolls;
+    bool short_probs; // lists one probability less than moves, which a sampler has to reject
+    player_id ptm;
+    move_data moves[5];
+} dice_data;
+
+static const uint32_t DICE_ROLLS = 64;
+static const float DICE_PROBS[5] = {0.5f, 0.25f, 0.125f, 0.0625f, 0.0625f};
+
+static error_code dice_create(game* self, game_init* init_info)
+{
+    self->data1 = calloc(1, sizeof(dice_data));
+    self->data2 = NULL;
+    return (self->data1 == NULL ? ERR_OUT_OF_MEMORY : ERR_OK);
+}
+
+static error_code dice_destroy(game* self)
+{
+    free(self->data1);
+    self->data1 = NULL;
+    return ERR_OK;
+}
+
+static error_code dice_players_to_move(game* self, uint8_t* ret_count, const player_id** ret_players)
+{
+    dice_data* data = (dice_data*)self->data1;
+    data->ptm = PLAYER_ENV;
+    *ret_count = (data->rolls < DICE_ROLLS ? 1 : 0);
+    *ret_players = &data->ptm;
+    return ERR_OK;
+}
+
+static error_code dice_get_concrete_moves(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves)
+{
+    dice_data* data = (dice_data*)self->data1;
+    for (uint32_t i = 0; i < 5; i++) {
+        data->moves[i] = game_e_create_move_small(i + 1);
+    }
+    *ret_count = 5;
+    *ret_moves = data->moves;
+    return ERR_OK;
+}
+
+static error_code dice_get_concrete_move_probabilities(game* self, uint32_t* ret_count, const float** ret_move_probabilities)
+{
+    *ret_count = (((dice_data*)self->data1)->short_probs == true ? 4 : 5);
+    *ret_move_probabilities = DICE_PROBS;
+    return ERR_OK;
+}
+
+static error_code dice_is_legal_move(game* self, player_id player, move_data_sync move)
+{
+    return (move.md.cl.code >= 1 && move.md.cl.code <= 5 ? ERR_OK : ERR_INVALID_MOVE);
+}
+
+static error_code dice_make_move(game* self, player_id player, move_data_sync move)
+{
+    ((dice_data*)self->data1)->rolls++;
+    return ERR_OK;
+}
+
+static error_code dice_memory_usage(game* self, size_t* ret_state, size_t* ret_buffers)
+{
+    *ret_state = sizeof(dice_data);
+    *ret_buffers = 0;
+    return ERR_OK;
+}
+
+static const game_methods dice_gbe = {
+    .game_name = "Dice",
+    .variant_name = "Test",
+    .impl_name = "game_tests",
+    .version = (semver){1, 0, 0},
+    .features = (game_feature_flags){.random_moves = true, .memory_usage = true},
+    .create = dice_create,
+    .destroy = dice_destroy,
+    .players_to_move = dice_players_to_move,
+    .get_concrete_moves = dice_get_concrete_moves,
+    .get_concrete_move_probabilities = dice_get_concrete_move_probabilities,
+    .is_legal_move = dice_is_legal_move,
+    .make_move = dice_make_move,
+    .memory_usage = dice_memory_usage,
+};
+
+// random moves follow the move probabilities, with the cache on and off alike, and rolling the same die again does not grow the cached tables
+static void test_random_moves(void)
+{
+    const test_game tg = {&dice_gbe, NULL};
+    game plain;
+    game cached;
+    if (test_game_create(&plain, &tg) == false || test_game_create(&cached, &tg) == false) {
+        return;
+    }
+    game_e_cache_enable(&cached);
+    uint32_t counts[5] = {0, 0, 0, 0, 0};
+    const uint32_t draws = 4000;
+    size_t first_buffers = 0;
+    for (uint32_t roll = 0; roll < DICE_ROLLS; roll++) {
+        for (uint32_t i = 0; i < draws / DICE_ROLLS; i++) {
+            seed128 seed = SEED128_NONE;
+            uint64_t seed_num = roll * draws + i + 1;
+            memcpy(seed.bytes, &seed_num, sizeof(seed_num));
+            move_data_sync plain_move = game_e_get_random_move_sync(&plain, seed);
+            move_data_sync cached_move = game_e_get_random_move_sync(&cached, seed);
+            CHECK(plain_move.md.cl.code == cached_move.md.cl.code, "dice: roll %u draw %u: cached %" PRIu64 ", plain %" PRIu64, roll, i, cached_move.md.cl.code, plain_move.md.cl.code);
+            if (plain_move.md.cl.code >= 1 && plain_move.md.cl.code <= 5) {
+                counts[plain_move.md.cl.code - 1]++;
+            }
+            game_e_move_sync_destroy(plain_move);
+            game_e_move_sync_destroy(cached_move);
+        }
+        size_t state_size;
+        size_t buffers_size;
+        game_memory_usage(&cached, &state_size, &buffers_size);
+        if (roll == 0) {
+            first_buffers = buffers_size;
+        }
+        CHECK(buffers_size == first_buffers, "dice: roll %u: cache grew from %zu to %zu bytes", roll, first_buffers, buffers_size);
+        game_make_move(&plain, PLAYER_ENV, game_e_create_move_sync_small(&plain, 1));
+        game_make_move(&cached, PLAYER_ENV, game_e_create_move_sync_small(&cached, 1));
+    }
+    for (uint32_t i = 0; i < 5; i++) {
+        // binomial, within 5 standard deviations
+        double expected = draws * DICE_PROBS[i];
+        double deviation = expected - counts[i];
+        CHECK(deviation * deviation < 25 * expected * (1 - DICE_PROBS[i]), "dice: face %u drawn %u times, expected %.0f", i + 1, counts[i], expected);
+    }
+    game_destroy(&plain);
+    game_destroy(&cached);
+}
+
+// generic playouts end the game on quasar, both with the env drawing from the probabilities and with its values discretized in advance
+// a game whose moves and probabilities disagree is rejected instead of sampled
+static void test_playout_generic(void)
+{
+    const test_game tg = {&quasar_standard_gbe, NULL};
+    for (uint64_t i = 0; i < 64; i++) {
+        game g;
+        if (test_game_create(&g, &tg) == false) {
+            return;
+        }
+        seed128 seed = SEED128_NONE;
+        memcpy(seed.bytes, &i, sizeof(i));
+        seed.bytes[15] = 0x39;
+        if (i % 2 == 1) {
+            game_discretize(&g, seed);
+        }
+        error_code ec = game_e_playout_generic(&g, seed);
+        CHECK(ec == ERR_OK, "quasar: playout %" PRIu64 " returned %d", i, ec);
+        uint8_t ptm_count;
+        const player_id* ptm;
+        game_players_to_move(&g, &ptm_count, &ptm);
+        CHECK(ptm_count == 0, "quasar: playout %" PRIu64 " did not end the game", i);
+        game_destroy(&g);
+    }
+    const test_game dice = {&dice_gbe, NULL};
+    game g;
+    if (test_game_create(&g, &dice) == false) {
+        return;
+    }
+    ((dice_data*)g.data1)->short_probs = true;
+    seed128 seed = SEED128_NONE;
+    seed.bytes[0] = 1;
+    error_code ec = game_e_playout_generic(&g, seed);
+    CHECK(ec == ERR_INVALID_STATE, "dice: playout with short probabilities returned %d", ec);
+    game_destroy(&g);
+}
+
+// minimal counting game: player 1 adds 1 or 2 to a counter until it reaches 16, making a move fails while fail_moves is set
+typedef struct counter_data_s {
+    uint32_t value;
+    bool fail_moves;
+    player_id ptm;
+    move_data moves[2];
+    char state[16];
+} counter_data;
+
+static error_code counter_create(game* self, game_init* init_info)
+{
+    self->data1 = calloc(1, sizeof(counter_data));
+    self->data2 = NULL;
+    return (self->data1 == NULL ? ERR_OUT_OF_MEMORY : ERR_OK);
+}
+
+static error_code counter_destroy(game* self)
+{
+    free(self->data1);
+    self->data1 = NULL;
+    return ERR_OK;
+}
+
+static error_code counter_clone(game* self, game* clone_target)
+{
+    clone_target->data1 = malloc(sizeof(counter_data));
+    clone_target->data2 = NULL;
+    if (clone_target->data1 == NULL) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    memcpy(clone_target->data1, self->data1, sizeof(counter_data));
+    ((counter_data*)clone_target->data1)->fail_moves = false;
+    return ERR_OK;
+}
+
+static error_code counter_copy_from(game* self, game* other)
+{
+    ((counter_data*)self->data1)->value = ((counter_data*)other->data1)->value;
+    return ERR_OK;
+}
+
+static error_code counter_export_state(game* self, size_t* ret_size, const char** ret_str)
+{
+    counter_data* data = (counter_data*)self->data1;
+    *ret_size = (size_t)snprintf(data->state, sizeof(data->state), "%u", data->value);
+    *ret_str = data->state;
+    return ERR_OK;
+}
+
+static error_code counter_players_to_move(game* self, uint8_t* ret_count, const player_id** ret_players)
+{
+    counter_data* data = (counter_data*)self->data1;
+    data->ptm = 1;
+    *ret_count = (data->value < 16 ? 1 : 0);
+    *ret_players = &data->ptm;
+    return ERR_OK;
+}
+
+static error_code counter_get_concrete_moves(game* self, player_id player, uint32_t* ret_count, const move_data** ret_moves)
+{
+    counter_data* data = (counter_data*)self->data1;
+    data->moves[0] = game_e_create_move_small(1);
+    data->moves[1] = game_e_create_move_small(2);
+    *ret_count = 2;
+    *ret_moves = data->moves;
+    return ERR_OK;
+}
+
+static error_code counter_is_legal_move(game* self, player_id player, move_data_sync move)
+{
+    return (move.md.cl.code == 1 || move.md.cl.code == 2 ? ERR_OK : ERR_INVALID_MOVE);
+}
+
+static error_code counter_make_move(game* self, player_id player, move_data_sync move)
+{
+    counter_data* data = (counter_data*)self->data1;
+    if (data->fail_moves == true) {
+        return ERR_OUT_OF_MEMORY;
+    }
+    data->value += (uint32_t)move.md.cl.code;
+    return ERR_OK;
+}
+
+static const game_methods counter_gbe = {
+    .game_name = "Counter",
+    .variant_name = "Test",
+    .impl_name = "game_tests",
+    .version = (semver){1, 0, 0},
+    .create = counter_create,
+    .destroy = counter_destroy,
+    .clone = counter_clone,
+    .copy_from = counter_copy_from,
+    .export_state = counter_export_state,
+    .players_to_move = counter_players_to_move,
+    .get_concrete_moves = counter_get_concrete_moves,
+    .is_legal_move = counter_is_legal_move,
+    .make_move = counter_make_move,
+};
+
+// the exact ev of every quasar state is the best ev of its moves, or the ev of the outcomes weighted by their probabilities while generating
+static void test_quasar_policy(void)
+{
+    const test_game tg = {&quasar_standard_gbe, NULL};
+    game g;
+    if (test_game_create(&g, &tg) == false) {
+        return;
+    }
+    const quasar_internal_methods* qi = (const quasar_internal_methods*)g.methods->internal_methods;
+    const char generating_chars[3] = {'-', 'B', 'S'};
+    for (uint8_t num = 0; num < 20; num++) {
+        for (int generating = 0; generating < 3; generating++) {
+            char state[32];
+            sprintf(state, "%hhu %c 0", num, generating_chars[generating]);
+            if (game_import_state(&g, state) != ERR_OK) {
+                CHECK(false, "quasar: import of \"%s\" failed", state);
+                continue;
+            }
+            float ev;
+            qi->get_exact_ev(&g, &ev);
+            uint8_t ptm_count;
+            const player_id* ptm;
+            game_players_to_move(&g, &ptm_count, &ptm);
+            uint32_t move_count;
+            const move_data* moves;
+            game_get_concrete_moves(&g, ptm[0], &move_count, &moves);
+            move_code codes[8];
+            for (uint32_t i = 0; i < move_count; i++) {
+                codes[i] = moves[i].cl.code;
+            }
+            float probs[8];
+            if (ptm[0] == PLAYER_ENV) {
+                uint32_t prob_count;
+                const float* move_probs;
+                game_get_concrete_move_probabilities(&g, &prob_count, &move_probs);
+                memcpy(probs, move_probs, move_count * sizeof(float));
+            }
+            float expected = (ptm[0] == PLAYER_ENV ? 0 : -1000);
+            float best_ev = -1000;
+            move_code optimal = 0;
+            if (ptm[0] != PLAYER_ENV) {
+                qi->get_optimal_move(&g, &optimal);
+            }
+            for (uint32_t i = 0; i < move_count; i++) {
+                game child;
+                game_clone(&g, &child);
+                game_make_move(&child, ptm[0], game_e_create_move_sync_small(&child, codes[i]));
+                float child_ev;
+                qi->get_exact_ev(&child, &child_ev);
+                game_destroy(&child);
+                if (ptm[0] == PLAYER_ENV) {
+                    expected += probs[i] * child_ev;
+                } else {
+                    expected = (child_ev > expected ? child_ev : expected);
+                    best_ev = (codes[i] == optimal ? child_ev : best_ev);
+                }
+            }
+            CHECK(ev - expected < 1e-4f && expected - ev < 1e-4f, "quasar: \"%s\": exact ev %f, from its moves %f", state, ev, expected);
+            CHECK(ptm[0] == PLAYER_ENV || (best_ev - expected < 1e-4f && expected - best_ev < 1e-4f), "quasar: \"%s\": optimal move has ev %f, best %f", state, best_ev, expected);
+        }
+    }
+    game_destroy(&g);
+}
+
+// value of a stage game of the oshisumo solver for player 1, including positions that are already pushed out
+static float test_oshisumo_value(game* g, int half, int t1, int t2, int cell)
+{
+    if (cell > half) {
+        return 1;
+    }
+    if (cell < -half) {
+        return -1;
+    }
+    const oshisumo_internal_methods* oi = (const oshisumo_internal_methods*)g->methods->internal_methods;
+    float value = 0;
+    const float* s1;
+    const float* s2;
+    oi->get_equilibrium(g, t1, t2, cell, &value, &s1, &s2);
+    return value;
+}
+
+// the solver strategies of every stage game are an equilibrium: against any pure bid of the opponent each player keeps the value
+static void test_oshisumo_equilibrium(void)
+{
+    const test_game tg = {&oshisumo_gbe, "5-6"};
+    const int half = 2;
+    const int tokens = 6;
+    game g;
+    if (test_game_create(&g, &tg) == false) {
+        return;
+    }
+    const oshisumo_internal_methods* oi = (const oshisumo_internal_methods*)g.methods->internal_methods;
+    for (int t1 = 0; t1 <= tokens; t1++) {
+        for (int t2 = 0; t2 <= tokens; t2++) {
+            for (int cell = -half; cell <= half; cell++) {
+                float value;
+                const float* s1;
+                const float* s2;
+                error_code ec = oi->get_equilibrium(&g, t1, t2, cell, &value, &s1, &s2);
+                CHECK(ec == ERR_OK, "oshisumo: equilibrium at %d %d %d returned %d", t1, t2, cell, ec);
+                if (ec != ERR_OK) {
+                    continue;
+                }
+                float sum1 = 0;
+                float sum2 = 0;
+                for (int b = 0; b <= t1; b++) {
+                    sum1 += s1[b];
+                }
+                for (int b = 0; b <= t2; b++) {
+                    sum2 += s2[b];
+                }
+                CHECK(sum1 > 0.999f && sum1 < 1.001f && sum2 > 0.999f && sum2 < 1.001f, "oshisumo: %d %d %d: strategies sum to %f and %f", t1, t2, cell, sum1, sum2);
+                if (t1 + t2 == 0) {
+                    CHECK(value == (cell > 0) - (cell < 0), "oshisumo: %d %d %d: final value %f", t1, t2, cell, value);
+                    continue;
+                }
+                // bids are [1, t] while tokens are left, otherwise the only bid is 0
+                int min1 = (t1 > 0 ? 1 : 0);
+                int min2 = (t2 > 0 ? 1 : 0);
+                for (int b2 = min2; b2 <= t2; b2++) {
+                    float payoff = 0;
+                    for (int b1 = min1; b1 <= t1; b1++) {
+                        payoff += s1[b1] * test_oshisumo_value(&g, half, t1 - b1, t2 - b2, cell + (b1 > b2) - (b1 < b2));
+                    }
+                    CHECK(payoff > value - 1e-3f, "oshisumo: %d %d %d: bid %d of player 2 holds player 1 to %f, value %f", t1, t2, cell, b2, payoff, value);
+                }
+                for (int b1 = min1; b1 <= t1; b1++) {
+                    float payoff = 0;
+                    for (int b2 = min2; b2 <= t2; b2++) {
+                        payoff += s2[b2] * test_oshisumo_value(&g, half, t1 - b1, t2 - b2, cell + (b1 > b2) - (b1 < b2));
+                    }
+                    CHECK(payoff < value + 1e-3f, "oshisumo: %d %d %d: bid %d of player 1 gets %f, value %f", t1, t2, cell, b1, payoff, value);
+                }
+            }
+        }
+    }
+    game_destroy(&g);
+}
+
+// rockpaperscissors hands out its actions and sync data from rings in the game, the outputs of the last few rounds stay valid and no round needs new storage
+static void test_rps_sync_rings(void)
+{
+    const test_game tg = {&rockpaperscissors_standard_gbe, NULL};
+    const uint32_t ROUNDS = 12;
+    const uint32_t KEPT = 3; // earlier rounds whose outputs must still be intact
+    game server;
+    game view;
+    if (test_game_create(&server, &tg) == false) {
+        return;
+    }
+    if (test_game_create(&view, &tg) == false) {
+        game_destroy(&server);
+        return;
+    }
+    CHECK(game_ff(&server).sync_data, "rockpaperscissors: no sync_data feature");
+    const sync_data* syncs[12];
+    move_data_sync* actions[12];
+    uint8_t played[12][2];
+    const void* seen[24];
+    uint32_t seen_count = 0;
+    for (uint32_t r = 0; r < ROUNDS; r++) {
+        game_import_state(&server, "---");
+        game_import_state(&view, "---");
+        played[r][0] = ROCKPAPERSCISSORS_ROCK + r % 3;
+        played[r][1] = ROCKPAPERSCISSORS_ROCK + (r / 3) % 3;
+        for (player_id p = 1; p <= 2; p++) {
+            move_data_sync move = game_e_create_move_sync_small(&server, played[r][p - 1]);
+            const player_id other = 3 - p;
+            move_data_sync* own;
+            move_data_sync* hidden;
+            error_code ec = game_move_to_action(&server, p, move, 1, &p, &own);
+            CHECK(ec == ERR_OK && own->md.cl.code == played[r][p - 1], "rockpaperscissors: round %u: player %hhu does not get their own move back", r, p);
+            ec = game_move_to_action(&server, p, move, 1, &other, &hidden);
+            CHECK(ec == ERR_OK && hidden->md.cl.code == ROCKPAPERSCISSORS_ANY, "rockpaperscissors: round %u: move of player %hhu not hidden from player %hhu", r, p, other);
+            CHECK(own != hidden && own->md.cl.code == played[r][p - 1], "rockpaperscissors: round %u: hidden action overwrote the own action", r);
+            if (p == 1) {
+                actions[r] = hidden;
+            }
+            ec = game_make_move(&view, p, game_e_create_move_sync_small(&view, hidden->md.cl.code));
+            CHECK(ec == ERR_OK, "rockpaperscissors: round %u: view rejected the hidden action of player %hhu", r, p);
+            ec = game_make_move(&server, p, move);
+            CHECK(ec == ERR_OK, "rockpaperscissors: round %u: move of player %hhu returned %d", r, p, ec);
+        }
+        uint32_t sync_count = 0;
+        error_code ec = game_export_sync_data(&server, &sync_count, &syncs[r]);
+        CHECK(ec == ERR_OK && sync_count == 1, "rockpaperscissors: round %u: export_sync_data returned %d with %u entries", r, ec, sync_count);
+        if (ec != ERR_OK || sync_count != 1) {
+            break;
+        }
+        const sync_data* sd = syncs[r];
+        CHECK(sd->player_c == 2 && sd->players[0] == 1 && sd->players[1] == 2, "rockpaperscissors: round %u: sync data does not go to both players", r);
+        CHECK(sd->b.len == 2 && memcmp(sd->b.data, played[r], 2) == 0, "rockpaperscissors: round %u: sync data does not hold the played moves", r);
+        ec = game_import_sync_data(&view, sd->b);
+        CHECK(ec == ERR_OK, "rockpaperscissors: round %u: import_sync_data returned %d", r, ec);
+        uint8_t server_res_count;
+        uint8_t view_res_count;
+        const player_id* server_res;
+        const player_id* view_res;
+        game_get_results(&server, &server_res_count, &server_res);
+        game_get_results(&view, &view_res_count, &view_res);
+        CHECK(view_res_count == server_res_count && (server_res_count == 0 || view_res[0] == server_res[0]), "rockpaperscissors: round %u: view and server results differ", r);
+        for (uint32_t k = 1; k <= KEPT && k <= r; k++) {
+            const sync_data* old = syncs[r - k];
+            CHECK(old->b.len == 2 && memcmp(old->b.data, played[r - k], 2) == 0 && old->players[0] == 1 && old->players[1] == 2, "rockpaperscissors: round %u: sync data of round %u was overwritten", r, r - k);
+            CHECK(actions[r - k]->md.cl.code == ROCKPAPERSCISSORS_ANY, "rockpaperscissors: round %u: action of round %u was overwritten", r, r - k);
+        }
+        const void* outs[2] = {sd, sd->b.data};
+        for (int o = 0; o < 2; o++) {
+            bool known = false;
+            for (uint32_t i = 0; i < seen_count; i++) {
+                known = known || seen[i] == outs[o];
+            }
+            if (known == false && seen_count < 24) {
+                seen[seen_count++] = outs[o];
+            }
+        }
+    }
+    // a ring reuses its slots, fresh storage every round would show up as a new address each round
+    CHECK(seen_count <= 2 * (KEPT + 1), "rockpaperscissors: %u distinct sync data addresses over %u rounds", seen_count, ROUNDS);
+    blob short_blob = {.len = 1, .data = (uint8_t[]){ROCKPAPERSCISSORS_ROCK}};
+    CHECK(game_import_sync_data(&view, short_blob) == ERR_INVALID_INPUT, "rockpaperscissors: import_sync_data accepted a short payload");
+    game_destroy(&view);
+    game_destroy(&server);
+}
+
+// views follow the moves made through the view cache, and are rebuilt from the source if making a move on the source fails
+static void test_view_cache_moves(void)
+{
+    const test_game tg = {&counter_gbe, NULL};
+    game source;
+    if (test_game_create(&source, &tg) == false) {
+        return;
+    }
+    game_view_cache* views = game_view_cache_create(&source);
+    const player_id pov = 1;
+    game* view;
+    game_view_cache_get(views, &source, 1, &pov, &view);
+    for (uint32_t i = 0; i < 8; i++) {
+        bool fail = (i % 3 == 1);
+        ((counter_data*)source.data1)->fail_moves = fail;
+        error_code ec = game_view_cache_make_move(views, &source, 1, game_e_create_move_sync_small(&source, 1 + i % 2));
+        CHECK((ec == ERR_OK) == (fail == false), "counter: move %u: view cache make_move returned %d", i, ec);
+        game* got;
+        game_view_cache_get(views, &source, 1, &pov, &got);
+        CHECK(got == view, "counter: move %u: view moved from %p to %p", i, (void*)view, (void*)got);
+        size_t size;
+        const char* str;
+        game_export_state(&source, &size, &str);
+        char* expected = strdup(str);
+        game_export_state(got, &size, &str);
+        CHECK(strcmp(str, expected) == 0, "counter: move %u: view state \"%s\", source \"%s\"", i, str, expected);
+        free(expected);
+    }
+    game_view_cache_destroy(views);
+    game_destroy(&source);
+}
+
+static const test_game test_into_games[] = {
+    {&tictactoe_standard_gbe, NULL},
+    {&quasar_standard_gbe, NULL},
+    {&rockpaperscissors_standard_gbe, NULL},
+    {&oshisumo_gbe, "5-12"},
+};
+
+static const uint32_t TEST_INTO_GAME_COUNT = sizeof(test_into_games) / sizeof(test_game);
+
+// a string _into query refuses a buffer one too small without writing to it, then writes the expected string into one of the required size
+static void test_check_into_str(game* self, const char* what, const char* expected, error_code (*into)(game*, size_t, size_t*, char*))
+{
+    char buf[1024];
+    size_t need = 0;
+    memset(buf, 0x7F, sizeof(buf));
+    error_code ec = into(self, 0, &need, buf);
+    CHECK(ec == ERR_OUT_OF_MEMORY && need > strlen(expected) && need <= sizeof(buf), "%s: %s: cap 0 returned %d with size %zu", game_gname(self), what, ec, need);
+    if (ec != ERR_OUT_OF_MEMORY || need > sizeof(buf)) {
+        return;
+    }
+    size_t size;
+    ec = into(self, need - 1, &size, buf);
+    CHECK(ec == ERR_OUT_OF_MEMORY && size == need && buf[0] == 0x7F, "%s: %s: cap %zu returned %d and wrote to the buffer", game_gname(self), what, need - 1, ec);
+    ec = into(self, need, &size, buf);
+    CHECK(ec == ERR_OK && size == strlen(expected) && strcmp(buf, expected) == 0, "%s: %s: into \"%s\", expected \"%s\"", game_gname(self), what, buf, expected);
+}
+
+// every _into query writes exactly what the buffered query returns, throughout random games
+// the buffered queries may just forward to the _into ones, so the moves are also checked to be distinct and legal, and the state unchanged
+static void test_query_into(const test_game* tg)
+{
+    game g;
+    if (test_game_create(&g, tg) == false) {
+        return;
+    }
+    CHECK(game_ff(&g).query_into, "%s: no query_into feature", test_game_name(tg));
+    game_rng rng = test_rng(34);
+    for (uint32_t step = 0; step < 64; step++) {
+        size_t size;
+        const char* str;
+        game_export_state(&g, &size, &str);
+        char* state = strdup(str);
+        test_check_into_str(&g, "export_state", state, game_export_state_into);
+        char* expected;
+        game_print(&g, &size, &str);
+        expected = strdup(str);
+        test_check_into_str(&g, "print", expected, game_print_into);
+        free(expected);
+
+        uint8_t ptm_count;
+        const player_id* ptm;
+        game_players_to_move(&g, &ptm_count, &ptm);
+        player_id players[UINT8_MAX];
+        uint8_t need_players = 0;
+        error_code ec = game_players_to_move_into(&g, 0, &need_players, players);
+        CHECK(ec == ERR_OUT_OF_MEMORY && need_players >= ptm_count, "%s: players_to_move cap 0 returned %d with count %hhu", test_game_name(tg), ec, need_players);
+        uint8_t players_count;
+        ec = game_players_to_move_into(&g, need_players, &players_count, players);
+        CHECK(ec == ERR_OK && players_count == ptm_count && memcmp(players, ptm, ptm_count * sizeof(player_id)) == 0, "%s: players_to_move into differs", test_game_name(tg));
+        if (ptm_count == 0) {
+            free(state);
+            break;
+        }
+
+        for (uint8_t i = 0; i < ptm_count; i++) {
+            uint32_t move_count;
+            const move_data* moves;
+            game_get_concrete_moves(&g, ptm[i], &move_count, &moves);
+            uint32_t need_moves = 0;
+            move_data dummy;
+            ec = game_get_concrete_moves_into(&g, ptm[i], 0, &need_moves, &dummy);
+            CHECK(ec == ERR_OUT_OF_MEMORY && need_moves >= move_count, "%s: concrete_moves cap 0 returned %d with count %u", test_game_name(tg), ec, need_moves);
+            if (ec != ERR_OUT_OF_MEMORY) {
+                continue;
+            }
+            move_data* into_moves = (move_data*)malloc(need_moves * sizeof(move_data));
+            uint32_t into_count;
+            ec = game_get_concrete_moves_into(&g, ptm[i], need_moves, &into_count, into_moves);
+            CHECK(ec == ERR_OK && into_count == move_count, "%s: concrete_moves into returned %d with %u moves, expected %u", test_game_name(tg), ec, into_count, move_count);
+            for (uint32_t m = 0; ec == ERR_OK && m < into_count && m < move_count; m++) {
+                CHECK(into_moves[m].cl.code == moves[m].cl.code, "%s: concrete move %u into %" PRIu64 ", expected %" PRIu64, test_game_name(tg), m, into_moves[m].cl.code, moves[m].cl.code);
+                for (uint32_t o = 0; o < m; o++) {
+                    CHECK(into_moves[o].cl.code != into_moves[m].cl.code, "%s: concrete move %" PRIu64 " listed twice", test_game_name(tg), into_moves[m].cl.code);
+                }
+                move_data_sync move = game_e_move_make_sync(&g, into_moves[m]);
+                CHECK(game_is_legal_move(&g, ptm[i], move) == ERR_OK, "%s: concrete move %" PRIu64 " is not legal", test_game_name(tg), into_moves[m].cl.code);
+                game_get_move_str(&g, ptm[i], move, &size, &str);
+                char* move_str = strdup(str);
+                char buf[64];
+                size_t need = 0;
+                CHECK(game_get_move_str_into(&g, ptm[i], move, 0, &need, buf) == ERR_OUT_OF_MEMORY && need <= sizeof(buf), "%s: move str cap 0 accepted", test_game_name(tg));
+                CHECK(game_get_move_str_into(&g, ptm[i], move, need, &size, buf) == ERR_OK && strcmp(buf, move_str) == 0, "%s: move str into \"%s\", expected \"%s\"", test_game_name(tg), buf, move_str);
+                free(move_str);
+            }
+            free(into_moves);
+        }
+        game_export_state(&g, &size, &str);
+        CHECK(strcmp(str, state) == 0, "%s: state \"%s\" changed to \"%s\" by the _into queries", test_game_name(tg), state, str);
+        free(state);
+
+        player_id player;
+        move_data_sync move;
+        if (test_random_move(&g, &rng, &player, &move) == false || game_make_move(&g, player, move) != ERR_OK) {
+            break;
+        }
+    }
+    game_destroy(&g);
+}
+
+// games with create_in live entirely in the block of size_hint from the arena, also while recording moves to unmake
+// games without it refuse size_hint, so nobody sizes an arena for a game that would not use it
+static void test_arena_games(const test_game* tg)
+{
+    game g = (game){.methods = tg->methods};
+    game_init init_info;
+    game_init_create_standard(&init_info, tg->opts, 0, NULL, NULL, NULL, 0);
+    size_t size;
+    error_code ec = game_size_hint(&g, &init_info, &size);
+    if (game_ff(&g).create_in == false) {
+        CHECK(ec == ERR_FEATURE_UNSUPPORTED, "%s: size_hint without create_in returned %d", test_game_name(tg), ec);
+        layout_serializer(GSIT_DESTROY, sl_game_init_info, &init_info, NULL, NULL, NULL);
+        return;
+    }
+    CHECK(ec == ERR_OK && size > 0, "%s: size_hint returned %d with size %zu", test_game_name(tg), ec, size);
+    const size_t block_size = size;
+    // room for exactly the game and one clone
+    size_t buf_size = game_e_arena_buffer_size(2 * block_size);
+    uint8_t* buf = (uint8_t*)malloc(buf_size);
+    game_arena arena;
+    game_e_arena_init(&arena, buf, buf_size);
+    ec = game_create_in(&g, &init_info, &arena);
+    layout_serializer(GSIT_DESTROY, sl_game_init_info, &init_info, NULL, NULL, NULL);
+    CHECK(ec == ERR_OK, "%s: create_in returned %d", test_game_name(tg), ec);
+    if (ec != ERR_OK) {
+        free(buf);
+        return;
+    }
+    CHECK((uint8_t*)g.data1 >= buf && (uint8_t*)g.data1 < buf + buf_size, "%s: game data outside of the arena", test_game_name(tg));
+    size_t used = arena.used;
+    game clone;
+    ec = game_clone_in(&g, &clone, &arena);
+    CHECK(ec == ERR_OK && arena.used - used == block_size, "%s: clone_in returned %d and took %zu, size_hint %zu", test_game_name(tg), ec, arena.used - used, block_size);
+    game extra;
+    used = arena.used;
+    ec = game_clone_in(&g, &extra, &arena);
+    CHECK(ec == ERR_OUT_OF_MEMORY && arena.used == used, "%s: clone_in into the full arena returned %d", test_game_name(tg), ec);
+    if (ec == ERR_OK) {
+        game_destroy(&extra);
+    }
+
+    game_rng rng = test_rng(35);
+    bool can_unmake = game_ff(&g).unmake_move;
+    game_e_unmake_enable(&g);
+    char* states[64];
+    player_id players[64];
+    move_data_sync moves[64];
+    uint32_t made = 0;
+    while (made < 64 && test_random_move(&g, &rng, &players[made], &moves[made]) == true) {
+        const char* str;
+        game_export_state(&g, &size, &str);
+        states[made] = strdup(str);
+        if (game_make_move(&g, players[made], moves[made]) != ERR_OK) {
+            free(states[made]);
+            break;
+        }
+        made++;
+        size_t state_size;
+        size_t buffers_size;
+        game_memory_usage(&g, &state_size, &buffers_size);
+        CHECK(state_size + buffers_size == block_size, "%s: move %u: memory usage %zu grew past the block of %zu", test_game_name(tg), made, state_size + buffers_size, block_size);
+    }
+    // the bounded history unmakes the most recent moves exactly, then refuses
+    uint32_t unmade = 0;
+    while (can_unmake == true && made > 0) {
+        made--;
+        ec = game_unmake_move(&g, players[made], (move_data_sync){moves[made].md, g.sync_ctr - 1});
+        if (ec != ERR_OK) {
+            CHECK(ec == ERR_INVALID_INPUT, "%s: unmake of move %u returned %d", test_game_name(tg), made, ec);
+            made++;
+            break;
+        }
+        unmade++;
+        const char* str;
+        game_export_state(&g, &size, &str);
+        CHECK(strcmp(str, states[made]) == 0, "%s: arena state after unmake of move %u \"%s\", expected \"%s\"", test_game_name(tg), made, str, states[made]);
+        free(states[made]);
+    }
+    CHECK(can_unmake == false || unmade > 0, "%s: no move unmade in the arena", test_game_name(tg));
+    while (made > 0) {
+        free(states[--made]);
+    }
+    game_destroy(&clone);
+    game_destroy(&g);
+    game_e_arena_reset(&arena);
+    CHECK(arena.used == 0, "%s: arena reset left %zu used", test_game_name(tg), arena.used);
+    free(buf);
+}
+
+// the pool keeps at most max_bytes of warm instances over all threads, and never reuses one for a source with other options
+static void test_game_pool(void)
+{
+    const test_game tg = {&havannah_standard_gbe, "5"};
+    const test_game other_tg = {&havannah_standard_gbe, "4"};
+    game source;
+    game other;
+    if (test_game_create(&source, &tg) == false) {
+        return;
+    }
+    if (test_game_create(&other, &other_tg) == false) {
+        game_destroy(&source);
+        return;
+    }
+    game_rng rng = test_rng(36);
+    test_play(&source, &rng, 6);
+    size_t state_size;
+    size_t buffers_size;
+    game_memory_usage(&source, &state_size, &buffers_size);
+    // room for two clones of source and a half, so the third release is over the cap
+    size_t max_bytes = 5 * (sizeof(game) + state_size + buffers_size) / 2;
+    game_pool* pool = game_pool_create(&source, 4, max_bytes);
+    CHECK(pool != NULL, "pool create failed");
+    if (pool == NULL) {
+        game_destroy(&other);
+        game_destroy(&source);
+        return;
+    }
+    game targets[4];
+    for (uint32_t i = 0; i < 4; i++) {
+        CHECK(game_pool_acquire(pool, &source, &targets[i]) == ERR_OK, "pool acquire %u failed", i);
+    }
+    size_t last_retained = 0;
+    for (uint32_t i = 0; i < 4; i++) {
+        game_pool_release(pool, &targets[i]);
+        size_t retained = game_pool_retained_bytes(pool);
+        CHECK(retained <= max_bytes, "pool release %u: retained %zu bytes, cap %zu", i, retained, max_bytes);
+        CHECK((i < 2) == (retained > last_retained), "pool release %u: retained %zu bytes after %zu", i, retained, last_retained);
+        last_retained = retained;
+    }
+    // a source with other options gets a fresh clone, the warm instances stay in the pool
+    game target;
+    CHECK(game_pool_acquire(pool, &other, &target) == ERR_OK, "pool acquire with other options failed");
+    CHECK(game_pool_retained_bytes(pool) == last_retained, "pool reused a warm instance for other options");
+    size_t size;
+    const char* str;
+    game_export_state(&other, &size, &str);
+    char* expected = strdup(str);
+    test_check_strs(&target, "pool acquire with other options", expected, NULL);
+    free(expected);
+    // and an instance with other options is not retained
+    game_pool_release(pool, &target);
+    CHECK(game_pool_retained_bytes(pool) == last_retained, "pool retained an instance with other options");
+    CHECK(game_pool_acquire(pool, &source, &target) == ERR_OK, "pool acquire of a warm instance failed");
+    CHECK(game_pool_retained_bytes(pool) < last_retained, "pool did not reuse a warm instance");
+    game_export_state(&source, &size, &str);
+    expected = strdup(str);
+    test_check_strs(&target, "pool acquire", expected, NULL);
+    free(expected);
+    game_export_options(&target, &size, &str);
+    CHECK(strcmp(str, "5") == 0, "pool acquire options \"%s\", expected \"5\"", str);
+    game_pool_release(pool, &target);
+    game_pool_destroy(pool);
+    game_destroy(&other);
+    game_destroy(&source);
+}
+
+// shared big move payloads are shared by their copies and stay valid until the last copy is destroyed
+// heap payloads move into a slab on their first copy, payloads too large for a slab stay on the heap
+static void test_big_move_slab(void)
+{
+    uint8_t buf[12288]; // larger than a slab payload may be
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = (uint8_t)(i * 7 + 3);
+    }
+    move_data heap_move = game_e_create_move_big(24, buf);
+    game_e_move_big_shared_enable(true);
+    move_data move = game_e_create_move_big(24, buf);
+    move_data copies[3];
+    for (int i = 0; i < 3; i++) {
+        CHECK(game_e_move_copy(&copies[i], &move) == true, "slab: copy %d failed", i);
+        CHECK(copies[i].data == move.data, "slab: copy %d does not share the payload", i);
+        CHECK(game_e_move_compare(copies[i], move) == true, "slab: copy %d differs", i);
+    }
+    game_e_move_destroy(move);
+    for (int i = 0; i < 3; i++) {
+        CHECK(copies[i].cl.len == 24 && memcmp(copies[i].data, buf, 24) == 0, "slab: copy %d lost its payload", i);
+    }
+    move_data moved;
+    move_data moved_copy;
+    game_e_move_copy(&moved, &heap_move);
+    game_e_move_copy(&moved_copy, &moved);
+    CHECK(moved.data != heap_move.data && moved_copy.data == moved.data, "slab: heap payload not shared after its first copy");
+    CHECK(game_e_move_compare(moved_copy, heap_move) == true, "slab: moved heap payload differs");
+    move_data large = game_e_create_move_big(sizeof(buf), buf);
+    move_data large_copy;
+    game_e_move_copy(&large_copy, &large);
+    CHECK(large_copy.data != large.data && game_e_move_compare(large_copy, large) == true, "slab: large payload shared or differs");
+    game_e_move_destroy(large_copy);
+    game_e_move_destroy(large);
+    game_e_move_destroy(moved_copy);
+    game_e_move_destroy(moved);
+    // churn through many slabs worth of payloads, the freed slabs get reused and every payload keeps its own bytes
+    // the slab of the copies must not be reused while they are alive
+    for (uint32_t round = 0; round < 64; round++) {
+        move_data churn[256];
+        for (uint32_t i = 0; i < 256; i++) {
+            churn[i] = game_e_create_move_big(64 + i % 64, buf + (round + i) % 1024);
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            CHECK(memcmp(churn[i].data, buf + (round + i) % 1024, 64 + i % 64) == 0, "slab: round %u: payload %u overwritten", round, i);
+            game_e_move_destroy(churn[i]);
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        CHECK(memcmp(copies[i].data, buf, 24) == 0, "slab: copy %d overwritten by reused slabs", i);
+        game_e_move_destroy(copies[i]);
+    }
+    game_e_move_big_shared_enable(false);
+    game_e_move_destroy(heap_move);
+}
+
+// the move mask of every batch instance holds exactly the concrete moves of its game, while stepping all instances to the end
+static void test_batch_moves(const test_game* tg)
+{
+    const uint32_t count = 16;
+    game games[16];
+    for (uint32_t i = 0; i < count; i++) {
+        if (test_game_create(&games[i], tg) == false) {
+            return;
+        }
+    }
+    if (game_ff(&games[0]).batch == false) {
+        for (uint32_t i = 0; i < count; i++) {
+            game_destroy(&games[i]);
+        }
+        return;
+    }
+    game_rng rng = test_rng(40);
+    for (uint32_t i = 0; i < count; i++) {
+        test_play(&games[i], &rng, i);
+    }
+    game_batch batch;
+    error_code ec = game_batch_create(&games[0], count, &batch);
+    CHECK(ec == ERR_OK, "%s: batch_create returned %d", test_game_name(tg), ec);
+    if (ec != ERR_OK) {
+        for (uint32_t i = 0; i < count; i++) {
+            game_destroy(&games[i]);
+        }
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        game_batch_load(&batch, i, &games[i]);
+    }
+    uint32_t words = game_e_batch_mask_words(&batch);
+    uint64_t* masks = (uint64_t*)malloc(count * words * sizeof(uint64_t));
+    player_id players[16];
+    uint32_t move_idxs[16];
+    bool running = true;
+    for (uint32_t ply = 0; running == true; ply++) {
+        running = false;
+        game_batch_players_to_move(&batch, players);
+        game_batch_get_move_masks(&batch, masks);
+        for (uint32_t i = 0; i < count; i++) {
+            move_idxs[i] = GAME_BATCH_MOVE_NONE;
+            uint8_t ptm_count;
+            const player_id* ptm;
+            game_players_to_move(&games[i], &ptm_count, &ptm);
+            player_id player = (ptm_count == 0 ? PLAYER_NONE : ptm[0]);
+            CHECK(players[i] == player, "%s: instance %u ply %u: batch ptm %u, game ptm %u", test_game_name(tg), i, ply, players[i], player);
+            uint32_t move_count = 0;
+            const move_data* moves = NULL;
+            if (player != PLAYER_NONE) {
+                game_get_concrete_moves(&games[i], player, &move_count, &moves);
+            }
+            uint32_t mask_count = 0;
+            for (uint32_t idx = 0; idx < batch.move_space; idx++) {
+                if (((masks[i * words + idx / 64] >> (idx % 64)) & 1) == 0) {
+                    continue;
+                }
+                mask_count++;
+                bool found = false;
+                for (uint32_t m = 0; m < move_count; m++) {
+                    found |= (moves[m].cl.code == batch.move_codes[idx]);
+                }
+                CHECK(found == true, "%s: instance %u ply %u: batch move %" PRIu64 " is not a concrete move", test_game_name(tg), i, ply, batch.move_codes[idx]);
+            }
+            CHECK(mask_count == move_count, "%s: instance %u ply %u: %u batch moves, %u concrete moves", test_game_name(tg), i, ply, mask_count, move_count);
+            if (mask_count == 0 || player == PLAYER_NONE) {
+                continue;
+            }
+            // step batch and game with the same random legal move
+            uint32_t pick = game_e_rng_intn(&rng, mask_count);
+            for (uint32_t idx = 0; idx < batch.move_space; idx++) {
+                if (((masks[i * words + idx / 64] >> (idx % 64)) & 1) == 1 && pick-- == 0) {
+                    move_idxs[i] = idx;
+                    break;
+                }
+            }
+            game_make_move(&games[i], player, game_e_move_make_sync(&games[i], game_e_create_move_small(batch.move_codes[move_idxs[i]])));
+            running = true;
+        }
+        if (running == true) {
+            game_batch_make_moves(&batch, move_idxs);
+        }
+    }
+    // the finished instances store back into the same state and result as their games
+    player_id results[16];
+    game_batch_get_results(&batch, results);
+    game stored;
+    if (test_game_create(&stored, tg) == true) {
+        for (uint32_t i = 0; i < count; i++) {
+            uint8_t result_count;
+            const player_id* result_players;
+            game_get_results(&games[i], &result_count, &result_players);
+            uint8_t player_count;
+            game_player_count(&games[i], &player_count);
+            // batches report draws as PLAYER_NONE, some games report them as a result outside the players
+            player_id result = (result_count == 0 || result_players[0] > player_count ? PLAYER_NONE : result_players[0]);
+            CHECK(results[i] == result, "%s: instance %u: batch result %u, game result %u", test_game_name(tg), i, results[i], result);
+            size_t size;
+            const char* str;
+            game_export_state(&games[i], &size, &str);
+            char* expected = strdup(str);
+            game_batch_store(&batch, i, &stored);
+            game_export_state(&stored, &size, &str);
+            CHECK(strcmp(str, expected) == 0, "%s: instance %u: stored state \"%s\", game state \"%s\"", test_game_name(tg), i, str, expected);
+            free(expected);
+        }
+        game_destroy(&stored);
+    }
+    free(masks);
+    game_batch_destroy(&batch);
+    for (uint32_t i = 0; i < count; i++) {
+        game_destroy(&games[i]);
+    }
+}
+
+// unmaking the moves of random games in reverse restores the exported state and id from before each move
+static void test_unmake_moves(const test_game* tg)
+{
+    game g;
+    if (test_game_create(&g, tg) == false) {
+        return;
+    }
+    if (game_ff(&g).unmake_move == false) {
+        game_destroy(&g);
+        return;
+    }
+    game_rng rng = test_rng(29);
+    // moves are only recorded once enabled, a move made before either can not be unmade or still restores the exact state
+    player_id player;
+    move_data_sync move;
+    if (test_random_move(&g, &rng, &player, &move) == true) {
+        size_t size;
+        const char* str;
+        game_export_state(&g, &size, &str);
+        char* before = strdup(str);
+        game_make_move(&g, player, move);
+        if (game_unmake_move(&g, player, (move_data_sync){move.md, g.sync_ctr - 1}) == ERR_OK) {
+            game_export_state(&g, &size, &str);
+            CHECK(strcmp(str, before) == 0, "%s: unrecorded unmake state \"%s\", expected \"%s\"", test_game_name(tg), str, before);
+        }
+        free(before);
+    }
+    game_e_unmake_enable(&g);
+    for (uint32_t round = 0; round < 8; round++) {
+        char* states[512];
+        uint64_t ids[512];
+        player_id players[512];
+        move_data_sync moves[512];
+        uint32_t made = 0;
+        while (made < 512 && test_random_move(&g, &rng, &players[made], &moves[made]) == true) {
+            size_t size;
+            const char* str;
+            game_export_state(&g, &size, &str);
+            states[made] = strdup(str);
+            ids[made] = 0;
+            if (game_ff(&g).id == true) {
+                game_id(&g, &ids[made]);
+            }
+            if (game_make_move(&g, players[made], moves[made]) != ERR_OK) {
+                free(states[made]);
+                break;
+            }
+            made++;
+        }
+        // a clone has no moves to unmake, it either refuses or still restores the exact state
+        game clone;
+        if (made > 0 && game_clone(&g, &clone) == ERR_OK) {
+            move_data_sync last = moves[made - 1];
+            last.sync_ctr = clone.sync_ctr - 1;
+            if (game_unmake_move(&clone, players[made - 1], last) == ERR_OK) {
+                size_t size;
+                const char* str;
+                game_export_state(&clone, &size, &str);
+                CHECK(strcmp(str, states[made - 1]) == 0, "%s: unmade clone state \"%s\", expected \"%s\"", test_game_name(tg), str, states[made - 1]);
+            }
+            game_destroy(&clone);
+        }
+        while (made > 0) {
+            made--;
+            error_code ec = game_unmake_move(&g, players[made], (move_data_sync){moves[made].md, g.sync_ctr - 1});
+            CHECK(ec == ERR_OK, "%s: round %u: unmake of move %u returned %d", test_game_name(tg), round, made, ec);
+            size_t size;
+            const char* str;
+            game_export_state(&g, &size, &str);
+            CHECK(strcmp(str, states[made]) == 0, "%s: round %u: state after unmake of move %u \"%s\", expected \"%s\"", test_game_name(tg), round, made, str, states[made]);
+            if (game_ff(&g).id == true) {
+                uint64_t id;
+                game_id(&g, &id);
+                CHECK(id == ids[made], "%s: round %u: id after unmake of move %u %" PRIu64 ", expected %" PRIu64, test_game_name(tg), round, made, id, ids[made]);
+            }
+            free(states[made]);
+        }
+    }
+    game_destroy(&g);
+}
+
+// the dense move codes list the concrete moves in the same order, both from the games that list codes directly and from the gather fallback of the wrapper
+static void test_move_codes(const test_game* tg)
+{
+    game g;
+    if (test_game_create(&g, tg) == false) {
+        return;
+    }
+    game_rng rng = test_rng(31);
+    for (uint32_t ply = 0; ply < 256; ply++) {
+        uint8_t ptm_count;
+        const player_id* ptm;
+        game_players_to_move(&g, &ptm_count, &ptm);
+        if (ptm_count == 0) {
+            break;
+        }
+        for (uint8_t p = 0; p < ptm_count; p++) {
+            uint32_t move_count;
+            const move_data* moves;
+            error_code ec = game_get_concrete_moves(&g, ptm[p], &move_count, &moves);
+            if (ec != ERR_OK) {
+                continue;
+            }
+            uint32_t code_count;
+            const move_code* codes;
+            ec = game_get_concrete_moves_codes(&g, ptm[p], &code_count, &codes);
+            CHECK(ec == ERR_OK && code_count == move_count, "%s: ply %u: move codes returned %d with %u codes, %u moves", test_game_name(tg), ply, ec, code_count, move_count);
+            if (ec != ERR_OK) {
+                continue;
+            }
+            for (uint32_t m = 0; m < move_count && m < code_count; m++) {
+                CHECK(codes[m] == moves[m].cl.code, "%s: ply %u: code %u is %" PRIu64 ", move %" PRIu64, test_game_name(tg), ply, m, codes[m], moves[m].cl.code);
+            }
+        }
+        if (test_play(&g, &rng, 1) == 0) {
+            break;
+        }
+    }
+    game_destroy(&g);
+    game_e_thread_cleanup();
+}
+
+// the lazy iteration lists every concrete move exactly once, also when each move is made and unmade during the iteration like in a search
+static void test_lazy_moves(const test_game* tg)
+{
+    game g;
+    if (test_game_create(&g, tg) == false) {
+        return;
+    }
+    // making moves in between is only allowed for the games that iterate lazily, the fallback list is gone after the next call
+    const bool make_between = game_ff(&g).lazy_moves && game_ff(&g).unmake_move;
+    if (make_between == true) {
+        game_e_unmake_enable(&g);
+    }
+    game_rng rng = test_rng(32);
+    for (uint32_t ply = 0; ply < 256; ply++) {
+        uint8_t ptm_count;
+        const player_id* ptm;
+        game_players_to_move(&g, &ptm_count, &ptm);
+        if (ptm_count == 0) {
+            break;
+        }
+        player_id players[8];
+        memcpy(players, ptm, ptm_count * sizeof(player_id));
+        size_t size;
+        const char* str;
+        game_export_state(&g, &size, &str);
+        char* before = strdup(str);
+        for (uint8_t p = 0; p < ptm_count; p++) {
+            uint32_t move_count;
+            const move_data* moves;
+            if (game_get_concrete_moves(&g, players[p], &move_count, &moves) != ERR_OK) {
+                continue;
+            }
+            move_code* codes = (move_code*)malloc((move_count + 1) * sizeof(move_code));
+            bool* seen = (bool*)calloc(move_count + 1, sizeof(bool));
+            for (uint32_t m = 0; m < move_count; m++) {
+                codes[m] = moves[m].cl.code;
+            }
+            move_iterator it;
+            error_code ec = game_get_moves_begin(&g, players[p], &it);
+            CHECK(ec == ERR_OK, "%s: ply %u: get_moves_begin returned %d", test_game_name(tg), ply, ec);
+            uint32_t seen_count = 0;
+            while (ec == ERR_OK) {
+                bool done;
+                move_data move;
+                ec = game_get_moves_next(&g, &it, &done, &move);
+                CHECK(ec == ERR_OK, "%s: ply %u: get_moves_next returned %d", test_game_name(tg), ply, ec);
+                if (ec != ERR_OK || done == true) {
+                    break;
+                }
+                uint32_t idx = 0;
+                while (idx < move_count && codes[idx] != move.cl.code) {
+                    idx++;
+                }
+                CHECK(idx < move_count, "%s: ply %u: lazy move %" PRIu64 " is not a concrete move", test_game_name(tg), ply, move.cl.code);
+                CHECK(idx == move_count || seen[idx] == false, "%s: ply %u: lazy move %" PRIu64 " listed twice", test_game_name(tg), ply, move.cl.code);
+                if (idx == move_count || seen[idx] == true) {
+                    break;
+                }
+                seen[idx] = true;
+                seen_count++;
+                if (make_between == true && ptm_count == 1) {
+                    game_make_move(&g, players[p], game_e_move_make_sync(&g, move));
+                    game_unmake_move(&g, players[p], (move_data_sync){move, g.sync_ctr - 1});
+                }
+            }
+            CHECK(seen_count == move_count, "%s: ply %u: lazy iteration listed %u of %u moves", test_game_name(tg), ply, seen_count, move_count);
+            free(seen);
+            free(codes);
+        }
+        test_check_strs(&g, "lazy moves", before, NULL);
+        free(before);
+        if (test_play(&g, &rng, 1) == 0) {
+            break;
+        }
+    }
+    game_destroy(&g);
+}
+
+// the rng is philox4x32-10, every way of drawing from a stream gives the same draws, and streams and seeds are independent
+static void test_rng_streams(void)
+{
+    // known answer of the reference implementation for the all zero key and counter
+    const uint32_t kat[4] = {0x6627E8D5, 0xE169C58D, 0xBC57AC4C, 0x9B00DBD8};
+    game_rng zero = {.key = {0, 0}, .stream = 0, .ctr = 0, .block = {0, 0, 0, 0}};
+    for (uint32_t i = 0; i < 4; i++) {
+        uint32_t draw = game_e_rng_at(&zero, i);
+        CHECK(draw == kat[i], "rng: zero key draw %u is %08x, expected %08x", i, draw, kat[i]);
+    }
+    seed128 seed = SEED128_NONE;
+    for (int i = 0; i < 16; i++) {
+        seed.bytes[i] = (uint8_t)(0x38 + i);
+    }
+    game_rng rng = game_e_rng_create(seed, 7);
+    game_rng again = game_e_rng_create(seed, 7);
+    uint32_t draws[128];
+    for (uint32_t i = 0; i < 128; i++) {
+        draws[i] = game_e_rng_next(&rng);
+        CHECK(draws[i] == game_e_rng_at(&rng, i), "rng: next and at differ at draw %u", i);
+        CHECK(draws[i] == game_e_rng_next(&again), "rng: two streams of the same seed differ at draw %u", i);
+    }
+    // unaligned heads, whole blocks and tails of the fill
+    const uint32_t fills[][2] = {{0, 0}, {0, 1}, {3, 1}, {3, 2}, {1, 9}, {4, 16}, {5, 37}, {2, 120}};
+    for (uint32_t f = 0; f < sizeof(fills) / sizeof(fills[0]); f++) {
+        uint32_t buf[128];
+        memset(buf, 0, sizeof(buf));
+        game_e_rng_fill(&rng, fills[f][0], fills[f][1], buf);
+        CHECK(memcmp(buf, draws + fills[f][0], fills[f][1] * sizeof(uint32_t)) == 0, "rng: fill of %u draws from %u differs from next", fills[f][1], fills[f][0]);
+        CHECK(fills[f][1] == 128 || buf[fills[f][1]] == 0, "rng: fill of %u draws from %u wrote past its count", fills[f][1], fills[f][0]);
+    }
+    CHECK(rng.ctr == 128, "rng: fill or at advanced the stream to %" PRIu64, rng.ctr);
+    // every seed byte and the stream index change the draws
+    game_rng others[17];
+    for (int i = 0; i < 16; i++) {
+        seed128 other_seed = seed;
+        other_seed.bytes[i] ^= 1;
+        others[i] = game_e_rng_create(other_seed, 7);
+    }
+    others[16] = game_e_rng_create(seed, 8);
+    for (int o = 0; o < 17; o++) {
+        uint32_t same = 0;
+        for (uint32_t i = 0; i < 16; i++) {
+            same += (game_e_rng_at(&others[o], i) == draws[i]);
+        }
+        CHECK(same == 0, "rng: %s %d shares %u of 16 draws", (o < 16 ? "seed byte" : "stream"), (o < 16 ? o : 8), same);
+    }
+    const uint32_t bounds[] = {1, 2, 3, 7, 1000, 0x80000001, UINT32_MAX};
+    for (uint32_t b = 0; b < sizeof(bounds) / sizeof(bounds[0]); b++) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t v = game_e_rng_intn(&rng, bounds[b]);
+            CHECK(v < bounds[b], "rng: intn(%u) returned %u", bounds[b], v);
+        }
+    }
+}
+
+// the playouts of the games draw from the rng streams, so the same seed plays out the same game
+static void test_playout_seeded(const test_game* tg)
+{
+    for (uint64_t i = 0; i < 4; i++) {
+        game a;
+        if (test_game_create(&a, tg) == false) {
+            return;
+        }
+        game b;
+        if (game_ff(&a).playout == false || test_game_create(&b, tg) == false) {
+            game_destroy(&a);
+            return;
+        }
+        seed128 seed = SEED128_NONE;
+        memcpy(seed.bytes, &i, sizeof(i));
+        seed.bytes[15] = 0x38;
+        error_code ec_a = game_playout(&a, seed);
+        error_code ec_b = game_playout(&b, seed);
+        CHECK(ec_a == ERR_OK && ec_b == ERR_OK, "%s: playout %" PRIu64 " returned %d and %d", test_game_name(tg), i, ec_a, ec_b);
+        size_t size;
+        const char* str;
+        game_export_state(&a, &size, &str);
+        char* state = strdup(str);
+        test_check_strs(&b, "seeded playout", state, NULL);
+        free(state);
+        game_destroy(&b);
+        game_destroy(&a);
+    }
+}
+
+// games report the bytes they own, the export buffers are fixed at create and the state does not give back memory while a game is played
+static void test_memory_usage(const test_game* tg)
+{
+    game g;
+    if (test_game_create(&g, tg) == false) {
+        return;
+    }
+    if (game_ff(&g).memory_usage == false) {
+        game_destroy(&g);
+        return;
+    }
+    size_t state_size;
+    size_t buffers_size;
+    game_memory_usage(&g, &state_size, &buffers_size);
+    CHECK(state_size > 0 && buffers_size > 0, "%s: memory usage of %zu state and %zu buffer bytes", test_game_name(tg), state_size, buffers_size);
+    game_rng rng = test_rng(41);
+    for (uint32_t ply = 0; test_play(&g, &rng, 1) == 1; ply++) {
+        size_t ply_state_size;
+        size_t ply_buffers_size;
+        game_memory_usage(&g, &ply_state_size, &ply_buffers_size);
+        CHECK(ply_buffers_size == buffers_size, "%s: ply %u: buffers went from %zu to %zu bytes", test_game_name(tg), ply, buffers_size, ply_buffers_size);
+        CHECK(ply_state_size >= state_size, "%s: ply %u: state went from %zu down to %zu bytes", test_game_name(tg), ply, state_size, ply_state_size);
+        state_size = ply_state_size;
+    }
+    game_destroy(&g);
+}
+
+// the memory usage follows the options, a larger board owns more state and larger buffers
+static void test_memory_usage_options(void)
+{
+    const test_game pairs[][2] = {
+        {{&havannah_standard_gbe, "4"}, {&havannah_standard_gbe, "8"}},
+        {{&twixt_pp_gbe, "12"}, {&twixt_pp_gbe, "24"}},
+        {{&oshisumo_gbe, "2-4"}, {&oshisumo_gbe, "5-12"}},
+    };
+    for (uint32_t i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++) {
+        size_t state_sizes[2];
+        size_t buffers_sizes[2];
+        bool created = true;
+        for (int k = 0; k < 2; k++) {
+            game g;
+            created = created && test_game_create(&g, &pairs[i][k]);
+            if (created == false) {
+                break;
+            }
+            game_memory_usage(&g, &state_sizes[k], &buffers_sizes[k]);
+            game_destroy(&g);
+        }
+        if (created == false) {
+            continue;
+        }
+        CHECK(state_sizes[1] > state_sizes[0] || buffers_sizes[1] > buffers_sizes[0], "%s: options \"%s\" own %zu + %zu bytes, \"%s\" %zu + %zu", test_game_name(&pairs[i][0]), pairs[i][0].opts, state_sizes[0], buffers_sizes[0], pairs[i][1].opts, state_sizes[1], buffers_sizes[1]);
+        CHECK(state_sizes[1] >= state_sizes[0] && buffers_sizes[1] >= buffers_sizes[0], "%s: options \"%s\" own less than \"%s\"", test_game_name(&pairs[i][0]), pairs[i][1].opts, pairs[i][0].opts);
+    }
+}
+
+// clones that share state with their source still behave like deep copies, moves on one of them never show up on another
+static void test_clone_independence(const test_game* tg)
+{
+    game g;
+    if (test_game_create(&g, tg) == false) {
+        return;
+    }
+    game_rng rng = test_rng(42);
+    test_play(&g, &rng, 10);
+    size_t size;
+    const char* str;
+    game_export_state(&g, &size, &str);
+    char* at_clone = strdup(str);
+    game clone;
+    game untouched;
+    error_code ec = game_clone(&g, &clone);
+    CHECK(ec == ERR_OK, "%s: clone returned %d", test_game_name(tg), ec);
+    if (ec != ERR_OK) {
+        free(at_clone);
+        game_destroy(&g);
+        return;
+    }
+    ec = game_clone(&g, &untouched);
+    CHECK(ec == ERR_OK, "%s: second clone returned %d", test_game_name(tg), ec);
+    if (ec != ERR_OK) {
+        game_destroy(&clone);
+        free(at_clone);
+        game_destroy(&g);
+        return;
+    }
+    player_id players[16];
+    move_data_sync moves[16];
+    uint32_t made = 0;
+    while (made < 16 && test_random_move(&g, &rng, &players[made], &moves[made]) == true && game_make_move(&g, players[made], moves[made]) == ERR_OK) {
+        made++;
+    }
+    game_rng clone_rng = test_rng(43);
+    test_play(&clone, &clone_rng, 16);
+    game_export_state(&clone, &size, &str);
+    char* clone_state = strdup(str);
+    // a clone of the clone writes too, the clone it came from keeps its state
+    game grandchild;
+    if (game_clone(&clone, &grandchild) == ERR_OK) {
+        test_play(&grandchild, &clone_rng, 8);
+        game_destroy(&grandchild);
+    }
+    test_check_strs(&clone, "clone after its clone played", clone_state, NULL);
+    test_check_strs(&untouched, "untouched clone", at_clone, NULL);
+    // the moves of the source replayed on an unshared copy of the state give the same state as on the source
+    game replay;
+    if (test_game_create(&replay, tg) == true) {
+        ec = game_import_state(&replay, at_clone);
+        CHECK(ec == ERR_OK, "%s: import of \"%s\" returned %d", test_game_name(tg), at_clone, ec);
+        for (uint32_t i = 0; ec == ERR_OK && i < made; i++) {
+            ec = game_make_move(&replay, players[i], game_e_move_make_sync(&replay, moves[i].md));
+            CHECK(ec == ERR_OK, "%s: replay of source move %u returned %d", test_game_name(tg), i, ec);
+        }
+        game_export_state(&g, &size, &str);
+        char* source_state = strdup(str);
+        test_check_strs(&replay, "source moves replayed", source_state, NULL);
+        free(source_state);
+        game_destroy(&replay);
+    }
+    free(clone_state);
+    free(at_clone);
+    game_destroy(&untouched);
+    game_destroy(&clone);
+    game_destroy(&g);
+}
+
+// clones of the copy on write boards share their blocks, so siblings that each made a move own far less than deep copies would
+static void test_cow_sharing(void)
+{
+    const test_game cow_games[] = {
+        {&twixt_pp_gbe, "24"},
+        {&havannah_standard_gbe, "8"},
+    };
+    const uint32_t SIBLINGS = 8;
+    for (uint32_t i = 0; i < sizeof(cow_games) / sizeof(cow_games[0]); i++) {
+        const test_game* tg = &cow_games[i];
+        game g;
+        if (test_game_create(&g, tg) == false) {
+            continue;
+        }
+        game_rng rng = test_rng(42);
+        test_play(&g, &rng, 10);
+        size_t single;
+        size_t buffers_size;
+        game_memory_usage(&g, &single, &buffers_size);
+        game siblings[8];
+        uint32_t cloned = 0;
+        while (cloned < SIBLINGS && game_clone(&g, &siblings[cloned]) == ERR_OK) {
+            cloned++;
+        }
+        CHECK(cloned == SIBLINGS, "%s: only %u of %u clones succeeded", test_game_name(tg), cloned, SIBLINGS);
+        size_t shared = 0;
+        size_t state_size;
+        game_memory_usage(&g, &state_size, &buffers_size);
+        shared += state_size;
+        for (uint32_t c = 0; c < cloned; c++) {
+            game_memory_usage(&siblings[c], &state_size, &buffers_size);
+            shared += state_size;
+        }
+        CHECK(shared < (cloned + 1) * single, "%s: source and %u clones own %zu state bytes, %zu each on their own", test_game_name(tg), cloned, shared, single);
+        // a move only copies the blocks it writes, not the whole board
+        size_t written = 0;
+        game_memory_usage(&g, &state_size, &buffers_size);
+        written += state_size;
+        for (uint32_t c = 0; c < cloned; c++) {
+            test_play(&siblings[c], &rng, 1);
+            game_memory_usage(&siblings[c], &state_size, &buffers_size);
+            written += state_size;
+        }
+        CHECK(written - shared < cloned * single / 2, "%s: one move on each of %u clones grew them by %zu bytes, the source owns %zu", test_game_name(tg), cloned, written - shared, single);
+        for (uint32_t c = 0; c < cloned; c++) {
+            game_destroy(&siblings[c]);
+        }
+        game_destroy(&g);
+    }
+}
+
+// maps a move of the game to its image under board symmetry t, in the numbering of the canonical_id of the game, returns the symmetry count
+static int test_sym_move(const test_game* tg, int t, move_code* move)
+{
+    if (tg->methods == &tictactoe_standard_gbe || tg->methods == &tictactoe_ultimate_gbe) {
+        // t & 4 mirrors x -> n - 1 - x, then rotates (t & 3) times by (x, y) -> (n - 1 - y, x)
+        const int n = (tg->methods == &tictactoe_standard_gbe ? 3 : 9);
+        const int shift = (tg->methods == &tictactoe_standard_gbe ? 2 : 4);
+        int x = (int)(*move & ((1 << shift) - 1));
+        int y = (int)(*move >> shift);
+        if ((t & 4) != 0) {
+            x = n - 1 - x;
+        }
+        for (int i = 0; i < (t & 3); i++) {
+            int rx = n - 1 - y;
+            y = x;
+            x = rx;
+        }
+        *move = ((move_code)y << shift) | (move_code)x;
+        return 8;
+    }
+    if (tg->methods == &havannah_standard_gbe) {
+        // cube coordinates around the center, t >= 6 swaps b and c, then rotates (t % 6) times by (a, b, c) -> (-c, -a, -b)
+        const int m = atoi(tg->opts) - 1;
+        int a = (int)(*move >> 8) - m;
+        int b = m - (int)(*move & 0xFF);
+        int c = -a - b;
+        if (t >= 6) {
+            int tmp = b;
+            b = c;
+            c = tmp;
+        }
+        for (int i = 0; i < t % 6; i++) {
+            int ra = -c;
+            int rb = -a;
+            int rc = -b;
+            a = ra;
+            b = rb;
+            c = rc;
+        }
+        *move = ((move_code)(a + m) << 8) | (move_code)(m - b);
+        return 12;
+    }
+    return 0;
+}
+
+// every symmetric image of a state gets the same canonical id, and the image under the returned transform is its own canonical image
+static void test_canonical_id(const test_game* tg)
+{
+    game g;
+    if (test_game_create(&g, tg) == false) {
+        return;
+    }
+    move_code probe = 0;
+    const int sym_count = test_sym_move(tg, 0, &probe);
+    if (game_ff(&g).canonical_id == false || sym_count == 0) {
+        game_destroy(&g);
+        return;
+    }
+    game images[12];
+    for (int t = 0; t < sym_count; t++) {
+        if (test_game_create(&images[t], tg) == false) {
+            for (int i = 0; i < t; i++) {
+                game_destroy(&images[i]);
+            }
+            game_destroy(&g);
+            return;
+        }
+    }
+    game_rng rng = test_rng(44);
+    player_id player;
+    move_data_sync move;
+    for (uint32_t ply = 0; ply < 256; ply++) {
+        uint64_t id;
+        uint8_t transform;
+        game_canonical_id(&g, &id, &transform);
+        CHECK(transform < sym_count, "%s: ply %u: transform %hhu of %d symmetries", test_game_name(tg), ply, transform, sym_count);
+        for (int t = 0; t < sym_count; t++) {
+            uint64_t image_id;
+            uint8_t image_transform;
+            game_canonical_id(&images[t], &image_id, &image_transform);
+            CHECK(image_id == id, "%s: ply %u: image %d has canonical id %016" PRIx64 ", expected %016" PRIx64, test_game_name(tg), ply, t, image_id, id);
+            CHECK(t != transform || image_transform == 0, "%s: ply %u: the image under transform %d is not canonical, it has transform %hhu", test_game_name(tg), ply, t, image_transform);
+        }
+        // the pie swap mirrors the stone, which only commutes with some of the symmetries
+        if (test_random_move(&g, &rng, &player, &move) == false || (tg->methods == &havannah_standard_gbe && move.md.cl.code == HAVANNAH_MOVE_SWAP)) {
+            break;
+        }
+        game_make_move(&g, player, move);
+        for (int t = 0; t < sym_count; t++) {
+            move_code image_move = move.md.cl.code;
+            test_sym_move(tg, t, &image_move);
+            error_code ec = game_make_move(&images[t], player, game_e_create_move_sync_small(&images[t], image_move));
+            CHECK(ec == ERR_OK, "%s: ply %u: image %d rejected move %" PRIu64 " as %" PRIu64 " with %d", test_game_name(tg), ply, t, move.md.cl.code, image_move, ec);
+        }
+    }
+    for (int t = 0; t < sym_count; t++) {
+        game_destroy(&images[t]);
+    }
+    game_destroy(&g);
+}
+
+// replays a random game through make_moves, trusted and checked, and expects the same state as the single moves, a checked batch stops right at a bad move
+static void test_make_moves(const test_game* tg)
+{
+    game g;
+    if (test_game_create(&g, tg) == false) {
+        return;
+    }
+    game_rng rng = test_rng(30);
+    char* states[257];
+    player_id players[256];
+    move_data_sync moves[256];
+    uint32_t made = 0;
+    while (made < 256 && test_random_move(&g, &rng, &players[made], &moves[made]) == true) {
+        size_t size;
+        const char* str;
+        game_export_state(&g, &size, &str);
+        states[made] = strdup(str);
+        if (game_make_move(&g, players[made], moves[made]) != ERR_OK) {
+            free(states[made]);
+            break;
+        }
+        made++;
+    }
+    {
+        size_t size;
+        const char* str;
+        game_export_state(&g, &size, &str);
+        states[made] = strdup(str);
+    }
+    // bad moves are placed halfway, a move by the player not to move and a move with a stale sync ctr
+    const uint32_t bad_idx = made / 2;
+    player_id bad_players[256];
+    move_data_sync bad_moves[256];
+    memcpy(bad_players, players, made * sizeof(player_id));
+    memcpy(bad_moves, moves, made * sizeof(move_data_sync));
+    for (int variant = 0; variant < 4; variant++) {
+        game r;
+        if (test_game_create(&r, tg) == false) {
+            break;
+        }
+        const uint64_t start_ctr = r.sync_ctr;
+        const player_id* use_players = players;
+        const move_data_sync* use_moves = moves;
+        uint32_t expect_made = made;
+        if (variant == 2) {
+            if (made == 0) {
+                game_destroy(&r);
+                continue;
+            }
+            bad_players[bad_idx] = 3 - players[bad_idx];
+            use_players = bad_players;
+            expect_made = bad_idx;
+        } else if (variant == 3) {
+            if (made == 0 || game_ff(&r).sync_ctr == true) {
+                game_destroy(&r);
+                continue;
+            }
+            bad_players[bad_idx] = players[bad_idx];
+            bad_moves[bad_idx].sync_ctr++;
+            use_moves = bad_moves;
+            expect_made = bad_idx;
+        }
+        uint32_t batch_made = UINT32_MAX;
+        error_code ec = game_make_moves(&r, made, use_players, use_moves, variant == 0, &batch_made);
+        CHECK((ec == ERR_OK) == (expect_made == made), "%s: make_moves variant %d returned %d", test_game_name(tg), variant, ec);
+        CHECK(variant != 3 || ec == ERR_SYNC_COUNTER_MISMATCH, "%s: make_moves with a stale sync ctr returned %d", test_game_name(tg), ec);
+        CHECK(batch_made == expect_made, "%s: make_moves variant %d made %u moves, expected %u", test_game_name(tg), variant, batch_made, expect_made);
+        CHECK(r.sync_ctr == start_ctr + expect_made, "%s: make_moves variant %d advanced the sync ctr by %" PRIu64 ", expected %u", test_game_name(tg), variant, r.sync_ctr - start_ctr, expect_made);
+        test_check_strs(&r, "make_moves", states[expect_made], NULL);
+        game_destroy(&r);
+    }
+    for (uint32_t i = 0; i <= made; i++) {
+        free(states[i]);
+    }
+    game_destroy(&g);
+}
+
+// reads the board of a chess state into board[y][x], empty squares are '-'
+static void test_chess_read_board(const char* state, char board[8][8])
+{
+    int y = 7;
+    int x = 0;
+    for (const char* c = state; *c != ' ' && *c != '\0'; c++) {
+        if (*c == '/') {
+            y--;
+            x = 0;
+        } else if (*c >= '1' && *c <= '8') {
+            for (int i = 0; i < *c - '0'; i++) {
+                board[y][x++] = '-';
+            }
+        } else {
+            board[y][x++] = *c;
+        }
+    }
+}
+
+// writes the board in the same notation as the chess export_state, returns the number of chars written
+static size_t test_chess_write_board(char board[8][8], char* str)
+{
+    char* outbuf = str;
+    for (int y = 7; y >= 0; y--) {
+        int empty_squares = 0;
+        for (int x = 0; x < 8; x++) {
+            if (board[y][x] == '-') {
+                empty_squares++;
+                continue;
+            }
+            if (empty_squares > 0) {
+                outbuf += sprintf(outbuf, "%d", empty_squares);
+                empty_squares = 0;
+            }
+            *outbuf++ = board[y][x];
+        }
+        if (empty_squares > 0) {
+            outbuf += sprintf(outbuf, "%d", empty_squares);
+        }
+        if (y > 0) {
+            *outbuf++ = '/';
+        }
+    }
+    *outbuf = '\0';
+    return outbuf - str;
+}
+
+// the chess delta since any of the last few states, applied to that state, gives the current export_state
+static void test_chess_delta(void)
+{
+    const test_game tg = {&chess_standard_gbe, NULL};
+    game_rng rng = test_rng(47);
+    const uint32_t history = 8;
+    char* states[8] = {NULL};
+    for (uint32_t round = 0; round < 4; round++) {
+        game g;
+        if (test_game_create(&g, &tg) == false) {
+            break;
+        }
+        uint64_t start = g.sync_ctr;
+        player_id player;
+        move_data_sync move;
+        do {
+            size_t size;
+            const char* str;
+            game_export_state(&g, &size, &str);
+            free(states[g.sync_ctr % history]);
+            states[g.sync_ctr % history] = strdup(str);
+            for (uint64_t back = 0; back < history && back <= g.sync_ctr - start; back++) {
+                uint64_t since = g.sync_ctr - back;
+                const char* delta;
+                game_export_state_delta(&g, since, &size, &delta);
+                // the created state is never a base, after that the journal reaches back at least one move
+                CHECK(delta != NULL || back > 1 || since == start, "chess: round %u: no delta over %" PRIu64 " moves", round, back);
+                if (delta == NULL) {
+                    continue;
+                }
+                char board[8][8];
+                test_chess_read_board(states[since % history], board);
+                // changed squares like "e2-,e4P" up to the state flags, which are copied as they are
+                const char* c = delta;
+                while (*c != ' ' && *c != '\0') {
+                    board[c[1] - '1'][c[0] - 'a'] = c[2];
+                    c += (c[3] == ',' ? 4 : 3);
+                }
+                char applied[256];
+                size_t len = test_chess_write_board(board, applied);
+                snprintf(applied + len, sizeof(applied) - len, "%s", c);
+                CHECK(strcmp(applied, states[g.sync_ctr % history]) == 0, "chess: round %u: delta \"%s\" over %" PRIu64 " moves gives \"%s\", expected \"%s\"", round, delta, back, applied, states[g.sync_ctr % history]);
+            }
+        } while (test_random_move(&g, &rng, &player, &move) == true && game_make_move(&g, player, move) == ERR_OK && g.sync_ctr - start < 300);
+        game_destroy(&g);
+    }
+    for (uint32_t i = 0; i < history; i++) {
+        free(states[i]);
+    }
+}
+
+// replaying a trace of random games, with unmakes and clones where supported, gives every call the recorded result again
+static void test_trace_replay(const test_game* tg)
+{
+    if (game_trace_enabled() == false) {
+        return;
+    }
+    const char* path = "game_tests.trace";
+    error_code ec = game_trace_start(path);
+    CHECK(ec == ERR_OK, "%s: trace start returned %d", test_game_name(tg), ec);
+    if (ec != ERR_OK) {
+        return;
+    }
+    game_rng rng = test_rng(50);
+    for (uint32_t round = 0; round < 4; round++) {
+        game g;
+        if (test_game_create(&g, tg) == false) {
+            break;
+        }
+        // every other game records its moves, so the unmakes are replayed both ways
+        if (game_ff(&g).unmake_move == true && round % 2 == 0) {
+            game_e_unmake_enable(&g);
+        }
+        player_id player;
+        move_data_sync move;
+        // random chess games rarely end on their own, so the games are cut off
+        for (uint32_t ply = 0; ply < 200 && test_random_move(&g, &rng, &player, &move) == true; ply++) {
+            size_t size;
+            const char* str;
+            game_export_state(&g, &size, &str);
+            if (game_make_move(&g, player, move) != ERR_OK) {
+                break;
+            }
+            if (game_ff(&g).unmake_move == true && game_e_rng_intn(&rng, 4) == 0) {
+                game_unmake_move(&g, player, (move_data_sync){move.md, g.sync_ctr - 1});
+            }
+        }
+        game clone;
+        if (game_clone(&g, &clone) == ERR_OK) {
+            uint8_t result_count;
+            const player_id* result_players;
+            game_get_results(&clone, &result_count, &result_players);
+            game_destroy(&clone);
+        }
+        game_destroy(&g);
+    }
+    ec = game_trace_stop();
+    CHECK(ec == ERR_OK, "%s: trace stop returned %d", test_game_name(tg), ec);
+    game_trace_replay_stats stats;
+    ec = game_trace_replay(path, tg->methods, &stats);
+    CHECK(ec == ERR_OK, "%s: trace replay returned %d", test_game_name(tg), ec);
+    CHECK(ec != ERR_OK || stats.calls > 0, "%s: trace replay made no calls", test_game_name(tg));
+    CHECK(ec != ERR_OK || stats.mismatches == 0, "%s: trace replay had %" PRIu64 " mismatches in %" PRIu64 " calls", test_game_name(tg), stats.mismatches, stats.calls);
+    remove(path);
+}
+
+int main(int argc, char** argv)
+{
+    for (uint32_t i = 0; i < TEST_GAME_COUNT; i++) {
+        test_batch_moves(&test_games[i]);
+        test_unmake_moves(&test_games[i]);
+        test_make_moves(&test_games[i]);
+        test_move_codes(&test_games[i]);
+        test_lazy_moves(&test_games[i]);
+        test_playout_seeded(&test_games[i]);
+        test_memory_usage(&test_games[i]);
+        test_clone_independence(&test_games[i]);
+        test_canonical_id(&test_games[i]);
+        test_trace_replay(&test_games[i]);
+        test_cache_queries(&test_games[i]);
+        test_arena_games(&test_games[i]);
+    }
+    test_chess_delta();
+    test_cache_unlisted_moves();
+    test_action_groups();
+    test_game_stats();
+    test_cache_internal_setters();
+    test_rng_streams();
+    test_memory_usage_options();
+    test_cow_sharing();
+    test_random_moves();
+    test_view_cache_moves();
+    test_playout_generic();
+    test_quasar_policy();
+    test_oshisumo_equilibrium();
+    test_rps_sync_rings();
+    test_game_pool();
+    test_big_move_slab();
+    for (uint32_t i = 0; i < TEST_INTO_GAME_COUNT; i++) {
+        test_query_into(&test_into_games[i]);
+        test_move_codes(&test_into_games[i]);
+        test_lazy_moves(&test_into_games[i]);
+        test_playout_seeded(&test_into_games[i]);
+        test_memory_usage(&test_into_games[i]);
+    }
+    printf("%u failed checks\n", check_failures);
+    return (check_failures == 0 ? 0 : 1);
+}